@@ -2523,6 +2523,65 @@ static enum AVPixelFormat get_format(AVCodecContext *s, const enum AVPixelFormat
     return *p;
 }
 
+/**
+ * Let the decoder write directly into a buffer provided by the filtergraph,
+ * so that filters like pad which hand out the interior of their output frame
+ * can avoid copying the decoded picture.
+ *
+ * This only saves the copy for frames the decoder does not keep a reference
+ * to, i.e. intra-only codecs and non-reference frames. Reference frames are
+ * not writable, and pad must not draw its borders over the coded area the
+ * decoder still predicts from, so they are still copied. Frame threaded
+ * decoders call get_buffer2 from their worker threads, which must not touch
+ * the filtergraph, so the path is disabled for them; use -threads 1 or slice
+ * threading to benefit from it.
+ */
+static int get_filter_buffer(AVCodecContext *s, AVFrame *frame)
+{
+    InputStream *ist = s->opaque;
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    int w = frame->width, h = frame->height;
+    AVFrame *buf;
+    int i;
+
+    /* the filtergraph may only be accessed from the main thread and some
+     * decoders cannot handle linesize changes, so once the buffers cannot
+     * be used for one frame, they are not used for the rest of the stream */
+    if (ist->no_filter_buffers || ist->nb_filters != 1 ||
+        !(s->codec->capabilities & AV_CODEC_CAP_DR1) ||
+        (s->active_thread_type & FF_THREAD_FRAME))
+        goto fail;
+
+    avcodec_align_dimensions2(s, &w, &h, linesize_align);
+    buf = av_buffersrc_get_video_buffer(ist->filters[0]->filter, w, h);
+    if (!buf)
+        goto fail;
+
+    if (buf->format != frame->format || buf->nb_extended_buf)
+        goto fail_buf;
+    for (i = 0; i < 4 && buf->data[i]; i++)
+        if (buf->linesize[i] % linesize_align[i] ||
+            (uintptr_t)buf->data[i] % linesize_align[i])
+            goto fail_buf;
+
+    for (i = 0; i < AV_NUM_DATA_POINTERS; i++) {
+        frame->buf[i]      = buf->buf[i];
+        frame->data[i]     = buf->data[i];
+        frame->linesize[i] = buf->linesize[i];
+        buf->buf[i] = NULL;
+    }
+    frame->extended_data = frame->data;
+    av_frame_free(&buf);
+
+    return 0;
+
+fail_buf:
+    av_frame_free(&buf);
+fail:
+    ist->no_filter_buffers = 1;
+    return AVERROR(ENOSYS);
+}
+
 static int get_buffer(AVCodecContext *s, AVFrame *frame, int flags)
 {
     InputStream *ist = s->opaque;
@@ -2530,6 +2589,9 @@ static int get_buffer(AVCodecContext *s, AVFrame *frame, int flags)
     if (ist->hwaccel_get_buffer && frame->format == ist->hwaccel_pix_fmt)
         return ist->hwaccel_get_buffer(s, frame, flags);
 
+    if (s->codec_type == AVMEDIA_TYPE_VIDEO && get_filter_buffer(s, frame) >= 0)
+        return 0;
+
     return avcodec_default_get_buffer2(s, frame, flags);
 }
 
@@ -324,6 +324,10 @@ typedef struct InputStream {
     InputFilter **filters;
     int        nb_filters;
 
+    /* decoded frames are allocated from the filtergraph (see get_buffer())
+     * until this is set because it was not possible for one of them */
+    int no_filter_buffers;
+
     int reinit_filters;
 
     /* hwaccel options */
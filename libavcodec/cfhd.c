@@ -43,6 +43,9 @@ static av_cold int cfhd_decode_init(AVCodecContext *avctx)
 
     avctx->bits_per_raw_sample = 10;
     s->avctx                   = avctx;
+    s->slice_count             = FFMAX(avctx->thread_count, 1);
+
+    ff_cfhddsp_init(&s->dsp);
 
     return ff_cfhd_init_vlcs(s);
 }
@@ -78,12 +81,12 @@ static inline int dequant_and_decompand(int level, int quantisation)
 }
 
 static inline void filter(int16_t *output, ptrdiff_t out_stride, int16_t *low, ptrdiff_t low_stride,
-                          int16_t *high, ptrdiff_t high_stride, int len, uint8_t clip)
+                          int16_t *high, ptrdiff_t high_stride, int len, int start, int end, uint8_t clip)
 {
     int16_t tmp;
 
     int i;
-    for (i = 0; i < len; i++) {
+    for (i = start; i < end; i++) {
         if (i == 0) {
             tmp = (11*low[0*low_stride] - 4*low[1*low_stride] + low[2*low_stride] + 4) >> 3;
             output[(2*i+0)*out_stride] = (tmp + high[0*high_stride]) >> 1;
@@ -118,20 +121,39 @@ static inline void filter(int16_t *output, ptrdiff_t out_stride, int16_t *low, p
     }
 }
 
-static void horiz_filter(int16_t *output, int16_t *low, int16_t *high, int width)
+/* Filter one line, the interior positions are left to the DSP function. */
+static void horiz_filter(CFHDContext *s, int16_t *output, int16_t *low, int16_t *high,
+                         int width, uint8_t clip)
 {
-    filter(output, 1, low, 1, high, 1, width, 0);
-}
+    int simd = FFMAX(width - 2, 0) & ~7;
 
-static void horiz_filter_clip(int16_t *output, int16_t *low, int16_t *high, int width, uint8_t clip)
-{
-    filter(output, 1, low, 1, high, 1, width, clip);
+    if (simd) {
+        if (clip)
+            s->dsp.horiz_filter_clip(output + 2, low + 1, high + 1, simd, clip);
+        else
+            s->dsp.horiz_filter(output + 2, low + 1, high + 1, simd);
+    }
+    filter(output, 1, low, 1, high, 1, width, 0, 1, clip);
+    filter(output, 1, low, 1, high, 1, width, simd + 1, width, clip);
 }
 
-static void vert_filter(int16_t *output, int out_stride, int16_t *low, int low_stride,
-                        int16_t *high, int high_stride, int len)
+/* Filter the output row pairs start to end - 1 of len. */
+static void vert_filter(CFHDContext *s, int16_t *output, int out_stride, int16_t *low, int low_stride,
+                        int16_t *high, int high_stride, int width, int len, int start, int end)
 {
-    filter(output, out_stride, low, low_stride, high, high_stride, len, 0);
+    int i, j;
+
+    for (i = start; i < end; i++) {
+        int simd = i > 0 && i < len - 1 ? width & ~7 : 0;
+
+        if (simd)
+            s->dsp.vert_filter(output + 2 * i * out_stride, out_stride,
+                               low + i * low_stride, low_stride,
+                               high + i * high_stride, simd);
+        for (j = simd; j < width; j++)
+            filter(output + j, out_stride, low + j, low_stride, high + j, high_stride,
+                   len, i, i + 1, 0);
+    }
 }
 
 static void free_buffers(AVCodecContext *avctx)
@@ -224,6 +246,80 @@ static int alloc_buffers(AVCodecContext *avctx)
     return 0;
 }
 
+typedef struct CFHDTransformStep {
+    AVFrame *pic;
+    int level;
+    int horizontal;
+} CFHDTransformStep;
+
+/* One slice of the vertical or horizontal step of a level of the inverse
+ * transform of a plane. Level 1 starts from the lowpass band, levels 2 and 3
+ * from the output of the previous level, and level 3 writes to the frame. */
+static int inverse_transform_thread(AVCodecContext *avctx, void *arg,
+                                    int jobnr, int threadnr)
+{
+    CFHDContext *s = avctx->priv_data;
+    CFHDTransformStep *step = arg;
+    int plane = jobnr / s->slice_count;
+    int slice = jobnr % s->slice_count;
+    int level = step->level;
+    Plane *p  = &s->plane[plane];
+    int lowpass_height  = p->band[level][!!level].height;
+    int lowpass_width   = p->band[level][!!level].width;
+    int highpass_stride = p->band[level][1].stride;
+    int16_t *low, *high, *output;
+    int i, j, start, end;
+
+    if (!step->horizontal) {
+        start = slice       * lowpass_height / s->slice_count;
+        end   = (slice + 1) * lowpass_height / s->slice_count;
+
+        vert_filter(s, p->l_h[3 * level], lowpass_width,
+                    p->subband[0], lowpass_width,
+                    p->subband[3 * level + 2], highpass_stride,
+                    lowpass_width, lowpass_height, start, end);
+        // note the stride of "low" is highpass_stride
+        vert_filter(s, p->l_h[3 * level + 1], lowpass_width,
+                    p->subband[3 * level + 1], highpass_stride,
+                    p->subband[3 * level + 3], highpass_stride,
+                    lowpass_width, lowpass_height, start, end);
+        return 0;
+    }
+
+    start = slice       * lowpass_height * 2 / s->slice_count;
+    end   = (slice + 1) * lowpass_height * 2 / s->slice_count;
+    low   = p->l_h[3 * level]     + start * lowpass_width;
+    high  = p->l_h[3 * level + 1] + start * lowpass_width;
+
+    if (level == DWT_LEVELS - 1) {
+        int act_plane = plane == 1 ? 2 : plane == 2 ? 1 : plane;
+        ptrdiff_t dst_stride = step->pic->linesize[act_plane] / 2;
+        int16_t *dst = (int16_t *)step->pic->data[act_plane] + start * dst_stride;
+
+        for (i = start; i < end; i++) {
+            horiz_filter(s, dst, low, high, lowpass_width, s->bpc);
+            low  += lowpass_width;
+            high += lowpass_width;
+            dst  += dst_stride;
+        }
+        return 0;
+    }
+
+    output = p->subband[0] + start * lowpass_width * 2;
+    for (i = start; i < end; i++) {
+        horiz_filter(s, output, low, high, lowpass_width, 0);
+        if (level || s->bpc == 12) {
+            for (j = 0; j < lowpass_width * 2; j++)
+                output[j] <<= 2;
+        }
+        low    += lowpass_width;
+        high   += lowpass_width;
+        output += lowpass_width * 2;
+    }
+
+    return 0;
+}
+
 static int cfhd_decode(AVCodecContext *avctx, void *data, int *got_frame,
                        AVPacket *avpkt)
 {
@@ -605,162 +701,35 @@ static int cfhd_decode(AVCodecContext *avctx, void *data, int *got_frame,
     }
 
     planes = av_pix_fmt_count_planes(avctx->pix_fmt);
-    for (plane = 0; plane < planes && !ret; plane++) {
-        /* level 1 */
-        int lowpass_height  = s->plane[plane].band[0][0].height;
-        int lowpass_width   = s->plane[plane].band[0][0].width;
-        int highpass_stride = s->plane[plane].band[0][1].stride;
-        int act_plane = plane == 1 ? 2 : plane == 2 ? 1 : plane;
-        int16_t *low, *high, *output, *dst;
-
-        if (lowpass_height > s->plane[plane].band[0][0].a_height || lowpass_width > s->plane[plane].band[0][0].a_width ||
-            !highpass_stride || s->plane[plane].band[0][1].width > s->plane[plane].band[0][1].a_width) {
-            av_log(avctx, AV_LOG_ERROR, "Invalid plane dimensions\n");
-            ret = AVERROR(EINVAL);
-            goto end;
-        }
-
-        av_log(avctx, AV_LOG_DEBUG, "Decoding level 1 plane %i %i %i %i\n", plane, lowpass_height, lowpass_width, highpass_stride);
-
-        low    = s->plane[plane].subband[0];
-        high   = s->plane[plane].subband[2];
-        output = s->plane[plane].l_h[0];
-        for (i = 0; i < lowpass_width; i++) {
-            vert_filter(output, lowpass_width, low, lowpass_width, high, highpass_stride, lowpass_height);
-            low++;
-            high++;
-            output++;
-        }
-
-        low    = s->plane[plane].subband[1];
-        high   = s->plane[plane].subband[3];
-        output = s->plane[plane].l_h[1];
-
-        for (i = 0; i < lowpass_width; i++) {
-            // note the stride of "low" is highpass_stride
-            vert_filter(output, lowpass_width, low, highpass_stride, high, highpass_stride, lowpass_height);
-            low++;
-            high++;
-            output++;
-        }
-
-        low    = s->plane[plane].l_h[0];
-        high   = s->plane[plane].l_h[1];
-        output = s->plane[plane].subband[0];
-        for (i = 0; i < lowpass_height * 2; i++) {
-            horiz_filter(output, low, high, lowpass_width);
-            low    += lowpass_width;
-            high   += lowpass_width;
-            output += lowpass_width * 2;
-        }
-        if (s->bpc == 12) {
-            output = s->plane[plane].subband[0];
-            for (i = 0; i < lowpass_height * 2; i++) {
-                for (j = 0; j < lowpass_width * 2; j++)
-                    output[j] <<= 2;
-
-                output += lowpass_width * 2;
+    for (plane = 0; plane < planes; plane++) {
+        for (i = 0; i < DWT_LEVELS; i++) {
+            SubBand *lowpass  = &s->plane[plane].band[i][!!i];
+            SubBand *highpass = &s->plane[plane].band[i][1];
+
+            if (lowpass->height > lowpass->a_height || lowpass->width > lowpass->a_width ||
+                !highpass->stride || highpass->width > highpass->a_width) {
+                av_log(avctx, AV_LOG_ERROR, "Invalid plane dimensions\n");
+                ret = AVERROR(EINVAL);
+                goto end;
             }
-        }
-
-        /* level 2 */
-        lowpass_height  = s->plane[plane].band[1][1].height;
-        lowpass_width   = s->plane[plane].band[1][1].width;
-        highpass_stride = s->plane[plane].band[1][1].stride;
-
-        if (lowpass_height > s->plane[plane].band[1][1].a_height || lowpass_width > s->plane[plane].band[1][1].a_width ||
-            !highpass_stride || s->plane[plane].band[1][1].width > s->plane[plane].band[1][1].a_width) {
-            av_log(avctx, AV_LOG_ERROR, "Invalid plane dimensions\n");
-            ret = AVERROR(EINVAL);
-            goto end;
-        }
-
-        av_log(avctx, AV_LOG_DEBUG, "Level 2 plane %i %i %i %i\n", plane, lowpass_height, lowpass_width, highpass_stride);
-
-        low    = s->plane[plane].subband[0];
-        high   = s->plane[plane].subband[5];
-        output = s->plane[plane].l_h[3];
-        for (i = 0; i < lowpass_width; i++) {
-            vert_filter(output, lowpass_width, low, lowpass_width, high, highpass_stride, lowpass_height);
-            low++;
-            high++;
-            output++;
-        }
-
-        low    = s->plane[plane].subband[4];
-        high   = s->plane[plane].subband[6];
-        output = s->plane[plane].l_h[4];
-        for (i = 0; i < lowpass_width; i++) {
-            vert_filter(output, lowpass_width, low, highpass_stride, high, highpass_stride, lowpass_height);
-            low++;
-            high++;
-            output++;
-        }
 
-        low    = s->plane[plane].l_h[3];
-        high   = s->plane[plane].l_h[4];
-        output = s->plane[plane].subband[0];
-        for (i = 0; i < lowpass_height * 2; i++) {
-            horiz_filter(output, low, high, lowpass_width);
-            low    += lowpass_width;
-            high   += lowpass_width;
-            output += lowpass_width * 2;
-        }
-
-        output = s->plane[plane].subband[0];
-        for (i = 0; i < lowpass_height * 2; i++) {
-            for (j = 0; j < lowpass_width * 2; j++)
-                output[j] <<= 2;
-
-            output += lowpass_width * 2;
-        }
-
-        /* level 3 */
-        lowpass_height  = s->plane[plane].band[2][1].height;
-        lowpass_width   = s->plane[plane].band[2][1].width;
-        highpass_stride = s->plane[plane].band[2][1].stride;
-
-        if (lowpass_height > s->plane[plane].band[2][1].a_height || lowpass_width > s->plane[plane].band[2][1].a_width ||
-            !highpass_stride || s->plane[plane].band[2][1].width > s->plane[plane].band[2][1].a_width) {
-            av_log(avctx, AV_LOG_ERROR, "Invalid plane dimensions\n");
-            ret = AVERROR(EINVAL);
-            goto end;
-        }
-
-        av_log(avctx, AV_LOG_DEBUG, "Level 3 plane %i %i %i %i\n", plane, lowpass_height, lowpass_width, highpass_stride);
-
-        low    = s->plane[plane].subband[0];
-        high   = s->plane[plane].subband[8];
-        output = s->plane[plane].l_h[6];
-        for (i = 0; i < lowpass_width; i++) {
-            vert_filter(output, lowpass_width, low, lowpass_width, high, highpass_stride, lowpass_height);
-            low++;
-            high++;
-            output++;
+            av_log(avctx, AV_LOG_DEBUG, "Level %i plane %i %i %i %i\n", i + 1, plane,
+                   lowpass->height, lowpass->width, highpass->stride);
         }
+    }
 
-        low    = s->plane[plane].subband[7];
-        high   = s->plane[plane].subband[9];
-        output = s->plane[plane].l_h[7];
-        for (i = 0; i < lowpass_width; i++) {
-            vert_filter(output, lowpass_width, low, highpass_stride, high, highpass_stride, lowpass_height);
-            low++;
-            high++;
-            output++;
-        }
+    /* Each step of a level depends on the whole previous step, run it on
+     * all planes at once to keep the threads busy */
+    for (i = 0; i < DWT_LEVELS; i++) {
+        CFHDTransformStep step = { .pic = pic, .level = i };
 
-        dst = (int16_t *)pic->data[act_plane];
-        low  = s->plane[plane].l_h[6];
-        high = s->plane[plane].l_h[7];
-        for (i = 0; i < lowpass_height * 2; i++) {
-            horiz_filter_clip(dst, low, high, lowpass_width, s->bpc);
-            low  += lowpass_width;
-            high += lowpass_width;
-            dst  += pic->linesize[act_plane] / 2;
-        }
+        avctx->execute2(avctx, inverse_transform_thread, &step, NULL,
+                        planes * s->slice_count);
+        step.horizontal = 1;
+        avctx->execute2(avctx, inverse_transform_thread, &step, NULL,
+                        planes * s->slice_count);
     }
 
-
 end:
     if (ret < 0)
         return ret;
@@ -792,6 +761,7 @@ AVCodec ff_cfhd_decoder = {
     .init           = cfhd_decode_init,
     .close          = cfhd_close_decoder,
     .decode         = cfhd_decode,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_INIT_CLEANUP,
 };
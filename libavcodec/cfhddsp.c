@@ -0,0 +1,80 @@
+/*
+ * CineForm HD DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "cfhddsp.h"
+
+static void horiz_filter(int16_t *output, const int16_t *low,
+                         const int16_t *high, int width)
+{
+    int i;
+
+    for (i = 0; i < width; i++) {
+        int16_t even = (low[i - 1] - low[i + 1] + 4) >> 3;
+        int16_t odd  = (low[i + 1] - low[i - 1] + 4) >> 3;
+
+        output[2 * i + 0] = (even + low[i] + high[i]) >> 1;
+        output[2 * i + 1] = (odd  + low[i] - high[i]) >> 1;
+    }
+}
+
+static void horiz_filter_clip(int16_t *output, const int16_t *low,
+                              const int16_t *high, int width, int clip)
+{
+    int i;
+
+    for (i = 0; i < width; i++) {
+        int16_t even = (low[i - 1] - low[i + 1] + 4) >> 3;
+        int16_t odd  = (low[i + 1] - low[i - 1] + 4) >> 3;
+
+        even = (even + low[i] + high[i]) >> 1;
+        odd  = (odd  + low[i] - high[i]) >> 1;
+        output[2 * i + 0] = av_clip_uintp2_c(even, clip);
+        output[2 * i + 1] = av_clip_uintp2_c(odd,  clip);
+    }
+}
+
+static void vert_filter(int16_t *output, ptrdiff_t out_stride,
+                        const int16_t *low, ptrdiff_t low_stride,
+                        const int16_t *high, int width)
+{
+    int i;
+
+    for (i = 0; i < width; i++) {
+        int16_t even = (low[i - low_stride] - low[i + low_stride] + 4) >> 3;
+        int16_t odd  = (low[i + low_stride] - low[i - low_stride] + 4) >> 3;
+
+        output[i]              = (even + low[i] + high[i]) >> 1;
+        output[i + out_stride] = (odd  + low[i] - high[i]) >> 1;
+    }
+}
+
+av_cold void ff_cfhddsp_init(CFHDDSPContext *c)
+{
+    c->horiz_filter      = horiz_filter;
+    c->horiz_filter_clip = horiz_filter_clip;
+    c->vert_filter       = vert_filter;
+
+    if (ARCH_X86)
+        ff_cfhddsp_init_x86(c);
+}
@@ -0,0 +1,58 @@
+/*
+ * CineForm HD DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_CFHDDSP_H
+#define AVCODEC_CFHDDSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Interior steps of the inverse 2/6 wavelet, for positions that have a
+ * neighbour on both sides. The first and last positions are handled by the
+ * caller. Intermediate values wrap to 16 bits as in the reference decoder.
+ */
+typedef struct CFHDDSPContext {
+    /**
+     * Horizontal step for width lowpass/highpass pairs, writing 2 * width
+     * interleaved samples. low[-1] and low[width] are read.
+     * width must be a multiple of 8.
+     */
+    void (*horiz_filter)(int16_t *output, const int16_t *low,
+                         const int16_t *high, int width);
+    /**
+     * Same as horiz_filter, clipping the output to clip bits unsigned.
+     */
+    void (*horiz_filter_clip)(int16_t *output, const int16_t *low,
+                              const int16_t *high, int width, int clip);
+    /**
+     * Vertical step for one row pair, writing output and
+     * output + out_stride. The lowpass rows above and below low are read.
+     * width must be a multiple of 8.
+     */
+    void (*vert_filter)(int16_t *output, ptrdiff_t out_stride,
+                        const int16_t *low, ptrdiff_t low_stride,
+                        const int16_t *high, int width);
+} CFHDDSPContext;
+
+void ff_cfhddsp_init(CFHDDSPContext *c);
+void ff_cfhddsp_init_x86(CFHDDSPContext *c);
+
+#endif /* AVCODEC_CFHDDSP_H */
@@ -85,6 +85,16 @@ static void flac_lpc_32_c(int32_t *decoded, const int coeffs[32],
 
 }
 
+static uint64_t flac_rice_sum_c(const uint32_t *res, int len, int k)
+{
+    uint64_t sum = 0;
+    int i;
+
+    for (i = 0; i < len; i++)
+        sum += res[i] >> k;
+    return sum;
+}
+
 av_cold void ff_flacdsp_init(FLACDSPContext *c, enum AVSampleFormat fmt, int channels,
                              int bps)
 {
@@ -92,6 +102,7 @@ av_cold void ff_flacdsp_init(FLACDSPContext *c, enum AVSampleFormat fmt, int cha
     c->lpc32        = flac_lpc_32_c;
     c->lpc16_encode = flac_lpc_encode_c_16;
     c->lpc32_encode = flac_lpc_encode_c_32;
+    c->rice_sum     = flac_rice_sum_c;
 
     switch (fmt) {
     case AV_SAMPLE_FMT_S32:
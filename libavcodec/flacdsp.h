@@ -33,6 +33,11 @@ typedef struct FLACDSPContext {
                          const int32_t coefs[32], int shift);
     void (*lpc32_encode)(int32_t *res, const int32_t *smp, int len, int order,
                          const int32_t coefs[32], int shift);
+    /**
+     * Sum of res[i] >> k, used for the rice parameter search.
+     * @param len number of elements, a positive multiple of 4
+     */
+    uint64_t (*rice_sum)(const uint32_t *res, int len, int k);
 } FLACDSPContext;
 
 void ff_flacdsp_init(FLACDSPContext *c, enum AVSampleFormat fmt, int channels, int bps);
@@ -125,6 +125,19 @@ typedef struct FlacEncodeContext {
 
     int flushed;
     int64_t next_pts;
+
+    /* frame-parallel encoding, in order of submission */
+    struct FlacEncodeContext *thread_ctx; ///< one context per queued frame
+    int nb_thread_ctx;
+    int nb_queued;                        ///< frames waiting to be encoded
+    int next_out;                         ///< next encoded frame to return
+    int nb_encoded;                       ///< encoded frames in the current batch
+
+    /* per-frame state of a thread context */
+    uint8_t *frame_buf;
+    int frame_bytes;
+    int frame_nb_samples;
+    int64_t frame_pts;
 } FlacEncodeContext;
 
 
@@ -462,7 +475,37 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     dprint_compression_options(s);
 
-    return ret;
+    if (ret < 0)
+        return ret;
+
+    if (avctx->active_thread_type & FF_THREAD_SLICE && avctx->thread_count > 1) {
+        s->thread_ctx = av_mallocz_array(avctx->thread_count, sizeof(*s->thread_ctx));
+        if (!s->thread_ctx)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < avctx->thread_count; i++) {
+            FlacEncodeContext *t = &s->thread_ctx[i];
+
+            /* only the configuration read by compress_frame() and
+             * write_frame(), the frame itself is set up per submission */
+            t->avctx      = avctx;
+            t->channels   = s->channels;
+            t->sr_code[0] = s->sr_code[0];
+            t->sr_code[1] = s->sr_code[1];
+            t->bps_code   = s->bps_code;
+            t->options    = s->options;
+            t->flac_dsp   = s->flac_dsp;
+            t->frame_buf  = av_malloc(s->max_framesize);
+            ret = ff_lpc_init(&t->lpc_ctx, avctx->frame_size,
+                              s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+            s->nb_thread_ctx++;
+            if (ret < 0)
+                return ret;
+            if (!t->frame_buf)
+                return AVERROR(ENOMEM);
+        }
+    }
+
+    return 0;
 }
 
 
@@ -661,7 +704,19 @@ static uint64_t calc_optimal_rice_params(RiceContext *rc, int porder,
 }
 
 
-static void calc_sum_top(int pmax, int kmax, const uint32_t *data, int n, int pred_order,
+static uint64_t rice_sum(const FLACDSPContext *dsp, const uint32_t *res,
+                         int len, int k)
+{
+    int len4 = len & ~3;
+    uint64_t sum = len4 ? dsp->rice_sum(res, len4, k) : 0;
+
+    for (; len4 < len; len4++)
+        sum += res[len4] >> k;
+    return sum;
+}
+
+static void calc_sum_top(const FLACDSPContext *dsp, int pmax, int kmax,
+                         const uint32_t *data, int n, int pred_order,
                          uint64_t sums[32][MAX_PARTITIONS])
 {
     int i, k;
@@ -675,17 +730,11 @@ static void calc_sum_top(int pmax, int kmax, const uint32_t *data, int n, int pr
         res     = &data[pred_order];
         res_end = &data[n >> pmax];
         for (i = 0; i < parts; i++) {
-            if (kmax) {
-                uint64_t sum = (1LL + k) * (res_end - res);
-                while (res < res_end)
-                    sum += *(res++) >> k;
-                sums[k][i] = sum;
-            } else {
-                uint64_t sum = 0;
-                while (res < res_end)
-                    sum += *(res++);
-                sums[k][i] = sum;
-            }
+            uint64_t sum = rice_sum(dsp, res, res_end - res, k);
+            if (kmax)
+                sum += (1LL + k) * (res_end - res);
+            sums[k][i] = sum;
+            res      = res_end;
             res_end += n >> pmax;
         }
     }
@@ -701,7 +750,7 @@ static void calc_sum_next(int level, uint64_t sums[32][MAX_PARTITIONS], int kmax
     }
 }
 
-static uint64_t calc_rice_params(RiceContext *rc,
+static uint64_t calc_rice_params(const FLACDSPContext *dsp, RiceContext *rc,
                                  uint32_t udata[FLAC_MAX_BLOCKSIZE],
                                  uint64_t sums[32][MAX_PARTITIONS],
                                  int pmin, int pmax,
@@ -722,7 +771,7 @@ static uint64_t calc_rice_params(RiceContext *rc,
     for (i = 0; i < n; i++)
         udata[i] = (2 * data[i]) ^ (data[i] >> 31);
 
-    calc_sum_top(pmax, exact ? kmax : 0, udata, n, pred_order, sums);
+    calc_sum_top(dsp, pmax, exact ? kmax : 0, udata, n, pred_order, sums);
 
     opt_porder = pmin;
     bits[pmin] = UINT32_MAX;
@@ -761,8 +810,9 @@ static uint64_t find_subframe_rice_params(FlacEncodeContext *s,
     uint64_t bits = 8 + pred_order * sub->obits + 2 + sub->rc.coding_mode;
     if (sub->type == FLAC_SUBFRAME_LPC)
         bits += 4 + 5 + pred_order * s->options.lpc_coeff_precision;
-    bits += calc_rice_params(&sub->rc, sub->rc_udata, sub->rc_sums, pmin, pmax, sub->residual,
-                             s->frame.blocksize, pred_order, s->options.exact_rice_parameters);
+    bits += calc_rice_params(&s->flac_dsp, &sub->rc, sub->rc_udata, sub->rc_sums,
+                             pmin, pmax, sub->residual, s->frame.blocksize,
+                             pred_order, s->options.exact_rice_parameters);
     return bits;
 }
 
@@ -1309,9 +1359,9 @@ static void write_frame_footer(FlacEncodeContext *s)
 }
 
 
-static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
+static int write_frame(FlacEncodeContext *s, uint8_t *buf, int buf_size)
 {
-    init_put_bits(&s->pb, avpkt->data, avpkt->size);
+    init_put_bits(&s->pb, buf, buf_size);
     write_frame_header(s);
     write_subframes(s);
     write_frame_footer(s);
@@ -1319,10 +1369,11 @@ static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
 }
 
 
-static int update_md5_sum(FlacEncodeContext *s, const void *samples)
+static int update_md5_sum(FlacEncodeContext *s, const void *samples,
+                          int nb_samples)
 {
     const uint8_t *buf;
-    int buf_size = s->frame.blocksize * s->channels *
+    int buf_size = nb_samples * s->channels *
                    ((s->avctx->bits_per_raw_sample + 7) / 8);
 
     if (s->avctx->bits_per_raw_sample > 16 || HAVE_BIGENDIAN) {
@@ -1343,7 +1394,7 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
         const int32_t *samples0 = samples;
         uint8_t *tmp            = s->md5_buffer;
 
-        for (i = 0; i < s->frame.blocksize * s->channels; i++) {
+        for (i = 0; i < nb_samples * s->channels; i++) {
             int32_t v = samples0[i] >> 8;
             AV_WL24(tmp + 3*i, v);
         }
@@ -1355,6 +1406,125 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
 }
 
 
+/**
+ * Compress the samples in s->frame and return the size of the coded frame.
+ */
+static int compress_frame(FlacEncodeContext *s)
+{
+    int frame_bytes;
+
+    channel_decorrelation(s);
+
+    remove_wasted_bits(s);
+
+    frame_bytes = encode_frame(s);
+
+    /* Fall back on verbatim mode if the compressed frame is larger than it
+       would be if encoded uncompressed. */
+    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
+        s->frame.verbatim_only = 1;
+        frame_bytes = encode_frame(s);
+        if (frame_bytes < 0) {
+            av_log(s->avctx, AV_LOG_ERROR, "Bad frame count\n");
+            return frame_bytes;
+        }
+    }
+
+    return frame_bytes;
+}
+
+
+static int encode_frame_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    FlacEncodeContext *t = &s->thread_ctx[jobnr];
+    int frame_bytes;
+
+    frame_bytes = compress_frame(t);
+    if (frame_bytes < 0)
+        return frame_bytes;
+
+    t->frame_bytes = write_frame(t, t->frame_buf, frame_bytes);
+    return 0;
+}
+
+
+/**
+ * Frame-parallel encoding: input frames are queued into thread contexts
+ * and compressed together once a batch is full, then returned in order.
+ * Frame numbers and the MD5 sum are assigned at submission time, so the
+ * output is identical to serial encoding.
+ */
+static int encode_frame_threaded(AVCodecContext *avctx, AVPacket *avpkt,
+                                 const AVFrame *frame, int *got_packet_ptr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    FlacEncodeContext *t;
+    int i, ret;
+
+    if (frame) {
+        t = &s->thread_ctx[s->nb_queued++];
+
+        t->frame_count   = s->frame_count++;
+        t->max_framesize = frame->nb_samples < s->max_blocksize ?
+                           ff_flac_get_max_frame_size(frame->nb_samples,
+                                                      s->channels,
+                                                      avctx->bits_per_raw_sample) :
+                           s->max_framesize;
+        t->frame_nb_samples = frame->nb_samples;
+        t->frame_pts        = frame->pts;
+        init_frame(t, frame->nb_samples);
+        copy_samples(t, frame->data[0]);
+
+        s->sample_count += frame->nb_samples;
+        if ((ret = update_md5_sum(s, frame->data[0], frame->nb_samples)) < 0) {
+            av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
+            return ret;
+        }
+    }
+
+    if (s->next_out == s->nb_encoded && s->nb_queued &&
+        (s->nb_queued == s->nb_thread_ctx || !frame)) {
+        int *job_ret = av_malloc_array(s->nb_queued, sizeof(*job_ret));
+        if (!job_ret)
+            return AVERROR(ENOMEM);
+        avctx->execute2(avctx, encode_frame_job, NULL, job_ret, s->nb_queued);
+        for (i = 0; i < s->nb_queued; i++) {
+            if (job_ret[i] < 0) {
+                ret = job_ret[i];
+                av_free(job_ret);
+                return ret;
+            }
+        }
+        av_free(job_ret);
+        s->nb_encoded = s->nb_queued;
+        s->nb_queued  = 0;
+        s->next_out   = 0;
+    }
+
+    if (s->next_out == s->nb_encoded)
+        return 0;
+
+    t = &s->thread_ctx[s->next_out++];
+    if ((ret = ff_alloc_packet2(avctx, avpkt, t->frame_bytes, 0)) < 0)
+        return ret;
+    memcpy(avpkt->data, t->frame_buf, t->frame_bytes);
+
+    if (t->frame_bytes > s->max_encoded_framesize)
+        s->max_encoded_framesize = t->frame_bytes;
+    if (t->frame_bytes < s->min_framesize)
+        s->min_framesize = t->frame_bytes;
+
+    avpkt->pts      = t->frame_pts;
+    avpkt->duration = ff_samples_to_time_base(avctx, t->frame_nb_samples);
+
+    s->next_pts = avpkt->pts + avpkt->duration;
+
+    *got_packet_ptr = 1;
+    return 0;
+}
+
+
 static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                              const AVFrame *frame, int *got_packet_ptr)
 {
@@ -1364,7 +1534,7 @@ static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
     s = avctx->priv_data;
 
     /* when the last block is reached, update the header in extradata */
-    if (!frame) {
+    if (!frame && (!s->nb_thread_ctx || s->nb_queued + s->nb_encoded == s->next_out)) {
         s->max_framesize = s->max_encoded_framesize;
         av_md5_final(s->md5ctx, s->md5sum);
         write_streaminfo(s, avctx->extradata);
@@ -1391,6 +1561,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
         return 0;
     }
 
+    if (s->nb_thread_ctx)
+        return encode_frame_threaded(avctx, avpkt, frame, got_packet_ptr);
+
     /* change max_framesize for small final frame */
     if (frame->nb_samples < s->frame.blocksize) {
         s->max_framesize = ff_flac_get_max_frame_size(frame->nb_samples,
@@ -1402,31 +1575,18 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
     copy_samples(s, frame->data[0]);
 
-    channel_decorrelation(s);
-
-    remove_wasted_bits(s);
-
-    frame_bytes = encode_frame(s);
-
-    /* Fall back on verbatim mode if the compressed frame is larger than it
-       would be if encoded uncompressed. */
-    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
-        s->frame.verbatim_only = 1;
-        frame_bytes = encode_frame(s);
-        if (frame_bytes < 0) {
-            av_log(avctx, AV_LOG_ERROR, "Bad frame count\n");
-            return frame_bytes;
-        }
-    }
+    frame_bytes = compress_frame(s);
+    if (frame_bytes < 0)
+        return frame_bytes;
 
     if ((ret = ff_alloc_packet2(avctx, avpkt, frame_bytes, 0)) < 0)
         return ret;
 
-    out_bytes = write_frame(s, avpkt);
+    out_bytes = write_frame(s, avpkt->data, avpkt->size);
 
     s->frame_count++;
     s->sample_count += frame->nb_samples;
-    if ((ret = update_md5_sum(s, frame->data[0])) < 0) {
+    if ((ret = update_md5_sum(s, frame->data[0], frame->nb_samples)) < 0) {
         av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
         return ret;
     }
@@ -1450,9 +1610,15 @@ static av_cold int flac_encode_close(AVCodecContext *avctx)
 {
     if (avctx->priv_data) {
         FlacEncodeContext *s = avctx->priv_data;
+        int i;
         av_freep(&s->md5ctx);
         av_freep(&s->md5_buffer);
         ff_lpc_end(&s->lpc_ctx);
+        for (i = 0; i < s->nb_thread_ctx; i++) {
+            ff_lpc_end(&s->thread_ctx[i].lpc_ctx);
+            av_freep(&s->thread_ctx[i].frame_buf);
+        }
+        av_freep(&s->thread_ctx);
     }
     av_freep(&avctx->extradata);
     avctx->extradata_size = 0;
@@ -1507,7 +1673,8 @@ AVCodec ff_flac_encoder = {
     .init           = flac_encode_init,
     .encode2        = flac_encode_frame,
     .close          = flac_encode_close,
-    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_LOSSLESS,
+    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_LOSSLESS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_S16,
                                                      AV_SAMPLE_FMT_S32,
                                                      AV_SAMPLE_FMT_NONE },
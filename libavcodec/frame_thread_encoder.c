@@ -23,6 +23,7 @@
 #include "libavutil/fifo.h"
 #include "libavutil/avassert.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/opt.h"
 #include "libavutil/thread.h"
 #include "avcodec.h"
 #include "internal.h"
@@ -30,6 +31,8 @@
 
 #define MAX_THREADS 64
 #define BUFFER_SIZE (2*MAX_THREADS)
+/* upper bound for the input frames held by the GOPs in flight */
+#define MAX_GOP_QUEUE_FRAMES (4*MAX_THREADS)
 
 typedef struct{
     void *indata;
@@ -38,6 +41,17 @@ typedef struct{
     unsigned index;
 } Task;
 
+/**
+ * A closed GOP encoded by its own encoder instance in GOP-parallel mode.
+ */
+typedef struct{
+    AVFrame **frames;
+    int nb_frames;
+    int64_t first_frame;    ///< display number of the first frame
+    AVPacket *pkts;
+    int nb_pkts;
+} GOPTask;
+
 typedef struct{
     AVCodecContext *parent_avctx;
     pthread_mutex_t buffer_mutex;
@@ -55,8 +69,42 @@ typedef struct{
 
     pthread_t worker[MAX_THREADS];
     int exit;
+
+    /* GOP-parallel mode for inter encoders */
+    int gop_size;                   ///< frames per GOP, 0 for per-frame tasks
+    AVCodecContext *gop_template;   ///< unopened copy of the parent context
+    AVDictionary *gop_options;
+    GOPTask *gop;                   ///< GOP being filled with input frames
+    int64_t gop_frame_count;
+    GOPTask *out_gop;               ///< finished GOP being returned
+    int out_pkt;
+    int64_t max_pts;
 } ThreadContext;
 
+static int get_task(ThreadContext *c, Task *task)
+{
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    while (av_fifo_size(c->task_fifo) <= 0 || c->exit) {
+        if(c->exit){
+            pthread_mutex_unlock(&c->task_fifo_mutex);
+            return 0;
+        }
+        pthread_cond_wait(&c->task_fifo_cond, &c->task_fifo_mutex);
+    }
+    av_fifo_generic_read(c->task_fifo, task, sizeof(*task), NULL);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+    return 1;
+}
+
+static void put_task(ThreadContext *c, Task *task)
+{
+    pthread_mutex_lock(&c->task_fifo_mutex);
+    av_fifo_generic_write(c->task_fifo, task, sizeof(*task), NULL);
+    pthread_cond_signal(&c->task_fifo_cond);
+    pthread_mutex_unlock(&c->task_fifo_mutex);
+    c->task_index = (c->task_index+1) % BUFFER_SIZE;
+}
+
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
@@ -71,16 +119,8 @@ static void * attribute_align_arg worker(void *v){
         if(!pkt) continue;
         av_init_packet(pkt);
 
-        pthread_mutex_lock(&c->task_fifo_mutex);
-        while (av_fifo_size(c->task_fifo) <= 0 || c->exit) {
-            if(c->exit){
-                pthread_mutex_unlock(&c->task_fifo_mutex);
-                goto end;
-            }
-            pthread_cond_wait(&c->task_fifo_cond, &c->task_fifo_mutex);
-        }
-        av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
-        pthread_mutex_unlock(&c->task_fifo_mutex);
+        if (!get_task(c, &task))
+            goto end;
         frame = task.indata;
 
         ret = avcodec_encode_video2(avctx, pkt, frame, &got_packet);
@@ -111,15 +151,152 @@ end:
     return NULL;
 }
 
+
+static void free_gop(ThreadContext *c, GOPTask **pgop)
+{
+    GOPTask *gop = *pgop;
+    int i;
+
+    if (!gop)
+        return;
+    pthread_mutex_lock(&c->buffer_mutex);
+    for (i = 0; i < gop->nb_frames; i++)
+        av_frame_free(&gop->frames[i]);
+    pthread_mutex_unlock(&c->buffer_mutex);
+    for (i = 0; i < gop->nb_pkts; i++)
+        av_packet_unref(&gop->pkts[i]);
+    av_freep(&gop->frames);
+    av_freep(&gop->pkts);
+    av_freep(pgop);
+}
+
+/**
+ * Encode one GOP with a fresh encoder instance, so that it does not
+ * reference any other GOP and can be coded independently.
+ */
+static int encode_gop(ThreadContext *c, GOPTask *gop)
+{
+    AVCodecContext *avctx = c->parent_avctx;
+    AVCodecContext *enc = avcodec_alloc_context3(avctx->codec);
+    AVDictionary *tmp = NULL;
+    int64_t tc_start;
+    int i, ret;
+
+    if (!enc)
+        return AVERROR(ENOMEM);
+
+FF_DISABLE_DEPRECATION_WARNINGS
+    ret = avcodec_copy_context(enc, c->gop_template);
+FF_ENABLE_DEPRECATION_WARNINGS
+    if (ret < 0)
+        goto end;
+    enc->thread_count = 1;
+
+    av_dict_copy(&tmp, c->gop_options, 0);
+    av_dict_set(&tmp, "threads", "1", 0);
+    ret = avcodec_open2(enc, avctx->codec, &tmp);
+    av_dict_free(&tmp);
+    if (ret < 0)
+        goto end;
+
+    /* keep GOP time codes continuous across instances */
+    if (av_opt_get_int(enc->priv_data, "timecode_frame_start", 0, &tc_start) >= 0)
+        av_opt_set_int(enc->priv_data, "timecode_frame_start",
+                       tc_start + gop->first_frame, 0);
+
+    /* one spare entry for the final, empty flush call */
+    gop->pkts = av_mallocz_array(gop->nb_frames + 1, sizeof(*gop->pkts));
+    if (!gop->pkts) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (i = 0; i <= gop->nb_frames; i++) {
+        AVFrame *frame = i < gop->nb_frames ? gop->frames[i] : NULL;
+        int got_packet;
+
+        do {
+            AVPacket *pkt = &gop->pkts[gop->nb_pkts];
+
+            if (gop->nb_pkts > gop->nb_frames) {
+                ret = AVERROR_BUG;
+                goto end;
+            }
+            av_init_packet(pkt);
+            pkt->data = NULL;
+            pkt->size = 0;
+            ret = avcodec_encode_video2(enc, pkt, frame, &got_packet);
+            if (ret < 0)
+                goto end;
+            gop->nb_pkts += got_packet;
+        } while (!frame && got_packet);
+
+        if (frame) {
+            pthread_mutex_lock(&c->buffer_mutex);
+            av_frame_free(&gop->frames[i]);
+            pthread_mutex_unlock(&c->buffer_mutex);
+        }
+    }
+
+end:
+    pthread_mutex_lock(&c->buffer_mutex);
+    avcodec_free_context(&enc);
+    pthread_mutex_unlock(&c->buffer_mutex);
+    return ret;
+}
+
+static void * attribute_align_arg gop_worker(void *v){
+    ThreadContext *c = v;
+    Task task;
+
+    while (get_task(c, &task)) {
+        int ret = encode_gop(c, task.indata);
+
+        pthread_mutex_lock(&c->finished_task_mutex);
+        c->finished_tasks[task.index].outdata = task.indata;
+        c->finished_tasks[task.index].return_code = ret;
+        pthread_cond_signal(&c->finished_task_cond);
+        pthread_mutex_unlock(&c->finished_task_mutex);
+    }
+    return NULL;
+}
+
+static int gop_parallel_supported(AVCodecContext *avctx)
+{
+    switch (avctx->codec_id) {
+    case AV_CODEC_ID_MPEG1VIDEO:
+    case AV_CODEC_ID_MPEG2VIDEO:
+    case AV_CODEC_ID_MPEG4:
+    case AV_CODEC_ID_MSMPEG4V2:
+    case AV_CODEC_ID_MSMPEG4V3:
+    case AV_CODEC_ID_WMV1:
+    case AV_CODEC_ID_WMV2:
+    case AV_CODEC_ID_H263P:
+        /* only when frame threading is requested explicitly, so that the
+         * default slice+frame setting keeps single instance rate control */
+        return !(avctx->thread_type & FF_THREAD_SLICE) && avctx->gop_size > 1 &&
+               !(avctx->flags & (AV_CODEC_FLAG_PASS1 | AV_CODEC_FLAG_PASS2));
+    }
+    return 0;
+}
+
 int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     int i=0;
+    int gop_size = 0;
     ThreadContext *c;
 
 
-    if(   !(avctx->thread_type & FF_THREAD_FRAME)
-       || !(avctx->codec->capabilities & AV_CODEC_CAP_INTRA_ONLY))
+    if(!(avctx->thread_type & FF_THREAD_FRAME))
         return 0;
 
+    /* Inter encoders can only be frame threaded by splitting the stream
+     * into closed GOPs of fixed length, each coded by its own instance. */
+    if (!(avctx->codec->capabilities & AV_CODEC_CAP_INTRA_ONLY)) {
+        if (!gop_parallel_supported(avctx))
+            return 0;
+        gop_size = avctx->gop_size;
+    }
+
     if(   !avctx->thread_count
        && avctx->codec_id == AV_CODEC_ID_MJPEG
        && !(avctx->flags & AV_CODEC_FLAG_QSCALE)) {
@@ -170,6 +347,16 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     if(avctx->thread_count > MAX_THREADS)
         return AVERROR(EINVAL);
 
+    /* Every GOP in flight keeps up to gop_size input frames alive, so
+     * limit the number of GOPs to keep the queued frames bounded. */
+    if (gop_size && avctx->thread_count * gop_size > MAX_GOP_QUEUE_FRAMES) {
+        int max_gops = FFMAX(MAX_GOP_QUEUE_FRAMES / gop_size, 1);
+        av_log(avctx, AV_LOG_VERBOSE,
+               "Limiting GOP-parallel encoding to %d threads for GOP size %d\n",
+               max_gops, gop_size);
+        avctx->thread_count = max_gops;
+    }
+
     av_assert0(!avctx->internal->frame_thread_encoder);
     c = avctx->internal->frame_thread_encoder = av_mallocz(sizeof(ThreadContext));
     if(!c)
@@ -187,6 +374,43 @@ int ff_frame_thread_encoder_init(AVCodecContext *avctx, AVDictionary *options){
     pthread_cond_init(&c->task_fifo_cond, NULL);
     pthread_cond_init(&c->finished_task_cond, NULL);
 
+    if (gop_size) {
+        c->gop_size = gop_size;
+        c->max_pts  = AV_NOPTS_VALUE;
+        c->gop_template = avcodec_alloc_context3(avctx->codec);
+        if (!c->gop_template)
+            goto fail;
+FF_DISABLE_DEPRECATION_WARNINGS
+        if (avcodec_copy_context(c->gop_template, avctx) < 0)
+            goto fail;
+#if FF_API_PRIVATE_OPT
+        c->gop_template->scenechange_threshold = 0;
+#endif
+FF_ENABLE_DEPRECATION_WARNINGS
+        av_dict_copy(&c->gop_options, options, 0);
+
+        /* Each instance sees exactly one GOP; close it and disable scene
+         * change detection so that no extra I-frames alter its length. */
+        c->gop_template->flags |= AV_CODEC_FLAG_CLOSED_GOP;
+        av_dict_set(&c->gop_options, "sc_threshold", "1000000000", 0);
+
+        /* Rate control runs per instance and restarts with every GOP. */
+        if (avctx->rc_buffer_size || avctx->rc_max_rate)
+            av_log(avctx, AV_LOG_WARNING,
+                   "VBV constraints are only enforced within each GOP in "
+                   "GOP-parallel encoding, the buffer model restarts at "
+                   "every GOP boundary.\n");
+
+        for (i = 0; i < avctx->thread_count; i++) {
+            if (pthread_create(&c->worker[i], NULL, gop_worker, c))
+                goto fail;
+        }
+
+        avctx->active_thread_type = FF_THREAD_FRAME;
+
+        return 0;
+    }
+
     for(i=0; i<avctx->thread_count ; i++){
         AVDictionary *tmp = NULL;
         void *tmpv;
@@ -238,15 +462,126 @@ void ff_frame_thread_encoder_free(AVCodecContext *avctx){
          pthread_join(c->worker[i], NULL);
     }
 
+    if (c->gop_size) {
+        Task task;
+
+        while (av_fifo_size(c->task_fifo) > 0) {
+            av_fifo_generic_read(c->task_fifo, &task, sizeof(task), NULL);
+            free_gop(c, (GOPTask **)&task.indata);
+        }
+        for (i = 0; i < BUFFER_SIZE; i++)
+            free_gop(c, (GOPTask **)&c->finished_tasks[i].outdata);
+        free_gop(c, &c->gop);
+        free_gop(c, &c->out_gop);
+        avcodec_free_context(&c->gop_template);
+        av_dict_free(&c->gop_options);
+    }
+
     pthread_mutex_destroy(&c->task_fifo_mutex);
     pthread_mutex_destroy(&c->finished_task_mutex);
     pthread_mutex_destroy(&c->buffer_mutex);
     pthread_cond_destroy(&c->task_fifo_cond);
     pthread_cond_destroy(&c->finished_task_cond);
+
     av_fifo_freep(&c->task_fifo);
     av_freep(&avctx->internal->frame_thread_encoder);
 }
 
+static void submit_gop(ThreadContext *c)
+{
+    Task task;
+
+    task.index  = c->task_index;
+    task.indata = c->gop;
+    c->gop = NULL;
+    put_task(c, &task);
+}
+
+static int gop_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
+                            const AVFrame *frame, int *got_packet_ptr)
+{
+    ThreadContext *c = avctx->internal->frame_thread_encoder;
+    Task task;
+    int ret;
+
+    if (frame) {
+        AVFrame *new;
+
+        if (!c->gop) {
+            c->gop = av_mallocz(sizeof(*c->gop));
+            if (!c->gop)
+                return AVERROR(ENOMEM);
+            c->gop->frames = av_mallocz_array(c->gop_size, sizeof(*c->gop->frames));
+            if (!c->gop->frames) {
+                av_freep(&c->gop);
+                return AVERROR(ENOMEM);
+            }
+            c->gop->first_frame = c->gop_frame_count;
+        }
+
+        new = av_frame_alloc();
+        if (!new)
+            return AVERROR(ENOMEM);
+        ret = av_frame_ref(new, frame);
+        if (ret < 0) {
+            av_frame_free(&new);
+            return ret;
+        }
+        c->gop->frames[c->gop->nb_frames++] = new;
+        c->gop_frame_count++;
+
+        if (c->gop->nb_frames == c->gop_size)
+            submit_gop(c);
+    } else if (c->gop) {
+        submit_gop(c);
+    }
+
+    for (;;) {
+        if (c->out_gop && c->out_pkt < c->out_gop->nb_pkts) {
+            *pkt = c->out_gop->pkts[c->out_pkt];
+            memset(&c->out_gop->pkts[c->out_pkt], 0, sizeof(*pkt));
+
+            /* The first packet of a GOP is decoded right after the last
+             * reference of the previous GOP, which is its last frame. */
+            if (!c->out_pkt && c->out_gop->first_frame &&
+                pkt->dts != AV_NOPTS_VALUE && c->max_pts != AV_NOPTS_VALUE &&
+                pkt->dts < pkt->pts)
+                pkt->dts = c->max_pts;
+            if (pkt->pts != AV_NOPTS_VALUE &&
+                (c->max_pts == AV_NOPTS_VALUE || pkt->pts > c->max_pts))
+                c->max_pts = pkt->pts;
+
+            c->out_pkt++;
+            *got_packet_ptr = 1;
+            return 0;
+        }
+        free_gop(c, &c->out_gop);
+
+        if (c->task_index == c->finished_task_index)
+            return 0;
+
+        pthread_mutex_lock(&c->finished_task_mutex);
+        if (frame && !c->finished_tasks[c->finished_task_index].outdata &&
+            (c->task_index - c->finished_task_index) % BUFFER_SIZE <= avctx->thread_count) {
+            pthread_mutex_unlock(&c->finished_task_mutex);
+            return 0;
+        }
+        while (!c->finished_tasks[c->finished_task_index].outdata)
+            pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+        task = c->finished_tasks[c->finished_task_index];
+        c->finished_tasks[c->finished_task_index].outdata = NULL;
+        c->finished_task_index = (c->finished_task_index+1) % BUFFER_SIZE;
+        pthread_mutex_unlock(&c->finished_task_mutex);
+
+        c->out_gop = task.outdata;
+        c->out_pkt = 0;
+        if (task.return_code < 0) {
+            free_gop(c, &c->out_gop);
+            return task.return_code;
+        }
+    }
+}
+
 int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVFrame *frame, int *got_packet_ptr){
     ThreadContext *c = avctx->internal->frame_thread_encoder;
     Task task;
@@ -254,6 +589,9 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
 
     av_assert1(!*got_packet_ptr);
 
+    if (c->gop_size)
+        return gop_encode_frame(avctx, pkt, frame, got_packet_ptr);
+
     if(frame){
         AVFrame *new = av_frame_alloc();
         if(!new)
@@ -266,12 +604,7 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt, const AVF
 
         task.index = c->task_index;
         task.indata = (void*)new;
-        pthread_mutex_lock(&c->task_fifo_mutex);
-        av_fifo_generic_write(c->task_fifo, &task, sizeof(task), NULL);
-        pthread_cond_signal(&c->task_fifo_cond);
-        pthread_mutex_unlock(&c->task_fifo_mutex);
-
-        c->task_index = (c->task_index+1) % BUFFER_SIZE;
+        put_task(c, &task);
 
         if(!c->finished_tasks[c->finished_task_index].outdata && (c->task_index - c->finished_task_index) % BUFFER_SIZE <= avctx->thread_count)
             return 0;
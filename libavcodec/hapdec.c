@@ -237,10 +237,28 @@ static int hap_parse_frame_header(AVCodecContext *avctx)
     return ret;
 }
 
+static void decompress_texture_rows(AVCodecContext *avctx, AVFrame *frame,
+                                    const uint8_t *d, int start, int end)
+{
+    HapContext *ctx = avctx->priv_data;
+    int w_block = avctx->coded_width / TEXTURE_BLOCK_W;
+    int x, y;
+
+    for (y = start; y < end; y++) {
+        uint8_t *p = frame->data[0] + y * frame->linesize[0] * TEXTURE_BLOCK_H;
+        int off  = y * w_block;
+        for (x = 0; x < w_block; x++) {
+            ctx->tex_fun(p + x * 16, frame->linesize[0],
+                         d + (off + x) * ctx->tex_rat);
+        }
+    }
+}
+
 static int decompress_chunks_thread(AVCodecContext *avctx, void *arg,
                                     int chunk_nb, int thread_nb)
 {
     HapContext *ctx = avctx->priv_data;
+    AVFrame *frame = arg;
 
     HapChunk *chunk = &ctx->chunks[chunk_nb];
     GetByteContext gbc;
@@ -262,6 +280,18 @@ static int decompress_chunks_thread(AVCodecContext *avctx, void *arg,
         bytestream2_get_buffer(&gbc, dst, chunk->compressed_size);
     }
 
+    /* The chunk holds whole rows of blocks, decode them while they are
+     * still in cache */
+    if (frame) {
+        int row_size = avctx->coded_width / TEXTURE_BLOCK_W * ctx->tex_rat;
+        int h_block  = avctx->coded_height / TEXTURE_BLOCK_H;
+        int start    = chunk->uncompressed_offset / row_size;
+        int end      = (chunk->uncompressed_offset + chunk->uncompressed_size) / row_size;
+
+        decompress_texture_rows(avctx, frame, ctx->tex_buf,
+                                FFMIN(start, h_block), FFMIN(end, h_block));
+    }
+
     return 0;
 }
 
@@ -270,10 +300,7 @@ static int decompress_texture_thread(AVCodecContext *avctx, void *arg,
 {
     HapContext *ctx = avctx->priv_data;
     AVFrame *frame = arg;
-    const uint8_t *d = ctx->tex_data;
-    int w_block = avctx->coded_width / TEXTURE_BLOCK_W;
     int h_block = avctx->coded_height / TEXTURE_BLOCK_H;
-    int x, y;
     int start_slice, end_slice;
     int base_blocks_per_slice = h_block / ctx->slice_count;
     int remainder_blocks = h_block % ctx->slice_count;
@@ -290,18 +317,33 @@ static int decompress_texture_thread(AVCodecContext *avctx, void *arg,
     if (slice < remainder_blocks)
         end_slice++;
 
-    for (y = start_slice; y < end_slice; y++) {
-        uint8_t *p = frame->data[0] + y * frame->linesize[0] * TEXTURE_BLOCK_H;
-        int off  = y * w_block;
-        for (x = 0; x < w_block; x++) {
-            ctx->tex_fun(p + x * 16, frame->linesize[0],
-                         d + (off + x) * ctx->tex_rat);
-        }
-    }
+    decompress_texture_rows(avctx, frame, ctx->tex_data, start_slice, end_slice);
 
     return 0;
 }
 
+/* Texture decoding can be merged into the chunk decompression when there
+ * are enough chunks to keep the threads busy and each of them starts and
+ * ends on a row of blocks. */
+static int hap_can_decode_per_chunk(AVCodecContext *avctx)
+{
+    HapContext *ctx = avctx->priv_data;
+    int row_size = avctx->coded_width / TEXTURE_BLOCK_W * ctx->tex_rat;
+    int i;
+
+    if (ctx->chunk_count < 2 || ctx->chunk_count < ctx->slice_count)
+        return 0;
+
+    for (i = 0; i < ctx->chunk_count; i++) {
+        HapChunk *chunk = &ctx->chunks[i];
+        if (chunk->uncompressed_offset % row_size ||
+            chunk->uncompressed_size   % row_size)
+            return 0;
+    }
+
+    return 1;
+}
+
 static int hap_decode(AVCodecContext *avctx, void *data,
                       int *got_frame, AVPacket *avpkt)
 {
@@ -309,6 +351,7 @@ static int hap_decode(AVCodecContext *avctx, void *data,
     ThreadFrame tframe;
     int ret, i;
     int tex_size;
+    int per_chunk = 0;
 
     bytestream2_init(&ctx->gbc, avpkt->data, avpkt->size);
 
@@ -331,12 +374,26 @@ static int hap_decode(AVCodecContext *avctx, void *data,
         ctx->tex_data = ctx->gbc.buffer;
         tex_size = bytestream2_get_bytes_left(&ctx->gbc);
     } else {
+        tex_size = ctx->tex_size;
+    }
+
+    if (tex_size < (avctx->coded_width  / TEXTURE_BLOCK_W)
+                  *(avctx->coded_height / TEXTURE_BLOCK_H)
+                  *ctx->tex_rat) {
+        av_log(avctx, AV_LOG_ERROR, "Insufficient data\n");
+        return AVERROR_INVALIDDATA;
+    }
+
+    if (!hap_can_use_tex_in_place(ctx)) {
+        per_chunk = hap_can_decode_per_chunk(avctx);
+
         /* Perform the second-stage decompression */
         ret = av_reallocp(&ctx->tex_buf, ctx->tex_size);
         if (ret < 0)
             return ret;
 
-        avctx->execute2(avctx, decompress_chunks_thread, NULL,
+        avctx->execute2(avctx, decompress_chunks_thread,
+                        per_chunk ? tframe.f : NULL,
                         ctx->chunk_results, ctx->chunk_count);
 
         for (i = 0; i < ctx->chunk_count; i++) {
@@ -345,18 +402,11 @@ static int hap_decode(AVCodecContext *avctx, void *data,
         }
 
         ctx->tex_data = ctx->tex_buf;
-        tex_size = ctx->tex_size;
-    }
-
-    if (tex_size < (avctx->coded_width  / TEXTURE_BLOCK_W)
-                  *(avctx->coded_height / TEXTURE_BLOCK_H)
-                  *ctx->tex_rat) {
-        av_log(avctx, AV_LOG_ERROR, "Insufficient data\n");
-        return AVERROR_INVALIDDATA;
     }
 
     /* Use the decompress function on the texture, one block per thread */
-    avctx->execute2(avctx, decompress_texture_thread, tframe.f, NULL, ctx->slice_count);
+    if (!per_chunk)
+        avctx->execute2(avctx, decompress_texture_thread, tframe.f, NULL, ctx->slice_count);
 
     /* Frame is ready to be output */
     tframe.f->pict_type = AV_PICTURE_TYPE_I;
@@ -52,19 +52,32 @@ enum HapHeaderLength {
     HAP_HDR_LONG = 8,
 };
 
-static void compress_texture(AVCodecContext *avctx, const AVFrame *f)
+static int compress_texture_thread(AVCodecContext *avctx, void *arg,
+                                   int slice, int thread_nb)
 {
     HapContext *ctx = avctx->priv_data;
-    uint8_t *out = ctx->tex_buf;
-    int i, j;
-
-    for (j = 0; j < avctx->height; j += 4) {
-        for (i = 0; i < avctx->width; i += 4) {
-            uint8_t *p = f->data[0] + i * 4 + j * f->linesize[0];
-            const int step = ctx->tex_fun(out, f->linesize[0], p);
-            out += step;
-        }
+    const AVFrame *f = arg;
+    int w_block = avctx->width  / TEXTURE_BLOCK_W;
+    int h_block = avctx->height / TEXTURE_BLOCK_H;
+    int x, y;
+    int start_slice, end_slice;
+    int base_blocks_per_slice = h_block / ctx->slice_count;
+    int remainder_blocks = h_block % ctx->slice_count;
+
+    /* Same slicing as the decoder: the first slices take one more row of
+     * blocks when the height does not divide evenly */
+    start_slice = slice * base_blocks_per_slice + FFMIN(slice, remainder_blocks);
+    end_slice   = start_slice + base_blocks_per_slice + (slice < remainder_blocks);
+
+    for (y = start_slice; y < end_slice; y++) {
+        const uint8_t *p = f->data[0] + y * f->linesize[0] * TEXTURE_BLOCK_H;
+        uint8_t *out = ctx->tex_buf + y * w_block * ctx->tex_rat;
+
+        for (x = 0; x < w_block; x++)
+            ctx->tex_fun(out + x * ctx->tex_rat, f->linesize[0], p + x * 16);
     }
+
+    return 0;
 }
 
 /* section_length does not include the header */
@@ -85,47 +98,64 @@ static void hap_write_section_header(PutByteContext *pbc,
     }
 }
 
+/* Compress one chunk with snappy into its own max_snappy sized slot of dst */
+static int compress_chunks_thread(AVCodecContext *avctx, void *arg,
+                                  int chunk_nb, int thread_nb)
+{
+    HapContext *ctx = avctx->priv_data;
+    HapChunk *chunk = &ctx->chunks[chunk_nb];
+    uint8_t *chunk_src, *chunk_dst;
+    int ret;
+
+    chunk->uncompressed_size = ctx->tex_size / ctx->chunk_count;
+    chunk->uncompressed_offset = chunk_nb * chunk->uncompressed_size;
+    chunk->compressed_size = ctx->max_snappy;
+    chunk_src = ctx->tex_buf + chunk->uncompressed_offset;
+    chunk_dst = (uint8_t *)arg + chunk_nb * ctx->max_snappy;
+
+    ret = snappy_compress(chunk_src, chunk->uncompressed_size,
+                          chunk_dst, &chunk->compressed_size);
+    if (ret != SNAPPY_OK) {
+        av_log(avctx, AV_LOG_ERROR, "Snappy compress error.\n");
+        return AVERROR_BUG;
+    }
+
+    /* If there is no gain from snappy, just use the raw texture. */
+    if (chunk->compressed_size >= chunk->uncompressed_size) {
+        av_log(avctx, AV_LOG_VERBOSE,
+               "Snappy buffer bigger than uncompressed (%lu >= %lu bytes).\n",
+               chunk->compressed_size, chunk->uncompressed_size);
+        memcpy(chunk_dst, chunk_src, chunk->uncompressed_size);
+        chunk->compressor = HAP_COMP_NONE;
+        chunk->compressed_size = chunk->uncompressed_size;
+    } else {
+        chunk->compressor = HAP_COMP_SNAPPY;
+    }
+
+    return 0;
+}
+
 static int hap_compress_frame(AVCodecContext *avctx, uint8_t *dst)
 {
     HapContext *ctx = avctx->priv_data;
     int i, final_size = 0;
 
+    /* Compress (using Snappy) each chunk on its own thread, write directly
+     * on packet buffer. */
+    avctx->execute2(avctx, compress_chunks_thread, dst,
+                    ctx->chunk_results, ctx->chunk_count);
+
+    /* Pack the chunks, each one only ever moves towards the start */
     for (i = 0; i < ctx->chunk_count; i++) {
         HapChunk *chunk = &ctx->chunks[i];
-        uint8_t *chunk_src, *chunk_dst;
-        int ret;
-
-        if (i == 0) {
-            chunk->compressed_offset = 0;
-        } else {
-            chunk->compressed_offset = ctx->chunks[i-1].compressed_offset
-                                       + ctx->chunks[i-1].compressed_size;
-        }
-        chunk->uncompressed_size = ctx->tex_size / ctx->chunk_count;
-        chunk->uncompressed_offset = i * chunk->uncompressed_size;
-        chunk->compressed_size = ctx->max_snappy;
-        chunk_src = ctx->tex_buf + chunk->uncompressed_offset;
-        chunk_dst = dst + chunk->compressed_offset;
-
-        /* Compress with snappy too, write directly on packet buffer. */
-        ret = snappy_compress(chunk_src, chunk->uncompressed_size,
-                              chunk_dst, &chunk->compressed_size);
-        if (ret != SNAPPY_OK) {
-            av_log(avctx, AV_LOG_ERROR, "Snappy compress error.\n");
-            return AVERROR_BUG;
-        }
 
-        /* If there is no gain from snappy, just use the raw texture. */
-        if (chunk->compressed_size >= chunk->uncompressed_size) {
-            av_log(avctx, AV_LOG_VERBOSE,
-                   "Snappy buffer bigger than uncompressed (%lu >= %lu bytes).\n",
-                   chunk->compressed_size, chunk->uncompressed_size);
-            memcpy(chunk_dst, chunk_src, chunk->uncompressed_size);
-            chunk->compressor = HAP_COMP_NONE;
-            chunk->compressed_size = chunk->uncompressed_size;
-        } else {
-            chunk->compressor = HAP_COMP_SNAPPY;
-        }
+        if (ctx->chunk_results[i] < 0)
+            return ctx->chunk_results[i];
+
+        chunk->compressed_offset = final_size;
+        if (i)
+            memmove(dst + final_size, dst + i * ctx->max_snappy,
+                    chunk->compressed_size);
 
         final_size += chunk->compressed_size;
     }
@@ -200,8 +230,9 @@ static int hap_encode(AVCodecContext *avctx, AVPacket *pkt,
     if (ret < 0)
         return ret;
 
-    /* DXTC compression. */
-    compress_texture(avctx, frame);
+    /* DXTC compression, one slice of rows per thread. */
+    avctx->execute2(avctx, compress_texture_thread, (void *)frame, NULL,
+                    ctx->slice_count);
 
     /* Compress (using Snappy) the frame */
     final_data_size = hap_compress_frame(avctx, pkt->data + header_length);
@@ -236,7 +267,7 @@ static av_cold int hap_init(AVCodecContext *avctx)
         return AVERROR_INVALIDDATA;
     }
 
-    ff_texturedspenc_init(&ctx->dxtc);
+    ff_texturedspenc_init(&ctx->dxtc, ctx->opt_tex_fit);
 
     switch (ctx->opt_tex_fmt) {
     case HAP_FMT_RGBDXT1:
@@ -266,6 +297,10 @@ static av_cold int hap_init(AVCodecContext *avctx)
      * beforehand the final size of the uncompressed buffer. */
     ctx->tex_size   = FFALIGN(avctx->width,  TEXTURE_BLOCK_W) *
                       FFALIGN(avctx->height, TEXTURE_BLOCK_H) * 4 / ratio;
+    ctx->tex_rat    = 64 / ratio;
+
+    ctx->slice_count = av_clip(avctx->thread_count, 1,
+                               avctx->height / TEXTURE_BLOCK_H);
 
     /* Round the chunk count to divide evenly on DXT block edges */
     corrected_chunk_count = av_clip(ctx->opt_chunk_count, 1, HAP_MAX_CHUNKS);
@@ -306,6 +341,10 @@ static const AVOption options[] = {
         { "hap_alpha", "Hap Alpha (DXT5 textures)", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_FMT_RGBADXT5  }, 0, 0, FLAGS, "format" },
         { "hap_q",     "Hap Q (DXT5-YCoCg textures)", 0, AV_OPT_TYPE_CONST, { .i64 = HAP_FMT_YCOCGDXT5 }, 0, 0, FLAGS, "format" },
     { "chunks", "chunk count", OFFSET(opt_chunk_count), AV_OPT_TYPE_INT, {.i64 = 1 }, 1, HAP_MAX_CHUNKS, FLAGS, },
+    { "texture_fit", "texture compression speed/quality tradeoff", OFFSET(opt_tex_fit), AV_OPT_TYPE_INT, { .i64 = TEXTURE_FIT_PCA }, TEXTURE_FIT_RANGE, TEXTURE_FIT_CLUSTER, FLAGS, "texture_fit" },
+        { "range",   "Fastest, bounding box endpoints", 0, AV_OPT_TYPE_CONST, { .i64 = TEXTURE_FIT_RANGE   }, 0, 0, FLAGS, "texture_fit" },
+        { "pca",     "Principal axis endpoints",        0, AV_OPT_TYPE_CONST, { .i64 = TEXTURE_FIT_PCA     }, 0, 0, FLAGS, "texture_fit" },
+        { "cluster", "Slowest, least squares cluster fit", 0, AV_OPT_TYPE_CONST, { .i64 = TEXTURE_FIT_CLUSTER }, 0, 0, FLAGS, "texture_fit" },
     { NULL },
 };
 
@@ -326,6 +365,7 @@ AVCodec ff_hap_encoder = {
     .init           = hap_init,
     .encode2        = hap_encode,
     .close          = hap_close,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGBA, AV_PIX_FMT_NONE,
     },
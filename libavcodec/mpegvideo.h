@@ -556,6 +556,10 @@ typedef struct MpegEncContext {
     int b_frame_strategy;
     int b_sensitivity;
 
+    /* lookahead analysis used by b_frame_strategy = 3 */
+    struct LookaheadContext *lookahead;
+    float lookahead_aq;
+
     /* frame skip options for encoding */
     int frame_skip_threshold;
     int frame_skip_factor;
@@ -640,7 +644,8 @@ FF_MPV_OPT_CMP_FUNC, \
 { "epzs", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = FF_ME_EPZS }, 0, 0, FF_MPV_OPT_FLAGS, "motion_est" }, \
 { "xone", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = FF_ME_XONE }, 0, 0, FF_MPV_OPT_FLAGS, "motion_est" }, \
 { "force_duplicated_matrix", "Always write luma and chroma matrix for mjpeg, useful for rtp streaming.", FF_MPV_OFFSET(force_duplicated_matrix), AV_OPT_TYPE_BOOL, {.i64 = 0 }, 0, 1, FF_MPV_OPT_FLAGS },   \
-{"b_strategy", "Strategy to choose between I/P/B-frames",           FF_MPV_OFFSET(b_frame_strategy), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, 2, FF_MPV_OPT_FLAGS }, \
+{"b_strategy", "Strategy to choose between I/P/B-frames",           FF_MPV_OFFSET(b_frame_strategy), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, 3, FF_MPV_OPT_FLAGS }, \
+{"lookahead_aq", "Lower the quantizer of reference blocks the lookahead finds reused (b_strategy 3)", FF_MPV_OFFSET(lookahead_aq), AV_OPT_TYPE_FLOAT, {.dbl = 0 }, 0, 4, FF_MPV_OPT_FLAGS }, \
 {"b_sensitivity", "Adjust sensitivity of b_frame_strategy 1",       FF_MPV_OFFSET(b_sensitivity), AV_OPT_TYPE_INT, {.i64 = 40 }, 1, INT_MAX, FF_MPV_OPT_FLAGS }, \
 {"brd_scale", "Downscale frames for dynamic B-frame decision",      FF_MPV_OFFSET(brd_scale), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, 3, FF_MPV_OPT_FLAGS }, \
 {"skip_threshold", "Frame skip threshold",                          FF_MPV_OFFSET(frame_skip_threshold), AV_OPT_TYPE_INT, {.i64 = 0 }, INT_MIN, INT_MAX, FF_MPV_OPT_FLAGS }, \
@@ -692,6 +697,13 @@ int ff_mpv_encode_picture(AVCodecContext *avctx, AVPacket *pkt,
                           const AVFrame *frame, int *got_packet);
 int ff_mpv_reallocate_putbitbuffer(MpegEncContext *s, size_t threshold, size_t size_increase);
 
+int ff_mpv_lookahead_init(MpegEncContext *s);
+void ff_mpv_lookahead_uninit(MpegEncContext *s);
+void ff_mpv_lookahead_add_frame(MpegEncContext *s, const AVFrame *frame,
+                                int display_picture_number);
+int ff_mpv_lookahead_b_count(MpegEncContext *s);
+const float *ff_mpv_lookahead_aq_weights(MpegEncContext *s);
+
 void ff_clean_intra_table_entries(MpegEncContext *s);
 void ff_mpeg_draw_horiz_band(MpegEncContext *s, int y, int h);
 void ff_mpeg_flush(AVCodecContext *avctx);
@@ -432,6 +432,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
                          s->avctx->spatial_cplx_masking  ||
                          s->avctx->p_masking      ||
                          s->border_masking ||
+                         (s->lookahead_aq && s->b_frame_strategy == 3) ||
                          (s->mpv_flags & FF_MPV_FLAG_QP_RD)) &&
                         !s->fixed_qscale;
 
@@ -684,6 +685,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     }
 
     if (s->avctx->thread_count > 1         &&
+        !(s->avctx->active_thread_type & FF_THREAD_FRAME) &&
         s->codec_id != AV_CODEC_ID_MPEG4      &&
         s->codec_id != AV_CODEC_ID_MPEG1VIDEO &&
         s->codec_id != AV_CODEC_ID_MPEG2VIDEO &&
@@ -1101,6 +1103,10 @@ FF_ENABLE_DEPRECATION_WARNINGS
             if (ret < 0)
                 return ret;
         }
+    } else if (s->b_frame_strategy == 3) {
+        ret = ff_mpv_lookahead_init(s);
+        if (ret < 0)
+            return ret;
     }
 
     cpb_props = ff_add_cpb_side_data(avctx);
@@ -1133,6 +1139,7 @@ av_cold int ff_mpv_encode_end(AVCodecContext *avctx)
 
     for (i = 0; i < FF_ARRAY_ELEMS(s->tmp_frames); i++)
         av_frame_free(&s->tmp_frames[i]);
+    ff_mpv_lookahead_uninit(s);
 
     ff_free_picture_tables(&s->new_picture);
     ff_mpeg_unref_picture(s->avctx, &s->new_picture);
@@ -1328,6 +1335,9 @@ static int load_input_picture(MpegEncContext *s, const AVFrame *pic_arg)
 
         pic->f->display_picture_number = display_picture_number;
         pic->f->pts = pts; // we set this here to avoid modifying pic_arg
+
+        if (s->lookahead)
+            ff_mpv_lookahead_add_frame(s, pic_arg, display_picture_number);
     } else {
         /* Flushing: When we have not received enough input frames,
          * ensure s->input_picture[0] contains the first picture */
@@ -1601,6 +1611,10 @@ static int select_input_picture(MpegEncContext *s)
                 }
             } else if (s->b_frame_strategy == 2) {
                 b_frames = estimate_best_b_count(s);
+            } else if (s->b_frame_strategy == 3) {
+                b_frames = ff_mpv_lookahead_b_count(s);
+                if (b_frames < 0)
+                    return b_frames;
             }
 
             emms_c();
@@ -0,0 +1,502 @@
+/*
+ * Lookahead analysis for the mpegvideo encoders
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Lookahead analysis for the mpegvideo encoders (b_strategy 3).
+ *
+ * Input frames are downscaled by two once, when they are queued. The cost
+ * of coding a frame as P or B from a given set of references is estimated
+ * on the small frames, one 8x8 block per macroblock, with a small motion
+ * search over the SAD functions of MECmpContext. Costs are cached per
+ * (past, future, current) triple and computed in parallel through
+ * avctx->execute(). They drive B-frame placement, scene cut detection and
+ * an optional adaptive quantization weight for reference frames.
+ */
+
+#include "libavutil/avassert.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "avcodec.h"
+#include "mpegutils.h"
+#include "mpegvideo.h"
+
+#define LA_PAD   32     ///< edge extension of the small frames
+#define LA_RANGE 8      ///< motion search range in small frame pixels
+#define LA_NONE  (-1)
+#define LA_B_BIAS 0.5f  ///< weight of B-frame costs, they get a coarser quantizer
+
+typedef struct LookaheadFrame {
+    int display_picture_number;     ///< -1 if the slot is unused
+    uint8_t *base;
+    uint8_t *data;                  ///< top left pixel of the small frame
+    int *intra_cost;                ///< per block DC prediction cost
+    int *prev_cost;                 ///< per block cost from the previous frame
+    int prev_valid;
+    int64_t intra_sum;
+} LookaheadFrame;
+
+typedef struct LookaheadJob {
+    struct LookaheadContext *la;
+    int cur, past, future;
+    int64_t cost;
+} LookaheadJob;
+
+typedef struct LookaheadContext {
+    MpegEncContext *s;
+    int nb_frames;
+    LookaheadFrame *frames;
+    int linesize;
+    int bw, bh;                     ///< number of 8x8 blocks
+    int64_t *costs;                 ///< [past][future + 1][cur], -1 if unknown
+    LookaheadJob *jobs;
+    int nb_jobs;
+    float *aq;
+} LookaheadContext;
+
+#define COST(la, past, future, cur) \
+    (la)->costs[((past) * ((la)->nb_frames + 1) + (future) + 1) * (la)->nb_frames + (cur)]
+
+av_cold int ff_mpv_lookahead_init(MpegEncContext *s)
+{
+    LookaheadContext *la;
+    int i, h;
+
+    la = s->lookahead = av_mallocz(sizeof(*la));
+    if (!la)
+        return AVERROR(ENOMEM);
+
+    la->s         = s;
+    la->nb_frames = s->max_b_frames + 3;
+    la->bw        = s->mb_width;
+    la->bh        = s->mb_height;
+    la->linesize  = FFALIGN(la->bw * 8 + 2 * LA_PAD, 32);
+    h             = la->bh * 8 + 2 * LA_PAD;
+
+    la->frames = av_mallocz_array(la->nb_frames, sizeof(*la->frames));
+    la->costs  = av_malloc_array(la->nb_frames * (la->nb_frames + 1) * la->nb_frames,
+                                 sizeof(*la->costs));
+    la->jobs   = av_malloc_array(la->nb_frames * (la->nb_frames + 1), sizeof(*la->jobs));
+    la->aq     = av_malloc_array(la->bw * la->bh, sizeof(*la->aq));
+    if (!la->frames || !la->costs || !la->jobs || !la->aq)
+        return AVERROR(ENOMEM);
+    memset(la->costs, -1, la->nb_frames * (la->nb_frames + 1) * la->nb_frames *
+                          sizeof(*la->costs));
+
+    for (i = 0; i < la->nb_frames; i++) {
+        LookaheadFrame *f = &la->frames[i];
+
+        f->display_picture_number = -1;
+        f->base       = av_malloc(la->linesize * h);
+        f->intra_cost = av_malloc_array(la->bw * la->bh, sizeof(*f->intra_cost));
+        f->prev_cost  = av_malloc_array(la->bw * la->bh, sizeof(*f->prev_cost));
+        if (!f->base || !f->intra_cost || !f->prev_cost)
+            return AVERROR(ENOMEM);
+        f->data = f->base + LA_PAD * la->linesize + LA_PAD;
+    }
+
+    return 0;
+}
+
+av_cold void ff_mpv_lookahead_uninit(MpegEncContext *s)
+{
+    LookaheadContext *la = s->lookahead;
+    int i;
+
+    if (!la)
+        return;
+
+    for (i = 0; la->frames && i < la->nb_frames; i++) {
+        av_freep(&la->frames[i].base);
+        av_freep(&la->frames[i].intra_cost);
+        av_freep(&la->frames[i].prev_cost);
+    }
+    av_freep(&la->frames);
+    av_freep(&la->costs);
+    av_freep(&la->jobs);
+    av_freep(&la->aq);
+    av_freep(&s->lookahead);
+}
+
+static int find_frame(LookaheadContext *la, int display_picture_number)
+{
+    int idx = display_picture_number % la->nb_frames;
+
+    return la->frames[idx].display_picture_number == display_picture_number ?
+           idx : LA_NONE;
+}
+
+/**
+ * Replicate the border pixels over the padding and over the part of the
+ * block grid that lies outside the picture.
+ */
+static void extend_edges(LookaheadContext *la, uint8_t *data, int w, int h)
+{
+    const int stride = la->linesize;
+    int y;
+
+    for (y = 0; y < h; y++) {
+        uint8_t *row = data + y * stride;
+        memset(row - LA_PAD, row[0], LA_PAD);
+        memset(row + w, row[w - 1], stride - LA_PAD - w);
+    }
+    for (y = -LA_PAD; y < 0; y++)
+        memcpy(data + y * stride - LA_PAD, data - LA_PAD, stride);
+    for (y = h; y < la->bh * 8 + LA_PAD; y++)
+        memcpy(data + y * stride - LA_PAD, data + (h - 1) * stride - LA_PAD, stride);
+}
+
+void ff_mpv_lookahead_add_frame(MpegEncContext *s, const AVFrame *frame,
+                                int display_picture_number)
+{
+    LookaheadContext *la = s->lookahead;
+    int idx = display_picture_number % la->nb_frames;
+    LookaheadFrame *f = &la->frames[idx];
+    int w = s->width >> 1, h = s->height >> 1;
+    int i, j, x, y;
+
+    /* forget every cached cost involving the recycled slot */
+    for (i = 0; i < la->nb_frames; i++) {
+        for (j = LA_NONE; j < la->nb_frames; j++) {
+            COST(la, idx, j, i) = -1;
+            COST(la, i, j, idx) = -1;
+            if (j != LA_NONE)
+                COST(la, i, idx, j) = -1;
+        }
+    }
+    f->display_picture_number = display_picture_number;
+    f->prev_valid             = 0;
+
+    s->mpvencdsp.shrink[1](f->data, la->linesize, frame->data[0],
+                           frame->linesize[0], w, h);
+    extend_edges(la, f->data, w, h);
+
+    f->intra_sum = 0;
+    for (y = 0; y < la->bh; y++) {
+        for (x = 0; x < la->bw; x++) {
+            const uint8_t *src = f->data + y * 8 * la->linesize + x * 8;
+            int sum = 0, cost = 0, dc;
+
+            for (j = 0; j < 8; j++)
+                for (i = 0; i < 8; i++)
+                    sum += src[j * la->linesize + i];
+            dc = (sum + 32) >> 6;
+            for (j = 0; j < 8; j++)
+                for (i = 0; i < 8; i++)
+                    cost += FFABS(src[j * la->linesize + i] - dc);
+            f->intra_cost[y * la->bw + x] = cost;
+            f->intra_sum += cost;
+        }
+    }
+}
+
+static int block_sad(LookaheadContext *la, const uint8_t *cur,
+                     const uint8_t *ref, int mx, int my)
+{
+    return la->s->mecc.sad[1](NULL, (uint8_t *)cur,
+                              (uint8_t *)ref + my * la->linesize + mx,
+                              la->linesize, 8);
+}
+
+/**
+ * Small diamond search around the best of the given predictors.
+ */
+static int search_block(LookaheadContext *la, const uint8_t *cur,
+                        const uint8_t *ref, const int (*pred)[2], int nb_pred,
+                        int mv[2])
+{
+    static const int dia[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    int best = INT_MAX, bx = 0, by = 0;
+    int i, step;
+
+    for (i = 0; i < nb_pred; i++) {
+        int mx = av_clip(pred[i][0], -LA_RANGE, LA_RANGE);
+        int my = av_clip(pred[i][1], -LA_RANGE, LA_RANGE);
+        int d  = block_sad(la, cur, ref, mx, my);
+        if (d < best) {
+            best = d;
+            bx   = mx;
+            by   = my;
+        }
+    }
+
+    for (step = 2; step > 0; step >>= 1) {
+        int moved = 1, iter = 0;
+        while (moved && iter++ < LA_RANGE) {
+            int cx = bx, cy = by;
+            moved = 0;
+            for (i = 0; i < 4; i++) {
+                int mx = cx + dia[i][0] * step;
+                int my = cy + dia[i][1] * step;
+                int d;
+                if (FFABS(mx) > LA_RANGE || FFABS(my) > LA_RANGE)
+                    continue;
+                d = block_sad(la, cur, ref, mx, my);
+                if (d < best) {
+                    best  = d;
+                    bx    = mx;
+                    by    = my;
+                    moved = 1;
+                }
+            }
+        }
+    }
+
+    mv[0] = bx;
+    mv[1] = by;
+    return best;
+}
+
+static int frame_cost_job(AVCodecContext *avctx, void *arg)
+{
+    LookaheadJob *job     = arg;
+    LookaheadContext *la  = job->la;
+    LookaheadFrame *cur   = &la->frames[job->cur];
+    LookaheadFrame *past  = &la->frames[job->past];
+    LookaheadFrame *fut   = job->future != LA_NONE ? &la->frames[job->future] : NULL;
+    const int stride      = la->linesize;
+    int *prev_cost        = NULL;
+    int (*mvs)[2][2];
+    int64_t total = 0;
+    int x, y;
+
+    /* the per block cost from the previous frame is kept for adaptive quant */
+    if (!fut && past->display_picture_number + 1 == cur->display_picture_number)
+        prev_cost = cur->prev_cost;
+
+    mvs = av_malloc_array(la->bw, sizeof(*mvs));
+    if (!mvs)
+        return AVERROR(ENOMEM);
+    memset(mvs, 0, la->bw * sizeof(*mvs));
+
+    for (y = 0; y < la->bh; y++) {
+        for (x = 0; x < la->bw; x++) {
+            const uint8_t *src = cur->data + y * 8 * stride + x * 8;
+            int off  = y * 8 * stride + x * 8;
+            int cost = cur->intra_cost[y * la->bw + x];
+            int pred[3][2] = { { 0, 0 } };
+            int nb_pred = 1, d, mv0[2], mv1[2];
+
+            /* left neighbour is in mvs[x - 1], top neighbour still in mvs[x] */
+            if (x) {
+                pred[nb_pred][0]   = mvs[x - 1][0][0];
+                pred[nb_pred++][1] = mvs[x - 1][0][1];
+            }
+            if (y) {
+                pred[nb_pred][0]   = mvs[x][0][0];
+                pred[nb_pred++][1] = mvs[x][0][1];
+            }
+            d = search_block(la, src, past->data + off, (const int (*)[2])pred,
+                             nb_pred, mv0);
+            if (prev_cost)
+                prev_cost[y * la->bw + x] = d;
+            cost = FFMIN(cost, d);
+
+            if (fut) {
+                DECLARE_ALIGNED(8, uint8_t, avg)[64];
+                DECLARE_ALIGNED(8, uint8_t, blk)[64];
+                const uint8_t *r0, *r1;
+                int i, j;
+
+                nb_pred = 1;
+                if (x) {
+                    pred[nb_pred][0]   = mvs[x - 1][1][0];
+                    pred[nb_pred++][1] = mvs[x - 1][1][1];
+                }
+                if (y) {
+                    pred[nb_pred][0]   = mvs[x][1][0];
+                    pred[nb_pred++][1] = mvs[x][1][1];
+                }
+                d = search_block(la, src, fut->data + off, (const int (*)[2])pred,
+                                 nb_pred, mv1);
+                cost = FFMIN(cost, d);
+
+                r0 = past->data + off + mv0[1] * stride + mv0[0];
+                r1 = fut->data  + off + mv1[1] * stride + mv1[0];
+                /* sad[] takes a single stride, so pack the source block too */
+                for (j = 0; j < 8; j++) {
+                    for (i = 0; i < 8; i++) {
+                        avg[j * 8 + i] = (r0[j * stride + i] + r1[j * stride + i] + 1) >> 1;
+                        blk[j * 8 + i] = src[j * stride + i];
+                    }
+                }
+                d = la->s->mecc.sad[1](NULL, avg, blk, 8, 8);
+                cost = FFMIN(cost, d);
+                mvs[x][1][0] = mv1[0];
+                mvs[x][1][1] = mv1[1];
+            }
+            mvs[x][0][0] = mv0[0];
+            mvs[x][0][1] = mv0[1];
+            total += cost;
+        }
+    }
+
+    av_free(mvs);
+    if (prev_cost)
+        cur->prev_valid = 1;
+    job->cost = total;
+    return 0;
+}
+
+static void queue_cost(LookaheadContext *la, int past, int future, int cur)
+{
+    int i;
+
+    if (COST(la, past, future, cur) >= 0)
+        return;
+    for (i = 0; i < la->nb_jobs; i++)
+        if (la->jobs[i].past == past && la->jobs[i].future == future &&
+            la->jobs[i].cur == cur)
+            return;
+    la->jobs[la->nb_jobs++] = (LookaheadJob) { la, cur, past, future, 0 };
+}
+
+static int run_jobs(LookaheadContext *la)
+{
+    MpegEncContext *s = la->s;
+    int i, ret;
+
+    if (!la->nb_jobs)
+        return 0;
+    ret = s->avctx->execute(s->avctx, frame_cost_job, la->jobs, NULL,
+                            la->nb_jobs, sizeof(*la->jobs));
+    if (ret < 0)
+        return ret;
+    for (i = 0; i < la->nb_jobs; i++)
+        COST(la, la->jobs[i].past, la->jobs[i].future, la->jobs[i].cur) = la->jobs[i].cost;
+    la->nb_jobs = 0;
+    emms_c();
+    return 0;
+}
+
+/**
+ * Estimated cost of coding the window with a reference every b_count + 1
+ * frames, the same layout estimate_best_b_count() tries.
+ */
+static int64_t pattern_cost(LookaheadContext *la, const int *idx, int n,
+                            int b_count, int queue)
+{
+    int64_t cost = 0, b_cost = 0;
+    int prev = 0, i, j;
+
+    for (i = 1; i <= n; i++) {
+        if ((i - 1) % (b_count + 1) != b_count && i != n)
+            continue;
+        if (queue)
+            queue_cost(la, idx[prev], LA_NONE, idx[i]);
+        else
+            cost += COST(la, idx[prev], LA_NONE, idx[i]);
+        for (j = prev + 1; j < i; j++) {
+            if (queue)
+                queue_cost(la, idx[prev], idx[i], idx[j]);
+            else
+                b_cost += COST(la, idx[prev], idx[i], idx[j]);
+        }
+        prev = i;
+    }
+    return cost + (int64_t)(b_cost * LA_B_BIAS);
+}
+
+int ff_mpv_lookahead_b_count(MpegEncContext *s)
+{
+    LookaheadContext *la = s->lookahead;
+    int idx[MAX_B_FRAMES + 2];
+    int64_t best_cost = INT64_MAX;
+    int i, n, ret, best = 0;
+
+    /* idx[0] is the last reference, idx[1..n] the queued input pictures */
+    idx[0] = find_frame(la, s->next_picture_ptr->f->display_picture_number);
+    for (n = 0; n < s->max_b_frames + 1 && s->input_picture[n]; n++) {
+        idx[n + 1] = find_frame(la, s->input_picture[n]->f->display_picture_number);
+        if (idx[n + 1] == LA_NONE)
+            break;
+    }
+    if (idx[0] == LA_NONE || !n)
+        return FFMAX(n - 1, 0);
+
+    /* scene cuts: a frame that is predicted from its predecessor hardly
+     * better than from its own DC is coded as an I-frame. sc_threshold
+     * shifts the 70% ratio like it shifts the motion estimation score,
+     * whose per macroblock sqrt(SSE) is about a quarter of the SAD of the
+     * corresponding 8x8 block here. */
+    for (i = 1; i <= n; i++)
+        if (la->frames[idx[i - 1]].display_picture_number + 1 ==
+            la->frames[idx[i]].display_picture_number)
+            queue_cost(la, idx[i - 1], LA_NONE, idx[i]);
+    if ((ret = run_jobs(la)) < 0)
+        return ret;
+
+    if (s->scenechange_threshold < 1000000000) {
+        for (i = 1; i <= n; i++) {
+            LookaheadFrame *f = &la->frames[idx[i]];
+            int64_t cost;
+
+            if (la->frames[idx[i - 1]].display_picture_number + 1 != f->display_picture_number)
+                continue;
+            cost = COST(la, idx[i - 1], LA_NONE, idx[i]);
+            if (!s->input_picture[i - 1]->f->pict_type &&
+                cost * 10 - f->intra_sum * 7 > 40LL * s->scenechange_threshold) {
+                s->input_picture[i - 1]->f->pict_type = AV_PICTURE_TYPE_I;
+                n = i - 1;
+                break;
+            }
+        }
+        if (!n)
+            return 0;
+    }
+
+    for (i = 0; i < n; i++)
+        pattern_cost(la, idx, n, i, 1);
+    if ((ret = run_jobs(la)) < 0)
+        return ret;
+
+    for (i = 0; i < n; i++) {
+        int64_t cost = pattern_cost(la, idx, n, i, 0);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best      = i;
+        }
+    }
+
+    return best;
+}
+
+const float *ff_mpv_lookahead_aq_weights(MpegEncContext *s)
+{
+    LookaheadContext *la = s->lookahead;
+    int dpn = s->current_picture.f->display_picture_number;
+    int cur, next, i;
+
+    if (!la || s->pict_type == AV_PICTURE_TYPE_B)
+        return NULL;
+
+    cur  = find_frame(la, dpn);
+    next = find_frame(la, dpn + 1);
+    if (cur == LA_NONE || next == LA_NONE || !la->frames[next].prev_valid)
+        return NULL;
+
+    /* share of the next frame that is predicted from this one */
+    for (i = 0; i < la->bw * la->bh; i++) {
+        int intra = la->frames[next].intra_cost[i];
+        int inter = la->frames[next].prev_cost[i];
+        la->aq[i] = intra > inter ? 1.0f - (float)inter / intra : 0.0f;
+    }
+    return la->aq;
+}
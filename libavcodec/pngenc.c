@@ -24,6 +24,7 @@
 #include "bytestream.h"
 #include "huffyuvencdsp.h"
 #include "png.h"
+#include "pngencdsp.h"
 #include "apng.h"
 
 #include "libavutil/avassert.h"
@@ -37,6 +38,11 @@
 
 #define IOBUF_SIZE 4096
 
+/* Uncompressed bytes per independently deflated band in threaded mode.
+ * It does not depend on the thread count so the output does not either. */
+#define PNG_BAND_SIZE (128 * 1024)
+#define PNG_DICT_SIZE 32768
+
 typedef struct APNGFctlChunk {
     uint32_t sequence_number;
     uint32_t width, height;
@@ -48,6 +54,7 @@ typedef struct APNGFctlChunk {
 typedef struct PNGEncContext {
     AVClass *class;
     HuffYUVEncDSPContext hdsp;
+    PNGEncDSPContext pdsp;
 
     uint8_t *bytestream;
     uint8_t *bytestream_start;
@@ -57,6 +64,13 @@ typedef struct PNGEncContext {
 
     z_stream zstream;
     uint8_t buf[IOBUF_SIZE];
+    int compression_level;
+
+    z_stream *band_zstream;      ///< raw deflate streams, one per slice thread
+    int nb_band_zstreams;
+    uint8_t *band_buf;
+    unsigned int band_buf_size;
+
     int dpi;                     ///< Physical pixel density, in dots per inch, if set
     int dpm;                     ///< Physical pixel density, in dots per meter, if set
 
@@ -115,34 +129,6 @@ static void png_get_interlaced_row(uint8_t *dst, int row_size,
     }
 }
 
-static void sub_png_paeth_prediction(uint8_t *dst, uint8_t *src, uint8_t *top,
-                                     int w, int bpp)
-{
-    int i;
-    for (i = 0; i < w; i++) {
-        int a, b, c, p, pa, pb, pc;
-
-        a = src[i - bpp];
-        b = top[i];
-        c = top[i - bpp];
-
-        p  = b - c;
-        pc = a - c;
-
-        pa = abs(p);
-        pb = abs(pc);
-        pc = abs(p + pc);
-
-        if (pa <= pb && pa <= pc)
-            p = a;
-        else if (pb <= pc)
-            p = b;
-        else
-            p = c;
-        dst[i] = src[i] - p;
-    }
-}
-
 static void sub_left_prediction(PNGEncContext *c, uint8_t *dst, const uint8_t *src, int bpp, int size)
 {
     const uint8_t *src1 = src + bpp;
@@ -162,7 +148,7 @@ static void sub_left_prediction(PNGEncContext *c, uint8_t *dst, const uint8_t *s
 static void png_filter_row(PNGEncContext *c, uint8_t *dst, int filter_type,
                            uint8_t *src, uint8_t *top, int size, int bpp)
 {
-    int i;
+    int i, w;
 
     switch (filter_type) {
     case PNG_FILTER_VALUE_NONE:
@@ -177,13 +163,18 @@ static void png_filter_row(PNGEncContext *c, uint8_t *dst, int filter_type,
     case PNG_FILTER_VALUE_AVG:
         for (i = 0; i < bpp; i++)
             dst[i] = src[i] - (top[i] >> 1);
-        for (; i < size; i++)
-            dst[i] = src[i] - ((src[i - bpp] + top[i]) >> 1);
+        w = (size - bpp) & ~15;
+        c->pdsp.sub_avg_prediction(dst + bpp, src + bpp, top + bpp, w, bpp);
+        i = bpp + w;
+        ff_sub_png_avg_prediction(dst + i, src + i, top + i, size - i, bpp);
         break;
     case PNG_FILTER_VALUE_PAETH:
         for (i = 0; i < bpp; i++)
             dst[i] = src[i] - top[i];
-        sub_png_paeth_prediction(dst + i, src + i, top + i, size - i, bpp);
+        w = (size - bpp) & ~7;
+        c->pdsp.sub_paeth_prediction(dst + bpp, src + bpp, top + bpp, w, bpp);
+        i = bpp + w;
+        ff_sub_png_paeth_prediction(dst + i, src + i, top + i, size - i, bpp);
         break;
     }
 }
@@ -196,15 +187,14 @@ static uint8_t *png_choose_filter(PNGEncContext *s, uint8_t *dst,
     if (!top && pred)
         pred = PNG_FILTER_VALUE_SUB;
     if (pred == PNG_FILTER_VALUE_MIXED) {
-        int i;
+        int w = (size + 1) & ~15;
         int cost, bcost = INT_MAX;
         uint8_t *buf1 = dst, *buf2 = dst + size + 16;
         for (pred = 0; pred < 5; pred++) {
             png_filter_row(s, buf1 + 1, pred, src, top, size, bpp);
             buf1[0] = pred;
-            cost = 0;
-            for (i = 0; i <= size; i++)
-                cost += abs((int8_t) buf1[i]);
+            cost = s->pdsp.filter_cost(buf1, w) +
+                   ff_png_filter_cost(buf1 + w, size + 1 - w);
             if (cost < bcost) {
                 bcost = cost;
                 FFSWAP(uint8_t *, buf1, buf2);
@@ -425,6 +415,170 @@ static int encode_headers(AVCodecContext *avctx, const AVFrame *pict)
     return 0;
 }
 
+typedef struct PNGBandThreadData {
+    const AVFrame *pict;
+    int row_size;
+    int band_rows;
+    int dict_rows;
+    uint8_t *crow_base;          ///< filter scratch, crow_size bytes per thread
+    int crow_size;
+    uint8_t *dict_base;          ///< window priming buffer, dict_size bytes per thread
+    int dict_size;
+    uint8_t *out;                ///< compressed output, out_size bytes per band
+    size_t out_size;
+    size_t *out_len;
+    uLong *adler;
+} PNGBandThreadData;
+
+/**
+ * Filter and deflate one band of rows into a raw deflate stream that ends
+ * on a byte boundary, so that the bands can simply be concatenated.
+ */
+static int deflate_band(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    PNGEncContext *s       = avctx->priv_data;
+    PNGBandThreadData *td  = arg;
+    const AVFrame *p       = td->pict;
+    z_stream *zs           = &s->band_zstream[threadnr];
+    uint8_t *crow_buf      = td->crow_base + threadnr * td->crow_size + 15;
+    uint8_t *dict          = td->dict_base + threadnr * td->dict_size;
+    const int row_size     = td->row_size;
+    const int bpp          = s->bits_per_pixel >> 3;
+    const int y0           = jobnr * td->band_rows;
+    const int y1           = FFMIN(y0 + td->band_rows, p->height);
+    const int last         = y1 == p->height;
+    uLong adler            = adler32(0, NULL, 0);
+    uint8_t *ptr, *top, *crow;
+    int y, ret = Z_OK, dict_len = 0;
+
+    if (deflateReset(zs) != Z_OK)
+        return AVERROR_EXTERNAL;
+
+    /* prime the window with the data a single stream would have seen */
+    if (y0 > 0) {
+        for (y = FFMAX(y0 - td->dict_rows, 0); y < y0; y++) {
+            ptr  = p->data[0] + y * p->linesize[0];
+            top  = y ? ptr - p->linesize[0] : NULL;
+            crow = png_choose_filter(s, crow_buf, ptr, top, row_size, bpp);
+            memcpy(dict + dict_len, crow, row_size + 1);
+            dict_len += row_size + 1;
+        }
+        y = FFMAX(dict_len - PNG_DICT_SIZE, 0);
+        if (deflateSetDictionary(zs, dict + y, dict_len - y) != Z_OK)
+            return AVERROR_EXTERNAL;
+    }
+
+    zs->next_out  = td->out + jobnr * td->out_size;
+    zs->avail_out = td->out_size;
+    for (y = y0; y < y1; y++) {
+        ptr  = p->data[0] + y * p->linesize[0];
+        top  = y ? ptr - p->linesize[0] : NULL;
+        crow = png_choose_filter(s, crow_buf, ptr, top, row_size, bpp);
+        adler = adler32(adler, crow, row_size + 1);
+
+        zs->next_in  = crow;
+        zs->avail_in = row_size + 1;
+        ret = deflate(zs, y < y1 - 1 ? Z_NO_FLUSH :
+                          last       ? Z_FINISH   : Z_SYNC_FLUSH);
+        if ((ret != Z_OK && ret != Z_STREAM_END) || zs->avail_in || !zs->avail_out)
+            return AVERROR_EXTERNAL;
+    }
+    if (last && ret != Z_STREAM_END)
+        return AVERROR_EXTERNAL;
+
+    td->out_len[jobnr] = td->out_size - zs->avail_out;
+    td->adler[jobnr]   = adler;
+    return 0;
+}
+
+/**
+ * Compress the image as independent bands in parallel, pigz-style, and join
+ * them into a single zlib stream with a combined checksum.
+ */
+static int encode_frame_bands(AVCodecContext *avctx, const AVFrame *pict,
+                              int row_size, int band_rows)
+{
+    PNGEncContext *s  = avctx->priv_data;
+    const int nb_bands = (pict->height + band_rows - 1) / band_rows;
+    const int mixed    = s->filter_type == PNG_FILTER_VALUE_MIXED;
+    PNGBandThreadData td = { 0 };
+    int *band_ret = NULL;
+    uLong adler;
+    uint8_t *buf;
+    size_t len, pos;
+    int i, level_flags, header, ret = 0;
+
+    td.pict      = pict;
+    td.row_size  = row_size;
+    td.band_rows = band_rows;
+    td.dict_rows = (PNG_DICT_SIZE + row_size) / (row_size + 1);
+    td.crow_size = (row_size + 32) << mixed;
+    td.dict_size = td.dict_rows * (row_size + 1);
+    td.out_size  = deflateBound(&s->band_zstream[0], (uLong)band_rows * (row_size + 1)) + 16;
+
+    if (td.out_size > (INT_MAX - 6) / nb_bands)
+        return AVERROR(ENOMEM);
+    av_fast_malloc(&s->band_buf, &s->band_buf_size, 2 + nb_bands * td.out_size + 4);
+    td.crow_base = av_malloc_array(s->nb_band_zstreams, td.crow_size);
+    td.dict_base = av_malloc_array(s->nb_band_zstreams, td.dict_size);
+    td.out_len   = av_malloc_array(nb_bands, sizeof(*td.out_len));
+    td.adler     = av_malloc_array(nb_bands, sizeof(*td.adler));
+    band_ret     = av_malloc_array(nb_bands, sizeof(*band_ret));
+    if (!s->band_buf || !td.crow_base || !td.dict_base ||
+        !td.out_len || !td.adler || !band_ret) {
+        ret = AVERROR(ENOMEM);
+        goto the_end;
+    }
+    td.out = s->band_buf + 2;
+
+    avctx->execute2(avctx, deflate_band, &td, band_ret, nb_bands);
+    for (i = 0; i < nb_bands; i++) {
+        if (band_ret[i] < 0) {
+            ret = band_ret[i];
+            goto the_end;
+        }
+    }
+
+    /* zlib header, with the level hint deflate() would have written */
+    if (s->compression_level >= 0 && s->compression_level < 2)
+        level_flags = 0;
+    else if (s->compression_level >= 0 && s->compression_level < 6)
+        level_flags = 1;
+    else if (s->compression_level < 0 || s->compression_level == 6)
+        level_flags = 2;
+    else
+        level_flags = 3;
+    header  = (Z_DEFLATED + ((15 - 8) << 4)) << 8 | level_flags << 6;
+    header += 31 - header % 31;
+    buf = s->band_buf;
+    AV_WB16(buf, header);
+
+    pos   = 2 + td.out_len[0];
+    adler = td.adler[0];
+    for (i = 1; i < nb_bands; i++) {
+        int rows = FFMIN(band_rows, pict->height - i * band_rows);
+        memmove(buf + pos, td.out + i * td.out_size, td.out_len[i]);
+        pos  += td.out_len[i];
+        adler = adler32_combine(adler, td.adler[i], (z_off_t)rows * (row_size + 1));
+    }
+    AV_WB32(buf + pos, adler);
+    pos += 4;
+
+    for (; pos > 0; buf += len, pos -= len) {
+        len = FFMIN(pos, IOBUF_SIZE);
+        if (s->bytestream_end - s->bytestream > len + 100)
+            png_write_image_data(avctx, buf, len);
+    }
+
+the_end:
+    av_freep(&td.crow_base);
+    av_freep(&td.dict_base);
+    av_freep(&td.out_len);
+    av_freep(&td.adler);
+    av_freep(&band_ret);
+    return ret;
+}
+
 static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
 {
     PNGEncContext *s       = avctx->priv_data;
@@ -438,6 +592,12 @@ static int encode_frame(AVCodecContext *avctx, const AVFrame *pict)
 
     row_size = (pict->width * s->bits_per_pixel + 7) >> 3;
 
+    if (s->nb_band_zstreams > 1 && !s->is_progressive) {
+        int band_rows = FFMAX(PNG_BAND_SIZE / (row_size + 1), 1);
+        if (pict->height > band_rows)
+            return encode_frame_bands(avctx, pict, row_size, band_rows);
+    }
+
     crow_base = av_malloc((row_size + 32) << (s->filter_type == PNG_FILTER_VALUE_MIXED));
     if (!crow_base) {
         ret = AVERROR(ENOMEM);
@@ -979,7 +1139,7 @@ static int encode_apng(AVCodecContext *avctx, AVPacket *pkt,
 static av_cold int png_enc_init(AVCodecContext *avctx)
 {
     PNGEncContext *s = avctx->priv_data;
-    int compression_level;
+    int compression_level, i;
 
     switch (avctx->pix_fmt) {
     case AV_PIX_FMT_RGBA:
@@ -1006,6 +1166,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
 #endif
 
     ff_huffyuvencdsp_init(&s->hdsp);
+    ff_pngencdsp_init(&s->pdsp);
 
 #if FF_API_PRIVATE_OPT
 FF_DISABLE_DEPRECATION_WARNINGS
@@ -1081,6 +1242,22 @@ FF_ENABLE_DEPRECATION_WARNINGS
                       : av_clip(avctx->compression_level, 0, 9);
     if (deflateInit2(&s->zstream, compression_level, Z_DEFLATED, 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
         return -1;
+    s->compression_level = compression_level;
+
+    if (avctx->active_thread_type & FF_THREAD_SLICE && avctx->thread_count > 1) {
+        s->band_zstream = av_mallocz_array(avctx->thread_count, sizeof(*s->band_zstream));
+        if (!s->band_zstream)
+            return AVERROR(ENOMEM);
+        for (i = 0; i < avctx->thread_count; i++) {
+            z_stream *zs = &s->band_zstream[i];
+            zs->zalloc = ff_png_zalloc;
+            zs->zfree  = ff_png_zfree;
+            zs->opaque = NULL;
+            if (deflateInit2(zs, compression_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                return -1;
+            s->nb_band_zstreams++;
+        }
+    }
 
     return 0;
 }
@@ -1089,7 +1266,13 @@ static av_cold int png_enc_close(AVCodecContext *avctx)
 {
     PNGEncContext *s = avctx->priv_data;
 
+    int i;
+
     deflateEnd(&s->zstream);
+    for (i = 0; i < s->nb_band_zstreams; i++)
+        deflateEnd(&s->band_zstream[i]);
+    av_freep(&s->band_zstream);
+    av_freep(&s->band_buf);
     av_frame_free(&s->last_frame);
     av_frame_free(&s->prev_frame);
     av_freep(&s->last_frame_packet);
@@ -1134,7 +1317,8 @@ AVCodec ff_png_encoder = {
     .init           = png_enc_init,
     .close          = png_enc_close,
     .encode2        = encode_png,
-    .capabilities   = AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_INTRA_ONLY,
+    .capabilities   = AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS |
+                      AV_CODEC_CAP_INTRA_ONLY,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA,
         AV_PIX_FMT_RGB48BE, AV_PIX_FMT_RGBA64BE,
@@ -1155,7 +1339,7 @@ AVCodec ff_apng_encoder = {
     .init           = png_enc_init,
     .close          = png_enc_close,
     .encode2        = encode_apng,
-    .capabilities   = CODEC_CAP_DELAY,
+    .capabilities   = CODEC_CAP_DELAY | AV_CODEC_CAP_SLICE_THREADS,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA,
         AV_PIX_FMT_RGB48BE, AV_PIX_FMT_RGBA64BE,
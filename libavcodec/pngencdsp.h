@@ -0,0 +1,57 @@
+/*
+ * PNG encoder DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_PNGENCDSP_H
+#define AVCODEC_PNGENCDSP_H
+
+#include <stdint.h>
+
+typedef struct PNGEncDSPContext {
+    /**
+     * Subtract the Paeth predictor from w bytes of src.
+     * Reads src[-bpp] and top[-bpp]; w must be a multiple of 8.
+     */
+    void (*sub_paeth_prediction)(uint8_t *dst, const uint8_t *src,
+                                 const uint8_t *top, int w, int bpp);
+
+    /**
+     * Subtract the average predictor from w bytes of src.
+     * Reads src[-bpp]; w must be a multiple of 16.
+     */
+    void (*sub_avg_prediction)(uint8_t *dst, const uint8_t *src,
+                               const uint8_t *top, int w, int bpp);
+
+    /**
+     * Sum of the absolute values of w filtered bytes taken as signed,
+     * used to pick the filter in mixed mode. w must be a multiple of 16.
+     */
+    int (*filter_cost)(const uint8_t *buf, int w);
+} PNGEncDSPContext;
+
+void ff_sub_png_paeth_prediction(uint8_t *dst, const uint8_t *src,
+                                 const uint8_t *top, int w, int bpp);
+void ff_sub_png_avg_prediction(uint8_t *dst, const uint8_t *src,
+                               const uint8_t *top, int w, int bpp);
+int ff_png_filter_cost(const uint8_t *buf, int w);
+
+void ff_pngencdsp_init(PNGEncDSPContext *dsp);
+void ff_pngencdsp_init_x86(PNGEncDSPContext *dsp);
+
+#endif /* AVCODEC_PNGENCDSP_H */
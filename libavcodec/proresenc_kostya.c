@@ -31,6 +31,7 @@
 #include "bytestream.h"
 #include "internal.h"
 #include "proresdata.h"
+#include "proresencdsp.h"
 
 #define CFACTOR_Y422 2
 #define CFACTOR_Y444 3
@@ -181,6 +182,7 @@ struct TrellisNode {
 
 typedef struct ProresThreadData {
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(16, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16 * 16];
     int16_t custom_q[64];
     struct TrellisNode *nodes;
@@ -189,6 +191,7 @@ typedef struct ProresThreadData {
 typedef struct ProresContext {
     AVClass *class;
     DECLARE_ALIGNED(16, int16_t, blocks)[MAX_PLANES][64 * 4 * MAX_MBS_PER_SLICE];
+    DECLARE_ALIGNED(16, int16_t, levels)[64 * 4 * MAX_MBS_PER_SLICE];
     DECLARE_ALIGNED(16, uint16_t, emu_buf)[16*16];
     int16_t quants[MAX_STORED_Q][64];
     int16_t custom_q[64];
@@ -198,6 +201,7 @@ typedef struct ProresContext {
     void (*fdct)(FDCTDSPContext *fdsp, const uint16_t *src,
                  int linesize, int16_t *block);
     FDCTDSPContext fdsp;
+    ProresEncDSPContext dsp;
 
     const AVFrame *pic;
     int mb_width, mb_height;
@@ -386,10 +390,10 @@ static void encode_dcs(PutBitContext *pb, int16_t *blocks,
     }
 }
 
-static void encode_acs(PutBitContext *pb, int16_t *blocks,
+static void encode_acs(PutBitContext *pb, int16_t *levels,
                        int blocks_per_slice,
                        int plane_size_factor,
-                       const uint8_t *scan, const int16_t *qmat)
+                       const uint8_t *scan)
 {
     int idx, i;
     int run, level, run_cb, lev_cb;
@@ -402,7 +406,7 @@ static void encode_acs(PutBitContext *pb, int16_t *blocks,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level = blocks[idx] / qmat[scan[i]];
+            level = levels[idx];
             if (level) {
                 abs_level = FFABS(level);
                 encode_vlc_codeword(pb, ff_prores_ac_codebook[run_cb], run);
@@ -432,8 +436,9 @@ static int encode_slice_plane(ProresContext *ctx, PutBitContext *pb,
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
     encode_dcs(pb, blocks, blocks_per_slice, qmat[0]);
-    encode_acs(pb, blocks, blocks_per_slice, plane_size_factor,
-               ctx->scantable, qmat);
+    ctx->dsp.quantize(ctx->levels, blocks, qmat, blocks_per_slice);
+    encode_acs(pb, ctx->levels, blocks_per_slice, plane_size_factor,
+               ctx->scantable);
     flush_put_bits(pb);
 
     return (put_bits_count(pb) - saved_pos) >> 3;
@@ -633,9 +638,8 @@ static int estimate_dcs(int *error, int16_t *blocks, int blocks_per_slice,
     return bits;
 }
 
-static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
-                        int plane_size_factor,
-                        const uint8_t *scan, const int16_t *qmat)
+static int estimate_acs(const int16_t *levels, int blocks_per_slice,
+                        int plane_size_factor, const uint8_t *scan)
 {
     int idx, i;
     int run, level, run_cb, lev_cb;
@@ -649,8 +653,7 @@ static int estimate_acs(int *error, int16_t *blocks, int blocks_per_slice,
 
     for (i = 1; i < 64; i++) {
         for (idx = scan[i]; idx < max_coeffs; idx += 64) {
-            level   = blocks[idx] / qmat[scan[i]];
-            *error += FFABS(blocks[idx]) % qmat[scan[i]];
+            level = levels[idx];
             if (level) {
                 abs_level = FFABS(level);
                 bits += estimate_vlc(ff_prores_ac_codebook[run_cb], run);
@@ -680,9 +683,11 @@ static int estimate_slice_plane(ProresContext *ctx, int *error, int plane,
 
     blocks_per_slice = mbs_per_slice * blocks_per_mb;
 
-    bits  = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
-    bits += estimate_acs(error, td->blocks[plane], blocks_per_slice,
-                         plane_size_factor, ctx->scantable, qmat);
+    bits    = estimate_dcs(error, td->blocks[plane], blocks_per_slice, qmat[0]);
+    *error += ctx->dsp.quantize(td->levels, td->blocks[plane], qmat,
+                                blocks_per_slice);
+    bits   += estimate_acs(td->levels, blocks_per_slice,
+                           plane_size_factor, ctx->scantable);
 
     return FFALIGN(bits, 8);
 }
@@ -746,6 +751,37 @@ static int estimate_alpha_plane(ProresContext *ctx, int *error,
     return bits;
 }
 
+static int estimate_slice_bits(ProresContext *ctx, int *error, int q,
+                               const uint16_t *src, const int *linesize,
+                               int mbs_per_slice, const int *num_cblocks,
+                               const int *plane_factor, ProresThreadData *td)
+{
+    const int16_t *qmat;
+    int i, bits = 0;
+
+    if (q < MAX_STORED_Q) {
+        qmat = ctx->quants[q];
+    } else {
+        for (i = 0; i < 64; i++)
+            td->custom_q[i] = ctx->quant_mat[i] * q;
+        qmat = td->custom_q;
+    }
+
+    *error = 0;
+    for (i = 0; i < ctx->num_planes - !!ctx->alpha_bits; i++) {
+        bits += estimate_slice_plane(ctx, error, i,
+                                     src, linesize[i],
+                                     mbs_per_slice,
+                                     num_cblocks[i], plane_factor[i],
+                                     qmat, td);
+    }
+    if (ctx->alpha_bits)
+        bits += estimate_alpha_plane(ctx, error, src, linesize[3],
+                                     mbs_per_slice, q, td->blocks[3]);
+
+    return bits;
+}
+
 static int find_slice_quant(AVCodecContext *avctx,
                             int trellis_node, int x, int y, int mbs_per_slice,
                             ProresThreadData *td)
@@ -761,8 +797,7 @@ static int find_slice_quant(AVCodecContext *avctx,
     int error, bits, bits_limit;
     int mbs, prev, cur, new_score;
     int slice_bits[TRELLIS_WIDTH], slice_score[TRELLIS_WIDTH];
-    int overquant;
-    uint16_t *qmat;
+    int overquant, lo, step;
     int linesize[4], line_add;
 
     if (ctx->pictures_per_frame == 1)
@@ -811,18 +846,8 @@ static int find_slice_quant(AVCodecContext *avctx,
 
     // todo: maybe perform coarser quantising to fit into frame size when needed
     for (q = min_quant; q <= max_quant; q++) {
-        bits  = 0;
-        error = 0;
-        for (i = 0; i < ctx->num_planes - !!ctx->alpha_bits; i++) {
-            bits += estimate_slice_plane(ctx, &error, i,
-                                         src, linesize[i],
-                                         mbs_per_slice,
-                                         num_cblocks[i], plane_factor[i],
-                                         ctx->quants[q], td);
-        }
-        if (ctx->alpha_bits)
-            bits += estimate_alpha_plane(ctx, &error, src, linesize[3],
-                                         mbs_per_slice, q, td->blocks[3]);
+        bits = estimate_slice_bits(ctx, &error, q, src, linesize,
+                                   mbs_per_slice, num_cblocks, plane_factor, td);
         if (bits > 65000 * 8)
             error = SCORE_LIMIT;
 
@@ -834,29 +859,44 @@ static int find_slice_quant(AVCodecContext *avctx,
         slice_score[max_quant + 1] = slice_score[max_quant] + 1;
         overquant = max_quant;
     } else {
-        for (q = max_quant + 1; q < 128; q++) {
-            bits  = 0;
-            error = 0;
-            if (q < MAX_STORED_Q) {
-                qmat = ctx->quants[q];
+        const int slice_limit = ctx->bits_per_mb * mbs_per_slice;
+        int q_bits, q_error;
+
+        /* Look for the smallest quantiser fitting the budget by growing
+         * the step until one fits and then bisecting the last interval.
+         * The slice size mostly goes down as the quantiser grows, but not
+         * strictly, so this can settle on a coarser quantiser than a
+         * linear scan would find. */
+        lo   = max_quant;
+        q    = max_quant + 1;
+        step = 1;
+        for (;;) {
+            bits = estimate_slice_bits(ctx, &error, q, src, linesize,
+                                       mbs_per_slice, num_cblocks,
+                                       plane_factor, td);
+            if (bits <= slice_limit || q == 127)
+                break;
+            lo    = q;
+            step *= 2;
+            q     = FFMIN(q + step, 127);
+        }
+        while (q - lo > 1) {
+            const int mid = (lo + q) >> 1;
+
+            q_bits = estimate_slice_bits(ctx, &q_error, mid, src, linesize,
+                                         mbs_per_slice, num_cblocks,
+                                         plane_factor, td);
+            if (q_bits <= slice_limit) {
+                q     = mid;
+                bits  = q_bits;
+                error = q_error;
             } else {
-                qmat = td->custom_q;
-                for (i = 0; i < 64; i++)
-                    qmat[i] = ctx->quant_mat[i] * q;
+                lo = mid;
             }
-            for (i = 0; i < ctx->num_planes - !!ctx->alpha_bits; i++) {
-                bits += estimate_slice_plane(ctx, &error, i,
-                                             src, linesize[i],
-                                             mbs_per_slice,
-                                             num_cblocks[i], plane_factor[i],
-                                             qmat, td);
-            }
-            if (ctx->alpha_bits)
-                bits += estimate_alpha_plane(ctx, &error, src, linesize[3],
-                                             mbs_per_slice, q, td->blocks[3]);
-            if (bits <= ctx->bits_per_mb * mbs_per_slice)
-                break;
         }
+        /* nothing fits, go past the coarsest quantiser that was tried */
+        if (bits > slice_limit)
+            q = 128;
 
         slice_bits[max_quant + 1]  = bits;
         slice_score[max_quant + 1] = error;
@@ -1136,6 +1176,7 @@ FF_ENABLE_DEPRECATION_WARNINGS
     ctx->scantable = interlaced ? ff_prores_interlaced_scan
                                 : ff_prores_progressive_scan;
     ff_fdctdsp_init(&ctx->fdsp, avctx);
+    ff_proresencdsp_init(&ctx->dsp);
 
     mps = ctx->mbs_per_slice;
     if (mps & (mps - 1)) {
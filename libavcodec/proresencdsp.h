@@ -0,0 +1,44 @@
+/*
+ * Apple ProRes encoder DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_PRORESENCDSP_H
+#define AVCODEC_PRORESENCDSP_H
+
+#include <stdint.h>
+
+typedef struct ProresEncDSPContext {
+    /**
+     * Quantize nb_blocks blocks of 64 coefficients, dividing each one by
+     * the qmat entry at the same position and truncating towards zero.
+     * qmat entries must be positive.
+     *
+     * @return the sum of the absolute remainders of the AC coefficients
+     */
+    int (*quantize)(int16_t *dst, const int16_t *src, const int16_t *qmat,
+                    int nb_blocks);
+} ProresEncDSPContext;
+
+int ff_prores_quantize(int16_t *dst, const int16_t *src, const int16_t *qmat,
+                       int nb_blocks);
+
+void ff_proresencdsp_init(ProresEncDSPContext *dsp);
+void ff_proresencdsp_init_x86(ProresEncDSPContext *dsp);
+
+#endif /* AVCODEC_PRORESENCDSP_H */
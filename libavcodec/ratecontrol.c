@@ -640,6 +640,7 @@ static void adaptive_quantization(MpegEncContext *s, double q)
     Picture *const pic               = &s->current_picture;
     const int mb_width               = s->mb_width;
     const int mb_height              = s->mb_height;
+    const float *lookahead_weight    = s->lookahead_aq ? ff_mpv_lookahead_aq_weights(s) : NULL;
 
     for (i = 0; i < s->mb_num; i++) {
         const int mb_xy = s->mb_index2xy[i];
@@ -689,6 +690,9 @@ static void adaptive_quantization(MpegEncContext *s, double q)
 
         factor *= 1.0 - border_masking * mb_factor;
 
+        if (lookahead_weight)
+            factor *= 1.0 + s->lookahead_aq * lookahead_weight[i];
+
         if (factor < 0.00001)
             factor = 0.00001;
 
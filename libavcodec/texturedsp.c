@@ -25,6 +25,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "config.h"
 #include "libavutil/attributes.h"
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
@@ -611,4 +612,7 @@ av_cold void ff_texturedsp_init(TextureDSPContext *c)
     c->rgtc2s_block = rgtc2s_block;
     c->rgtc2u_block = rgtc2u_block;
     c->dxn3dc_block = dxn3dc_block;
+
+    if (ARCH_X86)
+        ff_texturedsp_init_x86(c);
 }
@@ -58,7 +58,25 @@ typedef struct TextureDSPContext {
     int (*dxn3dc_block)(uint8_t *dst, ptrdiff_t stride, const uint8_t *block);
 } TextureDSPContext;
 
+/**
+ * Endpoint search of the color block compressors, from fastest to best.
+ */
+enum TextureDSPFit {
+    TEXTURE_FIT_RANGE,      ///< inset bounding box of the block
+    TEXTURE_FIT_PCA,        ///< principal axis with one refinement pass
+    TEXTURE_FIT_CLUSTER,    ///< least squares over all index clusters
+};
+
 void ff_texturedsp_init(TextureDSPContext *c);
-void ff_texturedspenc_init(TextureDSPContext *c);
+void ff_texturedsp_init_x86(TextureDSPContext *c);
+void ff_texturedspenc_init(TextureDSPContext *c, enum TextureDSPFit fit);
+void ff_texturedspenc_init_x86(TextureDSPContext *c, enum TextureDSPFit fit);
+
+/**
+ * Convert a 4x4 block of RGBA pixels to the YCoCg layout the DXT5-YCoCg
+ * compressors work on, with a stride of 16 bytes.
+ */
+void ff_texturedspenc_rgba2ycocg_block(uint8_t *dst, ptrdiff_t stride,
+                                       const uint8_t *block);
 
 #endif /* AVCODEC_TEXTUREDSP_H */
@@ -23,13 +23,16 @@
  * IN THE SOFTWARE.
  */
 
+#include <float.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "libavutil/attributes.h"
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 
+#include "config.h"
 #include "texturedsp.h"
 
 static const uint8_t expand5[32] = {
@@ -495,6 +498,259 @@ static void compress_color(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
     AV_WL32(dst + 4, mask);
 }
 
+/* Squared distance between a block pixel and a palette color */
+static inline int color_distance(const uint8_t *p, const uint8_t *c)
+{
+    return (p[0] - c[0]) * (p[0] - c[0]) +
+           (p[1] - c[1]) * (p[1] - c[1]) +
+           (p[2] - c[2]) * (p[2] - c[2]);
+}
+
+/* Pick the nearest palette entry for each pixel and return the total error */
+static int nearest_colors(const uint8_t *block, ptrdiff_t stride,
+                          uint16_t c0, uint16_t c1, uint32_t *pmask)
+{
+    uint8_t color[16];
+    uint32_t mask = 0;
+    int x, y, k, error = 0, nb_colors = c0 == c1 ? 1 : 4;
+
+    rgb5652rgb(color + 0, c0);
+    rgb5652rgb(color + 4, c1);
+    lerp13rgb(color + 8, color + 0, color + 4);
+    lerp13rgb(color + 12, color + 4, color + 0);
+
+    for (y = 0; y < 4; y++) {
+        for (x = 0; x < 4; x++) {
+            const uint8_t *p = block + x * 4 + y * stride;
+            int best = color_distance(p, color), idx = 0;
+
+            for (k = 1; k < nb_colors; k++) {
+                int dist = color_distance(p, color + k * 4);
+                if (dist < best) {
+                    best = dist;
+                    idx  = k;
+                }
+            }
+            mask  |= idx << (2 * (x + y * 4));
+            error += best;
+        }
+    }
+
+    *pmask = mask;
+    return error;
+}
+
+/* Write the color block, c0 must not be smaller than c1 */
+static void write_color_block(uint8_t *dst, uint16_t c0, uint16_t c1,
+                              uint32_t mask)
+{
+    AV_WL16(dst + 0, c0);
+    AV_WL16(dst + 2, c1);
+    AV_WL32(dst + 4, mask);
+}
+
+/**
+ * Fast color compression: the endpoints are the corners of the bounding box
+ * of the block, inset by 1/16 of its size to reduce the error caused by
+ * outliers. Each pixel picks the palette entry at the smallest sum of
+ * absolute differences. See J.M.P. van Waveren, "Real-Time DXT Compression".
+ */
+static void compress_color_range(uint8_t *dst, ptrdiff_t stride,
+                                 const uint8_t *block)
+{
+    uint8_t color[16];
+    uint32_t mask = 0;
+    uint16_t max16, min16;
+    int mn[3] = { 255, 255, 255 }, mx[3] = { 0 };
+    int ch, x, y;
+
+    for (y = 0; y < 4; y++) {
+        for (x = 0; x < 4; x++) {
+            for (ch = 0; ch < 3; ch++) {
+                int v = block[ch + x * 4 + y * stride];
+                mn[ch] = FFMIN(mn[ch], v);
+                mx[ch] = FFMAX(mx[ch], v);
+            }
+        }
+    }
+
+    for (ch = 0; ch < 3; ch++) {
+        int inset = (mx[ch] - mn[ch]) >> 4;
+        mn[ch] += inset;
+        mx[ch] -= inset;
+    }
+
+    max16 = ((mx[0] >> 3) << 11) | ((mx[1] >> 2) << 5) | (mx[2] >> 3);
+    min16 = ((mn[0] >> 3) << 11) | ((mn[1] >> 2) << 5) | (mn[2] >> 3);
+
+    if (max16 != min16) {
+        rgb5652rgb(color + 0, max16);
+        rgb5652rgb(color + 4, min16);
+        lerp13rgb(color + 8, color + 0, color + 4);
+        lerp13rgb(color + 12, color + 4, color + 0);
+
+        for (y = 0; y < 4; y++) {
+            for (x = 0; x < 4; x++) {
+                const uint8_t *p = block + x * 4 + y * stride;
+                int d[4], b0, b1, b2, b3, b4;
+
+                for (ch = 0; ch < 4; ch++)
+                    d[ch] = FFABS(p[0] - color[ch * 4 + 0]) +
+                            FFABS(p[1] - color[ch * 4 + 1]) +
+                            FFABS(p[2] - color[ch * 4 + 2]);
+
+                /* branchless selection of the nearest of the four colors,
+                 * which lie in the order 0, 2, 3, 1 on the line */
+                b0 = d[0] > d[3];
+                b1 = d[1] > d[2];
+                b2 = d[0] > d[2];
+                b3 = d[1] > d[3];
+                b4 = d[2] > d[3];
+
+                mask |= ((b0 & b4) | (((b1 & b2) | (b0 & b3)) << 1)) <<
+                        (2 * (x + y * 4));
+            }
+        }
+    }
+
+    write_color_block(dst, max16, min16, mask);
+}
+
+/**
+ * Slow color compression: the pixels are sorted along the principal axis
+ * of the block and every split of that order into the four palette entries
+ * is solved in the least squares sense, keeping the endpoints with the
+ * smallest error after quantization. The result of compress_color() is
+ * kept if it happens to be better.
+ */
+static void compress_color_cluster(uint8_t *dst, ptrdiff_t stride,
+                                   const uint8_t *block)
+{
+    float pts[16][3], sums[17][3], mu[3] = { 0 }, cov[6] = { 0 };
+    float axis[3], dots[16], best_err = FLT_MAX;
+    int order[16], best[2][3] = { { 0 } };
+    uint32_t mask, mask2;
+    uint16_t max16, min16, c0, c1;
+    int i, j, k, ch, x, y, iter, err, err2;
+
+    compress_color(dst, stride, block);
+    if (constant_color(block, stride))
+        return;
+
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 4; x++)
+            for (ch = 0; ch < 3; ch++)
+                mu[ch] += block[ch + x * 4 + y * stride] / 16.0f;
+
+    for (y = 0; y < 4; y++) {
+        for (x = 0; x < 4; x++) {
+            const uint8_t *p = block + x * 4 + y * stride;
+            float r = p[0] - mu[0], g = p[1] - mu[1], b = p[2] - mu[2];
+
+            cov[0] += r * r;
+            cov[1] += r * g;
+            cov[2] += r * b;
+            cov[3] += g * g;
+            cov[4] += g * b;
+            cov[5] += b * b;
+        }
+    }
+
+    /* principal axis by power iteration, starting from the largest row */
+    axis[0] = cov[0] + cov[1] + cov[2];
+    axis[1] = cov[1] + cov[3] + cov[4];
+    axis[2] = cov[2] + cov[4] + cov[5];
+    for (iter = 0; iter < 8; iter++) {
+        float r = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+        float g = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+        float b = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+        float m = FFMAX3(fabsf(r), fabsf(g), fabsf(b));
+
+        if (m < 1e-6f)
+            return;
+        axis[0] = r / m;
+        axis[1] = g / m;
+        axis[2] = b / m;
+    }
+
+    /* sort the pixels along the axis */
+    for (i = 0; i < 16; i++) {
+        const uint8_t *p = block + (i & 3) * 4 + (i >> 2) * stride;
+
+        dots[i] = p[0] * axis[0] + p[1] * axis[1] + p[2] * axis[2];
+        for (j = i; j > 0 && dots[order[j - 1]] < dots[i]; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+    for (i = 0; i < 16; i++) {
+        const uint8_t *p = block + (order[i] & 3) * 4 + (order[i] >> 2) * stride;
+        for (ch = 0; ch < 3; ch++)
+            pts[i][ch] = p[ch];
+    }
+    for (ch = 0; ch < 3; ch++) {
+        sums[0][ch] = 0;
+        for (i = 0; i < 16; i++)
+            sums[i + 1][ch] = sums[i][ch] + pts[i][ch];
+    }
+
+    /* pixels [0, i) get the first endpoint, [i, j) the 2/3 point,
+     * [j, k) the 1/3 point and [k, 16) the second endpoint */
+    for (i = 0; i <= 16; i++) {
+        for (j = i; j <= 16; j++) {
+            for (k = j; k <= 16; k++) {
+                const float alpha2 = i + (j - i) * (4.0f / 9) + (k - j) * (1.0f / 9);
+                const float beta2  = (16 - k) + (j - i) * (1.0f / 9) + (k - j) * (4.0f / 9);
+                const float ab     = (k - i) * (2.0f / 9);
+                const float det    = alpha2 * beta2 - ab * ab;
+                float e = 0;
+                int q[2][3];
+
+                if (fabsf(det) < 1e-6f)
+                    continue;
+
+                for (ch = 0; ch < 3; ch++) {
+                    const int bits = ch == 1 ? 63 : 31;
+                    const uint8_t *expand = ch == 1 ? expand6 : expand5;
+                    float s0 = sums[i][ch];
+                    float s2 = sums[j][ch] - sums[i][ch];
+                    float s3 = sums[k][ch] - sums[j][ch];
+                    float s1 = sums[16][ch] - sums[k][ch];
+                    float ax = s0 + s2 * (2.0f / 3) + s3 * (1.0f / 3);
+                    float bx = s1 + s2 * (1.0f / 3) + s3 * (2.0f / 3);
+                    float a  = (ax * beta2 - bx * ab) / det;
+                    float b  = (bx * alpha2 - ax * ab) / det;
+
+                    q[0][ch] = av_clip(lrintf(a * bits / 255.0f), 0, bits);
+                    q[1][ch] = av_clip(lrintf(b * bits / 255.0f), 0, bits);
+                    a = expand[q[0][ch]];
+                    b = expand[q[1][ch]];
+                    e += a * a * alpha2 + b * b * beta2 +
+                         2.0f * (a * b * ab - a * ax - b * bx);
+                }
+
+                if (e < best_err) {
+                    best_err = e;
+                    memcpy(best, q, sizeof(best));
+                }
+            }
+        }
+    }
+
+    c0 = (best[0][0] << 11) | (best[0][1] << 5) | best[0][2];
+    c1 = (best[1][0] << 11) | (best[1][1] << 5) | best[1][2];
+    if (c0 < c1)
+        FFSWAP(uint16_t, c0, c1);
+
+    max16 = AV_RL16(dst + 0);
+    min16 = AV_RL16(dst + 2);
+    err  = nearest_colors(block, stride, max16, min16, &mask);
+    err2 = nearest_colors(block, stride, c0, c1, &mask2);
+    if (err2 < err)
+        write_color_block(dst, c0, c1, mask2);
+    else
+        write_color_block(dst, max16, min16, mask);
+}
+
 /* Alpha compression function */
 static void compress_alpha(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
 {
@@ -589,6 +845,16 @@ static void rgba2ycocg(uint8_t *dst, const uint8_t *pixel)
     dst[3] = av_clip_uint8(g + t);                      /* Y */
 }
 
+void ff_texturedspenc_rgba2ycocg_block(uint8_t *dst, ptrdiff_t stride,
+                                       const uint8_t *block)
+{
+    int x, y;
+
+    for (y = 0; y < 4; y++)
+        for (x = 0; x < 4; x++)
+            rgba2ycocg(dst + x * 4 + y * 16, block + x * 4 + y * stride);
+}
+
 /**
  * Compress one block of RGBA pixels in a DXT1 texture and store the
  * resulting bytes in 'dst'. Alpha is not preserved.
@@ -633,13 +899,10 @@ static int dxt5_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
  */
 static int dxt5ys_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
 {
-    int x, y;
     uint8_t reorder[64];
 
     /* Reorder the components and then run a normal DXT5 compression. */
-    for (y = 0; y < 4; y++)
-        for (x = 0; x < 4; x++)
-            rgba2ycocg(reorder + x * 4 + y * 16, block + x * 4 + y * stride);
+    ff_texturedspenc_rgba2ycocg_block(reorder, stride, block);
 
     compress_alpha(dst + 0, 16, reorder);
     compress_color(dst + 8, 16, reorder);
@@ -647,9 +910,75 @@ static int dxt5ys_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
     return 16;
 }
 
-av_cold void ff_texturedspenc_init(TextureDSPContext *c)
+/* Same as above with the other color endpoint searches. */
+static int dxt1_block_range(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+{
+    compress_color_range(dst, stride, block);
+
+    return 8;
+}
+
+static int dxt5_block_range(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+{
+    compress_alpha(dst, stride, block);
+    compress_color_range(dst + 8, stride, block);
+
+    return 16;
+}
+
+static int dxt5ys_block_range(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
 {
-    c->dxt1_block   = dxt1_block;
-    c->dxt5_block   = dxt5_block;
-    c->dxt5ys_block = dxt5ys_block;
+    uint8_t reorder[64];
+
+    ff_texturedspenc_rgba2ycocg_block(reorder, stride, block);
+
+    return dxt5_block_range(dst, 16, reorder);
+}
+
+static int dxt1_block_cluster(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+{
+    compress_color_cluster(dst, stride, block);
+
+    return 8;
+}
+
+static int dxt5_block_cluster(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+{
+    compress_alpha(dst, stride, block);
+    compress_color_cluster(dst + 8, stride, block);
+
+    return 16;
+}
+
+static int dxt5ys_block_cluster(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+{
+    uint8_t reorder[64];
+
+    ff_texturedspenc_rgba2ycocg_block(reorder, stride, block);
+
+    return dxt5_block_cluster(dst, 16, reorder);
+}
+
+av_cold void ff_texturedspenc_init(TextureDSPContext *c, enum TextureDSPFit fit)
+{
+    switch (fit) {
+    case TEXTURE_FIT_RANGE:
+        c->dxt1_block   = dxt1_block_range;
+        c->dxt5_block   = dxt5_block_range;
+        c->dxt5ys_block = dxt5ys_block_range;
+        break;
+    case TEXTURE_FIT_CLUSTER:
+        c->dxt1_block   = dxt1_block_cluster;
+        c->dxt5_block   = dxt5_block_cluster;
+        c->dxt5ys_block = dxt5ys_block_cluster;
+        break;
+    default:
+        c->dxt1_block   = dxt1_block;
+        c->dxt5_block   = dxt5_block;
+        c->dxt5ys_block = dxt5ys_block;
+        break;
+    }
+
+    if (ARCH_X86)
+        ff_texturedspenc_init_x86(c, fit);
 }
@@ -20,227 +20,187 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include "libavutil/attributes.h"
+#include "libavutil/common.h"
 #include "libavutil/mem.h"
+#include "config.h"
 #include "vc2enc_dwt.h"
 
-/* Since the transforms spit out interleaved coefficients, this function
- * rearranges the coefficients into the more traditional subdivision,
- * making it easier to encode and perform another level. */
-static av_always_inline void deinterleave(dwtcoef *linell, ptrdiff_t stride,
-                                          int width, int height, dwtcoef *synthl)
+/* Padding of the row buffer on each side of the low and high halves. */
+#define ROW_PAD 8
+
+static void deinterleave_c(dwtcoef *lo, dwtcoef *hi, const dwtcoef *src,
+                           int width, int shift)
 {
-    int x, y;
-    ptrdiff_t synthw = width << 1;
-    dwtcoef *linehl = linell + width;
-    dwtcoef *linelh = linell + height*stride;
-    dwtcoef *linehh = linelh + width;
+    int x;
 
-    /* Deinterleave the coefficients. */
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
-            linell[x] = synthl[(x << 1)];
-            linehl[x] = synthl[(x << 1) + 1];
-            linelh[x] = synthl[(x << 1) + synthw];
-            linehh[x] = synthl[(x << 1) + synthw + 1];
-        }
-        synthl += synthw << 1;
-        linell += stride;
-        linelh += stride;
-        linehl += stride;
-        linehh += stride;
+    for (x = 0; x < width; x++) {
+        lo[x] = src[2*x + 0] << shift;
+        hi[x] = src[2*x + 1] << shift;
     }
 }
 
-static void vc2_subband_dwt_97(VC2TransformContext *t, dwtcoef *data,
-                               ptrdiff_t stride, int width, int height)
+static void lift_lo_c(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+                      int width)
 {
-    int x, y;
-    dwtcoef *datal = data, *synth = t->buffer, *synthl = synth;
-    const ptrdiff_t synth_width  = width  << 1;
-    const ptrdiff_t synth_height = height << 1;
+    int x;
 
-    /*
-     * Shift in one bit that is used for additional precision and copy
-     * the data to the buffer.
-     */
-    for (y = 0; y < synth_height; y++) {
-        for (x = 0; x < synth_width; x++)
-            synthl[x] = datal[x] << 1;
-        synthl += synth_width;
-        datal += stride;
-    }
+    for (x = 0; x < width; x++)
+        dst[x] += (b0[x] + b1[x] + 2) >> 2;
+}
 
-    /* Horizontal synthesis. */
-    synthl = synth;
-    for (y = 0; y < synth_height; y++) {
-        /* Lifting stage 2. */
-        synthl[1] -= (8*synthl[0] + 9*synthl[2] - synthl[4] + 8) >> 4;
-        for (x = 1; x < width - 2; x++)
-            synthl[2*x + 1] -= (9*synthl[2*x] + 9*synthl[2*x + 2] - synthl[2*x + 4] -
-                                synthl[2 * x - 2] + 8) >> 4;
-        synthl[synth_width - 1] -= (17*synthl[synth_width - 2] -
-                                    synthl[synth_width - 4] + 8) >> 4;
-        synthl[synth_width - 3] -= (8*synthl[synth_width - 2] +
-                                    9*synthl[synth_width - 4] -
-                                    synthl[synth_width - 6] + 8) >> 4;
-        /* Lifting stage 1. */
-        synthl[0] += (synthl[1] + synthl[1] + 2) >> 2;
-        for (x = 1; x < width - 1; x++)
-            synthl[2*x] += (synthl[2*x - 1] + synthl[2*x + 1] + 2) >> 2;
+static void lift_hi_53_c(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+                         int width)
+{
+    int x;
 
-        synthl[synth_width - 2] += (synthl[synth_width - 3] +
-                                    synthl[synth_width - 1] + 2) >> 2;
-        synthl += synth_width;
-    }
+    for (x = 0; x < width; x++)
+        dst[x] -= (b0[x] + b1[x] + 1) >> 1;
+}
 
-    /* Vertical synthesis: Lifting stage 2. */
-    synthl = synth + synth_width;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] -= (8*synthl[x - synth_width] + 9*synthl[x + synth_width] -
-                      synthl[x + 3 * synth_width] + 8) >> 4;
-
-    synthl = synth + (synth_width << 1);
-    for (y = 1; y < height - 2; y++) {
-        for (x = 0; x < synth_width; x++)
-            synthl[x + synth_width] -= (9*synthl[x] +
-                                        9*synthl[x + 2 * synth_width] -
-                                        synthl[x - 2 * synth_width] -
-                                        synthl[x + 4 * synth_width] + 8) >> 4;
-        synthl += synth_width << 1;
-    }
+static void lift_hi_97_c(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+                         const dwtcoef *b2, const dwtcoef *b3, int width)
+{
+    int x;
 
-    synthl = synth + (synth_height - 1) * synth_width;
-    for (x = 0; x < synth_width; x++) {
-        synthl[x] -= (17*synthl[x - synth_width] -
-                      synthl[x - 3*synth_width] + 8) >> 4;
-                      synthl[x - 2*synth_width] -= (9*synthl[x - 3*synth_width] +
-                      8*synthl[x - 1*synth_width] - synthl[x - 5*synth_width] + 8) >> 4;
-    }
+    for (x = 0; x < width; x++)
+        dst[x] -= (9*b1[x] + 9*b2[x] - b0[x] - b3[x] + 8) >> 4;
+}
 
-    /* Vertical synthesis: Lifting stage 1. */
-    synthl = synth;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] += (synthl[x + synth_width] + synthl[x + synth_width] + 2) >> 2;
-
-    synthl = synth + (synth_width << 1);
-    for (y = 1; y < height - 1; y++) {
-        for (x = 0; x < synth_width; x++)
-            synthl[x] += (synthl[x - synth_width] + synthl[x + synth_width] + 2) >> 2;
-        synthl += synth_width << 1;
+static void haar_c(dwtcoef *lo, dwtcoef *hi, int width)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        hi[x] -= lo[x];
+        lo[x] += (hi[x] + 1) >> 1;
     }
+}
 
-    synthl = synth + (synth_height - 2) * synth_width;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] += (synthl[x - synth_width] + synthl[x + synth_width] + 2) >> 2;
+/*
+ * The horizontal pass leaves each row of the buffer split into its low and
+ * high halves, so the vertical pass lifts whole rows and the coefficients
+ * only need to be copied back into the traditional subband layout, making
+ * it easier to encode and perform another level.
+ */
+static av_always_inline void copy_subbands(dwtcoef *data, ptrdiff_t stride,
+                                           const dwtcoef *synth,
+                                           ptrdiff_t synth_stride,
+                                           int width, int height)
+{
+    int y;
 
-    deinterleave(data, stride, width, height, synth);
+    for (y = 0; y < height; y++) {
+        memcpy(data + y*stride, synth + 2*y*synth_stride,
+               2*width*sizeof(*data));
+        memcpy(data + (height + y)*stride, synth + (2*y + 1)*synth_stride,
+               2*width*sizeof(*data));
+    }
 }
 
-static void vc2_subband_dwt_53(VC2TransformContext *t, dwtcoef *data,
-                               ptrdiff_t stride, int width, int height)
+/*
+ * Both lifting transforms use symmetric extension at the edges, which is
+ * expressed by clamping the rows or padding the row buffer.
+ */
+static av_always_inline void dwt_lifting(VC2TransformContext *t, dwtcoef *data,
+                                         ptrdiff_t stride, int width, int height,
+                                         const int is_97)
 {
-    int x, y;
-    dwtcoef *synth = t->buffer, *synthl = synth, *datal = data;
-    const ptrdiff_t synth_width  = width  << 1;
-    const ptrdiff_t synth_height = height << 1;
+    const VC2DWTDSPContext *c = &t->dsp;
+    const int synth_width  = width  << 1;
+    const int synth_height = height << 1;
+    const ptrdiff_t synth_stride = FFALIGN(synth_width, 8);
+    dwtcoef *synth = t->buffer;
+    dwtcoef *lo = t->row + ROW_PAD;
+    dwtcoef *hi = lo + FFALIGN(width, 8) + 2*ROW_PAD;
+    int y;
+
+#define LO(y) (synth + 2*av_clip(y, 0, height - 1)*synth_stride)
+#define HI(y) (LO(y) + synth_stride)
 
     /*
-     * Shift in one bit that is used for additional precision and copy
-     * the data to the buffer.
+     * Horizontal synthesis. One bit is shifted in for additional precision
+     * while the row is deinterleaved.
      */
     for (y = 0; y < synth_height; y++) {
-        for (x = 0; x < synth_width; x++)
-            synthl[x] = datal[x] << 1;
-        synthl += synth_width;
-        datal  += stride;
-    }
+        c->deinterleave(lo, hi, data + y*stride, width, 1);
 
-    /* Horizontal synthesis. */
-    synthl = synth;
-    for (y = 0; y < synth_height; y++) {
         /* Lifting stage 2. */
-        for (x = 0; x < width - 1; x++)
-            synthl[2 * x + 1] -= (synthl[2 * x] + synthl[2 * x + 2] + 1) >> 1;
-
-        synthl[synth_width - 1] -= (2*synthl[synth_width - 2] + 1) >> 1;
+        lo[-1]    = lo[0];
+        lo[width] = lo[width + 1] = lo[width - 1];
+        if (is_97)
+            c->lift_hi_97(hi, lo - 1, lo, lo + 1, lo + 2, width);
+        else
+            c->lift_hi_53(hi, lo, lo + 1, width);
 
         /* Lifting stage 1. */
-        synthl[0] += (2*synthl[1] + 2) >> 2;
-        for (x = 1; x < width - 1; x++)
-            synthl[2 * x] += (synthl[2 * x - 1] + synthl[2 * x + 1] + 2) >> 2;
-
-        synthl[synth_width - 2] += (synthl[synth_width - 3] + synthl[synth_width - 1] + 2) >> 2;
+        hi[-1] = hi[0];
+        c->lift_lo(lo, hi - 1, hi, width);
 
-        synthl += synth_width;
+        memcpy(synth + y*synth_stride,         lo, width*sizeof(*lo));
+        memcpy(synth + y*synth_stride + width, hi, width*sizeof(*hi));
     }
 
     /* Vertical synthesis: Lifting stage 2. */
-    synthl = synth + synth_width;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] -= (synthl[x - synth_width] + synthl[x + synth_width] + 1) >> 1;
-
-    synthl = synth + (synth_width << 1);
-    for (y = 1; y < height - 1; y++) {
-        for (x = 0; x < synth_width; x++)
-            synthl[x + synth_width] -= (synthl[x] + synthl[x + synth_width * 2] + 1) >> 1;
-        synthl += (synth_width << 1);
+    for (y = 0; y < height; y++) {
+        if (is_97)
+            c->lift_hi_97(HI(y), LO(y - 1), LO(y), LO(y + 1), LO(y + 2),
+                          synth_width);
+        else
+            c->lift_hi_53(HI(y), LO(y), LO(y + 1), synth_width);
     }
 
-    synthl = synth + (synth_height - 1) * synth_width;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] -= (2*synthl[x - synth_width] + 1) >> 1;
-
     /* Vertical synthesis: Lifting stage 1. */
-    synthl = synth;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] += (2*synthl[synth_width + x] + 2) >> 2;
-
-    synthl = synth + (synth_width << 1);
-    for (y = 1; y < height - 1; y++) {
-        for (x = 0; x < synth_width; x++)
-            synthl[x] += (synthl[x + synth_width] + synthl[x - synth_width] + 2) >> 2;
-        synthl += (synth_width << 1);
-    }
+    for (y = 0; y < height; y++)
+        c->lift_lo(LO(y), HI(y - 1), HI(y), synth_width);
 
-    synthl = synth + (synth_height - 2)*synth_width;
-    for (x = 0; x < synth_width; x++)
-        synthl[x] += (synthl[x - synth_width] + synthl[x + synth_width] + 2) >> 2;
+#undef LO
+#undef HI
 
+    copy_subbands(data, stride, synth, synth_stride, width, height);
+}
 
-    deinterleave(data, stride, width, height, synth);
+static void vc2_subband_dwt_97(VC2TransformContext *t, dwtcoef *data,
+                               ptrdiff_t stride, int width, int height)
+{
+    dwt_lifting(t, data, stride, width, height, 1);
+}
+
+static void vc2_subband_dwt_53(VC2TransformContext *t, dwtcoef *data,
+                               ptrdiff_t stride, int width, int height)
+{
+    dwt_lifting(t, data, stride, width, height, 0);
 }
 
 static av_always_inline void dwt_haar(VC2TransformContext *t, dwtcoef *data,
                                       ptrdiff_t stride, int width, int height,
                                       const int s)
 {
-    int x, y;
-    dwtcoef *synth = t->buffer, *synthl = synth, *datal = data;
-    const ptrdiff_t synth_width  = width  << 1;
-    const ptrdiff_t synth_height = height << 1;
+    const VC2DWTDSPContext *c = &t->dsp;
+    const int synth_width  = width  << 1;
+    const int synth_height = height << 1;
+    const ptrdiff_t synth_stride = FFALIGN(synth_width, 8);
+    dwtcoef *synth = t->buffer;
+    dwtcoef *lo = t->row + ROW_PAD;
+    dwtcoef *hi = lo + FFALIGN(width, 8) + 2*ROW_PAD;
+    int y;
 
     /* Horizontal synthesis. */
     for (y = 0; y < synth_height; y++) {
-        for (x = 0; x < synth_width; x += 2) {
-            synthl[y*synth_width + x + 1] = (datal[y*stride + x + 1] << s) -
-                                            (datal[y*stride + x] << s);
-            synthl[y*synth_width + x] = (datal[y*stride + x + 0] << s) +
-                                        ((synthl[y*synth_width + x + 1] + 1) >> 1);
-        }
+        c->deinterleave(lo, hi, data + y*stride, width, s);
+        c->haar(lo, hi, width);
+        memcpy(synth + y*synth_stride,         lo, width*sizeof(*lo));
+        memcpy(synth + y*synth_stride + width, hi, width*sizeof(*hi));
     }
 
     /* Vertical synthesis. */
-    for (x = 0; x < synth_width; x++) {
-        for (y = 0; y < synth_height; y += 2) {
-            synthl[(y + 1)*synth_width + x] = synthl[(y + 1)*synth_width + x] -
-                                              synthl[y*synth_width + x];
-            synthl[y*synth_width + x] = synthl[y*synth_width + x] +
-                                        ((synthl[(y + 1)*synth_width + x] + 1) >> 1);
-        }
-    }
+    for (y = 0; y < synth_height; y += 2)
+        c->haar(synth + y*synth_stride, synth + (y + 1)*synth_stride,
+                synth_width);
 
-    deinterleave(data, stride, width, height, synth);
+    copy_subbands(data, stride, synth, synth_stride, width, height);
 }
 
 static void vc2_subband_dwt_haar(VC2TransformContext *t, dwtcoef *data,
@@ -255,6 +215,18 @@ static void vc2_subband_dwt_haar_shift(VC2TransformContext *t, dwtcoef *data,
     dwt_haar(t, data, stride, width, height, 1);
 }
 
+av_cold void ff_vc2enc_dwt_dsp_init(VC2DWTDSPContext *c)
+{
+    c->deinterleave = deinterleave_c;
+    c->lift_lo      = lift_lo_c;
+    c->lift_hi_53   = lift_hi_53_c;
+    c->lift_hi_97   = lift_hi_97_c;
+    c->haar         = haar_c;
+
+    if (ARCH_X86)
+        ff_vc2enc_dwt_dsp_init_x86(c);
+}
+
 av_cold int ff_vc2enc_init_transforms(VC2TransformContext *s, int p_width, int p_height)
 {
     s->vc2_subband_dwt[VC2_TRANSFORM_9_7]    = vc2_subband_dwt_97;
@@ -262,8 +234,11 @@ av_cold int ff_vc2enc_init_transforms(VC2TransformContext *s, int p_width, int p
     s->vc2_subband_dwt[VC2_TRANSFORM_HAAR]   = vc2_subband_dwt_haar;
     s->vc2_subband_dwt[VC2_TRANSFORM_HAAR_S] = vc2_subband_dwt_haar_shift;
 
-    s->buffer = av_malloc(2*p_width*p_height*sizeof(dwtcoef));
-    if (!s->buffer)
+    ff_vc2enc_dwt_dsp_init(&s->dsp);
+
+    s->buffer = av_mallocz(FFALIGN(p_width, 8)*p_height*sizeof(dwtcoef));
+    s->row    = av_mallocz((p_width + 8*ROW_PAD)*sizeof(dwtcoef));
+    if (!s->buffer || !s->row)
         return 1;
 
     return 0;
@@ -272,4 +247,5 @@ av_cold int ff_vc2enc_init_transforms(VC2TransformContext *s, int p_width, int p
 av_cold void ff_vc2enc_free_transforms(VC2TransformContext *s)
 {
     av_freep(&s->buffer);
+    av_freep(&s->row);
 }
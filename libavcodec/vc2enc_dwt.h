@@ -39,8 +39,33 @@ enum VC2TransformType {
     VC2_TRANSFORMS_NB
 };
 
+/**
+ * Lifting steps shared by the horizontal and vertical passes. The
+ * horizontal pass works on a deinterleaved row so both passes run over
+ * contiguous coefficients. Functions may process up to 7 coefficients past
+ * width, so all buffers must be padded; dst, lo and hi must be aligned.
+ */
+typedef struct VC2DWTDSPContext {
+    /* lo[x] = src[2x] << shift, hi[x] = src[2x + 1] << shift */
+    void (*deinterleave)(dwtcoef *lo, dwtcoef *hi, const dwtcoef *src,
+                         int width, int shift);
+    /* dst[x] += (b0[x] + b1[x] + 2) >> 2 */
+    void (*lift_lo)(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+                    int width);
+    /* dst[x] -= (b0[x] + b1[x] + 1) >> 1 */
+    void (*lift_hi_53)(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+                       int width);
+    /* dst[x] -= (9*b1[x] + 9*b2[x] - b0[x] - b3[x] + 8) >> 4 */
+    void (*lift_hi_97)(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+                       const dwtcoef *b2, const dwtcoef *b3, int width);
+    /* hi[x] -= lo[x], lo[x] += (hi[x] + 1) >> 1 */
+    void (*haar)(dwtcoef *lo, dwtcoef *hi, int width);
+} VC2DWTDSPContext;
+
 typedef struct VC2TransformContext {
     dwtcoef *buffer;
+    dwtcoef *row;
+    VC2DWTDSPContext dsp;
     void (*vc2_subband_dwt[VC2_TRANSFORMS_NB])(struct VC2TransformContext *t,
                                                dwtcoef *data, ptrdiff_t stride,
                                                int width, int height);
@@ -49,4 +74,7 @@ typedef struct VC2TransformContext {
 int  ff_vc2enc_init_transforms(VC2TransformContext *t, int p_width, int p_height);
 void ff_vc2enc_free_transforms(VC2TransformContext *t);
 
+void ff_vc2enc_dwt_dsp_init(VC2DWTDSPContext *c);
+void ff_vc2enc_dwt_dsp_init_x86(VC2DWTDSPContext *c);
+
 #endif /* AVCODEC_VC2ENC_DWT_H */
@@ -0,0 +1,90 @@
+;******************************************************************************
+;* SIMD optimized AAC encoder DSP functions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+float_abs_mask: times 4 dd 0x7fffffff
+
+SECTION .text
+
+;*******************************************************************
+;void ff_abs_pow34(float *out, const float *in, const int size);
+;*******************************************************************
+INIT_XMM sse
+cglobal abs_pow34, 3, 3, 3, out, in, size
+    mova   m2, [float_abs_mask]
+    movsxdifnidn sizeq, sized
+    shl    sizeq, 2
+    add    inq, sizeq
+    add    outq, sizeq
+    neg    sizeq
+.loop:
+    movu   m0, [inq+sizeq]
+    andps  m0, m2
+    sqrtps m1, m0
+    mulps  m0, m1
+    sqrtps m0, m0
+    movu   [outq+sizeq], m0
+    add    sizeq, mmsize
+    jl    .loop
+    RET
+
+;*******************************************************************
+;void ff_aac_quantize_bands(int *out, const float *in, const float *scaled,
+;                           int size, int is_signed, int maxval, const float Q34,
+;                           const float rounding)
+;*******************************************************************
+INIT_XMM sse2
+cglobal aac_quantize_bands, 6, 6, 6, out, in, scaled, size, is_signed, maxval, Q34, rounding
+%if UNIX64 == 0
+    movss     m0, Q34m
+    movss     m1, roundingm
+%endif
+    cvtsi2ss  m2, maxvald
+    shufps    m0, m0, 0
+    shufps    m1, m1, 0
+    shufps    m2, m2, 0
+    movd      m3, is_signedd
+    pshufd    m3, m3, 0
+    pxor      m4, m4
+    pcmpgtd   m3, m4            ; all ones if is_signed
+    movsxdifnidn sizeq, sized
+    shl       sizeq, 2
+    add       inq, sizeq
+    add       outq, sizeq
+    add       scaledq, sizeq
+    neg       sizeq
+.loop:
+    movu      m4, [scaledq+sizeq]
+    mulps     m4, m0
+    addps     m4, m1
+    minps     m4, m2
+    cvttps2dq m4, m4
+    movu      m5, [inq+sizeq]
+    psrad     m5, 31
+    pand      m5, m3            ; -1 for negative input when signed
+    pxor      m4, m5
+    psubd     m4, m5
+    movu      [outq+sizeq], m4
+    add       sizeq, mmsize
+    jl       .loop
+    RET
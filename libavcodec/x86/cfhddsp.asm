@@ -0,0 +1,156 @@
+;******************************************************************************
+;* SIMD optimized CineForm HD inverse wavelet
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pd_4: times 4 dd 4
+
+cextern pd_65535
+
+SECTION .text
+
+; %1 = punpcklwd or punpckhwd selecting the half of m0-m3 to process
+; m0-m3 = low[i - 1], low[i], low[i + 1], high[i]
+; even outputs in %2 and odd outputs in %3 as dwords, clobbers m4
+; %2 may be m0 and %3 may be m2, both are dead by the time they are written
+%macro FILTER_HALF 3
+    %1                  %2, m0, m0
+    %1                  %3, m2, m2
+    psrad               %2, 16                  ; low[i - 1]
+    psrad               %3, 16                  ; low[i + 1]
+    psubd               m4, %2, %3
+    psubd               %3, %2
+    paddd               m4, [pd_4]
+    paddd               %3, [pd_4]
+    psrad               m4, 3                   ; (low[i - 1] - low[i + 1] + 4) >> 3
+    psrad               %3, 3                   ; (low[i + 1] - low[i - 1] + 4) >> 3
+    %1                  %2, m1, m1
+    psrad               %2, 16                  ; low[i]
+    paddd               m4, %2
+    paddd               %3, %2
+    %1                  %2, m3, m3
+    psrad               %2, 16                  ; high[i]
+    psubd               %3, %2
+    paddd               %2, m4
+    psrad               %2, 1
+    psrad               %3, 1
+%endmacro
+
+; both halves of the 8 pairs in m0-m3, even outputs in m5 and m0, odd
+; outputs in m6 and m2
+%macro FILTER 0
+    FILTER_HALF punpcklwd, m5, m6
+    FILTER_HALF punpckhwd, m0, m2
+%endmacro
+
+; %1 = 1 to clip the output
+%macro HORIZ_FILTER 1
+%if %1
+cglobal cfhd_horiz_filter_clip, 5, 5, 8, output, low, high, width, clip
+    movd                m7, clipd
+    pcmpeqw             m1, m1
+    psllw               m1, m7
+    pcmpeqw             m7, m7
+    pxor                m7, m1                  ; (1 << clip) - 1
+%else
+cglobal cfhd_horiz_filter, 4, 4, 7, output, low, high, width
+%endif
+    movsxdifnidn    widthq, widthd
+    add             widthq, widthq
+    add               lowq, widthq
+    add              highq, widthq
+    lea            outputq, [outputq+widthq*2]
+    neg             widthq
+.loop:
+    movu                m0, [lowq+widthq-2]
+    movu                m1, [lowq+widthq]
+    movu                m2, [lowq+widthq+2]
+    movu                m3, [highq+widthq]
+    FILTER
+    ; interleave the truncated even and odd outputs
+    pand                m5, [pd_65535]
+    pand                m0, [pd_65535]
+    pslld               m6, 16
+    pslld               m2, 16
+    por                 m5, m6
+    por                 m0, m2
+%if %1
+    pxor                m1, m1
+    pmaxsw              m5, m1
+    pmaxsw              m0, m1
+    pminsw              m5, m7
+    pminsw              m0, m7
+%endif
+    movu [outputq+widthq*2], m5
+    movu [outputq+widthq*2+mmsize], m0
+    add             widthq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+;------------------------------------------------------------------------------
+; void ff_cfhd_horiz_filter(int16_t *output, const int16_t *low,
+;                           const int16_t *high, int width)
+;------------------------------------------------------------------------------
+HORIZ_FILTER 0
+
+;------------------------------------------------------------------------------
+; void ff_cfhd_horiz_filter_clip(int16_t *output, const int16_t *low,
+;                                const int16_t *high, int width, int clip)
+;------------------------------------------------------------------------------
+HORIZ_FILTER 1
+
+;------------------------------------------------------------------------------
+; void ff_cfhd_vert_filter(int16_t *output, ptrdiff_t out_stride,
+;                          const int16_t *low, ptrdiff_t low_stride,
+;                          const int16_t *high, int width)
+;------------------------------------------------------------------------------
+cglobal cfhd_vert_filter, 6, 6, 7, output, out_stride, low, low_stride, high, width
+    add        out_strideq, out_strideq
+    add        low_strideq, low_strideq
+    sub               lowq, low_strideq         ; row above
+.loop:
+    movu                m0, [lowq]
+    movu                m1, [lowq+low_strideq]
+    movu                m2, [lowq+low_strideq*2]
+    movu                m3, [highq]
+    FILTER
+    ; truncate to 16 bits
+    pslld               m5, 16
+    pslld               m0, 16
+    pslld               m6, 16
+    pslld               m2, 16
+    psrad               m5, 16
+    psrad               m0, 16
+    psrad               m6, 16
+    psrad               m2, 16
+    packssdw            m5, m0
+    packssdw            m6, m2
+    movu         [outputq], m5
+    movu [outputq+out_strideq], m6
+    add            outputq, mmsize
+    add               lowq, mmsize
+    add              highq, mmsize
+    sub             widthd, mmsize / 2
+    jg .loop
+    RET
@@ -0,0 +1,45 @@
+/*
+ * CineForm HD DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/cfhddsp.h"
+
+void ff_cfhd_horiz_filter_sse2(int16_t *output, const int16_t *low,
+                               const int16_t *high, int width);
+void ff_cfhd_horiz_filter_clip_sse2(int16_t *output, const int16_t *low,
+                                    const int16_t *high, int width, int clip);
+void ff_cfhd_vert_filter_sse2(int16_t *output, ptrdiff_t out_stride,
+                              const int16_t *low, ptrdiff_t low_stride,
+                              const int16_t *high, int width);
+
+av_cold void ff_cfhddsp_init_x86(CFHDDSPContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        c->horiz_filter      = ff_cfhd_horiz_filter_sse2;
+        c->horiz_filter_clip = ff_cfhd_horiz_filter_clip_sse2;
+        c->vert_filter       = ff_cfhd_vert_filter_sse2;
+    }
+}
@@ -23,6 +23,10 @@
 
 %include "libavutil/x86/x86util.asm"
 
+SECTION_RODATA
+
+pd_0x7fffffff: times 4 dd 0x7fffffff
+
 SECTION .text
 
 %macro PMACSDQL 5
@@ -311,3 +315,127 @@ FLAC_DECORRELATE_INDEP 32, 6, 7, d
 FLAC_DECORRELATE_INDEP 16, 8, 5, w
 FLAC_DECORRELATE_INDEP 32, 8, 9, d
 %endif
+
+; %1 = two 64-bit predictions, %2/%3 = temporaries, m3 = shift
+; out: dwords 0 and 2 of %1 = av_clipl_int32(p >> shift)
+%macro SHIFT_CLIP_Q 3
+    mova    %2, %1
+    psrad   %2, 31
+    pshufd  %2, %2, q3311      ; sign of each qword
+    pxor    %1, %2
+    psrlq   %1, m3
+    pxor    %1, %2             ; p >> shift (arithmetic)
+    mova    %3, %1
+    psrad   %3, 31
+    pshufd  %3, %3, q2200
+    pcmpeqd %3, %1
+    pshufd  %3, %3, q3311      ; high dword == sign of low dword
+    pxor    %2, [pd_0x7fffffff]
+    pand    %1, %3
+    pandn   %3, %2
+    por     %1, %3
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_flac_enc_lpc_32(int32_t *res, const int32_t *smp, int len, int order,
+;                         const int32_t *coefs, int shift)
+;------------------------------------------------------------------------------
+INIT_XMM sse4
+%if ARCH_X86_64
+cglobal flac_enc_lpc_32, 5, 7, 6, res, smp, len, order, coefs
+    DECLARE_REG_TMP 5, 6
+    %define length r2d
+
+    movsxd orderq, orderd
+%else
+cglobal flac_enc_lpc_32, 5, 6, 6, res, smp, len, order, coefs
+    DECLARE_REG_TMP 2, 5
+    %define length r2mp
+%endif
+
+; order is at most 32, so copying the first 32 samples is enough
+%assign iter 0
+%rep 32/(mmsize/4)
+    movu  m0,         [smpq+iter]
+    movu [resq+iter],  m0
+    %assign iter iter+mmsize
+%endrep
+
+    lea  resq,   [resq+orderq*4]
+    lea  smpq,   [smpq+orderq*4]
+    lea  coefsq, [coefsq+orderq*4]
+    sub  length,  orderd
+    movd m3,      r5m
+    neg  orderq
+
+%define posj t0q
+%define negj t1q
+
+.looplen:
+    pxor m0,   m0              ; p[i],   p[i+2]
+    pxor m1,   m1              ; p[i+1], p[i+3]
+    mov  posj, orderq
+    xor  negj, negj
+
+    .looporder:
+        movd    m2, [coefsq+posj*4] ; c = coefs[j]
+        SPLATD  m2
+        movu    m4, [smpq+negj*4-4] ; s = smp[i-j-1]
+        mova    m5, m4
+        psrlq   m5, 32
+        pmuldq  m4, m2
+        pmuldq  m5, m2
+        paddq   m0, m4              ; p += (int64_t)c * s
+        paddq   m1, m5
+
+        dec    negj
+        inc    posj
+    jnz .looporder
+
+    SHIFT_CLIP_Q m0, m4, m5
+    SHIFT_CLIP_Q m1, m4, m5
+    psllq   m1, 32
+    pblendw m0, m1, 0xcc
+    movu    m1, [smpq]
+    psubd   m1, m0
+    movu [resq], m1                 ; res[i] = smp[i] - clip(p >> shift)
+
+    add resq,   mmsize
+    add smpq,   mmsize
+    sub length, mmsize/4
+jg .looplen
+RET
+
+;------------------------------------------------------------------------------
+; uint64_t ff_flac_rice_sum(const uint32_t *res, int len, int k)
+; len must be a positive multiple of 4
+;------------------------------------------------------------------------------
+INIT_XMM sse2
+cglobal flac_rice_sum, 3, 3, 5, res, len, k
+    movsxdifnidn lenq, lend
+    movd      m3, kd
+    pxor      m0, m0
+    pxor      m4, m4
+    lea     resq, [resq+lenq*4]
+    neg     lenq
+.loop:
+    movu      m1, [resq+lenq*4]
+    psrld     m1, m3
+    mova      m2, m1
+    punpckldq m1, m4
+    punpckhdq m2, m4
+    paddq     m0, m1
+    paddq     m0, m2
+    add     lenq, mmsize/4
+    jl .loop
+
+    movhlps   m1, m0
+    paddq     m0, m1
+%if ARCH_X86_64
+    movq     rax, m0
+%else
+    movd     eax, m0
+    psrlq     m0, 32
+    movd     edx, m0
+%endif
+    RET
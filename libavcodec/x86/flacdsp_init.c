@@ -28,6 +28,8 @@ void ff_flac_lpc_32_xop(int32_t *samples, const int coeffs[32], int order,
                         int qlevel, int len);
 
 void ff_flac_enc_lpc_16_sse4(int32_t *, const int32_t *, int, int, const int32_t *,int);
+void ff_flac_enc_lpc_32_sse4(int32_t *, const int32_t *, int, int, const int32_t *,int);
+uint64_t ff_flac_rice_sum_sse2(const uint32_t *res, int len, int k);
 
 #define DECORRELATE_FUNCS(fmt, opt)                                                      \
 void ff_flac_decorrelate_ls_##fmt##_##opt(uint8_t **out, int32_t **in, int channels,     \
@@ -106,9 +108,13 @@ av_cold void ff_flacdsp_init_x86(FLACDSPContext *c, enum AVSampleFormat fmt, int
 #endif
 
 #if CONFIG_FLAC_ENCODER
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        c->rice_sum = ff_flac_rice_sum_sse2;
+    }
     if (EXTERNAL_SSE4(cpu_flags)) {
         if (CONFIG_GPL)
             c->lpc16_encode = ff_flac_enc_lpc_16_sse4;
+        c->lpc32_encode = ff_flac_enc_lpc_32_sse4;
     }
 #endif
 #endif /* HAVE_YASM */
@@ -0,0 +1,131 @@
+;******************************************************************************
+;* x86 optimizations for PNG encoding
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+cextern pb_1
+
+SECTION .text
+
+;------------------------------------------------------------------------------
+; void ff_sub_png_paeth_prediction(uint8_t *dst, const uint8_t *src,
+;                                  const uint8_t *top, int w, int bpp)
+;------------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal sub_png_paeth_prediction, 5, 7, 8, dst, src, top, w, bpp, srcl, topl
+    movsxdifnidn        wq, wd
+    movsxdifnidn      bppq, bppd
+    add               dstq, wq
+    add               srcq, wq
+    add               topq, wq
+    mov              srclq, srcq
+    mov              toplq, topq
+    sub              srclq, bppq
+    sub              toplq, bppq
+    neg                 wq
+.loop:
+    pxor                m7, m7
+    movh                m0, [srclq+wq]      ; a
+    movh                m1, [topq+wq]       ; b
+    movh                m2, [toplq+wq]      ; c
+    punpcklbw           m0, m7
+    punpcklbw           m1, m7
+    punpcklbw           m2, m7
+    mova                m3, m1
+    psubw               m3, m2              ; p  = b - c
+    mova                m4, m0
+    psubw               m4, m2              ; pc = a - c
+    mova                m5, m3
+    paddw               m5, m4
+    pabsw               m3, m3              ; pa
+    pabsw               m4, m4              ; pb
+    pabsw               m5, m5              ; pc
+    mova                m6, m3
+    pcmpgtw             m6, m4
+    pcmpgtw             m3, m5
+    por                 m6, m3              ; pa > pb || pa > pc
+    pcmpgtw             m4, m5              ; pb > pc
+    pxor                m2, m1
+    pand                m2, m4
+    pxor                m2, m1              ; pb > pc ? c : b
+    pxor                m2, m0
+    pand                m2, m6
+    pxor                m0, m2              ; predictor
+    packuswb            m0, m0
+    movh                m1, [srcq+wq]
+    psubb               m1, m0
+    movh        [dstq+wq], m1
+    add                 wq, 8
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_sub_png_avg_prediction(uint8_t *dst, const uint8_t *src,
+;                                const uint8_t *top, int w, int bpp)
+;------------------------------------------------------------------------------
+INIT_XMM sse2
+cglobal sub_png_avg_prediction, 5, 6, 4, dst, src, top, w, bpp, srcl
+    movsxdifnidn        wq, wd
+    movsxdifnidn      bppq, bppd
+    add               dstq, wq
+    add               srcq, wq
+    add               topq, wq
+    mov              srclq, srcq
+    sub              srclq, bppq
+    neg                 wq
+    mova                m3, [pb_1]
+.loop:
+    movu                m0, [srclq+wq]
+    movu                m1, [topq+wq]
+    mova                m2, m0
+    pxor                m2, m1
+    pand                m2, m3
+    pavgb               m0, m1
+    psubb               m0, m2              ; (a + b) >> 1
+    movu                m1, [srcq+wq]
+    psubb               m1, m0
+    movu        [dstq+wq], m1
+    add                 wq, mmsize
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; int ff_png_filter_cost(const uint8_t *buf, int w)
+;------------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal png_filter_cost, 2, 2, 4, buf, w
+    movsxdifnidn        wq, wd
+    add               bufq, wq
+    neg                 wq
+    pxor                m2, m2
+    pxor                m3, m3
+.loop:
+    movu                m0, [bufq+wq]
+    pabsb               m0, m0
+    psadbw              m0, m3
+    paddq               m2, m0
+    add                 wq, mmsize
+    jl .loop
+    pshufd              m0, m2, q0032
+    paddq               m2, m0
+    movd               eax, m2
+    RET
@@ -0,0 +1,41 @@
+/*
+ * x86 PNG encoder DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/pngencdsp.h"
+
+void ff_sub_png_paeth_prediction_ssse3(uint8_t *dst, const uint8_t *src,
+                                       const uint8_t *top, int w, int bpp);
+void ff_sub_png_avg_prediction_sse2(uint8_t *dst, const uint8_t *src,
+                                    const uint8_t *top, int w, int bpp);
+int ff_png_filter_cost_ssse3(const uint8_t *buf, int w);
+
+av_cold void ff_pngencdsp_init_x86(PNGEncDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags))
+        dsp->sub_avg_prediction   = ff_sub_png_avg_prediction_sse2;
+    if (EXTERNAL_SSSE3(cpu_flags)) {
+        dsp->sub_paeth_prediction = ff_sub_png_paeth_prediction_ssse3;
+        dsp->filter_cost          = ff_png_filter_cost_ssse3;
+    }
+}
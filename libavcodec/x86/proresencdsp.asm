@@ -0,0 +1,117 @@
+;******************************************************************************
+;* x86 optimized Apple ProRes encoder functions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_ac_mask: dw 0, -1, -1, -1, -1, -1, -1, -1
+            times 8 dw -1
+
+cextern pw_1
+
+SECTION .text
+
+; %1 = byte offset in the block, %2 = 1 to leave out the DC remainder
+; m6 = pw_1, m7 = remainder accumulator
+;
+; the division is done in single precision: with 16-bit operands the
+; rounded quotient never reaches the next integer, so truncating it
+; gives the same result as the integer division
+%macro QUANT 2
+%if cpuflag(avx2)
+    pmovsxwd            m0, [srcq+%1]
+    pmovsxwd            m1, [srcq+%1+mmsize/2]
+    pmovzxwd            m2, [qmatq+%1]
+    pmovzxwd            m3, [qmatq+%1+mmsize/2]
+    movu                m4, [srcq+%1]
+    movu                m5, [qmatq+%1]
+%else
+    movu                m4, [srcq+%1]
+    movu                m5, [qmatq+%1]
+    punpcklwd           m0, m4, m4
+    punpckhwd           m1, m4, m4
+    punpcklwd           m2, m5, m5
+    punpckhwd           m3, m5, m5
+    psrad               m0, 16
+    psrad               m1, 16
+    psrld               m2, 16
+    psrld               m3, 16
+%endif
+    cvtdq2ps            m0, m0
+    cvtdq2ps            m1, m1
+    cvtdq2ps            m2, m2
+    cvtdq2ps            m3, m3
+    divps               m0, m2
+    divps               m1, m3
+    cvttps2dq           m0, m0
+    cvttps2dq           m1, m1
+    packssdw            m0, m1
+%if cpuflag(avx2)
+    vpermq              m0, m0, q3120
+%endif
+    movu       [dstq+%1], m0
+    pmullw              m0, m5
+    psubw               m4, m0              ; remainder
+%if cpuflag(ssse3)
+    pabsw               m4, m4
+%else
+    psraw               m5, m4, 15
+    pxor                m4, m5
+    psubw               m4, m5
+%endif
+%if %2
+    pand                m4, [pw_ac_mask]
+%endif
+    pmaddwd             m4, m6
+    paddd               m7, m4
+%endmacro
+
+;------------------------------------------------------------------------------
+; int ff_prores_quantize(int16_t *dst, const int16_t *src, const int16_t *qmat,
+;                        int nb_blocks)
+;------------------------------------------------------------------------------
+%macro PRORES_QUANTIZE 0
+cglobal prores_quantize, 4, 4, 8, dst, src, qmat, nb
+    mova                m6, [pw_1]
+    pxor                m7, m7
+.loop:
+    QUANT                0, 1
+%assign %%off mmsize
+%rep 128 / mmsize - 1
+    QUANT            %%off, 0
+%assign %%off %%off + mmsize
+%endrep
+    add               srcq, 128
+    add               dstq, 128
+    dec                nbd
+    jg .loop
+    HADDD               m7, m0
+    movd               eax, xm7
+    RET
+%endmacro
+
+INIT_XMM sse2
+PRORES_QUANTIZE
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+PRORES_QUANTIZE
+%endif
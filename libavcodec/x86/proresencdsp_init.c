@@ -0,0 +1,38 @@
+/*
+ * x86 optimized Apple ProRes encoder functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/proresencdsp.h"
+
+int ff_prores_quantize_sse2(int16_t *dst, const int16_t *src,
+                            const int16_t *qmat, int nb_blocks);
+int ff_prores_quantize_avx2(int16_t *dst, const int16_t *src,
+                            const int16_t *qmat, int nb_blocks);
+
+av_cold void ff_proresencdsp_init_x86(ProresEncDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags))
+        dsp->quantize = ff_prores_quantize_sse2;
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        dsp->quantize = ff_prores_quantize_avx2;
+}
@@ -0,0 +1,228 @@
+;******************************************************************************
+;* x86 optimized texture block decompression
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+; rgb565 unpacking, fields moved to the top of the word and back down
+pw_565_mul:      times 2 dw     1,     32,   2048, 0
+pw_565_mask:     times 2 dw 0xf800, 0xfc00, 0xf800, 0
+pw_565_field:    times 2 dw    32,     64,     32, 0
+; expansion to 8 bits as in extract_color()
+pw_565_bias:     times 2 dw    16,     32,     16, 0
+pw_565_div:      times 2 dw  2048,   1024,   2048, 0
+pw_alpha:        times 2 dw     0,      0,      0, 255
+pw_c3_opaque:    dw -1, -1, -1, -1, 0, 0, 0, -1
+pw_c3_clear:     dw -1, -1, -1, -1, 0, 0, 0,  0
+pw_5556:         times 8 dw 0x5556
+
+; 2-bit color indices, the code byte of a row spread to every pixel and
+; the index of each pixel moved to bits 6-7
+pb_rows:         times 16 db 0
+                 times 16 db 1
+                 times 16 db 2
+                 times 16 db 3
+pw_idx_shift:    dw 64, 64, 16, 16, 4, 4, 1, 1
+pw_0404:         times 8 dw 0x0404
+pb_0123:         times 4 db 0, 1, 2, 3
+
+; 3-bit alpha indices, the word holding the index of each pixel and the
+; multiplier moving it to bits 13-15
+pb_aidx_lo:      db 2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5
+pb_aidx_hi:      db 5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, 8, 7, 8
+pw_aidx_shift:   dw 8192, 1024, 128, 4096, 512, 64, 2048, 256
+
+; alpha palettes: weights of the two endpoints, 1 / divisor and offset
+alpha_tab7:      dw 7, 0, 6, 5, 4, 3, 2, 1
+                 dw 0, 7, 1, 2, 3, 4, 5, 6
+                 times 8 dw 9363
+                 times 8 dw 0
+alpha_tab5:      dw 5, 0, 4, 3, 2, 1, 0, 0
+                 dw 0, 5, 1, 2, 3, 4, 0, 0
+                 times 8 dw 13108
+                 dw 0, 0, 0, 0, 0, 0, 0, 255
+
+; alpha of the pixels of a row moved to their alpha byte, or to all the
+; color bytes for RGTC1
+pb_alpha_rows:   db -1, -1, -1,  0, -1, -1, -1,  1, -1, -1, -1,  2, -1, -1, -1,  3
+                 db -1, -1, -1,  4, -1, -1, -1,  5, -1, -1, -1,  6, -1, -1, -1,  7
+                 db -1, -1, -1,  8, -1, -1, -1,  9, -1, -1, -1, 10, -1, -1, -1, 11
+                 db -1, -1, -1, 12, -1, -1, -1, 13, -1, -1, -1, 14, -1, -1, -1, 15
+pb_rgtc_rows:    db  0,  0,  0, -1,  1,  1,  1, -1,  2,  2,  2, -1,  3,  3,  3, -1
+                 db  4,  4,  4, -1,  5,  5,  5, -1,  6,  6,  6, -1,  7,  7,  7, -1
+                 db  8,  8,  8, -1,  9,  9,  9, -1, 10, 10, 10, -1, 11, 11, 11, -1
+                 db 12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1
+pd_alpha_ff:     times 4 dd 0xff000000
+
+cextern pw_3
+cextern pw_255
+
+SECTION .text
+
+; %1 = 1 for DXT2-5 color blocks (four colors, zero alpha), 0 for DXT1
+; %2 = offset of the color block
+; %3 = mask applied to the third and fourth colors in the three color mode
+; palette in m1 as four dwords, clobbers m2, t0
+%macro PALETTE 3
+    movd                m1, [blockq+%2]
+    punpcklwd           m1, m1
+    pshufd              m1, m1, q1100       ; c0 x4, c1 x4
+    pmullw              m1, [pw_565_mul]
+    pand                m1, [pw_565_mask]
+    pmulhuw             m1, [pw_565_field]
+    pmullw              m1, [pw_255]
+    paddw               m1, [pw_565_bias]
+    pmulhuw             m2, m1, [pw_565_div]
+    paddw               m1, m2
+    pmulhuw             m1, [pw_565_div]
+%if %1 == 0
+    por                 m1, [pw_alpha]
+%endif
+    pshufd              m2, m1, q1032
+    paddw               m2, m1
+%if %1 == 0
+    movzx             t0d, word [blockq+%2]
+    cmp               t0w, word [blockq+%2+2]
+    ja .four_colors
+    psrlw               m2, 1
+    pand                m2, [%3]
+    jmp .palette_done
+.four_colors:
+%endif
+    paddw               m2, m1
+    pmulhuw             m2, [pw_5556]
+.palette_done:
+    packuswb            m1, m2
+%endmacro
+
+; %1 = row, m0 = color indices, m1 = palette, row pixels in m3
+%macro COLOR_ROW 1
+    pshufb              m2, m0, [pb_rows+16*%1]
+    pmullw              m2, [pw_idx_shift]
+    psrlw               m2, 6
+    pand                m2, [pw_3]
+    pmullw              m2, [pw_0404]
+    paddb               m2, [pb_0123]
+    mova                m3, m1
+    pshufb              m3, m2
+%endmacro
+
+; %1 = 1 for signed endpoints
+; alpha or RGTC1 values of the 16 pixels in m1, clobbers m2, m3, t0, t1
+%macro ALPHA_BLOCK 1
+%if %1
+    movsx             t0d, byte [blockq]
+    movsx             t1d, byte [blockq+1]
+    add               t0d, 128
+    add               t1d, 128
+%else
+    movzx             t0d, byte [blockq]
+    movzx             t1d, byte [blockq+1]
+%endif
+    movd                m1, t0d
+    movd                m2, t1d
+    SPLATW              m1, m1
+    SPLATW              m2, m2
+    cmp               t0d, t1d
+    lea               t0q, [alpha_tab7]
+    lea               t1q, [alpha_tab5]
+    cmovbe            t0q, t1q
+    pmullw              m1, [t0q]
+    pmullw              m2, [t0q+16]
+    paddw               m1, m2
+    pmulhuw             m1, [t0q+32]
+    por                 m1, [t0q+48]
+    packuswb            m1, m1
+
+    movq                m2, [blockq]
+    pshufb              m3, m2, [pb_aidx_lo]
+    pshufb              m2, [pb_aidx_hi]
+    pmullw              m3, [pw_aidx_shift]
+    pmullw              m2, [pw_aidx_shift]
+    psrlw               m3, 13
+    psrlw               m2, 13
+    packuswb            m3, m2
+    pshufb              m1, m3
+%endmacro
+
+INIT_XMM ssse3
+;------------------------------------------------------------------------------
+; int ff_dxt1_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+;------------------------------------------------------------------------------
+%macro DXT1_BLOCK 2 ; name, third and fourth color mask
+cglobal %1, 3, 4, 4, dst, stride, block, t0
+    PALETTE              0, 0, %2
+    movd                m0, [blockq+4]
+%assign %%y 0
+%rep 4
+    COLOR_ROW          %%y
+    movu            [dstq], m3
+    add               dstq, strideq
+%assign %%y %%y+1
+%endrep
+    mov                eax, 8
+    RET
+%endmacro
+
+DXT1_BLOCK dxt1_block,  pw_c3_opaque
+DXT1_BLOCK dxt1a_block, pw_c3_clear
+
+;------------------------------------------------------------------------------
+; int ff_dxt5_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+;------------------------------------------------------------------------------
+cglobal dxt5_block, 3, 5, 6, dst, stride, block, t0, t1
+    ALPHA_BLOCK          0
+    mova                m4, m1
+    PALETTE              1, 8, 0
+    movd                m0, [blockq+12]
+%assign row 0
+%rep 4
+    COLOR_ROW          row
+    pshufb              m5, m4, [pb_alpha_rows+16*row]
+    por                 m3, m5
+    movu            [dstq], m3
+    add               dstq, strideq
+%assign row row+1
+%endrep
+    mov                eax, 16
+    RET
+
+;------------------------------------------------------------------------------
+; int ff_rgtc1_block(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+;------------------------------------------------------------------------------
+%macro RGTC1_BLOCK 2 ; name, signed
+cglobal %1, 3, 5, 4, dst, stride, block, t0, t1
+    ALPHA_BLOCK         %2
+    mova                m0, [pd_alpha_ff]
+%assign %%y 0
+%rep 4
+    pshufb              m2, m1, [pb_rgtc_rows+16*%%y]
+    por                 m2, m0
+    movu            [dstq], m2
+    add               dstq, strideq
+%assign %%y %%y+1
+%endrep
+    mov                eax, 8
+    RET
+%endmacro
+
+RGTC1_BLOCK rgtc1u_block, 0
+RGTC1_BLOCK rgtc1s_block, 1
@@ -0,0 +1,45 @@
+/*
+ * x86 optimized texture block decompression
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/texturedsp.h"
+
+int ff_dxt1_block_ssse3  (uint8_t *dst, ptrdiff_t stride, const uint8_t *block);
+int ff_dxt1a_block_ssse3 (uint8_t *dst, ptrdiff_t stride, const uint8_t *block);
+int ff_dxt5_block_ssse3  (uint8_t *dst, ptrdiff_t stride, const uint8_t *block);
+int ff_rgtc1s_block_ssse3(uint8_t *dst, ptrdiff_t stride, const uint8_t *block);
+int ff_rgtc1u_block_ssse3(uint8_t *dst, ptrdiff_t stride, const uint8_t *block);
+
+av_cold void ff_texturedsp_init_x86(TextureDSPContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSSE3(cpu_flags)) {
+        c->dxt1_block   = ff_dxt1_block_ssse3;
+        c->dxt1a_block  = ff_dxt1a_block_ssse3;
+        c->dxt5_block   = ff_dxt5_block_ssse3;
+        c->rgtc1s_block = ff_rgtc1s_block_ssse3;
+        c->rgtc1u_block = ff_rgtc1u_block_ssse3;
+    }
+}
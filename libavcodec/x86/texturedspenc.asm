@@ -0,0 +1,274 @@
+;******************************************************************************
+;* x86 optimized texture block compression
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pd_rgb_mask:   times 4 dd 0x00ffffff
+pw_565_mask:   times 2 dw 0xf8, 0xfc, 0xf8, 0
+pw_565_expand: times 2 dw 2048, 1024, 2048, 0   ; >> 5, >> 6, >> 5
+pw_565_pack:   times 2 dw 2048,   64,    1, 0   ; rgb565 << 3
+pw_5556:       times 8 dw 0x5556                ; x / 3 for x < 32768
+pw_7:          times 8 dw 7
+pw_1_8:        times 4 dw 1, 8
+pw_1_64:       times 4 dw 1, 64
+pw_1_4096:     times 4 dw 1, 4096
+
+cextern pb_1
+cextern pb_15
+cextern pw_1
+cextern pw_2
+cextern pw_4
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; load the block rows in m0-m3 and the per byte minimum and maximum of the
+; block in all dwords of m4 and m5
+%macro LOAD_BLOCK 0
+    lea           stride3q, [strideq*3]
+    movu                m0, [blockq]
+    movu                m1, [blockq+strideq]
+    movu                m2, [blockq+strideq*2]
+    movu                m3, [blockq+stride3q]
+    pminub              m4, m0, m1
+    pmaxub              m5, m0, m1
+    pminub              m4, m2
+    pmaxub              m5, m2
+    pminub              m4, m3
+    pmaxub              m5, m3
+    pshufd              m6, m4, q1032
+    pshufd              m7, m5, q1032
+    pminub              m4, m6
+    pmaxub              m5, m7
+    pshufd              m6, m4, q2301
+    pshufd              m7, m5, q2301
+    pminub              m4, m6
+    pmaxub              m5, m7
+%endmacro
+
+; %1 = dst, %2 = src, %3 = palette color
+; sum of absolute differences of each pixel of src to the color
+%macro COLOR_DIST 3
+    psubusb             %1, %2, %3
+    psubusb            m12, %3, %2
+    por                 %1, m12
+    pmaddubsw           %1, m14
+    pmaddwd             %1, m15
+%endmacro
+
+; %1 = row register, %2 = bit position of the row in the index mask
+%macro COLOR_ROW 2
+    pand                %1, m13
+    COLOR_DIST          m8, %1, m4
+    COLOR_DIST          m9, %1, m5
+    COLOR_DIST         m10, %1, m6
+    COLOR_DIST         m11, %1, m7
+    pcmpgtd            m12, m8, m11         ; b0 = d0 > d3
+    pcmpgtd             m8, m10             ; b2 = d0 > d2
+    pcmpgtd             %1, m9, m10         ; b1 = d1 > d2
+    pand                %1, m8              ; b1 & b2
+    pcmpgtd             m9, m11             ; b3 = d1 > d3
+    pand                m9, m12             ; b0 & b3
+    por                 %1, m9              ; high bit
+    pcmpgtd            m10, m11             ; b4 = d2 > d3
+    pand               m12, m10             ; low bit, b0 & b4
+    packssdw           m12, m12
+    packssdw            %1, %1
+    punpcklwd          m12, %1
+    packsswb           m12, m12
+    pmovmskb          tmpd, m12
+    and               tmpd, 0xff
+%if %2
+    shl               tmpd, %2
+%endif
+    or               maskd, tmpd
+%endmacro
+
+; %1 = offset of the color block in dst
+; expects LOAD_BLOCK to have run, clobbers everything
+%macro COLOR_BLOCK 1
+    ; inset the bounding box by 1/16 of its size
+    psubusb             m6, m5, m4
+    psrlw               m6, 4
+    pand                m6, [pb_15]
+    paddusb             m4, m6
+    psubusb             m5, m6
+
+    ; endpoints as words, max in the low half and min in the high half
+    punpckldq           m5, m4
+    pxor                m7, m7
+    punpcklbw           m5, m7
+    pand                m5, [pw_565_mask]
+    pmaddwd             m6, m5, [pw_565_pack]
+    pshufd              m7, m6, q2301
+    paddd               m6, m7
+    psrld               m6, 3
+    movd               c0d, m6
+    pshufd              m6, m6, q2222
+    movd               c1d, m6
+    xor              maskd, maskd
+    cmp                c0d, c1d
+    je .write_color
+
+    ; palette, the 565 endpoints expanded back to 8 bits and the two
+    ; points at 1/3 and 2/3 between them
+    pmulhuw             m6, m5, [pw_565_expand]
+    por                 m5, m6
+    pshufd              m6, m5, q1032
+    paddw               m6, m5
+    paddw               m6, m5
+    pmulhuw             m6, [pw_5556]
+    packuswb            m5, m6
+    pshufd              m4, m5, q0000
+    pshufd              m6, m5, q2222
+    pshufd              m7, m5, q3333
+    pshufd              m5, m5, q1111
+
+    mova               m13, [pd_rgb_mask]
+    mova               m14, [pb_1]
+    mova               m15, [pw_1]
+    COLOR_ROW           m0, 0
+    COLOR_ROW           m1, 8
+    COLOR_ROW           m2, 16
+    COLOR_ROW           m3, 24
+
+.write_color:
+    mov   [dstq+%1+0], c0w
+    mov   [dstq+%1+2], c1w
+    mov   [dstq+%1+4], maskd
+%endmacro
+
+; %1 = alpha words, replaced by their 3 bit indices
+; m6 = bias, m7 = dist - 1, m8 = dist * 2, m9 = dist * 4
+%macro ALPHA_INDEX 1
+    pmullw              %1, [pw_7]
+    paddw               %1, m6
+    pcmpgtw            m12, m9, %1
+    mova               m13, m12
+    pandn              m12, m9
+    psubw               %1, m12
+    pandn              m13, [pw_4]
+    pcmpgtw            m12, m8, %1
+    mova               m14, m12
+    pandn              m12, m8
+    psubw               %1, m12
+    pandn              m14, [pw_2]
+    paddw              m13, m14
+    pcmpgtw             %1, m7
+    psubw              m13, %1              ; linear index
+    pxor                %1, %1
+    psubw               %1, m13
+    pand                %1, [pw_7]
+    mova               m12, [pw_2]
+    pcmpgtw            m12, %1
+    pand               m12, [pw_1]
+    pxor                %1, m12             ; DXT index
+%endmacro
+
+; same as compress_alpha(), expects LOAD_BLOCK to have run and preserves
+; m0-m5
+%macro ALPHA_BLOCK 0
+    movd              tmpd, m4
+    movd               c1d, m5
+    shr               tmpd, 24
+    shr               c1d, 24
+    mov         [dstq+0], c1b
+    mov         [dstq+1], tmpb
+    sub                c1d, tmpd            ; dist
+    jz .alpha_flat
+
+    imul              tmpd, 7
+    lea                c0d, [c1q-1]
+    cmp                c1d, 8
+    jl .bias
+    mov                c0d, c1d
+    shr                c0d, 1
+    add                c0d, 2
+.bias:
+    sub                c0d, tmpd
+    movd                m6, c0d
+    SPLATW              m6, m6
+    lea                c0d, [c1q-1]
+    movd                m7, c0d
+    SPLATW              m7, m7
+    lea                c0d, [c1q*2]
+    movd                m8, c0d
+    SPLATW              m8, m8
+    lea                c0d, [c1q*4]
+    movd                m9, c0d
+    SPLATW              m9, m9
+
+    psrld              m10, m0, 24
+    psrld              m11, m1, 24
+    packssdw           m10, m11
+    psrld              m11, m2, 24
+    psrld              m12, m3, 24
+    packssdw           m11, m12
+    ALPHA_INDEX        m10
+    ALPHA_INDEX        m11
+
+    ; pack the 16 indices into 48 bits
+    pmaddwd            m10, [pw_1_8]
+    pmaddwd            m11, [pw_1_8]
+    packssdw           m10, m11
+    pmaddwd            m10, [pw_1_64]
+    packssdw           m10, m10
+    pmaddwd            m10, [pw_1_4096]
+    movq              tmpq, m10
+    mov                c0q, tmpq
+    shr                c0q, 32
+    shl                c0q, 24
+    mov               tmpd, tmpd
+    or                tmpq, c0q
+    mov       [dstq+2], tmpd
+    shr               tmpq, 32
+    mov       [dstq+6], tmpw
+    jmp .alpha_done
+
+.alpha_flat:
+    mov dword [dstq+2], 0
+    mov  word [dstq+6], 0
+.alpha_done:
+%endmacro
+
+INIT_XMM ssse3
+;------------------------------------------------------------------------------
+; int ff_dxt1_block_range(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+;------------------------------------------------------------------------------
+cglobal dxt1_block_range, 3, 8, 16, dst, stride, block, stride3, c0, c1, mask, tmp
+    LOAD_BLOCK
+    COLOR_BLOCK 0
+    mov                eax, 8
+    RET
+
+;------------------------------------------------------------------------------
+; int ff_dxt5_block_range(uint8_t *dst, ptrdiff_t stride, const uint8_t *block)
+;------------------------------------------------------------------------------
+cglobal dxt5_block_range, 3, 8, 16, dst, stride, block, stride3, c0, c1, mask, tmp
+    LOAD_BLOCK
+    ALPHA_BLOCK
+    COLOR_BLOCK 8
+    mov                eax, 16
+    RET
+
+%endif ; ARCH_X86_64
@@ -0,0 +1,54 @@
+/*
+ * x86 optimized texture block compression
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/texturedsp.h"
+
+int ff_dxt1_block_range_ssse3(uint8_t *dst, ptrdiff_t stride,
+                              const uint8_t *block);
+int ff_dxt5_block_range_ssse3(uint8_t *dst, ptrdiff_t stride,
+                              const uint8_t *block);
+
+static int dxt5ys_block_range_ssse3(uint8_t *dst, ptrdiff_t stride,
+                                    const uint8_t *block)
+{
+    DECLARE_ALIGNED(16, uint8_t, reorder)[64];
+
+    ff_texturedspenc_rgba2ycocg_block(reorder, stride, block);
+
+    return ff_dxt5_block_range_ssse3(dst, 16, reorder);
+}
+
+av_cold void ff_texturedspenc_init_x86(TextureDSPContext *c,
+                                       enum TextureDSPFit fit)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (ARCH_X86_64 && EXTERNAL_SSSE3(cpu_flags) && fit == TEXTURE_FIT_RANGE) {
+        c->dxt1_block   = ff_dxt1_block_range_ssse3;
+        c->dxt5_block   = ff_dxt5_block_range_ssse3;
+        c->dxt5ys_block = dxt5ys_block_range_ssse3;
+    }
+}
@@ -0,0 +1,178 @@
+;******************************************************************************
+;* x86 optimized VC-2 encoder wavelet transforms
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_2: times 8 dd 2
+pd_8: times 8 dd 8
+
+cextern pd_1
+
+SECTION .text
+
+; all functions process the width rounded up to a multiple of mmsize / 4
+; and expect dst to be aligned
+
+%macro VC2_DWT_FUNCS 0
+;------------------------------------------------------------------------------
+; void ff_vc2enc_deinterleave(dwtcoef *lo, dwtcoef *hi, const dwtcoef *src,
+;                             int width, int shift)
+;------------------------------------------------------------------------------
+cglobal vc2enc_deinterleave, 5, 5, 4, lo, hi, src, w, shift
+    movd               xm3, shiftd
+    movsxdifnidn        wq, wd
+    shl                 wq, 2
+    add                loq, wq
+    add                hiq, wq
+    lea               srcq, [srcq+2*wq]
+    neg                 wq
+.loop:
+    movu                m0, [srcq+2*wq]
+    movu                m1, [srcq+2*wq+mmsize]
+    shufps              m2, m0, m1, q2020
+    shufps              m0, m0, m1, q3131
+%if cpuflag(avx2)
+    vpermq              m2, m2, q3120
+    vpermq              m0, m0, q3120
+%endif
+    pslld               m2, xm3
+    pslld               m0, xm3
+    mova         [loq+wq], m2
+    mova         [hiq+wq], m0
+    add                 wq, mmsize
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_vc2enc_lift_lo(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+;                        int width)
+;------------------------------------------------------------------------------
+cglobal vc2enc_lift_lo, 4, 4, 3, dst, b0, b1, w
+    mova                m2, [pd_2]
+    movsxdifnidn        wq, wd
+    shl                 wq, 2
+    add               dstq, wq
+    add                b0q, wq
+    add                b1q, wq
+    neg                 wq
+.loop:
+    movu                m0, [b0q+wq]
+    movu                m1, [b1q+wq]
+    paddd               m0, m1
+    paddd               m0, m2
+    psrad               m0, 2
+    paddd               m0, [dstq+wq]
+    mova        [dstq+wq], m0
+    add                 wq, mmsize
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_vc2enc_lift_hi_53(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+;                           int width)
+;------------------------------------------------------------------------------
+cglobal vc2enc_lift_hi_53, 4, 4, 3, dst, b0, b1, w
+    mova                m2, [pd_1]
+    movsxdifnidn        wq, wd
+    shl                 wq, 2
+    add               dstq, wq
+    add                b0q, wq
+    add                b1q, wq
+    neg                 wq
+.loop:
+    movu                m0, [b0q+wq]
+    movu                m1, [b1q+wq]
+    paddd               m0, m1
+    paddd               m0, m2
+    psrad               m0, 1
+    mova                m1, [dstq+wq]
+    psubd               m1, m0
+    mova        [dstq+wq], m1
+    add                 wq, mmsize
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_vc2enc_lift_hi_97(dwtcoef *dst, const dwtcoef *b0, const dwtcoef *b1,
+;                           const dwtcoef *b2, const dwtcoef *b3, int width)
+;------------------------------------------------------------------------------
+cglobal vc2enc_lift_hi_97, 6, 6, 4, dst, b0, b1, b2, b3, w
+    mova                m3, [pd_8]
+    movsxdifnidn        wq, wd
+    shl                 wq, 2
+    add               dstq, wq
+    add                b0q, wq
+    add                b1q, wq
+    add                b2q, wq
+    add                b3q, wq
+    neg                 wq
+.loop:
+    movu                m0, [b1q+wq]
+    movu                m1, [b2q+wq]
+    paddd               m0, m1
+    mova                m1, m0
+    pslld               m1, 3
+    paddd               m0, m1              ; 9 * (b1 + b2)
+    movu                m1, [b0q+wq]
+    movu                m2, [b3q+wq]
+    paddd               m1, m2
+    psubd               m0, m1
+    paddd               m0, m3
+    psrad               m0, 4
+    mova                m1, [dstq+wq]
+    psubd               m1, m0
+    mova        [dstq+wq], m1
+    add                 wq, mmsize
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_vc2enc_haar(dwtcoef *lo, dwtcoef *hi, int width)
+;------------------------------------------------------------------------------
+cglobal vc2enc_haar, 3, 3, 3, lo, hi, w
+    mova                m2, [pd_1]
+    movsxdifnidn        wq, wd
+    shl                 wq, 2
+    add                loq, wq
+    add                hiq, wq
+    neg                 wq
+.loop:
+    mova                m0, [loq+wq]
+    mova                m1, [hiq+wq]
+    psubd               m1, m0
+    mova         [hiq+wq], m1
+    paddd               m1, m2
+    psrad               m1, 1
+    paddd               m0, m1
+    mova         [loq+wq], m0
+    add                 wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+VC2_DWT_FUNCS
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+VC2_DWT_FUNCS
+%endif
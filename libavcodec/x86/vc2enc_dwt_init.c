@@ -0,0 +1,57 @@
+/*
+ * x86 optimized VC-2 encoder wavelet transforms
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/vc2enc_dwt.h"
+
+#define DWT_FUNCS(opt)                                                        \
+void ff_vc2enc_deinterleave_##opt(dwtcoef *lo, dwtcoef *hi,                   \
+                                  const dwtcoef *src, int width, int shift);  \
+void ff_vc2enc_lift_lo_##opt(dwtcoef *dst, const dwtcoef *b0,                 \
+                             const dwtcoef *b1, int width);                   \
+void ff_vc2enc_lift_hi_53_##opt(dwtcoef *dst, const dwtcoef *b0,              \
+                                const dwtcoef *b1, int width);                \
+void ff_vc2enc_lift_hi_97_##opt(dwtcoef *dst, const dwtcoef *b0,              \
+                                const dwtcoef *b1, const dwtcoef *b2,         \
+                                const dwtcoef *b3, int width);                \
+void ff_vc2enc_haar_##opt(dwtcoef *lo, dwtcoef *hi, int width);
+
+DWT_FUNCS(sse2)
+DWT_FUNCS(avx2)
+
+#define SET_FUNCS(opt)                                                        \
+    do {                                                                      \
+        c->deinterleave = ff_vc2enc_deinterleave_##opt;                       \
+        c->lift_lo      = ff_vc2enc_lift_lo_##opt;                            \
+        c->lift_hi_53   = ff_vc2enc_lift_hi_53_##opt;                         \
+        c->lift_hi_97   = ff_vc2enc_lift_hi_97_##opt;                         \
+        c->haar         = ff_vc2enc_haar_##opt;                               \
+    } while (0)
+
+av_cold void ff_vc2enc_dwt_dsp_init_x86(VC2DWTDSPContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags))
+        SET_FUNCS(sse2);
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        SET_FUNCS(avx2);
+}
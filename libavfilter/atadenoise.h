@@ -0,0 +1,38 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_ATADENOISE_H
+#define AVFILTER_ATADENOISE_H
+
+#include <stdint.h>
+
+typedef struct ATADenoiseDSPContext {
+    /**
+     * Filter width samples of the row src of frame mid, averaging it with
+     * the rows srcf[0..size-1] of the surrounding frames.
+     * thra and thrb are compared as unsigned values.
+     * SIMD versions require width to be a multiple of 16.
+     */
+    void (*filter_row)(const uint8_t *src, uint8_t *dst, const uint8_t **srcf,
+                       int width, int mid, int size, int thra, int thrb);
+} ATADenoiseDSPContext;
+
+void ff_atadenoise_dsp_init(ATADenoiseDSPContext *dsp, int depth);
+void ff_atadenoise_dsp_init_x86(ATADenoiseDSPContext *dsp, int depth);
+
+#endif /* AVFILTER_ATADENOISE_H */
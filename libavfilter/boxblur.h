@@ -0,0 +1,39 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_BOXBLUR_H
+#define AVFILTER_BOXBLUR_H
+
+#include <stdint.h>
+
+typedef struct BoxBlurDSPContext {
+    /**
+     * Slide the vertical window of width columns down by one row:
+     * sum[x] += (add[x] - sub[x]) * inv, dst[x] = sum[x] >> 16.
+     * width is a multiple of 16, sum must be aligned to 16 bytes.
+     */
+    void (*blur_row8)(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                      int32_t *sum, int width, int inv);
+    void (*blur_row16)(uint16_t *dst, const uint16_t *add, const uint16_t *sub,
+                       int32_t *sum, int width, int inv);
+} BoxBlurDSPContext;
+
+void ff_boxblur_dsp_init(BoxBlurDSPContext *dsp);
+void ff_boxblur_dsp_init_x86(BoxBlurDSPContext *dsp);
+
+#endif /* AVFILTER_BOXBLUR_H */
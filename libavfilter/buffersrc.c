@@ -242,6 +242,18 @@ static int av_buffersrc_add_frame_internal(AVFilterContext *ctx,
     return 0;
 }
 
+AVFrame *av_buffersrc_get_video_buffer(AVFilterContext *ctx, int w, int h)
+{
+    BufferSourceContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->nb_outputs ? ctx->outputs[0] : NULL;
+
+    if (!outlink || outlink->type != AVMEDIA_TYPE_VIDEO ||
+        outlink->init_state != AVLINK_INIT || s->hw_frames_ctx)
+        return NULL;
+
+    return ff_get_video_buffer(outlink, w, h);
+}
+
 static av_cold int init_video(AVFilterContext *ctx)
 {
     BufferSourceContext *c = ctx->priv;
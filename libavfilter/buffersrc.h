@@ -194,6 +194,31 @@ av_warn_unused_result
 int av_buffersrc_add_frame_flags(AVFilterContext *buffer_src,
                                  AVFrame *frame, int flags);
 
+/**
+ * Get a video buffer from the filters following the buffer source.
+ *
+ * The frame is allocated the same way a filter connected to the source would
+ * allocate its output, so filters which provide buffers to the filters before
+ * them (like pad, which hands out the interior of its padded output frame)
+ * can take the data written into it without copying. A frame obtained this
+ * way should be filled and then passed back to av_buffersrc_add_frame() or
+ * av_buffersrc_add_frame_flags() on the same buffer source; it is however a
+ * normal reference-counted frame and may also be used otherwise.
+ *
+ * The format of the frame is the format negotiated on the output of the
+ * buffer source, the caller must check that it matches the data it intends to
+ * write. This function must not be called concurrently with any other
+ * function operating on the same filter graph.
+ *
+ * @param buffer_src an instance of the buffersrc filter in a configured graph
+ * @param w          the width of the frame to allocate
+ * @param h          the height of the frame to allocate
+ * @return a new frame, or NULL if the source is not a video source, the graph
+ *         is not configured yet, the source carries hardware frames, or on
+ *         allocation failure
+ */
+AVFrame *av_buffersrc_get_video_buffer(AVFilterContext *buffer_src, int w, int h);
+
 
 /**
  * @}
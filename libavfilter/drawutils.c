@@ -21,6 +21,7 @@
 
 #include <string.h>
 
+#include "config.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
 #include "libavutil/colorspace.h"
@@ -173,6 +174,31 @@ void ff_copy_rectangle(uint8_t *dst[4], int dst_linesize[4],
     }
 }
 
+static void blend_row8_c(uint8_t *dst, const uint8_t *mask, int w,
+                        unsigned src, unsigned alpha)
+{
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned a = mask[x] * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+}
+
+static void blend_row8_2x2_c(uint8_t *dst, const uint8_t *mask,
+                             ptrdiff_t mask_linesize, int w,
+                             unsigned src, unsigned alpha)
+{
+    const uint8_t *mask2 = mask + mask_linesize;
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned t = mask[2 * x] + mask[2 * x + 1] + mask2[2 * x] + mask2[2 * x + 1];
+        unsigned a = (t >> 2) * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+}
+
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
@@ -215,6 +241,10 @@ int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
     for (i = 0; i < (desc->nb_components - !!(desc->flags & AV_PIX_FMT_FLAG_ALPHA)); i++)
         draw->comp_mask[desc->comp[i].plane] |=
             1 << desc->comp[i].offset;
+    draw->blend_row8     = blend_row8_c;
+    draw->blend_row8_2x2 = blend_row8_2x2_c;
+    if (ARCH_X86)
+        ff_draw_init_x86(draw);
     return 0;
 }
 
@@ -604,6 +634,37 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
                     right, hband, hsub + vsub, xm);
 }
 
+/**
+ * Blend a line of an 8-bit plane with an 8-bit mask, using the row functions
+ * of the context for the pixels that are not on the left and right edges.
+ * The plane must have one component per pixel and the same subsampling in
+ * both directions, at most 2.
+ */
+static void blend_line8(FFDrawContext *draw, uint8_t *dst,
+                        unsigned src, unsigned alpha,
+                        const uint8_t *mask, int mask_linesize, int w,
+                        unsigned sub, int xm, int left, int right)
+{
+    int w4 = w & ~3;
+
+    if (left) {
+        blend_pixel(dst, src, alpha, mask, mask_linesize, 3,
+                    left, 1 << sub, 2 * sub, xm);
+        dst++;
+        xm += left;
+    }
+    if (w4) {
+        if (sub)
+            draw->blend_row8_2x2(dst, mask + xm, mask_linesize, w4, src, alpha);
+        else
+            draw->blend_row8(dst, mask + xm, w4, src, alpha);
+        dst += w4;
+        xm  += w4 << sub;
+    }
+    blend_line_hv(dst, 1, src, alpha, mask, mask_linesize, 3, w - w4,
+                  sub, sub, xm, 0, right, 1 << sub);
+}
+
 void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                    uint8_t *dst[], int dst_linesize[], int dst_w, int dst_h,
                    const uint8_t *mask,  int mask_linesize, int mask_w, int mask_h,
@@ -660,7 +721,16 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                 p += dst_linesize[plane];
                 m += top * mask_linesize;
             }
-            if (depth <= 8) {
+            if (depth <= 8 && l2depth == 3 && draw->pixelstep[plane] == 1 &&
+                draw->hsub[plane] == draw->vsub[plane] && draw->hsub[plane] <= 1) {
+                for (y = 0; y < h_sub; y++) {
+                    blend_line8(draw, p, color->comp[plane].u8[comp], alpha,
+                                m, mask_linesize, w_sub, draw->hsub[plane],
+                                xm0, left, right);
+                    p += dst_linesize[plane];
+                    m += mask_linesize << draw->vsub[plane];
+                }
+            } else if (depth <= 8) {
                 for (y = 0; y < h_sub; y++) {
                     blend_line_hv(p, draw->pixelstep[plane],
                                   color->comp[plane].u8[comp], alpha,
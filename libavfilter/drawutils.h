@@ -24,6 +24,7 @@
  * misc drawing utilities
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include "avfilter.h"
 #include "libavutil/pixfmt.h"
@@ -55,6 +56,21 @@ typedef struct FFDrawContext {
     uint8_t vsub[MAX_PLANES];  /*< vertical subsampling */
     uint8_t hsub_max;
     uint8_t vsub_max;
+
+    /**
+     * Blend a color into a row of w pixels of an 8-bit plane using an 8-bit
+     * mask: dst[x] = blend(dst[x], src, mask[x] * alpha).
+     * w must be a positive multiple of 4.
+     */
+    void (*blend_row8)(uint8_t *dst, const uint8_t *mask, int w,
+                       unsigned src, unsigned alpha);
+    /**
+     * Same as blend_row8() for a plane subsampled by 2 in both directions:
+     * the mask value of each pixel is the average of a 2x2 block of mask.
+     */
+    void (*blend_row8_2x2)(uint8_t *dst, const uint8_t *mask,
+                           ptrdiff_t mask_linesize, int w,
+                           unsigned src, unsigned alpha);
 } FFDrawContext;
 
 typedef struct FFDrawColor {
@@ -76,6 +92,8 @@ typedef struct FFDrawColor {
  */
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags);
 
+void ff_draw_init_x86(FFDrawContext *draw);
+
 /**
  * Prepare a color.
  */
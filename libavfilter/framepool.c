@@ -84,7 +84,9 @@ FFVideoFramePool *ff_video_frame_pool_init(AVBufferRef* (*alloc)(int size),
         if (i == 1 || i == 2)
             h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
 
-        pool->pools[i] = av_buffer_pool_init(pool->linesize[i] * h + 16 + 16 - 1,
+        /* same padding as libavcodec's default get_buffer2(), so that
+         * decoders can write directly into frames from this pool */
+        pool->pools[i] = av_buffer_pool_init(pool->linesize[i] * h + 16 + pool->align - 1,
                                              alloc);
         if (!pool->pools[i])
             goto fail;
@@ -0,0 +1,54 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_FRAMERATE_H
+#define AVFILTER_FRAMERATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*framerate_blend_func)(const uint8_t *src1, ptrdiff_t src1_linesize,
+                                     const uint8_t *src2, ptrdiff_t src2_linesize,
+                                     uint8_t *dst, ptrdiff_t dst_linesize,
+                                     ptrdiff_t width, ptrdiff_t height,
+                                     int factor1, int factor2, int half, int shift);
+
+typedef struct FrameRateDSPContext {
+    /**
+     * dst = (src1 * factor1 + src2 * factor2 + half) >> shift for a block of
+     * width x height samples, with factor1 + factor2 == 1 << shift.
+     * blend8 works on bytes and requires shift == 8, blend16 works on native
+     * endian words of at most 14 bits and requires shift <= 14.
+     * SIMD versions require width to be a multiple of 32.
+     */
+    framerate_blend_func blend8;
+    framerate_blend_func blend16;
+
+    /**
+     * Sum of absolute differences of a block of width x height native endian
+     * words of at most 15 bits. width is a multiple of 8.
+     */
+    int64_t (*sad16)(const uint8_t *src1, ptrdiff_t src1_linesize,
+                     const uint8_t *src2, ptrdiff_t src2_linesize,
+                     ptrdiff_t width, ptrdiff_t height);
+} FrameRateDSPContext;
+
+void ff_framerate_dsp_init(FrameRateDSPContext *dsp);
+void ff_framerate_dsp_init_x86(FrameRateDSPContext *dsp);
+
+#endif /* AVFILTER_FRAMERATE_H */
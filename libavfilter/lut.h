@@ -0,0 +1,43 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_LUT_H
+#define AVFILTER_LUT_H
+
+#include <stdint.h>
+
+typedef struct LutDSPContext {
+    /**
+     * dst[x] = lut[src[x]] for a plane row of width samples.
+     * width is a multiple of 32, lut has 256 entries.
+     */
+    void (*lut_plane8)(uint8_t *dst, const uint8_t *src, const uint8_t *lut,
+                       int width);
+    /**
+     * dst[x] = lut[src[x]] for a plane row of width native endian samples.
+     * width is a multiple of 32, lut must be readable one entry past the
+     * largest sample value.
+     */
+    void (*lut_plane16)(uint16_t *dst, const uint16_t *src, const uint16_t *lut,
+                        int width);
+} LutDSPContext;
+
+void ff_lut_dsp_init(LutDSPContext *dsp);
+void ff_lut_dsp_init_x86(LutDSPContext *dsp);
+
+#endif /* AVFILTER_LUT_H */
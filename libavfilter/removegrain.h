@@ -40,6 +40,7 @@ typedef struct RemoveGrainContext {
     void (*fl[4])(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 } RemoveGrainContext;
 
+void ff_removegrain_init(RemoveGrainContext *rg);
 void ff_removegrain_init_x86(RemoveGrainContext *rg);
 
 #endif /* AVFILTER_REMOVEGRAIN_H */
@@ -0,0 +1,37 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_SUBTITLES_H
+#define AVFILTER_SUBTITLES_H
+
+#include <stdint.h>
+
+typedef struct SubtitlesDSPContext {
+    /**
+     * Blend a row of the premultiplied subtitles overlay into an 8-bit plane:
+     * dst[x] = (((dst[x] << 8) * transp[x] >> 16) + color[x] + 128) >> 8,
+     * saturated to 255. w must be a positive multiple of 8.
+     */
+    void (*blend_row)(uint8_t *dst, const uint16_t *color,
+                      const uint16_t *transp, int w);
+} SubtitlesDSPContext;
+
+void ff_subtitles_dsp_init(SubtitlesDSPContext *dsp);
+void ff_subtitles_dsp_init_x86(SubtitlesDSPContext *dsp);
+
+#endif /* AVFILTER_SUBTITLES_H */
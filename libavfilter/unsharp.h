@@ -65,9 +65,28 @@ typedef struct UnsharpFilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[MAX_MATRIX_SIZE - 1];       ///< finite state machine storage
+    uint32_t *sc;                            ///< per-thread finite state machine storage
+    int sc_stride;                           ///< elements between two rows of sc
 } UnsharpFilterParam;
 
+typedef struct UnsharpDSPContext {
+    /**
+     * One pass of the horizontal binomial blur, buf[x] += buf[x + 1]
+     * for 0 <= x < len, processed in increasing order of x.
+     */
+    void (*hblur_pass)(uint32_t *buf, int len);
+
+    /**
+     * Advance the vertical finite state machine by one row: acc holds the
+     * horizontally blurred input row on entry and the blurred output row
+     * on return, sc holds nb_stages rows of state.
+     */
+    void (*vblur)(uint32_t *acc, uint32_t *const *sc, int nb_stages, int width);
+
+    void (*sharpen)(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                    int width, int amount, int scalebits, uint32_t halfscale);
+} UnsharpDSPContext;
+
 typedef struct UnsharpContext {
     const AVClass *class;
     int lmsize_x, lmsize_y, cmsize_x, cmsize_y;
@@ -75,11 +94,16 @@ typedef struct UnsharpContext {
     UnsharpFilterParam luma;   ///< luma parameters (width, height, amount)
     UnsharpFilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
+    int nb_threads;
     int opencl;
+    UnsharpDSPContext dsp;
 #if CONFIG_OPENCL
     UnsharpOpenclContext opencl_ctx;
 #endif
     int (* apply_unsharp)(AVFilterContext *ctx, AVFrame *in, AVFrame *out);
 } UnsharpContext;
 
+void ff_unsharp_dsp_init(UnsharpDSPContext *dsp);
+void ff_unsharp_dsp_init_x86(UnsharpDSPContext *dsp);
+
 #endif /* AVFILTER_UNSHARP_H */
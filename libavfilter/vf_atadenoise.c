@@ -27,6 +27,7 @@
 
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
+#include "atadenoise.h"
 #include "avfilter.h"
 
 #define FF_BUFQUEUE_SIZE 129
@@ -54,7 +55,10 @@ typedef struct ATADenoiseContext {
     int size, mid;
     int available;
 
-    int (*filter_slice)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
+    int depth;
+    ATADenoiseDSPContext dsp;
+    void (*filter_row_c)(const uint8_t *src, uint8_t *dst, const uint8_t **srcf,
+                         int w, int mid, int size, int thra, int thrb);
 } ATADenoiseContext;
 
 #define OFFSET(x) offsetof(ATADenoiseContext, x)
@@ -113,78 +117,96 @@ typedef struct ThreadData {
     AVFrame *in, *out;
 } ThreadData;
 
-static int filter_slice8(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+static void filter_row8(const uint8_t *src, uint8_t *dst, const uint8_t **srcf,
+                        int w, int mid, int size, int thra, int thrb)
 {
-    ATADenoiseContext *s = ctx->priv;
-    ThreadData *td = arg;
-    AVFrame *in = td->in;
-    AVFrame *out = td->out;
-    const int size = s->size;
-    const int mid = s->mid;
-    int p, x, y, i, j;
-
-    for (p = 0; p < s->nb_planes; p++) {
-        const int h = s->planeheight[p];
-        const int w = s->planewidth[p];
-        const int slice_start = (h * jobnr) / nb_jobs;
-        const int slice_end = (h * (jobnr+1)) / nb_jobs;
-        const uint8_t *src = in->data[p] + slice_start * in->linesize[p];
-        uint8_t *dst = out->data[p] + slice_start * out->linesize[p];
-        const int thra = s->thra[p];
-        const int thrb = s->thrb[p];
-        const uint8_t **data = (const uint8_t **)s->data[p];
-        const int *linesize = (const int *)s->linesize[p];
-        const uint8_t *srcf[SIZE];
-
-        for (i = 0; i < size; i++)
-            srcf[i] = data[i] + slice_start * linesize[i];
-
-        for (y = slice_start; y < slice_end; y++) {
-            for (x = 0; x < w; x++) {
-                const int srcx = src[x];
-                unsigned lsumdiff = 0, rsumdiff = 0;
-                unsigned ldiff, rdiff;
-                unsigned sum = srcx;
-                int l = 0, r = 0;
-                int srcjx, srcix;
-
-                for (j = mid - 1, i = mid + 1; j >= 0 && i < size; j--, i++) {
-                    srcjx = srcf[j][x];
-
-                    ldiff = FFABS(srcx - srcjx);
-                    lsumdiff += ldiff;
-                    if (ldiff > thra ||
-                        lsumdiff > thrb)
-                        break;
-                    l++;
-                    sum += srcjx;
-
-                    srcix = srcf[i][x];
-
-                    rdiff = FFABS(srcx - srcix);
-                    rsumdiff += rdiff;
-                    if (rdiff > thra ||
-                        rsumdiff > thrb)
-                        break;
-                    r++;
-                    sum += srcix;
-                }
-
-                dst[x] = sum / (r + l + 1);
-            }
+    int x, i, j;
+
+    for (x = 0; x < w; x++) {
+        const int srcx = src[x];
+        unsigned lsumdiff = 0, rsumdiff = 0;
+        unsigned ldiff, rdiff;
+        unsigned sum = srcx;
+        int l = 0, r = 0;
+        int srcjx, srcix;
+
+        for (j = mid - 1, i = mid + 1; j >= 0 && i < size; j--, i++) {
+            srcjx = srcf[j][x];
+
+            ldiff = FFABS(srcx - srcjx);
+            lsumdiff += ldiff;
+            if (ldiff > thra ||
+                lsumdiff > thrb)
+                break;
+            l++;
+            sum += srcjx;
+
+            srcix = srcf[i][x];
+
+            rdiff = FFABS(srcx - srcix);
+            rsumdiff += rdiff;
+            if (rdiff > thra ||
+                rsumdiff > thrb)
+                break;
+            r++;
+            sum += srcix;
+        }
 
-            dst += out->linesize[p];
-            src += in->linesize[p];
+        dst[x] = sum / (r + l + 1);
+    }
+}
 
-            for (i = 0; i < size; i++)
-                srcf[i] += linesize[i];
+static void filter_row16(const uint8_t *ssrc, uint8_t *ddst, const uint8_t **ssrcf,
+                         int w, int mid, int size, int thra, int thrb)
+{
+    const uint16_t *src = (const uint16_t *)ssrc;
+    const uint16_t **srcf = (const uint16_t **)ssrcf;
+    uint16_t *dst = (uint16_t *)ddst;
+    int x, i, j;
+
+    for (x = 0; x < w; x++) {
+        const int srcx = src[x];
+        unsigned lsumdiff = 0, rsumdiff = 0;
+        unsigned ldiff, rdiff;
+        unsigned sum = srcx;
+        int l = 0, r = 0;
+        int srcjx, srcix;
+
+        for (j = mid - 1, i = mid + 1; j >= 0 && i < size; j--, i++) {
+            srcjx = srcf[j][x];
+
+            ldiff = FFABS(srcx - srcjx);
+            lsumdiff += ldiff;
+            if (ldiff > thra ||
+                lsumdiff > thrb)
+                break;
+            l++;
+            sum += srcjx;
+
+            srcix = srcf[i][x];
+
+            rdiff = FFABS(srcx - srcix);
+            rsumdiff += rdiff;
+            if (rdiff > thra ||
+                rsumdiff > thrb)
+                break;
+            r++;
+            sum += srcix;
         }
+
+        dst[x] = sum / (r + l + 1);
     }
+}
 
-    return 0;
+av_cold void ff_atadenoise_dsp_init(ATADenoiseDSPContext *dsp, int depth)
+{
+    dsp->filter_row = depth == 8 ? filter_row8 : filter_row16;
+
+    if (ARCH_X86)
+        ff_atadenoise_dsp_init_x86(dsp, depth);
 }
 
-static int filter_slice16(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     ATADenoiseContext *s = ctx->priv;
     ThreadData *td = arg;
@@ -192,63 +214,42 @@ static int filter_slice16(AVFilterContext *ctx, void *arg, int jobnr, int nb_job
     AVFrame *out = td->out;
     const int size = s->size;
     const int mid = s->mid;
-    int p, x, y, i, j;
+    const int bpp = s->depth > 8 ? 2 : 1;
+    int p, y, i;
 
     for (p = 0; p < s->nb_planes; p++) {
         const int h = s->planeheight[p];
         const int w = s->planewidth[p];
+        const int w_simd = w & ~15;
         const int slice_start = (h * jobnr) / nb_jobs;
         const int slice_end = (h * (jobnr+1)) / nb_jobs;
-        const uint16_t *src = (uint16_t *)(in->data[p] + slice_start * in->linesize[p]);
-        uint16_t *dst = (uint16_t *)(out->data[p] + slice_start * out->linesize[p]);
+        const uint8_t *src = in->data[p] + slice_start * in->linesize[p];
+        uint8_t *dst = out->data[p] + slice_start * out->linesize[p];
         const int thra = s->thra[p];
         const int thrb = s->thrb[p];
         const uint8_t **data = (const uint8_t **)s->data[p];
         const int *linesize = (const int *)s->linesize[p];
-        const uint16_t *srcf[SIZE];
+        const uint8_t *srcf[SIZE];
+        const uint8_t *srcf_tail[SIZE];
 
-        for (i = 0; i < s->size; i++)
-            srcf[i] = (const uint16_t *)(data[i] + slice_start * linesize[i]);
+        for (i = 0; i < size; i++)
+            srcf[i] = data[i] + slice_start * linesize[i];
 
         for (y = slice_start; y < slice_end; y++) {
-            for (x = 0; x < w; x++) {
-                const int srcx = src[x];
-                unsigned lsumdiff = 0, rsumdiff = 0;
-                unsigned ldiff, rdiff;
-                unsigned sum = srcx;
-                int l = 0, r = 0;
-                int srcjx, srcix;
-
-                for (j = mid - 1, i = mid + 1; j >= 0 && i < size; j--, i++) {
-                    srcjx = srcf[j][x];
-
-                    ldiff = FFABS(srcx - srcjx);
-                    lsumdiff += ldiff;
-                    if (ldiff > thra ||
-                        lsumdiff > thrb)
-                        break;
-                    l++;
-                    sum += srcjx;
-
-                    srcix = srcf[i][x];
-
-                    rdiff = FFABS(srcx - srcix);
-                    rsumdiff += rdiff;
-                    if (rdiff > thra ||
-                        rsumdiff > thrb)
-                        break;
-                    r++;
-                    sum += srcix;
-                }
-
-                dst[x] = sum / (r + l + 1);
+            if (w_simd)
+                s->dsp.filter_row(src, dst, srcf, w_simd, mid, size, thra, thrb);
+            if (w > w_simd) {
+                for (i = 0; i < size; i++)
+                    srcf_tail[i] = srcf[i] + w_simd * bpp;
+                s->filter_row_c(src + w_simd * bpp, dst + w_simd * bpp, srcf_tail,
+                                w - w_simd, mid, size, thra, thrb);
             }
 
-            dst += out->linesize[p] / 2;
-            src += in->linesize[p] / 2;
+            dst += out->linesize[p];
+            src += in->linesize[p];
 
             for (i = 0; i < size; i++)
-                srcf[i] += linesize[i] / 2;
+                srcf[i] += linesize[i];
         }
     }
 
@@ -269,11 +270,9 @@ static int config_input(AVFilterLink *inlink)
     s->planewidth[1]  = s->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, desc->log2_chroma_w);
     s->planewidth[0]  = s->planewidth[3]  = inlink->w;
 
-    depth = desc->comp[0].depth;
-    if (depth == 8)
-        s->filter_slice = filter_slice8;
-    else
-        s->filter_slice = filter_slice16;
+    depth = s->depth = desc->comp[0].depth;
+    s->filter_row_c = depth == 8 ? filter_row8 : filter_row16;
+    ff_atadenoise_dsp_init(&s->dsp, depth);
 
     s->thra[0] = s->fthra[0] * (1 << depth) - 1;
     s->thra[1] = s->fthra[1] * (1 << depth) - 1;
@@ -334,7 +333,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
         }
 
         td.in = in; td.out = out;
-        ctx->internal->execute(ctx, s->filter_slice, &td, NULL,
+        ctx->internal->execute(ctx, filter_slice, &td, NULL,
                                FFMIN3(s->planeheight[1],
                                       s->planeheight[2],
                                       ctx->graph->nb_threads));
@@ -28,9 +28,11 @@
 #include "libavutil/avstring.h"
 #include "libavutil/common.h"
 #include "libavutil/eval.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "boxblur.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
@@ -70,9 +72,16 @@ typedef struct BoxBlurContext {
     int hsub, vsub;
     int radius[4];
     int power[4];
-    uint8_t *temp[2]; ///< temporary buffer used in blur_power()
+    int nb_threads;
+    int temp_size;    ///< size in bytes of the temporary buffers of one thread
+    uint8_t *temp[2]; ///< per-thread temporary buffers used in blur_power() and vblur_power()
+    int32_t *sum;     ///< per-thread column accumulators used in vblur_strip()
+    BoxBlurDSPContext dsp;
 } BoxBlurContext;
 
+/* width of the column strips processed at once by the vertical pass */
+#define STRIP_WIDTH 64
+
 #define Y 0
 #define U 1
 #define V 2
@@ -104,6 +113,8 @@ static av_cold int init(AVFilterContext *ctx)
     if (s->alpha_param.power < 0)
         s->alpha_param.power = s->luma_param.power;
 
+    ff_boxblur_dsp_init(&s->dsp);
+
     return 0;
 }
 
@@ -113,6 +124,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->temp[0]);
     av_freep(&s->temp[1]);
+    av_freep(&s->sum);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -143,8 +155,15 @@ static int config_input(AVFilterLink *inlink)
     char *expr;
     int ret;
 
-    if (!(s->temp[0] = av_malloc(2*FFMAX(w, h))) ||
-        !(s->temp[1] = av_malloc(2*FFMAX(w, h))))
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    s->temp_size  = FFALIGN(FFMAX(2*w, 2*STRIP_WIDTH*h), 32);
+
+    av_freep(&s->temp[0]);
+    av_freep(&s->temp[1]);
+    av_freep(&s->sum);
+    if (!(s->temp[0] = av_malloc_array(s->nb_threads, s->temp_size)) ||
+        !(s->temp[1] = av_malloc_array(s->nb_threads, s->temp_size)) ||
+        !(s->sum     = av_malloc_array(s->nb_threads, STRIP_WIDTH * sizeof(*s->sum))))
         return AVERROR(ENOMEM);
 
     s->hsub = desc->log2_chroma_w;
@@ -298,7 +317,8 @@ static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_li
 {
     int y;
 
-    if (radius == 0 && dst == src)
+    /* no blurring, only a copy, which is a no-op in place */
+    if ((radius == 0 || power == 0) && dst == src)
         return;
 
     for (y = 0; y < h; y++)
@@ -306,17 +326,179 @@ static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_li
                    w, radius, power, temp, pixsize);
 }
 
-static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+/* The vertical pass slides the window down a strip of adjacent columns at
+ * once instead of walking each column separately, so that every step reads
+ * and writes whole rows and can be vectorized across the columns. The
+ * arithmetic per column is identical to blur(). */
+#define BLUR_ROW(type, depth)                                               \
+static void blur_row ## depth ## _c(type *dst, const type *add,             \
+                                    const type *sub, int32_t *sum,          \
+                                    int width, int inv)                     \
+{                                                                           \
+    int x;                                                                  \
+                                                                            \
+    for (x = 0; x < width; x++) {                                           \
+        sum[x] += (add[x] - sub[x]) * inv;                                  \
+        dst[x] = sum[x] >> 16;                                              \
+    }                                                                       \
+}
+
+BLUR_ROW(uint8_t,   8)
+BLUR_ROW(uint16_t, 16)
+
+#undef BLUR_ROW
+
+av_cold void ff_boxblur_dsp_init(BoxBlurDSPContext *dsp)
+{
+    dsp->blur_row8  = blur_row8_c;
+    dsp->blur_row16 = blur_row16_c;
+
+    if (ARCH_X86)
+        ff_boxblur_dsp_init_x86(dsp);
+}
+
+static void vblur_strip(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                        const uint8_t *src, int src_linesize,
+                        int w, int len, int radius, int32_t *sum, int pixsize)
+{
+    const int length = radius*2 + 1;
+    const int inv = ((1<<16) + length/2)/length;
+    const int width = FFALIGN(w, 16);
+    int x, y;
+
+    for (x = 0; x < width; x++) {
+        if (pixsize == 1) {
+            const uint8_t *col = src + x;
+            sum[x] = col[radius*src_linesize];
+            for (y = 0; y < radius; y++)
+                sum[x] += col[y*src_linesize]<<1;
+        } else {
+            const uint16_t *col = (const uint16_t *)src + x;
+            sum[x] = col[radius*(src_linesize>>1)];
+            for (y = 0; y < radius; y++)
+                sum[x] += col[y*(src_linesize>>1)]<<1;
+        }
+        sum[x] = sum[x]*inv + (1<<15);
+    }
+
+    for (y = 0; y < len; y++) {
+        int add, sub;
+
+        if (y <= radius) {
+            add = radius + y;
+            sub = radius - y;
+        } else if (y < len - radius) {
+            add = radius + y;
+            sub = y - radius - 1;
+        } else {
+            add = 2*len - radius - y - 1;
+            sub = y - radius - 1;
+        }
+
+        if (pixsize == 1)
+            s->dsp.blur_row8(dst + y*dst_linesize, src + add*src_linesize,
+                             src + sub*src_linesize, sum, width, inv);
+        else
+            s->dsp.blur_row16((uint16_t *)(dst + y*dst_linesize),
+                              (const uint16_t *)(src + add*src_linesize),
+                              (const uint16_t *)(src + sub*src_linesize),
+                              sum, width, inv);
+    }
+}
+
+static void vblur_power(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                        const uint8_t *src, int src_linesize, int w, int h,
+                        int radius, int power, uint8_t *temp[2], int32_t *sum,
+                        int pixsize)
+{
+    const int temp_linesize = STRIP_WIDTH * pixsize;
+    uint8_t *a = temp[0], *b = temp[1];
+
+    if (radius && power) {
+        vblur_strip(s, a, temp_linesize, src, src_linesize, w, h, radius, sum, pixsize);
+        for (; power > 2; power--) {
+            uint8_t *c;
+            vblur_strip(s, b, temp_linesize, a, temp_linesize, w, h, radius, sum, pixsize);
+            c = a; a = b; b = c;
+        }
+        if (power > 1)
+            vblur_strip(s, dst, dst_linesize, a, temp_linesize, w, h, radius, sum, pixsize);
+        else
+            av_image_copy_plane(dst, dst_linesize, a, temp_linesize, w*pixsize, h);
+    } else {
+        av_image_copy_plane(dst, dst_linesize, src, src_linesize, w*pixsize, h);
+    }
+}
+
+static void vblur(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                  const uint8_t *src, int src_linesize, int x_start, int x_end,
+                  int h, int radius, int power, uint8_t *temp[2], int32_t *sum,
+                  int pixsize)
 {
     int x;
 
-    if (radius == 0 && dst == src)
+    /* no blurring, only a copy, which is a no-op in place */
+    if ((radius == 0 || power == 0) && dst == src)
         return;
 
-    for (x = 0; x < w; x++)
-        blur_power(dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
-                   h, radius, power, temp, pixsize);
+    for (x = x_start; x < x_end; x += STRIP_WIDTH)
+        vblur_power(s, dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
+                    FFMIN(STRIP_WIDTH, x_end - x), h, radius, power, temp, sum,
+                    pixsize);
+}
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int w[4], h[4];
+    int pixsize;
+} ThreadData;
+
+static int filter_slice_h(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    uint8_t *temp[2] = { s->temp[0] + jobnr * s->temp_size,
+                         s->temp[1] + jobnr * s->temp_size };
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        const int slice_start = (td->h[plane] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (td->h[plane] * (jobnr + 1)) / nb_jobs;
+
+        hblur(out->data[plane] + slice_start * out->linesize[plane], out->linesize[plane],
+              in ->data[plane] + slice_start * in ->linesize[plane], in ->linesize[plane],
+              td->w[plane], slice_end - slice_start, s->radius[plane], s->power[plane],
+              temp, td->pixsize);
+    }
+
+    return 0;
+}
+
+static int filter_slice_v(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    uint8_t *temp[2] = { s->temp[0] + jobnr * s->temp_size,
+                         s->temp[1] + jobnr * s->temp_size };
+    int32_t *sum = s->sum + jobnr * STRIP_WIDTH;
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        /* keep the column ranges of the jobs 16-aligned, so that the row
+         * functions never write into the columns of another job */
+        const int w = td->w[plane];
+        const int x_start = FFMIN(FFALIGN(w *  jobnr      / nb_jobs, 16), w);
+        const int x_end   = FFMIN(FFALIGN(w * (jobnr + 1) / nb_jobs, 16), w);
+
+        vblur(s, out->data[plane], out->linesize[plane],
+              out->data[plane], out->linesize[plane],
+              x_start, x_end, td->h[plane], s->radius[plane], s->power[plane],
+              temp, sum, td->pixsize);
+    }
+
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
@@ -325,13 +507,10 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     BoxBlurContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
-    int plane;
+    ThreadData td;
     int cw = AV_CEIL_RSHIFT(inlink->w, s->hsub), ch = AV_CEIL_RSHIFT(in->height, s->vsub);
-    int w[4] = { inlink->w, cw, cw, inlink->w };
-    int h[4] = { in->height, ch, ch, in->height };
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     const int depth = desc->comp[0].depth;
-    const int pixsize = (depth+7)/8;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -340,17 +519,18 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        hblur(out->data[plane], out->linesize[plane],
-              in ->data[plane], in ->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    td.in  = in;
+    td.out = out;
+    td.w[0] = td.w[3] = inlink->w;
+    td.w[1] = td.w[2] = cw;
+    td.h[0] = td.h[3] = in->height;
+    td.h[1] = td.h[2] = ch;
+    td.pixsize = (depth+7)/8;
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        vblur(out->data[plane], out->linesize[plane],
-              out->data[plane], out->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    ctx->internal->execute(ctx, filter_slice_h, &td, NULL,
+                           FFMIN(in->height, s->nb_threads));
+    ctx->internal->execute(ctx, filter_slice_v, &td, NULL,
+                           FFMIN(FFALIGN(inlink->w, 16) / 16, s->nb_threads));
 
     av_frame_free(&in);
 
@@ -409,5 +589,5 @@ AVFilter ff_vf_boxblur = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_boxblur_inputs,
     .outputs       = avfilter_vf_boxblur_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
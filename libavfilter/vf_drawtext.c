@@ -134,6 +134,25 @@ enum expansion_mode {
     EXP_STRFTIME,
 };
 
+/**
+ * 8-bit coverage of all the glyphs of the text, blended into the frames at
+ * once. Only the area of the glyphs which changed is rendered again when
+ * the text changes.
+ */
+typedef struct TextMask {
+    uint8_t *data;
+    int x, y;                       ///< position relative to the text origin
+    int w, h;
+} TextMask;
+
+/**
+ * A glyph composited into the text masks.
+ */
+typedef struct MaskGlyph {
+    struct Glyph *glyph;
+    int x, y;                       ///< position relative to the text origin
+} MaskGlyph;
+
 typedef struct DrawTextContext {
     const AVClass *class;
     int exp_mode;                   ///< expansion mode to use for the text
@@ -154,6 +173,15 @@ typedef struct DrawTextContext {
     int y;                          ///< y position to start drawing text
     int max_glyph_w;                ///< max glyph width
     int max_glyph_h;                ///< max glyph height
+    int max_glyph_a;                ///< max glyph ascent
+    int max_glyph_d;                ///< max glyph descent
+    int text_w;                     ///< width of the laid out text
+    int text_h;                     ///< height of the laid out text
+    char *layout_text;              ///< expanded text the glyph positions were computed for
+    MaskGlyph *mask_glyphs;         ///< glyphs of layout_text in the text masks
+    int nb_mask_glyphs;             ///< number of elements of mask_glyphs
+    TextMask text_mask;             ///< pre-composited glyphs of layout_text
+    TextMask border_mask;           ///< pre-composited glyph borders of layout_text
     int shadowx, shadowy;
     int borderw;                    ///< border width
     unsigned int fontsize;          ///< font size to use
@@ -710,7 +738,11 @@ static av_cold void uninit(AVFilterContext *ctx)
     s->x_pexpr = s->y_pexpr = NULL;
     av_freep(&s->positions);
     s->nb_positions = 0;
-
+    av_freep(&s->layout_text);
+    av_freep(&s->mask_glyphs);
+    s->nb_mask_glyphs = 0;
+    av_freep(&s->text_mask.data);
+    av_freep(&s->border_mask.data);
 
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
@@ -1070,49 +1102,134 @@ static int expand_text(AVFilterContext *ctx, char *text, AVBPrint *bp)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height,
-                       FFDrawColor *color,
-                       int x, int y, int borderw)
+/**
+ * Composite the glyphs into a single coverage mask. If the mask keeps its
+ * size, only the area of the glyphs which differ from s->mask_glyphs is
+ * rendered again.
+ */
+static int render_text_mask(DrawTextContext *s, TextMask *mask, int borderw,
+                            const MaskGlyph *glyphs, int nb_glyphs)
 {
-    char *text = s->expanded_text.str;
-    uint32_t code = 0;
-    int i, x1, y1;
-    uint8_t *p;
-    Glyph *glyph = NULL;
-
-    for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
-        GET_UTF8(code, *p++, continue;);
-
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
-            continue;
-
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+    int i, x, y, x1, y1, x2, y2;
+    int x_min = INT_MAX, y_min = INT_MAX, x_max = INT_MIN, y_max = INT_MIN;
 
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
+    for (i = 0; i < nb_glyphs; i++) {
+        const Glyph *glyph = glyphs[i].glyph;
+        FT_Bitmap bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
 
         if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
             glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
             return AVERROR(EINVAL);
+        if (!bitmap.width || !bitmap.rows)
+            continue;
+
+        x1 = glyphs[i].x - borderw;
+        y1 = glyphs[i].y - borderw;
+        x_min = FFMIN(x_min, x1);
+        y_min = FFMIN(y_min, y1);
+        x_max = FFMAX(x_max, x1 + (int)bitmap.width);
+        y_max = FFMAX(y_max, y1 + (int)bitmap.rows);
+    }
+
+    if (x_min >= x_max || y_min >= y_max) {
+        av_freep(&mask->data);
+        mask->w = mask->h = 0;
+        return 0;
+    }
 
-        x1 = s->positions[i].x+s->x+x - borderw;
-        y1 = s->positions[i].y+s->y+y - borderw;
+    if (mask->data && mask->x == x_min && mask->y == y_min &&
+        mask->w == x_max - x_min && mask->h == y_max - y_min) {
+        /* the area covered by the glyphs which changed */
+        x_min = y_min = INT_MAX;
+        x_max = y_max = INT_MIN;
+        for (i = 0; i < FFMAX(nb_glyphs, s->nb_mask_glyphs); i++) {
+            const MaskGlyph *cur  = i < nb_glyphs         ? &glyphs[i]         : NULL;
+            const MaskGlyph *prev = i < s->nb_mask_glyphs ? &s->mask_glyphs[i] : NULL;
+            const MaskGlyph *g[2] = { cur, prev };
+            int j;
+
+            if (cur && prev && cur->glyph == prev->glyph &&
+                cur->x == prev->x && cur->y == prev->y)
+                continue;
+
+            for (j = 0; j < 2; j++) {
+                FT_Bitmap bitmap;
+
+                if (!g[j])
+                    continue;
+                bitmap = borderw ? g[j]->glyph->border_bitmap : g[j]->glyph->bitmap;
+                if (!bitmap.width || !bitmap.rows)
+                    continue;
+                x1 = g[j]->x - borderw - mask->x;
+                y1 = g[j]->y - borderw - mask->y;
+                x_min = FFMIN(x_min, x1);
+                y_min = FFMIN(y_min, y1);
+                x_max = FFMAX(x_max, x1 + (int)bitmap.width);
+                y_max = FFMAX(y_max, y1 + (int)bitmap.rows);
+            }
+        }
+        x_min = FFMAX(x_min, 0);
+        y_min = FFMAX(y_min, 0);
+        x_max = FFMIN(x_max, mask->w);
+        y_max = FFMIN(y_max, mask->h);
+        if (x_min >= x_max || y_min >= y_max)
+            return 0;
+
+        for (y = y_min; y < y_max; y++)
+            memset(mask->data + y * mask->w + x_min, 0, x_max - x_min);
+    } else {
+        av_freep(&mask->data);
+        mask->x = x_min;
+        mask->y = y_min;
+        mask->w = x_max - x_min;
+        mask->h = y_max - y_min;
+        if (!(mask->data = av_mallocz_array(mask->h, mask->w))) {
+            mask->w = mask->h = 0;
+            return AVERROR(ENOMEM);
+        }
+        x_min = y_min = 0;
+        x_max = mask->w;
+        y_max = mask->h;
+    }
 
-        ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+    /* composite the glyphs within x_min, y_min - x_max, y_max of the mask */
+    for (i = 0; i < nb_glyphs; i++) {
+        const Glyph *glyph = glyphs[i].glyph;
+        FT_Bitmap bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
+
+        x1 = glyphs[i].x - borderw - mask->x;
+        y1 = glyphs[i].y - borderw - mask->y;
+        x2 = FFMIN(x1 + (int)bitmap.width, x_max);
+        y2 = FFMIN(y1 + (int)bitmap.rows,  y_max);
+
+        /* overlapping glyphs are composited like successive blends */
+        for (y = FFMAX(y1, y_min); y < y2; y++) {
+            const uint8_t *src = bitmap.buffer + (y - y1) * bitmap.pitch;
+            uint8_t *dst = mask->data + y * mask->w + x1;
+
+            for (x = FFMAX(x1, x_min) - x1; x < x2 - x1; x++) {
+                int v = bitmap.pixel_mode == FT_PIXEL_MODE_MONO ?
+                        (src[x >> 3] >> (~x & 7) & 1) * 255 : src[x];
+                dst[x] += ((255 - dst[x]) * v + 127) / 255;
+            }
+        }
     }
 
     return 0;
 }
 
+static void draw_text_mask(DrawTextContext *s, AVFrame *frame,
+                           int width, int height, FFDrawColor *color,
+                           const TextMask *mask, int x, int y)
+{
+    if (!mask->data)
+        return;
+
+    ff_blend_mask(&s->dc, color,
+                  frame->data, frame->linesize, width, height,
+                  mask->data, mask->w, mask->w, mask->h, 3, 0,
+                  s->x + x + mask->x, s->y + y + mask->y);
+}
 
 static void update_color_with_alpha(DrawTextContext *s, FFDrawColor *color, const FFDrawColor incolor)
 {
@@ -1136,23 +1253,143 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Load the glyphs of the expanded text, compute their positions and render
+ * the text masks.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
-
+    char *text = s->expanded_text.str;
     uint32_t code = 0, prev_code = 0;
     int x = 0, y = 0, i = 0, ret;
-    int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
+    int max_text_line_w = 0;
     uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
     FT_Vector delta;
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
+    MaskGlyph *glyphs;
+    int nb_glyphs = 0;
+
+    /* load and cache glyphs */
+    for (i = 0, p = text; *p; i++) {
+        GET_UTF8(code, *p++, continue;);
+
+        /* get glyph */
+        dummy.code = code;
+        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+        if (!glyph) {
+            ret = load_glyph(ctx, &glyph, code);
+            if (ret < 0)
+                return ret;
+        }
+
+        y_min = FFMIN(glyph->bbox.yMin, y_min);
+        y_max = FFMAX(glyph->bbox.yMax, y_max);
+        x_min = FFMIN(glyph->bbox.xMin, x_min);
+        x_max = FFMAX(glyph->bbox.xMax, x_max);
+    }
+    s->max_glyph_h = y_max - y_min;
+    s->max_glyph_w = x_max - x_min;
+
+    /* compute and save position for each glyph */
+    glyph = NULL;
+    for (i = 0, p = text; *p; i++) {
+        GET_UTF8(code, *p++, continue;);
+
+        /* skip the \n in the sequence \r\n */
+        if (prev_code == '\r' && code == '\n')
+            continue;
+
+        prev_code = code;
+        if (is_newline(code)) {
+
+            max_text_line_w = FFMAX(max_text_line_w, x);
+            y += s->max_glyph_h;
+            x = 0;
+            continue;
+        }
+
+        /* get glyph */
+        prev_glyph = glyph;
+        dummy.code = code;
+        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+
+        /* kerning */
+        if (s->use_kerning && prev_glyph && glyph->code) {
+            FT_Get_Kerning(s->face, prev_glyph->code, glyph->code,
+                           ft_kerning_default, &delta);
+            x += delta.x >> 6;
+        }
+
+        /* save position */
+        s->positions[i].x = x + glyph->bitmap_left;
+        s->positions[i].y = y - glyph->bitmap_top + y_max;
+        if (code == '\t') x  = (x / s->tabsize + 1)*s->tabsize;
+        else              x += glyph->advance;
+    }
+
+    max_text_line_w = FFMAX(x, max_text_line_w);
+
+    s->text_w = max_text_line_w;
+    s->text_h = y + s->max_glyph_h;
+    s->max_glyph_a = y_max;
+    s->max_glyph_d = y_min;
+
+    /* render the text masks for the new layout */
+    if (!(glyphs = av_malloc_array(FFMAX(i, 1), sizeof(*glyphs))))
+        return AVERROR(ENOMEM);
+    for (i = 0, p = text; *p; i++) {
+        GET_UTF8(code, *p++, continue;);
+
+        if (code == '\n' || code == '\r' || code == '\t')
+            continue;
+
+        dummy.code = code;
+        glyphs[nb_glyphs].glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+        glyphs[nb_glyphs].x     = s->positions[i].x;
+        glyphs[nb_glyphs].y     = s->positions[i].y;
+        nb_glyphs++;
+    }
+
+    if ((ret = render_text_mask(s, &s->text_mask, 0, glyphs, nb_glyphs)) < 0 ||
+        (s->borderw && (ret = render_text_mask(s, &s->border_mask, s->borderw,
+                                               glyphs, nb_glyphs)) < 0))
+        goto fail;
+
+    av_free(s->mask_glyphs);
+    s->mask_glyphs    = glyphs;
+    s->nb_mask_glyphs = nb_glyphs;
+    glyphs = NULL;
+
+    av_free(s->layout_text);
+    if (!(s->layout_text = av_strdup(text))) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    /* the masks may be partly updated, render them again from scratch */
+    av_freep(&s->text_mask.data);
+    av_freep(&s->border_mask.data);
+    av_freep(&s->layout_text);
+    av_free(glyphs);
+    return ret;
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+
+    int ret, len;
+    int box_w, box_h;
+    char *text;
 
     time_t now = time(0);
     struct tm ltime;
@@ -1213,76 +1450,19 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
     }
 
-    x = 0;
-    y = 0;
-
-    /* load and cache glyphs */
-    for (i = 0, p = text; *p; i++) {
-        GET_UTF8(code, *p++, continue;);
-
-        /* get glyph */
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-        if (!glyph) {
-            ret = load_glyph(ctx, &glyph, code);
-            if (ret < 0)
-                return ret;
-        }
-
-        y_min = FFMIN(glyph->bbox.yMin, y_min);
-        y_max = FFMAX(glyph->bbox.yMax, y_max);
-        x_min = FFMIN(glyph->bbox.xMin, x_min);
-        x_max = FFMAX(glyph->bbox.xMax, x_max);
-    }
-    s->max_glyph_h = y_max - y_min;
-    s->max_glyph_w = x_max - x_min;
-
-    /* compute and save position for each glyph */
-    glyph = NULL;
-    for (i = 0, p = text; *p; i++) {
-        GET_UTF8(code, *p++, continue;);
-
-        /* skip the \n in the sequence \r\n */
-        if (prev_code == '\r' && code == '\n')
-            continue;
-
-        prev_code = code;
-        if (is_newline(code)) {
-
-            max_text_line_w = FFMAX(max_text_line_w, x);
-            y += s->max_glyph_h;
-            x = 0;
-            continue;
-        }
-
-        /* get glyph */
-        prev_glyph = glyph;
-        dummy.code = code;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-
-        /* kerning */
-        if (s->use_kerning && prev_glyph && glyph->code) {
-            FT_Get_Kerning(s->face, prev_glyph->code, glyph->code,
-                           ft_kerning_default, &delta);
-            x += delta.x >> 6;
-        }
-
-        /* save position */
-        s->positions[i].x = x + glyph->bitmap_left;
-        s->positions[i].y = y - glyph->bitmap_top + y_max;
-        if (code == '\t') x  = (x / s->tabsize + 1)*s->tabsize;
-        else              x += glyph->advance;
+    /* the layout and the rendered text only depend on the expanded text */
+    if (!s->layout_text || strcmp(s->layout_text, text)) {
+        if ((ret = layout_text(ctx)) < 0)
+            return ret;
     }
 
-    max_text_line_w = FFMAX(x, max_text_line_w);
-
-    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = max_text_line_w;
-    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = y + s->max_glyph_h;
+    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = s->text_w;
+    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = s->text_h;
 
     s->var_values[VAR_MAX_GLYPH_W] = s->max_glyph_w;
     s->var_values[VAR_MAX_GLYPH_H] = s->max_glyph_h;
-    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = y_max;
-    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = y_min;
+    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = s->max_glyph_a;
+    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = s->max_glyph_d;
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
@@ -1296,8 +1476,8 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     update_color_with_alpha(s, &bordercolor, s->bordercolor);
     update_color_with_alpha(s, &boxcolor   , s->boxcolor   );
 
-    box_w = FFMIN(width - 1 , max_text_line_w);
-    box_h = FFMIN(height - 1, y + s->max_glyph_h);
+    box_w = FFMIN(width - 1 , s->text_w);
+    box_h = FFMIN(height - 1, s->text_h);
 
     /* draw box */
     if (s->draw_box)
@@ -1306,20 +1486,16 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
                            s->x - s->boxborderw, s->y - s->boxborderw,
                            box_w + s->boxborderw * 2, box_h + s->boxborderw * 2);
 
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
-    }
+    if (s->shadowx || s->shadowy)
+        draw_text_mask(s, frame, width, height, &shadowcolor,
+                       &s->text_mask, s->shadowx, s->shadowy);
 
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
-    }
-    if ((ret = draw_glyphs(s, frame, width, height,
-                           &fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    if (s->borderw)
+        draw_text_mask(s, frame, width, height, &bordercolor,
+                       &s->border_mask, 0, 0);
+
+    draw_text_mask(s, frame, width, height, &fontcolor,
+                   &s->text_mask, 0, 0);
 
     return 0;
 }
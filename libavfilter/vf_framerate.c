@@ -36,6 +36,7 @@
 #include "libavutil/pixelutils.h"
 
 #include "avfilter.h"
+#include "framerate.h"
 #include "internal.h"
 #include "video.h"
 
@@ -73,8 +74,11 @@ typedef struct FrameRateContext {
     int64_t srce_pts_dest[N_SRCE];      ///< pts for source frames scaled to output timebase
     int64_t pts;                        ///< pts of frame we are working on
 
-    int (*blend_frames)(AVFilterContext *ctx, float interpolate,
-                        AVFrame *copy_src1, AVFrame *copy_src2);
+    FrameRateDSPContext dsp;
+    framerate_blend_func blend;         ///< blend function for the input bit depth
+    framerate_blend_func blend_c;       ///< C blend function for the columns left over by blend
+    int64_t *sad_slices;                ///< per slice SAD of the scene score (scene detect only)
+    int nb_threads;
     int max;
     int bitdepth;
     AVFrame *work;
@@ -120,56 +124,116 @@ static void next_source(AVFilterContext *ctx)
     s->srce[s->frst] = NULL;
 }
 
-static av_always_inline int64_t sad_8x8_16(const uint16_t *src1, ptrdiff_t stride1,
-                                           const uint16_t *src2, ptrdiff_t stride2)
+static void blend_frames8_c(const uint8_t *src1, ptrdiff_t src1_linesize,
+                            const uint8_t *src2, ptrdiff_t src2_linesize,
+                            uint8_t *dst, ptrdiff_t dst_linesize,
+                            ptrdiff_t width, ptrdiff_t height,
+                            int factor1, int factor2, int half, int shift)
 {
-    int sum = 0;
+    int line, pixel;
+
+    for (line = 0; line < height; line++) {
+        for (pixel = 0; pixel < width; pixel++)
+            dst[pixel] = ((src1[pixel] * factor1) + (src2[pixel] * factor2) + half) >> shift;
+        src1 += src1_linesize;
+        src2 += src2_linesize;
+        dst  += dst_linesize;
+    }
+}
+
+static void blend_frames16_c(const uint8_t *_src1, ptrdiff_t src1_linesize,
+                             const uint8_t *_src2, ptrdiff_t src2_linesize,
+                             uint8_t *_dst, ptrdiff_t dst_linesize,
+                             ptrdiff_t width, ptrdiff_t height,
+                             int factor1, int factor2, int half, int shift)
+{
+    const uint16_t *src1 = (const uint16_t *)_src1;
+    const uint16_t *src2 = (const uint16_t *)_src2;
+    uint16_t *dst = (uint16_t *)_dst;
+    int line, pixel;
+
+    src1_linesize /= 2;
+    src2_linesize /= 2;
+    dst_linesize  /= 2;
+
+    for (line = 0; line < height; line++) {
+        for (pixel = 0; pixel < width; pixel++)
+            dst[pixel] = ((src1[pixel] * factor1) + (src2[pixel] * factor2) + half) >> shift;
+        src1 += src1_linesize;
+        src2 += src2_linesize;
+        dst  += dst_linesize;
+    }
+}
+
+static int64_t sad16_c(const uint8_t *_src1, ptrdiff_t src1_linesize,
+                       const uint8_t *_src2, ptrdiff_t src2_linesize,
+                       ptrdiff_t width, ptrdiff_t height)
+{
+    const uint16_t *src1 = (const uint16_t *)_src1;
+    const uint16_t *src2 = (const uint16_t *)_src2;
+    int64_t sum = 0;
     int x, y;
 
-    for (y = 0; y < 8; y++) {
-        for (x = 0; x < 8; x++)
-            sum += FFABS(src1[x] - src2[x]);
-        src1 += stride1;
-        src2 += stride2;
+    src1_linesize /= 2;
+    src2_linesize /= 2;
+
+    for (y = 0; y < height; y++) {
+        int row = 0;
+        for (x = 0; x < width; x++)
+            row += FFABS(src1[x] - src2[x]);
+        sum  += row;
+        src1 += src1_linesize;
+        src2 += src2_linesize;
     }
     return sum;
 }
 
-static double get_scene_score16(AVFilterContext *ctx, AVFrame *crnt, AVFrame *next)
+av_cold void ff_framerate_dsp_init(FrameRateDSPContext *dsp)
 {
-    FrameRateContext *s = ctx->priv;
-    double ret = 0;
+    dsp->blend8  = blend_frames8_c;
+    dsp->blend16 = blend_frames16_c;
+    dsp->sad16   = sad16_c;
 
-    ff_dlog(ctx, "get_scene_score16()\n");
+    if (ARCH_X86)
+        ff_framerate_dsp_init_x86(dsp);
+}
 
-    if (crnt &&
-        crnt->height == next->height &&
-        crnt->width  == next->width) {
-        int x, y;
-        int64_t sad;
-        double mafd, diff;
-        const uint16_t *p1 = (const uint16_t *)crnt->data[0];
-        const uint16_t *p2 = (const uint16_t *)next->data[0];
-        const int p1_linesize = crnt->linesize[0] / 2;
-        const int p2_linesize = next->linesize[0] / 2;
-
-        ff_dlog(ctx, "get_scene_score16() process\n");
-
-        for (sad = y = 0; y < crnt->height; y += 8) {
-            for (x = 0; x < p1_linesize; x += 8) {
-                sad += sad_8x8_16(p1 + y * p1_linesize + x,
-                                  p1_linesize,
-                                  p2 + y * p2_linesize + x,
-                                  p2_linesize);
-            }
+typedef struct ThreadData {
+    AVFrame *copy_src1, *copy_src2;
+    uint16_t src1_factor, src2_factor;
+} ThreadData;
+
+static int scene_sad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    FrameRateContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *crnt = td->copy_src1;
+    const AVFrame *next = td->copy_src2;
+    const int nb_blocks = (crnt->height + 7) >> 3;
+    const int slice_start = (nb_blocks *  jobnr     ) / nb_jobs * 8;
+    const int slice_end   = (nb_blocks * (jobnr + 1)) / nb_jobs * 8;
+    const int p1_linesize = crnt->linesize[0];
+    const int p2_linesize = next->linesize[0];
+    const uint8_t *p1 = crnt->data[0] + slice_start * p1_linesize;
+    const uint8_t *p2 = next->data[0] + slice_start * p2_linesize;
+    int64_t sad = 0;
+    int x, y;
+
+    if (s->bitdepth == 8) {
+        for (y = slice_start; y < slice_end; y += 8) {
+            for (x = 0; x < p1_linesize; x += 8)
+                sad += s->sad(p1 + x, p1_linesize, p2 + x, p2_linesize);
+            p1 += 8 * p1_linesize;
+            p2 += 8 * p2_linesize;
         }
-        mafd = sad / (crnt->height * crnt->width * 3);
-        diff = fabs(mafd - s->prev_mafd);
-        ret  = av_clipf(FFMIN(mafd, diff), 0, 100.0);
-        s->prev_mafd = mafd;
+        emms_c();
+    } else {
+        sad = s->dsp.sad16(p1, p1_linesize, p2, p2_linesize,
+                           FFALIGN(p1_linesize / 2, 8), slice_end - slice_start);
     }
-    ff_dlog(ctx, "get_scene_score16() result is:%f\n", ret);
-    return ret;
+    s->sad_slices[jobnr] = sad;
+
+    return 0;
 }
 
 static double get_scene_score(AVFilterContext *ctx, AVFrame *crnt, AVFrame *next)
@@ -182,100 +246,77 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *crnt, AVFrame *next
     if (crnt &&
         crnt->height == next->height &&
         crnt->width  == next->width) {
-        int x, y;
+        ThreadData td;
         int64_t sad;
         double mafd, diff;
-        uint8_t *p1 = crnt->data[0];
-        uint8_t *p2 = next->data[0];
-        const int p1_linesize = crnt->linesize[0];
-        const int p2_linesize = next->linesize[0];
+        int i, nb_jobs = FFMIN((crnt->height + 7) >> 3, s->nb_threads);
 
         ff_dlog(ctx, "get_scene_score() process\n");
 
-        for (sad = y = 0; y < crnt->height; y += 8) {
-            for (x = 0; x < p1_linesize; x += 8) {
-                sad += s->sad(p1 + y * p1_linesize + x,
-                              p1_linesize,
-                              p2 + y * p2_linesize + x,
-                              p2_linesize);
-            }
-        }
-        emms_c();
+        td.copy_src1 = crnt;
+        td.copy_src2 = next;
+        ctx->internal->execute(ctx, scene_sad_slice, &td, NULL, nb_jobs);
+        for (sad = i = 0; i < nb_jobs; i++)
+            sad += s->sad_slices[i];
+
         mafd = sad / (crnt->height * crnt->width * 3);
         diff = fabs(mafd - s->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff), 0, 100.0);
         s->prev_mafd = mafd;
     }
-        ff_dlog(ctx, "get_scene_score() result is:%f\n", ret);
+    ff_dlog(ctx, "get_scene_score() result is:%f\n", ret);
     return ret;
 }
 
-static int blend_frames16(AVFilterContext *ctx, float interpolate,
-                          AVFrame *copy_src1, AVFrame *copy_src2)
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     FrameRateContext *s = ctx->priv;
-    AVFilterLink *outlink = ctx->outputs[0];
-    double interpolate_scene_score = 0;
+    ThreadData *td = arg;
+    const int bpp = s->bitdepth > 8 ? 2 : 1;
+    const int half = s->max / 2;
+    const int shift = s->bitdepth;
+    int plane;
 
-    if ((s->flags & FRAMERATE_FLAG_SCD) && copy_src2) {
-        interpolate_scene_score = get_scene_score16(ctx, copy_src1, copy_src2);
-        ff_dlog(ctx, "blend_frames16() interpolate scene score:%f\n", interpolate_scene_score);
+    for (plane = 0; plane < 4 && td->copy_src1->data[plane] && td->copy_src2->data[plane]; plane++) {
+        int cpy_line_width = s->line_size[plane] / bpp;
+        int cpy_simd_width = cpy_line_width & ~31;
+        int cpy_src_h = (plane > 0 && plane < 3) ? AV_CEIL_RSHIFT(td->copy_src1->height, s->vsub) : (td->copy_src1->height);
+        int slice_start = (cpy_src_h *  jobnr     ) / nb_jobs;
+        int slice_end   = (cpy_src_h * (jobnr + 1)) / nb_jobs;
+        int cpy_src1_line_size = td->copy_src1->linesize[plane];
+        int cpy_src2_line_size = td->copy_src2->linesize[plane];
+        int cpy_dst_line_size = s->work->linesize[plane];
+        const uint8_t *cpy_src1_data = td->copy_src1->data[plane] + slice_start * cpy_src1_line_size;
+        const uint8_t *cpy_src2_data = td->copy_src2->data[plane] + slice_start * cpy_src2_line_size;
+        uint8_t *cpy_dst_data = s->work->data[plane] + slice_start * cpy_dst_line_size;
+
+        // the SIMD blend always processes at least one row, and small
+        // chroma planes leave some of the slices empty
+        if (slice_end <= slice_start)
+            continue;
+
+        // chroma is blended with the same formula as luma: with the two
+        // factors adding up to 1 << shift the offsets around the chroma
+        // midpoint cancel out
+        if (cpy_simd_width)
+            s->blend(cpy_src1_data, cpy_src1_line_size,
+                     cpy_src2_data, cpy_src2_line_size,
+                     cpy_dst_data, cpy_dst_line_size,
+                     cpy_simd_width, slice_end - slice_start,
+                     td->src1_factor, td->src2_factor, half, shift);
+        if (cpy_line_width > cpy_simd_width)
+            s->blend_c(cpy_src1_data + cpy_simd_width * bpp, cpy_src1_line_size,
+                       cpy_src2_data + cpy_simd_width * bpp, cpy_src2_line_size,
+                       cpy_dst_data + cpy_simd_width * bpp, cpy_dst_line_size,
+                       cpy_line_width - cpy_simd_width, slice_end - slice_start,
+                       td->src1_factor, td->src2_factor, half, shift);
     }
-    // decide if the shot-change detection allows us to blend two frames
-    if (interpolate_scene_score < s->scene_score && copy_src2) {
-        uint16_t src2_factor = fabsf(interpolate) * (1 << (s->bitdepth - 8));
-        uint16_t src1_factor = s->max - src2_factor;
-        const int half = s->max / 2;
-        const int uv = (s->max + 1) * half;
-        const int shift = s->bitdepth;
-        int plane, line, pixel;
-
-        // get work-space for output frame
-        s->work = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-        if (!s->work)
-            return AVERROR(ENOMEM);
 
-        av_frame_copy_props(s->work, s->srce[s->crnt]);
-
-        ff_dlog(ctx, "blend_frames16() INTERPOLATE to create work frame\n");
-        for (plane = 0; plane < 4 && copy_src1->data[plane] && copy_src2->data[plane]; plane++) {
-            int cpy_line_width = s->line_size[plane];
-            const uint16_t *cpy_src1_data = (const uint16_t *)copy_src1->data[plane];
-            int cpy_src1_line_size = copy_src1->linesize[plane] / 2;
-            const uint16_t *cpy_src2_data = (const uint16_t *)copy_src2->data[plane];
-            int cpy_src2_line_size = copy_src2->linesize[plane] / 2;
-            int cpy_src_h = (plane > 0 && plane < 3) ? (copy_src1->height >> s->vsub) : (copy_src1->height);
-            uint16_t *cpy_dst_data = (uint16_t *)s->work->data[plane];
-            int cpy_dst_line_size = s->work->linesize[plane] / 2;
-
-            if (plane <1 || plane >2) {
-                // luma or alpha
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++)
-                        cpy_dst_data[pixel] = ((cpy_src1_data[pixel] * src1_factor) + (cpy_src2_data[pixel] * src2_factor) + half) >> shift;
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            } else {
-                // chroma
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++) {
-                        cpy_dst_data[pixel] = (((cpy_src1_data[pixel] - half) * src1_factor) + ((cpy_src2_data[pixel] - half) * src2_factor) + uv) >> shift;
-                    }
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            }
-        }
-        return 1;
-    }
     return 0;
 }
 
-static int blend_frames8(AVFilterContext *ctx, float interpolate,
-                         AVFrame *copy_src1, AVFrame *copy_src2)
+static int blend_frames(AVFilterContext *ctx, float interpolate,
+                        AVFrame *copy_src1, AVFrame *copy_src2)
 {
     FrameRateContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
@@ -283,13 +324,16 @@ static int blend_frames8(AVFilterContext *ctx, float interpolate,
 
     if ((s->flags & FRAMERATE_FLAG_SCD) && copy_src2) {
         interpolate_scene_score = get_scene_score(ctx, copy_src1, copy_src2);
-        ff_dlog(ctx, "blend_frames8() interpolate scene score:%f\n", interpolate_scene_score);
+        ff_dlog(ctx, "blend_frames() interpolate scene score:%f\n", interpolate_scene_score);
     }
     // decide if the shot-change detection allows us to blend two frames
     if (interpolate_scene_score < s->scene_score && copy_src2) {
-        uint16_t src2_factor = fabsf(interpolate);
-        uint16_t src1_factor = 256 - src2_factor;
-        int plane, line, pixel;
+        ThreadData td;
+
+        td.copy_src1 = copy_src1;
+        td.copy_src2 = copy_src2;
+        td.src2_factor = fabsf(interpolate) * (1 << (s->bitdepth - 8));
+        td.src1_factor = s->max - td.src2_factor;
 
         // get work-space for output frame
         s->work = ff_get_video_buffer(outlink, outlink->w, outlink->h);
@@ -298,44 +342,9 @@ static int blend_frames8(AVFilterContext *ctx, float interpolate,
 
         av_frame_copy_props(s->work, s->srce[s->crnt]);
 
-        ff_dlog(ctx, "blend_frames8() INTERPOLATE to create work frame\n");
-        for (plane = 0; plane < 4 && copy_src1->data[plane] && copy_src2->data[plane]; plane++) {
-            int cpy_line_width = s->line_size[plane];
-            uint8_t *cpy_src1_data = copy_src1->data[plane];
-            int cpy_src1_line_size = copy_src1->linesize[plane];
-            uint8_t *cpy_src2_data = copy_src2->data[plane];
-            int cpy_src2_line_size = copy_src2->linesize[plane];
-            int cpy_src_h = (plane > 0 && plane < 3) ? (copy_src1->height >> s->vsub) : (copy_src1->height);
-            uint8_t *cpy_dst_data = s->work->data[plane];
-            int cpy_dst_line_size = s->work->linesize[plane];
-            if (plane <1 || plane >2) {
-                // luma or alpha
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++) {
-                        // integer version of (src1 * src1_factor) + (src2 + src2_factor) + 0.5
-                        // 0.5 is for rounding
-                        // 128 is the integer representation of 0.5 << 8
-                        cpy_dst_data[pixel] = ((cpy_src1_data[pixel] * src1_factor) + (cpy_src2_data[pixel] * src2_factor) + 128) >> 8;
-                    }
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            } else {
-                // chroma
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++) {
-                        // as above
-                        // because U and V are based around 128 we have to subtract 128 from the components.
-                        // 32896 is the integer representation of 128.5 << 8
-                        cpy_dst_data[pixel] = (((cpy_src1_data[pixel] - 128) * src1_factor) + ((cpy_src2_data[pixel] - 128) * src2_factor) + 32896) >> 8;
-                    }
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            }
-        }
+        ff_dlog(ctx, "blend_frames() INTERPOLATE to create work frame\n");
+        ctx->internal->execute(ctx, blend_slice, &td, NULL,
+                               FFMIN(outlink->h, s->nb_threads));
         return 1;
     }
     return 0;
@@ -411,7 +420,7 @@ static int process_work_frame(AVFilterContext *ctx, int stop)
             ff_dlog(ctx, "process_work_frame() interpolate source is:PREV\n");
             copy_src2 = s->srce[s->prev];
         }
-        if (s->blend_frames(ctx, interpolate, copy_src1, copy_src2))
+        if (blend_frames(ctx, interpolate, copy_src1, copy_src2))
             goto copy_done;
         else
             ff_dlog(ctx, "process_work_frame() CUT - DON'T INTERPOLATE\n");
@@ -531,6 +540,7 @@ static av_cold void uninit(AVFilterContext *ctx)
             av_frame_free(&s->srce[i]);
     }
     av_frame_free(&s->srce[s->last]);
+    av_freep(&s->sad_slices);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -575,10 +585,20 @@ static int config_input(AVFilterLink *inlink)
 
     s->srce_time_base = inlink->time_base;
 
-    if (s->bitdepth == 8)
-        s->blend_frames = blend_frames8;
-    else
-        s->blend_frames = blend_frames16;
+    s->nb_threads = FFMAX(1, ctx->graph->nb_threads);
+    av_freep(&s->sad_slices);
+    s->sad_slices = av_malloc_array(s->nb_threads, sizeof(*s->sad_slices));
+    if (!s->sad_slices)
+        return AVERROR(ENOMEM);
+
+    ff_framerate_dsp_init(&s->dsp);
+    if (s->bitdepth == 8) {
+        s->blend   = s->dsp.blend8;
+        s->blend_c = blend_frames8_c;
+    } else {
+        s->blend   = s->dsp.blend16;
+        s->blend_c = blend_frames16_c;
+    }
     s->max = 1 << (s->bitdepth);
 
     return 0;
@@ -728,4 +748,5 @@ AVFilter ff_vf_framerate = {
     .query_formats = query_formats,
     .inputs        = framerate_inputs,
     .outputs       = framerate_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -85,6 +85,7 @@ typedef struct PadContext {
     char *h_expr;           ///< height expression string
     char *x_expr;           ///< width  expression string
     char *y_expr;           ///< height expression string
+    int buf_w, buf_h;       ///< size of the frames requested from the output link
     uint8_t rgba_color[4];  ///< color for the padding area
     FFDrawContext draw;
     FFDrawColor color;
@@ -178,6 +179,9 @@ static int config_input(AVFilterLink *inlink)
         return AVERROR(EINVAL);
     }
 
+    s->buf_w = s->w;
+    s->buf_h = s->h + (s->x > 0);
+
     return 0;
 
 eval_fail:
@@ -199,12 +203,15 @@ static int config_output(AVFilterLink *outlink)
 static AVFrame *get_video_buffer(AVFilterLink *inlink, int w, int h)
 {
     PadContext *s = inlink->dst->priv;
-
-    AVFrame *frame = ff_get_video_buffer(inlink->dst->outputs[0],
-                                         w + (s->w - s->in_w),
-                                         h + (s->h - s->in_h) + (s->x > 0));
+    AVFrame *frame;
     int plane;
 
+    /* Request the same size for direct and copied frames, so that the
+     * output link pool is not reallocated when the two alternate. */
+    s->buf_w = FFMAX(s->buf_w, w + (s->w - s->in_w));
+    s->buf_h = FFMAX(s->buf_h, h + (s->h - s->in_h) + (s->x > 0));
+
+    frame = ff_get_video_buffer(inlink->dst->outputs[0], s->buf_w, s->buf_h);
     if (!frame)
         return NULL;
 
@@ -295,9 +302,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 
     if (needs_copy) {
         av_log(inlink->dst, AV_LOG_DEBUG, "Direct padding impossible allocating new frame\n");
-        out = ff_get_video_buffer(inlink->dst->outputs[0],
-                                  FFMAX(inlink->w, s->w),
-                                  FFMAX(inlink->h, s->h));
+        out = ff_get_video_buffer(inlink->dst->outputs[0], s->buf_w, s->buf_h);
         if (!out) {
             av_frame_free(&in);
             return AVERROR(ENOMEM);
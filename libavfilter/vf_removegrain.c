@@ -463,54 +463,97 @@ static int mode24(int c, int a1, int a2, int a3, int a4, int a5, int a6, int a7,
     return c - u + d;  // This probably will never overflow.
 }
 
-static int config_input(AVFilterLink *inlink)
+#define REMOVE_GRAIN_LINE(name)                                                   \
+static void name##_line(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels) \
+{                                                                                 \
+    int x;                                                                        \
+                                                                                  \
+    for (x = 0; x < pixels; x++)                                                  \
+        dst[x] = name(src[x], src[x - stride - 1], src[x - stride],               \
+                      src[x - stride + 1], src[x - 1], src[x + 1],                \
+                      src[x + stride - 1], src[x + stride], src[x + stride + 1]); \
+}
+
+REMOVE_GRAIN_LINE(mode01)
+REMOVE_GRAIN_LINE(mode02)
+REMOVE_GRAIN_LINE(mode03)
+REMOVE_GRAIN_LINE(mode04)
+REMOVE_GRAIN_LINE(mode05)
+REMOVE_GRAIN_LINE(mode06)
+REMOVE_GRAIN_LINE(mode07)
+REMOVE_GRAIN_LINE(mode08)
+REMOVE_GRAIN_LINE(mode09)
+REMOVE_GRAIN_LINE(mode10)
+REMOVE_GRAIN_LINE(mode1112)
+REMOVE_GRAIN_LINE(mode1314)
+REMOVE_GRAIN_LINE(mode1516)
+REMOVE_GRAIN_LINE(mode17)
+REMOVE_GRAIN_LINE(mode18)
+REMOVE_GRAIN_LINE(mode19)
+REMOVE_GRAIN_LINE(mode20)
+REMOVE_GRAIN_LINE(mode21)
+REMOVE_GRAIN_LINE(mode22)
+REMOVE_GRAIN_LINE(mode23)
+REMOVE_GRAIN_LINE(mode24)
+
+#define SET_MODE(name)            \
+    s->rg[i] = name;              \
+    s->fl[i] = name##_line;
+
+av_cold void ff_removegrain_init(RemoveGrainContext *s)
 {
-    RemoveGrainContext *s = inlink->dst->priv;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     int i;
 
-    s->nb_planes = av_pix_fmt_count_planes(inlink->format);
-
-    s->planeheight[1] = s->planeheight[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
-    s->planeheight[0] = s->planeheight[3] = inlink->h;
-    s->planewidth[1]  = s->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, desc->log2_chroma_w);
-    s->planewidth[0]  = s->planewidth[3]  = inlink->w;
-
     for (i = 0; i < s->nb_planes; i++) {
         switch (s->mode[i]) {
-        case 1:  s->rg[i] = mode01;   break;
-        case 2:  s->rg[i] = mode02;   break;
-        case 3:  s->rg[i] = mode03;   break;
-        case 4:  s->rg[i] = mode04;   break;
-        case 5:  s->rg[i] = mode05;   break;
-        case 6:  s->rg[i] = mode06;   break;
-        case 7:  s->rg[i] = mode07;   break;
-        case 8:  s->rg[i] = mode08;   break;
-        case 9:  s->rg[i] = mode09;   break;
-        case 10: s->rg[i] = mode10;   break;
-        case 11: s->rg[i] = mode1112; break;
-        case 12: s->rg[i] = mode1112; break;
+        case 1:  SET_MODE(mode01);   break;
+        case 2:  SET_MODE(mode02);   break;
+        case 3:  SET_MODE(mode03);   break;
+        case 4:  SET_MODE(mode04);   break;
+        case 5:  SET_MODE(mode05);   break;
+        case 6:  SET_MODE(mode06);   break;
+        case 7:  SET_MODE(mode07);   break;
+        case 8:  SET_MODE(mode08);   break;
+        case 9:  SET_MODE(mode09);   break;
+        case 10: SET_MODE(mode10);   break;
+        case 11: SET_MODE(mode1112); break;
+        case 12: SET_MODE(mode1112); break;
         case 13: s->skip_odd = 1;
-                 s->rg[i] = mode1314; break;
+                 SET_MODE(mode1314); break;
         case 14: s->skip_even = 1;
-                 s->rg[i] = mode1314; break;
+                 SET_MODE(mode1314); break;
         case 15: s->skip_odd = 1;
-                 s->rg[i] = mode1516; break;
+                 SET_MODE(mode1516); break;
         case 16: s->skip_even = 1;
-                 s->rg[i] = mode1516; break;
-        case 17: s->rg[i] = mode17;   break;
-        case 18: s->rg[i] = mode18;   break;
-        case 19: s->rg[i] = mode19;   break;
-        case 20: s->rg[i] = mode20;   break;
-        case 21: s->rg[i] = mode21;   break;
-        case 22: s->rg[i] = mode22;   break;
-        case 23: s->rg[i] = mode23;   break;
-        case 24: s->rg[i] = mode24;   break;
+                 SET_MODE(mode1516); break;
+        case 17: SET_MODE(mode17);   break;
+        case 18: SET_MODE(mode18);   break;
+        case 19: SET_MODE(mode19);   break;
+        case 20: SET_MODE(mode20);   break;
+        case 21: SET_MODE(mode21);   break;
+        case 22: SET_MODE(mode22);   break;
+        case 23: SET_MODE(mode23);   break;
+        case 24: SET_MODE(mode24);   break;
         }
     }
 
     if (ARCH_X86)
         ff_removegrain_init_x86(s);
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    RemoveGrainContext *s = inlink->dst->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+
+    s->nb_planes = av_pix_fmt_count_planes(inlink->format);
+
+    s->planeheight[1] = s->planeheight[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
+    s->planeheight[0] = s->planeheight[3] = inlink->h;
+    s->planewidth[1]  = s->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, desc->log2_chroma_w);
+    s->planewidth[0]  = s->planewidth[3]  = inlink->w;
+
+    ff_removegrain_init(s);
 
     return 0;
 }
@@ -531,6 +574,7 @@ static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
     const int om = in->linesize[i] - 1;
     const int o0 = in->linesize[i]    ;
     const int op = in->linesize[i] + 1;
+    const int w_asm = (s->planewidth[i] - 2) & ~15;
     int start = (height *  jobnr   ) / nb_jobs;
     int end   = (height * (jobnr+1)) / nb_jobs;
     int x, y;
@@ -555,16 +599,14 @@ static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 
         *dst++ = *src++;
 
-        if (s->fl[i]) {
-            int w_asm = (s->planewidth[i] - 2) & ~15;
-
+        x = 1;
+        if (w_asm) {
             s->fl[i](dst, src, in->linesize[i], w_asm);
 
-            x = 1 + w_asm;
+            x   += w_asm;
             dst += w_asm;
             src += w_asm;
-        } else
-            x = 1;
+        }
 
         for (; x < s->planewidth[i] - 1; x++) {
             const int a1 = src[-op];
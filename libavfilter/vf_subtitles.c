@@ -42,8 +42,23 @@
 #include "avfilter.h"
 #include "internal.h"
 #include "formats.h"
+#include "subtitles.h"
 #include "video.h"
 
+/**
+ * All the images returned by libass for a frame, composited into a single
+ * premultiplied overlay which is reused until libass reports a change.
+ */
+typedef struct AssOverlay {
+    int x, y;                   ///< position of the overlay, in luma pixels
+    int w[4], h[4];             ///< size of the overlay in each plane
+    int linesize[4];            ///< distance between rows, in elements
+    uint16_t *color[4];         ///< premultiplied color, 8.8 fixed point
+    uint16_t *transp[4];        ///< transparency, 0 (opaque) to 0xffff
+    uint8_t *buf;
+    unsigned buf_size;
+} AssOverlay;
+
 typedef struct {
     const AVClass *class;
     ASS_Library  *library;
@@ -59,6 +74,11 @@ typedef struct {
     int original_w, original_h;
     int shaping;
     FFDrawContext draw;
+    int nb_planes;             ///< number of non-alpha planes
+    int use_overlay;           ///< 1 if the frames are blended from the cached overlay
+    int overlay_valid;
+    AssOverlay overlay;
+    SubtitlesDSPContext dsp;
 } AssContext;
 
 #define OFFSET(x) offsetof(AssContext, x)
@@ -116,6 +136,8 @@ static av_cold int init(AVFilterContext *ctx)
         return AVERROR(EINVAL);
     }
 
+    ff_subtitles_dsp_init(&ass->dsp);
+
     return 0;
 }
 
@@ -123,6 +145,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     AssContext *ass = ctx->priv;
 
+    av_freep(&ass->overlay.buf);
+
     if (ass->track)
         ass_free_track(ass->track);
     if (ass->renderer)
@@ -139,9 +163,22 @@ static int query_formats(AVFilterContext *ctx)
 static int config_input(AVFilterLink *inlink)
 {
     AssContext *ass = inlink->dst->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    int i;
 
     ff_draw_init(&ass->draw, inlink->format, 0);
 
+    /* the cached overlay is used for planar 8-bit formats */
+    ass->nb_planes   = ass->draw.nb_planes - !!(desc->flags & AV_PIX_FMT_FLAG_ALPHA);
+    ass->use_overlay = 1;
+    for (i = 0; i < desc->nb_components; i++)
+        if (desc->comp[i].depth != 8)
+            ass->use_overlay = 0;
+    for (i = 0; i < ass->nb_planes; i++)
+        if (ass->draw.pixelstep[i] != 1 || ass->draw.hsub[i] > 1 || ass->draw.vsub[i] > 1)
+            ass->use_overlay = 0;
+    ass->overlay_valid = 0;
+
     ass_set_frame_size  (ass->renderer, inlink->w, inlink->h);
     if (ass->original_w && ass->original_h)
         ass_set_aspect_ratio(ass->renderer, (double)inlink->w / inlink->h,
@@ -173,6 +210,169 @@ static void overlay_ass_image(AssContext *ass, AVFrame *picref,
     }
 }
 
+static void blend_row_c(uint8_t *dst, const uint16_t *color,
+                        const uint16_t *transp, int w)
+{
+    int x;
+
+    for (x = 0; x < w; x++) {
+        unsigned v = ((dst[x] << 8) * (unsigned)transp[x] >> 16) + color[x] + 128;
+        dst[x] = FFMIN(v, 0xffff) >> 8;
+    }
+}
+
+av_cold void ff_subtitles_dsp_init(SubtitlesDSPContext *dsp)
+{
+    dsp->blend_row = blend_row_c;
+
+    if (ARCH_X86)
+        ff_subtitles_dsp_init_x86(dsp);
+}
+
+/**
+ * Composite an image over the overlay. Each pixel of a subsampled plane
+ * uses the average of the mask over the corresponding block, as
+ * ff_blend_mask() does.
+ */
+static void composite_image(AssContext *ass, const ASS_Image *image,
+                            int frame_w, int frame_h)
+{
+    AssOverlay *ov = &ass->overlay;
+    const unsigned alpha = AA(image->color);
+    const int x0 = FFMAX(image->dst_x, 0);
+    const int y0 = FFMAX(image->dst_y, 0);
+    const int x1 = FFMIN(image->dst_x + image->w, frame_w);
+    const int y1 = FFMIN(image->dst_y + image->h, frame_h);
+    uint8_t rgba_color[] = {AR(image->color), AG(image->color), AB(image->color), AA(image->color)};
+    FFDrawColor color;
+    int plane, x, y, px, py;
+
+    if (x0 >= x1 || y0 >= y1 || !alpha)
+        return;
+
+    ff_draw_color(&ass->draw, &color, rgba_color);
+
+    for (plane = 0; plane < ass->nb_planes; plane++) {
+        const int hsub = ass->draw.hsub[plane];
+        const int vsub = ass->draw.vsub[plane];
+        const unsigned c = color.comp[plane].u8[0] << 8;
+
+        for (py = y0 >> vsub; py < AV_CEIL_RSHIFT(y1, vsub); py++) {
+            const int row = (py - (ov->y >> vsub)) * ov->linesize[plane] - (ov->x >> hsub);
+            uint16_t *dst_color  = ov->color[plane]  + row;
+            uint16_t *dst_transp = ov->transp[plane] + row;
+
+            for (px = x0 >> hsub; px < AV_CEIL_RSHIFT(x1, hsub); px++) {
+                unsigned t = 0, a;
+
+                for (y = FFMAX(py << vsub, y0); y < FFMIN((py + 1) << vsub, y1); y++)
+                    for (x = FFMAX(px << hsub, x0); x < FFMIN((px + 1) << hsub, x1); x++)
+                        t += image->bitmap[(y - image->dst_y) * image->stride + x - image->dst_x];
+
+                /* coverage of the pixel, 0 to 0xffff */
+                a = ((t >> (hsub + vsub)) * alpha * 66049 + 32768) >> 16;
+                if (!a)
+                    continue;
+                dst_transp[px] = (dst_transp[px] * (0xffff - a) + 0x7fff) / 0xffff;
+                dst_color[px]  = (dst_color[px]  * (0xffff - a) + c * a + 0x7fff) / 0xffff;
+            }
+        }
+    }
+}
+
+static int render_overlay(AssContext *ass, const ASS_Image *images,
+                          int frame_w, int frame_h)
+{
+    AssOverlay *ov = &ass->overlay;
+    const ASS_Image *image;
+    int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+    size_t size = 0;
+    int plane, i;
+    uint16_t *p;
+
+    memset(ov->w, 0, sizeof(ov->w));
+    memset(ov->h, 0, sizeof(ov->h));
+
+    for (image = images; image; image = image->next) {
+        x0 = FFMIN(x0, image->dst_x);
+        y0 = FFMIN(y0, image->dst_y);
+        x1 = FFMAX(x1, image->dst_x + image->w);
+        y1 = FFMAX(y1, image->dst_y + image->h);
+    }
+    x0 = FFMAX(x0, 0);
+    y0 = FFMAX(y0, 0);
+    x1 = FFMIN(x1, frame_w);
+    y1 = FFMIN(y1, frame_h);
+    if (x0 >= x1 || y0 >= y1)
+        return 0;
+
+    /* start on a chroma sample, so that the planes stay aligned */
+    ov->x = x0 & ~((1 << ass->draw.hsub_max) - 1);
+    ov->y = y0 & ~((1 << ass->draw.vsub_max) - 1);
+
+    for (plane = 0; plane < ass->nb_planes; plane++) {
+        const int hsub = ass->draw.hsub[plane];
+        const int vsub = ass->draw.vsub[plane];
+
+        ov->w[plane] = AV_CEIL_RSHIFT(x1, hsub) - (ov->x >> hsub);
+        ov->h[plane] = AV_CEIL_RSHIFT(y1, vsub) - (ov->y >> vsub);
+        ov->linesize[plane] = FFALIGN(ov->w[plane], 8);
+        size += 2 * ov->linesize[plane] * ov->h[plane];
+    }
+
+    av_fast_malloc(&ov->buf, &ov->buf_size, size * sizeof(*p));
+    if (!ov->buf) {
+        memset(ov->h, 0, sizeof(ov->h));
+        return AVERROR(ENOMEM);
+    }
+
+    p = (uint16_t *)ov->buf;
+    for (plane = 0; plane < ass->nb_planes; plane++) {
+        const int n = ov->linesize[plane] * ov->h[plane];
+
+        ov->color[plane]  = p;
+        ov->transp[plane] = p + n;
+        memset(ov->color[plane], 0, n * sizeof(*p));
+        for (i = 0; i < n; i++)
+            ov->transp[plane][i] = 0xffff;
+        p += 2 * n;
+    }
+
+    for (image = images; image; image = image->next)
+        composite_image(ass, image, frame_w, frame_h);
+
+    return 0;
+}
+
+static int blend_overlay_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AssContext *ass = ctx->priv;
+    const AssOverlay *ov = &ass->overlay;
+    AVFrame *frame = arg;
+    int plane, y;
+
+    for (plane = 0; plane < ass->nb_planes; plane++) {
+        const int slice_start = (ov->h[plane] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (ov->h[plane] * (jobnr + 1)) / nb_jobs;
+        const int w  = ov->w[plane];
+        const int w8 = w & ~7;
+
+        for (y = slice_start; y < slice_end; y++) {
+            uint8_t *dst = frame->data[plane] +
+                           ((ov->y >> ass->draw.vsub[plane]) + y) * frame->linesize[plane] +
+                           (ov->x >> ass->draw.hsub[plane]);
+            const uint16_t *color  = ov->color[plane]  + y * ov->linesize[plane];
+            const uint16_t *transp = ov->transp[plane] + y * ov->linesize[plane];
+
+            if (w8)
+                ass->dsp.blend_row(dst, color, transp, w8);
+            blend_row_c(dst + w8, color + w8, transp + w8, w - w8);
+        }
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -182,11 +382,28 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
     double time_ms = picref->pts * av_q2d(inlink->time_base) * 1000;
     ASS_Image *image = ass_render_frame(ass->renderer, ass->track,
                                         time_ms, &detect_change);
+    int ret;
 
     if (detect_change)
         av_log(ctx, AV_LOG_DEBUG, "Change happened at time ms:%f\n", time_ms);
 
-    overlay_ass_image(ass, picref, image);
+    if (!ass->use_overlay) {
+        overlay_ass_image(ass, picref, image);
+        return ff_filter_frame(outlink, picref);
+    }
+
+    if (detect_change || !ass->overlay_valid) {
+        ass->overlay_valid = 0;
+        if ((ret = render_overlay(ass, image, inlink->w, inlink->h)) < 0) {
+            av_frame_free(&picref);
+            return ret;
+        }
+        ass->overlay_valid = 1;
+    }
+
+    if (ass->overlay.h[0])
+        ctx->internal->execute(ctx, blend_overlay_slice, picref, NULL,
+                               FFMIN(ass->overlay.h[0], ctx->graph->nb_threads));
 
     return ff_filter_frame(outlink, picref);
 }
@@ -254,6 +471,7 @@ AVFilter ff_vf_ass = {
     .inputs        = ass_inputs,
     .outputs       = ass_outputs,
     .priv_class    = &ass_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif
 
@@ -492,5 +710,6 @@ AVFilter ff_vf_subtitles = {
     .inputs        = ass_inputs,
     .outputs       = ass_outputs,
     .priv_class    = &subtitles_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif
@@ -48,16 +48,68 @@
 #include "unsharp.h"
 #include "unsharp_opencl.h"
 
-static void apply_unsharp(      uint8_t *dst, int dst_stride,
-                          const uint8_t *src, int src_stride,
-                          int width, int height, UnsharpFilterParam *fp)
+static void hblur_pass_c(uint32_t *buf, int len)
+{
+    int x;
+
+    for (x = 0; x < len; x++)
+        buf[x] += buf[x + 1];
+}
+
+static void vblur_c(uint32_t *acc, uint32_t *const *sc, int nb_stages, int width)
 {
-    uint32_t **sc = fp->sc;
-    uint32_t sr[MAX_MATRIX_SIZE - 1], tmp1, tmp2;
+    uint32_t tmp1, tmp2;
+    int x, z;
+
+    for (x = 0; x < width; x++) {
+        tmp1 = acc[x];
+        for (z = 0; z < nb_stages; z++) {
+            tmp2 = sc[z][x] + tmp1; sc[z][x] = tmp1;
+            tmp1 = tmp2;
+        }
+        acc[x] = tmp1;
+    }
+}
 
+static void sharpen_c(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                      int width, int amount, int scalebits, uint32_t halfscale)
+{
     int32_t res;
+    int x;
+
+    for (x = 0; x < width; x++) {
+        res = (int32_t)src[x] + ((((int32_t)src[x] - (int32_t)((blur[x] + halfscale) >> scalebits)) * amount) >> 16);
+        dst[x] = av_clip_uint8(res);
+    }
+}
+
+av_cold void ff_unsharp_dsp_init(UnsharpDSPContext *dsp)
+{
+    dsp->hblur_pass = hblur_pass_c;
+    dsp->vblur      = vblur_c;
+    dsp->sharpen    = sharpen_c;
+
+    if (ARCH_X86)
+        ff_unsharp_dsp_init_x86(dsp);
+}
+
+/**
+ * Filter the rows [slice_start, slice_end) of a plane. The blur is a
+ * separable binomial kernel with replicated borders; every slice primes
+ * its own vertical state from the rows above it, so slices are
+ * independent and the output does not depend on the slice layout.
+ */
+static void apply_unsharp(UnsharpContext *s,
+                                uint8_t *dst, int dst_stride,
+                          const uint8_t *src, int src_stride,
+                          int width, int height, int slice_start, int slice_end,
+                          UnsharpFilterParam *fp, int jobnr)
+{
+    const UnsharpDSPContext *dsp = &s->dsp;
+    uint32_t *sc[MAX_MATRIX_SIZE - 1];
+    uint32_t *buf;
+    const uint8_t *src2;
     int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
     const int amount = fp->amount;
     const int steps_x = fp->steps_x;
     const int steps_y = fp->steps_y;
@@ -65,47 +117,51 @@ static void apply_unsharp(      uint8_t *dst, int dst_stride,
     const int32_t halfscale = fp->halfscale;
 
     if (!amount) {
-        av_image_copy_plane(dst, dst_stride, src, src_stride, width, height);
+        av_image_copy_plane(dst + slice_start * dst_stride, dst_stride,
+                            src + slice_start * src_stride, src_stride,
+                            width, slice_end - slice_start);
         return;
     }
 
-    for (y = 0; y < 2 * steps_y; y++)
-        memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * steps_x));
-
-    for (y = -steps_y; y < height + steps_y; y++) {
-        if (y < height)
-            src2 = src;
-
-        memset(sr, 0, sizeof(sr[0]) * (2 * steps_x - 1));
-        for (x = -steps_x; x < width + steps_x; x++) {
-            tmp1 = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
-            for (z = 0; z < steps_x * 2; z += 2) {
-                tmp2 = sr[z + 0] + tmp1; sr[z + 0] = tmp1;
-                tmp1 = sr[z + 1] + tmp2; sr[z + 1] = tmp2;
-            }
-            for (z = 0; z < steps_y * 2; z += 2) {
-                tmp2 = sc[z + 0][x + steps_x] + tmp1; sc[z + 0][x + steps_x] = tmp1;
-                tmp1 = sc[z + 1][x + steps_x] + tmp2; sc[z + 1][x + steps_x] = tmp2;
-            }
-            if (x >= steps_x && y >= steps_y) {
-                const uint8_t *srx = src - steps_y * src_stride + x - steps_x;
-                uint8_t *dsx       = dst - steps_y * dst_stride + x - steps_x;
-
-                res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + halfscale) >> scalebits)) * amount) >> 16);
-                *dsx = av_clip_uint8(res);
-            }
+    buf = fp->sc + jobnr * (2 * steps_y + 1) * fp->sc_stride;
+    for (z = 0; z < 2 * steps_y; z++) {
+        sc[z] = buf + (z + 1) * fp->sc_stride;
+        memset(sc[z], 0, sizeof(sc[z][0]) * fp->sc_stride);
+    }
+
+    for (y = slice_start - steps_y; y < slice_end + steps_y; y++) {
+        src2 = src + av_clip(y, 0, height - 1) * src_stride;
+
+        for (x = 0; x < steps_x; x++) {
+            buf[x]                   = src2[0];
+            buf[width + steps_x + x] = src2[width - 1];
         }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
+        for (x = 0; x < width; x++)
+            buf[steps_x + x] = src2[x];
+        for (z = 0; z < 2 * steps_x; z++)
+            dsp->hblur_pass(buf, width + 2 * steps_x - 1 - z);
+
+        dsp->vblur(buf, sc, 2 * steps_y, width);
+
+        if (y >= slice_start + steps_y) {
+            const int yo = y - steps_y;
+            dsp->sharpen(dst + yo * dst_stride, src + yo * src_stride, buf,
+                         width, amount, scalebits, halfscale);
         }
     }
 }
 
-static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int unsharp_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     AVFilterLink *inlink = ctx->inputs[0];
     UnsharpContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in;
+    AVFrame *out = td->out;
     int i, plane_w[3], plane_h[3];
     UnsharpFilterParam *fp[3];
     plane_w[0] = inlink->w;
@@ -115,11 +171,28 @@ static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
     fp[0] = &s->luma;
     fp[1] = fp[2] = &s->chroma;
     for (i = 0; i < 3; i++) {
-        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i], plane_w[i], plane_h[i], fp[i]);
+        const int slice_start = (plane_h[i] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (plane_h[i] * (jobnr + 1)) / nb_jobs;
+
+        apply_unsharp(s, out->data[i], out->linesize[i], in->data[i], in->linesize[i],
+                      plane_w[i], plane_h[i], slice_start, slice_end, fp[i], jobnr);
     }
     return 0;
 }
 
+static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    AVFilterLink *inlink = ctx->inputs[0];
+    UnsharpContext *s = ctx->priv;
+    ThreadData td;
+
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, unsharp_slice, &td, NULL,
+                           FFMIN(inlink->h, s->nb_threads));
+    return 0;
+}
+
 static void set_filter_param(UnsharpFilterParam *fp, int msize_x, int msize_y, float amount)
 {
     fp->msize_x = msize_x;
@@ -141,6 +214,7 @@ static av_cold int init(AVFilterContext *ctx)
     set_filter_param(&s->luma,   s->lmsize_x, s->lmsize_y, s->lamount);
     set_filter_param(&s->chroma, s->cmsize_x, s->cmsize_y, s->camount);
 
+    ff_unsharp_dsp_init(&s->dsp);
     s->apply_unsharp = apply_unsharp_c;
     if (!CONFIG_OPENCL && s->opencl) {
         av_log(ctx, AV_LOG_ERROR, "OpenCL support was not enabled in this build, cannot be selected\n");
@@ -171,7 +245,7 @@ static int query_formats(AVFilterContext *ctx)
 
 static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type, int width)
 {
-    int z;
+    UnsharpContext *s = ctx->priv;
     const char *effect = fp->amount == 0 ? "none" : fp->amount < 0 ? "blur" : "sharpen";
 
     if  (!(fp->msize_x & fp->msize_y & 1)) {
@@ -184,10 +258,14 @@ static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const
     av_log(ctx, AV_LOG_VERBOSE, "effect:%s type:%s msize_x:%d msize_y:%d amount:%0.2f\n",
            effect, effect_type, fp->msize_x, fp->msize_y, fp->amount / 65535.0);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        if (!(fp->sc[z] = av_malloc_array(width + 2 * fp->steps_x,
-                                          sizeof(*(fp->sc[z])))))
-            return AVERROR(ENOMEM);
+    /* one row for the horizontal pass plus 2 * steps_y rows of vertical
+     * state per thread, padded so that SIMD code may overread */
+    fp->sc_stride = FFALIGN(width + 2 * fp->steps_x, 16) + 16;
+    av_freep(&fp->sc);
+    fp->sc = av_malloc_array((size_t)s->nb_threads * (2 * fp->steps_y + 1),
+                             fp->sc_stride * sizeof(*fp->sc));
+    if (!fp->sc)
+        return AVERROR(ENOMEM);
 
     return 0;
 }
@@ -200,6 +278,7 @@ static int config_props(AVFilterLink *link)
 
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
+    s->nb_threads = FFMAX(1, link->dst->graph->nb_threads);
 
     ret = init_filter_param(link->dst, &s->luma,   "luma",   link->w);
     if (ret < 0)
@@ -213,10 +292,7 @@ static int config_props(AVFilterLink *link)
 
 static void free_filter_param(UnsharpFilterParam *fp)
 {
-    int z;
-
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        av_freep(&fp->sc[z]);
+    av_freep(&fp->sc);
 }
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -310,5 +386,5 @@ AVFilter ff_vf_unsharp = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_unsharp_inputs,
     .outputs       = avfilter_vf_unsharp_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
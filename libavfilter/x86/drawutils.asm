@@ -0,0 +1,91 @@
+;*****************************************************************************
+;* x86-optimized functions for drawutils
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pd_0x1010101: times 4 dd 0x1010101
+pw_1:         times 8 dw 1
+
+SECTION .text
+
+; m0: mask values (dwords), m4: src, m5: alpha
+; dst = ((0x1010101 - mask * alpha) * dst + mask * alpha * src) >> 24
+%macro BLEND4 1 ; dst
+    pmovzxbd        m1, %1
+    pmulld          m0, m5
+    mova            m2, [pd_0x1010101]
+    psubd           m2, m0
+    pmulld          m1, m2
+    pmulld          m0, m4
+    paddd           m0, m1
+    psrld           m0, 24
+    packusdw        m0, m0
+    packuswb        m0, m0
+    movd            %1, m0
+%endmacro
+
+INIT_XMM sse4
+; void ff_blend_row8_sse4(uint8_t *dst, const uint8_t *mask, int w,
+;                         unsigned src, unsigned alpha)
+cglobal blend_row8, 5, 5, 6, dst, mask, w, src, alpha
+    movd            m4, srcd
+    movd            m5, alphad
+    pshufd          m4, m4, 0
+    pshufd          m5, m5, 0
+    movsxdifnidn    wq, wd
+    add           dstq, wq
+    add          maskq, wq
+    neg             wq
+.loop:
+    pmovzxbd        m0, [maskq + wq]
+    BLEND4 [dstq + wq]
+    add             wq, 4
+    jl .loop
+    RET
+
+; void ff_blend_row8_2x2_sse4(uint8_t *dst, const uint8_t *mask,
+;                             ptrdiff_t mask_linesize, int w,
+;                             unsigned src, unsigned alpha)
+cglobal blend_row8_2x2, 6, 7, 7, dst, mask, mask_linesize, w, src, alpha, mask2
+    movd            m4, srcd
+    movd            m5, alphad
+    pshufd          m4, m4, 0
+    pshufd          m5, m5, 0
+    pxor            m6, m6
+    movsxdifnidn    wq, wd
+    lea         mask2q, [maskq + mask_linesizeq]
+    add           dstq, wq
+    lea          maskq, [maskq  + 2 * wq]
+    lea         mask2q, [mask2q + 2 * wq]
+    neg             wq
+.loop:
+    movq            m0, [maskq  + 2 * wq]
+    movq            m1, [mask2q + 2 * wq]
+    punpcklbw       m0, m6
+    punpcklbw       m1, m6
+    paddw           m0, m1
+    pmaddwd         m0, [pw_1]          ; sum of each 2x2 block
+    psrld           m0, 2
+    BLEND4 [dstq + wq]
+    add             wq, 4
+    jl .loop
+    RET
@@ -0,0 +1,185 @@
+;*****************************************************************************
+;* x86-optimized functions for atadenoise filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_1: times 8 dw 1
+pd_1: times 4 dd 1
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; Loads the samples at %2 + x, widened to the lane size
+%macro LOAD_SAMPLES 2
+%if DEPTH == 8
+    movh             %1, [%2 + xq]
+    punpcklbw        %1, m8
+%else
+    pmovzxwd         %1, [%2 + xq * 2]
+%endif
+%endmacro
+
+; %1 = |m0 - %2|, %3 temp
+%macro ABS_DIFF_X 3
+%if DEPTH == 8
+    mova             %3, %2
+    psubusw          %3, m0
+    mova             %1, m0
+    psubusw          %1, %2
+    por              %1, %3
+%else
+    mova             %1, m0
+    psubd            %1, %2
+    pabsd            %1, %1
+%endif
+%endmacro
+
+; %1 frame index register, %2 diff sum register
+%macro FILTER_STEP 2
+    mov              pq, [srcfq + %1 * 8]
+    LOAD_SAMPLES     m9, pq
+    ABS_DIFF_X      m10, m9, m11
+    ADDX             %2, m10
+    CMPGTX          m10, m6
+    mova            m11, %2
+    CMPGTX          m11, m7
+    por             m10, m11
+    pandn           m10, m5
+    mova             m5, m10
+    pand             m9, m5
+    ADDX             m1, m9
+    SUBX             m2, m5
+%endmacro
+
+; void ff_atadenoise_filter_row<8|16>_<opt>(const uint8_t *src, uint8_t *dst,
+;                                           const uint8_t **srcf, int width,
+;                                           int mid, int size, int thra, int thrb)
+;
+; Every lane walks the frames outwards from mid like the C code does. A lane
+; stops for good at the first frame exceeding a threshold, which is tracked
+; with a mask; the walk ends early once no lane is left.
+;
+; m0: center samples   m1: sum            m2: count
+; m3: left diff sum    m4: right diff sum m5: lanes still active
+; m6: thra             m7: thrb           m8: zero
+%macro FILTER_ROW 1 ; depth
+%define DEPTH %1
+%if %1 == 8
+    %define LANES  mmsize / 2
+    %define ADDX   paddw
+    %define SUBX   psubw
+    %define CMPGTX pcmpgtw
+    %define THRMAX 0x7fff
+%else
+    %define LANES  mmsize / 4
+    %define ADDX   paddd
+    %define SUBX   psubd
+    %define CMPGTX pcmpgtd
+    %define THRMAX 0x7fffffff
+%endif
+
+cglobal atadenoise_filter_row%1, 8, 13, 12, src, dst, srcf, width, mid, size, thra, thrb, x, j, i, p, t
+    movsxdifnidn widthq, widthd
+    movsxdifnidn   midq, midd
+    movsxdifnidn  sizeq, sized
+    ; the thresholds are unsigned, larger ones can never be exceeded
+    mov              td, THRMAX
+    cmp           thrad, td
+    cmova         thrad, td
+    cmp           thrbd, td
+    cmova         thrbd, td
+    movd             m6, thrad
+    movd             m7, thrbd
+%if %1 == 8
+    SPLATW           m6, m6
+    SPLATW           m7, m7
+%else
+    SPLATD           m6
+    SPLATD           m7
+%endif
+    pxor             m8, m8
+    xor              xq, xq
+
+.loop_x:
+    LOAD_SAMPLES     m0, srcq
+    mova             m1, m0
+%if %1 == 8
+    mova             m2, [pw_1]
+%else
+    mova             m2, [pd_1]
+%endif
+    pxor             m3, m3
+    pxor             m4, m4
+    pcmpeqb          m5, m5
+    lea              jq, [midq - 1]
+    lea              iq, [midq + 1]
+
+.loop_frames:
+    test             jq, jq
+    jl .done
+    cmp              iq, sizeq
+    jge .done
+    FILTER_STEP      jq, m3
+    FILTER_STEP      iq, m4
+    dec              jq
+    inc              iq
+    pmovmskb         td, m5
+    test             td, td
+    jnz .loop_frames
+
+.done:
+%if %1 == 8
+    punpckhwd        m9, m1, m8
+    punpcklwd        m1, m8
+    punpckhwd       m10, m2, m8
+    punpcklwd        m2, m8
+    cvtdq2ps         m9, m9
+    cvtdq2ps        m10, m10
+%endif
+    cvtdq2ps         m1, m1
+    cvtdq2ps         m2, m2
+    divps            m1, m2
+    cvttps2dq        m1, m1
+%if %1 == 8
+    divps            m9, m10
+    cvttps2dq        m9, m9
+    packssdw         m1, m9
+    packuswb         m1, m1
+    movh    [dstq + xq], m1
+%else
+    packusdw         m1, m1
+    movh [dstq + xq * 2], m1
+%endif
+    add              xq, LANES
+    cmp              xq, widthq
+    jl .loop_x
+    RET
+%endmacro
+
+INIT_XMM sse2
+FILTER_ROW 8
+
+INIT_XMM sse4
+FILTER_ROW 16
+
+%endif ; ARCH_X86_64
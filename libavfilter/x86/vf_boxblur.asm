@@ -0,0 +1,115 @@
+;*****************************************************************************
+;* x86-optimized functions for boxblur filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or modify
+;* it under the terms of the GNU General Public License as published by
+;* the Free Software Foundation; either version 2 of the License, or
+;* (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;* GNU General Public License for more details.
+;*
+;* You should have received a copy of the GNU General Public License along
+;* with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+;* 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_255: times 8 dw 255
+
+SECTION .text
+
+; void ff_boxblur_blur_row8_sse2(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+;                                int32_t *sum, int width, int inv)
+INIT_XMM sse2
+cglobal boxblur_blur_row8, 5, 6, 8, dst, add, sub, sum, width, x
+    movd            m7, r5m
+    pshufd          m7, m7, 0          ; words: inv, 0, inv, 0, ...
+    pxor            m6, m6
+    movsxdifnidn widthq, widthd
+    xor             xq, xq
+.loop:
+    movu            m0, [addq + xq]
+    movu            m1, [subq + xq]
+    mova            m2, m0
+    mova            m3, m1
+    punpcklbw       m0, m6
+    punpckhbw       m2, m6
+    punpcklbw       m1, m6
+    punpckhbw       m3, m6
+    psubw           m0, m1             ; add - sub, columns 0-7
+    psubw           m2, m3             ; add - sub, columns 8-15
+    mova            m1, m0
+    mova            m3, m2
+    punpcklwd       m1, m1
+    punpckhwd       m0, m0
+    punpcklwd       m3, m3
+    punpckhwd       m2, m2
+    pmaddwd         m1, m7
+    pmaddwd         m0, m7
+    pmaddwd         m3, m7
+    pmaddwd         m2, m7
+    paddd           m1, [sumq + xq * 4]
+    paddd           m0, [sumq + xq * 4 + 16]
+    paddd           m3, [sumq + xq * 4 + 32]
+    paddd           m2, [sumq + xq * 4 + 48]
+    mova [sumq + xq * 4     ], m1
+    mova [sumq + xq * 4 + 16], m0
+    mova [sumq + xq * 4 + 32], m3
+    mova [sumq + xq * 4 + 48], m2
+    psrad           m1, 16
+    psrad           m0, 16
+    psrad           m3, 16
+    psrad           m2, 16
+    packssdw        m1, m0
+    packssdw        m3, m2
+    pand            m1, [pw_255]
+    pand            m3, [pw_255]
+    packuswb        m1, m3
+    movu  [dstq + xq], m1
+    add             xq, 16
+    cmp             xq, widthq
+    jl .loop
+    RET
+
+; void ff_boxblur_blur_row16_sse4(uint16_t *dst, const uint16_t *add, const uint16_t *sub,
+;                                 int32_t *sum, int width, int inv)
+INIT_XMM sse4
+cglobal boxblur_blur_row16, 5, 6, 8, dst, add, sub, sum, width, x
+    movd            m7, r5m
+    pshufd          m7, m7, 0
+    pxor            m6, m6
+    movsxdifnidn widthq, widthd
+    xor             xq, xq
+.loop:
+    movu            m0, [addq + xq * 2]
+    movu            m1, [subq + xq * 2]
+    mova            m2, m0
+    mova            m3, m1
+    punpcklwd       m0, m6
+    punpckhwd       m2, m6
+    punpcklwd       m1, m6
+    punpckhwd       m3, m6
+    psubd           m0, m1
+    psubd           m2, m3
+    pmulld          m0, m7
+    pmulld          m2, m7
+    paddd           m0, [sumq + xq * 4]
+    paddd           m2, [sumq + xq * 4 + 16]
+    mova [sumq + xq * 4     ], m0
+    mova [sumq + xq * 4 + 16], m2
+    psrld           m0, 16
+    psrld           m2, 16
+    packusdw        m0, m2
+    movu [dstq + xq * 2], m0
+    add             xq, 8
+    cmp             xq, widthq
+    jl .loop
+    RET
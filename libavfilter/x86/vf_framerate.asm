@@ -0,0 +1,185 @@
+;*****************************************************************************
+;* x86-optimized functions for framerate filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_1: times 8 dw 1
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; void ff_blend_frames<8|16>_<opt>(const uint8_t *src1, ptrdiff_t src1_linesize,
+;                                  const uint8_t *src2, ptrdiff_t src2_linesize,
+;                                  uint8_t *dst, ptrdiff_t dst_linesize,
+;                                  ptrdiff_t width, ptrdiff_t height,
+;                                  int factor1, int factor2, int half, int shift)
+%macro BLEND_INIT 1
+cglobal blend_frames%1, 8, 9, 10, src1, src1_linesize, src2, src2_linesize, dst, dst_linesize, width, height, x
+%if %1 == 16
+    add          widthq, widthq
+%endif
+    add           src1q, widthq
+    add           src2q, widthq
+    add            dstq, widthq
+    neg          widthq
+    movd            xm7, r11m           ; shift
+%endmacro
+
+%macro BLEND_END 0
+    add           src1q, src1_linesizeq
+    add           src2q, src2_linesizeq
+    add            dstq, dst_linesizeq
+    sub         heightd, 1
+    jg .nextrow
+    RET
+%endmacro
+
+; Bytes are widened to words. With factor1 + factor2 == 256 the weighted sum
+; plus rounding never exceeds 16 bits, so pmullw is exact.
+%macro BLEND_FRAMES8 0
+BLEND_INIT 8
+    movd            xm4, r8m            ; factor1
+    movd            xm5, r9m            ; factor2
+    movd            xm6, r10m           ; half
+    SPLATW           m4, xm4
+    SPLATW           m5, xm5
+    SPLATW           m6, xm6
+    pxor             m3, m3
+.nextrow:
+    mov              xq, widthq
+
+    .loop:
+        movu             m0, [src1q + xq]
+        movu             m2, [src2q + xq]
+        punpckhbw        m1, m0, m3
+        punpcklbw        m0, m3
+        punpckhbw        m8, m2, m3
+        punpcklbw        m2, m3
+        pmullw           m0, m4
+        pmullw           m1, m4
+        pmullw           m2, m5
+        pmullw           m8, m5
+        paddw            m0, m2
+        paddw            m1, m8
+        paddw            m0, m6
+        paddw            m1, m6
+        psrlw            m0, xm7
+        psrlw            m1, xm7
+        packuswb         m0, m1
+        movu    [dstq + xq], m0
+        add              xq, mmsize
+    jl .loop
+BLEND_END
+%endmacro
+
+; Samples of both sources are interleaved and weighted with a single pmaddwd
+; against interleaved factor1/factor2 words.
+%macro BLEND_FRAMES16 0
+BLEND_INIT 16
+    mov              xd, r9m            ; factor2
+    shl              xd, 16
+    or               xd, r8m            ; factor1
+    movd            xm4, xd
+    movd            xm6, r10m           ; half
+%if mmsize == 32
+    vpbroadcastd     m4, xm4
+    vpbroadcastd     m6, xm6
+%else
+    SPLATD           m4
+    SPLATD           m6
+%endif
+.nextrow:
+    mov              xq, widthq
+
+    .loop:
+        movu             m0, [src1q + xq]
+        movu             m2, [src2q + xq]
+        punpckhwd        m1, m0, m2
+        punpcklwd        m0, m2
+        pmaddwd          m0, m4
+        pmaddwd          m1, m4
+        paddd            m0, m6
+        paddd            m1, m6
+        psrld            m0, xm7
+        psrld            m1, xm7
+        packssdw         m0, m1
+        movu    [dstq + xq], m0
+        add              xq, mmsize
+    jl .loop
+BLEND_END
+%endmacro
+
+INIT_XMM sse2
+BLEND_FRAMES8
+BLEND_FRAMES16
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+BLEND_FRAMES8
+BLEND_FRAMES16
+%endif
+
+; int64_t ff_framerate_sad16_sse2(const uint8_t *src1, ptrdiff_t src1_linesize,
+;                                 const uint8_t *src2, ptrdiff_t src2_linesize,
+;                                 ptrdiff_t width, ptrdiff_t height)
+; Absolute differences are summed into dwords for every row and flushed into
+; qwords at the end of the row, so whole frames of any depth cannot overflow.
+INIT_XMM sse2
+cglobal framerate_sad16, 6, 7, 7, src1, src1_linesize, src2, src2_linesize, width, height, x
+    add          widthq, widthq
+    add           src1q, widthq
+    add           src2q, widthq
+    neg          widthq
+    mova             m6, [pw_1]
+    pxor             m5, m5             ; qword sums
+    pxor             m4, m4
+.nextrow:
+    pxor             m3, m3             ; dword sums of the row
+    mov              xq, widthq
+
+    .loop:
+        movu             m0, [src1q + xq]
+        movu             m1, [src2q + xq]
+        psubusw          m2, m0, m1
+        psubusw          m1, m0
+        por              m1, m2
+        pmaddwd          m1, m6
+        paddd            m3, m1
+        add              xq, mmsize
+    jl .loop
+
+    punpckhdq        m0, m3, m4
+    punpckldq        m3, m4
+    paddq            m5, m0
+    paddq            m5, m3
+    add           src1q, src1_linesizeq
+    add           src2q, src2_linesizeq
+    sub         heightd, 1
+    jg .nextrow
+
+    pshufd           m0, m5, q3232
+    paddq            m5, m0
+    movq            rax, m5
+    RET
+
+%endif ; ARCH_X86_64
@@ -0,0 +1,55 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/framerate.h"
+
+#define BLEND_FUNC(depth, opt)                                                          \
+void ff_blend_frames##depth##_##opt(const uint8_t *src1, ptrdiff_t src1_linesize,      \
+                                    const uint8_t *src2, ptrdiff_t src2_linesize,      \
+                                    uint8_t *dst, ptrdiff_t dst_linesize,              \
+                                    ptrdiff_t width, ptrdiff_t height,                 \
+                                    int factor1, int factor2, int half, int shift);
+
+BLEND_FUNC(8,  sse2)
+BLEND_FUNC(16, sse2)
+BLEND_FUNC(8,  avx2)
+BLEND_FUNC(16, avx2)
+
+int64_t ff_framerate_sad16_sse2(const uint8_t *src1, ptrdiff_t src1_linesize,
+                                const uint8_t *src2, ptrdiff_t src2_linesize,
+                                ptrdiff_t width, ptrdiff_t height);
+
+av_cold void ff_framerate_dsp_init_x86(FrameRateDSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->blend8  = ff_blend_frames8_sse2;
+        dsp->blend16 = ff_blend_frames16_sse2;
+        dsp->sad16   = ff_framerate_sad16_sse2;
+    }
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->blend8  = ff_blend_frames8_avx2;
+        dsp->blend16 = ff_blend_frames16_avx2;
+    }
+#endif
+}
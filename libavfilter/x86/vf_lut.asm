@@ -0,0 +1,102 @@
+;*****************************************************************************
+;* x86-optimized functions for lut filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pb_1:     times 32 db 1
+pb_15:    times 32 db 15
+pd_65535: times 8 dd 0xffff
+
+SECTION .text
+
+; void ff_lut_plane8_<opt>(uint8_t *dst, const uint8_t *src, const uint8_t *lut,
+;                          int width)
+; The table is split into 16 rows of 16 entries. Every row is looked up with
+; the low nibble of the samples and kept where the high nibble selects it.
+%macro LUT_PLANE8 0
+cglobal lut_plane8, 4, 5, 8, dst, src, lut, width, x
+    movsxdifnidn widthq, widthd
+    mova            m6, [pb_15]
+    mova            m7, [pb_1]
+    xor             xq, xq
+.loop:
+    movu            m0, [srcq + xq]
+    psrlw           m1, m0, 4
+    pand            m0, m6             ; low nibble
+    pand            m1, m6             ; high nibble
+    pxor            m2, m2
+    pxor            m5, m5             ; current row
+%assign i 0
+%rep 16
+%if mmsize == 32
+    vbroadcasti128  m3, [lutq + i * 16]
+%else
+    movu            m3, [lutq + i * 16]
+%endif
+    pshufb          m3, m0
+    pcmpeqb         m4, m1, m5
+    pand            m3, m4
+    por             m2, m3
+%if i < 15
+    paddb           m5, m7
+%endif
+%assign i i+1
+%endrep
+    movu   [dstq + xq], m2
+    add             xq, mmsize
+    cmp             xq, widthq
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM ssse3
+LUT_PLANE8
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+LUT_PLANE8
+
+; void ff_lut_plane16_avx2(uint16_t *dst, const uint16_t *src, const uint16_t *lut,
+;                          int width)
+; Gathers dwords at lut + 2 * src and keeps the low word, which is why the
+; table has to be readable one entry past the largest sample.
+cglobal lut_plane16, 4, 5, 7, dst, src, lut, width, x
+    movsxdifnidn widthq, widthd
+    mova            m6, [pd_65535]
+    xor             xq, xq
+.loop:
+    pmovzxwd        m0, [srcq + xq * 2]
+    pmovzxwd        m1, [srcq + xq * 2 + 16]
+    pcmpeqd         m2, m2
+    pcmpeqd         m3, m3
+    vpgatherdd      m4, [lutq + m0 * 2], m2
+    vpgatherdd      m5, [lutq + m1 * 2], m3
+    pand            m4, m6
+    pand            m5, m6
+    packusdw        m4, m5
+    vpermq          m4, m4, q3120
+    movu [dstq + xq * 2], m4
+    add             xq, mmsize / 2
+    cmp             xq, widthq
+    jl .loop
+    RET
+%endif
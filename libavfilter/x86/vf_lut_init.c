@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/lut.h"
+
+void ff_lut_plane8_ssse3(uint8_t *dst, const uint8_t *src, const uint8_t *lut,
+                         int width);
+void ff_lut_plane8_avx2(uint8_t *dst, const uint8_t *src, const uint8_t *lut,
+                        int width);
+void ff_lut_plane16_avx2(uint16_t *dst, const uint16_t *src, const uint16_t *lut,
+                         int width);
+
+av_cold void ff_lut_dsp_init_x86(LutDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSSE3(cpu_flags))
+        dsp->lut_plane8  = ff_lut_plane8_ssse3;
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->lut_plane8  = ff_lut_plane8_avx2;
+        dsp->lut_plane16 = ff_lut_plane16_avx2;
+    }
+}
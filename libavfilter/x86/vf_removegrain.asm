@@ -1216,3 +1216,358 @@ cglobal rg_fl_mode_24, 4, 5, 16, mmsize, dst, src, stride, pixels
     jg .loop
 RET
 %endif
+
+
+%if ARCH_X86_32
+; The modes above that need more than 8 registers, reworked for x86-32:
+; ranks are found by insertion into a short sorted list and the per-axis
+; choices are made as running selections. The axes are processed in the order
+; 1, 3, 2, 4 and later axes win ties, like in the C code.
+
+; %1 dest simd register
+; %2 source memory location
+; Loads 8 pixels as words without a zero register.
+%macro LOAD_W 2
+    movh %1, %2
+    punpcklbw %1, %1
+    psrlw %1, 8
+%endmacro
+
+; %1 rank
+; %2 pmin/pmax keeping the smallest/largest values in m1..m%1
+; %3 the opposite of %2
+; %4 source memory location
+%macro RANK_INSERT 4
+    movu m5, [%4]
+    %assign i 1
+    %rep %1
+        %if i < %1
+            mova m6, m %+ i
+        %endif
+        %2 m %+ i, m5
+        %if i < %1
+            %3 m5, m6
+        %endif
+        %assign i i+1
+    %endrep
+%endmacro
+
+; %1 rank
+; %2 pmin/pmax keeping the smallest/largest values
+; %3 the opposite of %2
+%macro RANK_ALL 3
+    RANK_INSERT %1, %2, %3, a1
+    RANK_INSERT %1, %2, %3, a2
+    RANK_INSERT %1, %2, %3, a3
+    RANK_INSERT %1, %2, %3, a4
+    RANK_INSERT %1, %2, %3, a5
+    RANK_INSERT %1, %2, %3, a6
+    RANK_INSERT %1, %2, %3, a7
+    RANK_INSERT %1, %2, %3, a8
+%endmacro
+
+; %1 mode, which is also the rank of the clipping bounds
+%macro RANK_MODE 1
+cglobal rg_fl_mode_%1, 4, 5, 7, 0, dst, src, stride, pixels
+    mov r4q, strideq
+    neg r4q
+    %define stride_p strideq
+    %define stride_n r4q
+
+    .loop:
+        %assign i 1
+        %rep %1
+            pcmpeqb m %+ i, m %+ i
+            %assign i i+1
+        %endrep
+        RANK_ALL %1, pminub, pmaxub
+        movu m0, [c]
+        pmaxub m0, m %+ %1
+
+        %assign i 1
+        %rep %1
+            pxor m %+ i, m %+ i
+            %assign i i+1
+        %endrep
+        RANK_ALL %1, pmaxub, pminub
+        pminub m0, m %+ %1
+
+        movu [dstq], m0
+        add srcq, mmsize
+        add dstq, mmsize
+        sub pixelsd, mmsize
+    jg .loop
+RET
+%endmacro
+
+RANK_MODE 2
+RANK_MODE 3
+RANK_MODE 4
+
+; Running selection of the clipped value with the smallest score.
+; m0 c, m1 best score, m2 result, m3/m4 min/max of the axis, m5 clipped c,
+; m6 score of the axis, m7 temp.
+; %1 b/w data type, %2 ub/sw for min/max, %3 mode, %4/%5 axis locations,
+; %6 first axis
+%macro AXIS_SELECT 6
+%ifidn %1, b
+    movu m3, [%4]
+    movu m4, [%5]
+%else
+    LOAD_W m3, [%4]
+    LOAD_W m4, [%5]
+%endif
+    mova m7, m3
+    pmin%2 m3, m4
+    pmax%2 m4, m7
+    mova m5, m0
+    pmax%2 m5, m3
+    pmin%2 m5, m4
+
+%if %3 == 5
+    mova m6, m0
+    ABS_DIFF m6, m5, m7
+%elif %3 == 9
+    mova m6, m4
+    psubb m6, m3
+%elif %3 == 18
+    mova m6, m0
+    mova m7, m4
+    psubusb m6, m3
+    psubusb m7, m0
+    pmaxub m6, m7
+%else ; 6, 7, 8
+    mova m6, m0
+    ABS_DIFF_W m6, m5, m7
+    psubw m4, m3
+%if %3 == 6
+    psllw m6, 1
+%elif %3 == 8
+    psllw m4, 1
+%endif
+    paddw m6, m4
+%endif
+
+%if %6
+    mova m1, m6
+    mova m2, m5
+%else
+    mova m7, m1
+    pmin%2 m7, m6
+    pcmpeq%1 m7, m6
+    pmin%2 m1, m6
+    BLEND m2, m5, m7
+%endif
+%endmacro
+
+; %1 mode, %2 b/w data type, %3 ub/sw for min/max
+%macro AXIS_MODE 3
+cglobal rg_fl_mode_%1, 4, 5, 8, 0, dst, src, stride, pixels
+    mov r4q, strideq
+    neg r4q
+    %define stride_p strideq
+    %define stride_n r4q
+
+    .loop:
+%ifidn %2, b
+        movu m0, [c]
+%else
+        LOAD_W m0, [c]
+%endif
+        AXIS_SELECT %2, %3, %1, a1, a8, 1
+        AXIS_SELECT %2, %3, %1, a3, a6, 0
+        AXIS_SELECT %2, %3, %1, a2, a7, 0
+        AXIS_SELECT %2, %3, %1, a4, a5, 0
+
+%ifidn %2, b
+        movu [dstq], m2
+        add srcq, mmsize
+        add dstq, mmsize
+        sub pixelsd, mmsize
+%else
+        packuswb m2, m2
+        movh [dstq], m2
+        add srcq, mmsize/2
+        add dstq, mmsize/2
+        sub pixelsd, mmsize/2
+%endif
+    jg .loop
+RET
+%endmacro
+
+AXIS_MODE 5,  b, ub
+AXIS_MODE 6,  w, sw
+AXIS_MODE 7,  w, sw
+AXIS_MODE 8,  w, sw
+AXIS_MODE 9,  b, ub
+AXIS_MODE 18, b, ub
+
+; %1/%2 axis locations, %3 first axis
+; m0 average, m1 best score, m2 result, m3/m4 min/max of the axis, m5 clipped
+; average, m6 score of the axis, m7 temp
+%macro PAIR_SELECT 3
+    LOAD_W m3, [%1]
+    LOAD_W m4, [%2]
+    mova m7, m3
+    pminsw m3, m4
+    pmaxsw m4, m7
+    mova m5, m0
+    CLIPW m5, m3, m4
+    mova m6, m4
+    psubw m6, m3
+%if %3
+    mova m1, m6
+    mova m2, m5
+%else
+    mova m7, m1
+    pminsw m7, m6
+    pcmpeqw m7, m6
+    pminsw m1, m6
+    BLEND m2, m5, m7
+%endif
+%endmacro
+
+cglobal rg_fl_mode_15_16, 4, 5, 8, 0, dst, src, stride, pixels
+    mov r4q, strideq
+    neg r4q
+    %define stride_p strideq
+    %define stride_n r4q
+
+    .loop:
+        LOAD_W m0, [a2]
+        LOAD_W m1, [a7]
+        paddw m0, m1
+        psllw m0, 1
+        LOAD_W m1, [a1]
+        LOAD_W m2, [a3]
+        paddw m0, m1
+        paddw m0, m2
+        LOAD_W m1, [a6]
+        LOAD_W m2, [a8]
+        paddw m0, m1
+        paddw m0, m2
+        paddw m0, [pw_4]
+        psrlw m0, 3
+
+        PAIR_SELECT a1, a8, 1
+        PAIR_SELECT a3, a6, 0
+        PAIR_SELECT a2, a7, 0
+        packuswb m2, m2
+
+        movh [dstq], m2
+        add srcq, mmsize/2
+        add dstq, mmsize/2
+        sub pixelsd, mmsize/2
+    jg .loop
+RET
+
+cglobal rg_fl_mode_17, 4, 5, 6, 0, dst, src, stride, pixels
+    mov r4q, strideq
+    neg r4q
+    %define stride_p strideq
+    %define stride_n r4q
+
+    .loop:
+        pxor m1, m1    ; max of the axis minimums
+        pcmpeqb m2, m2 ; min of the axis maximums
+%assign i 1
+%rep 4
+    %if i == 1
+        movu m3, [a1]
+        movu m4, [a8]
+    %elif i == 2
+        movu m3, [a2]
+        movu m4, [a7]
+    %elif i == 3
+        movu m3, [a3]
+        movu m4, [a6]
+    %else
+        movu m3, [a4]
+        movu m4, [a5]
+    %endif
+        mova m5, m3
+        pminub m3, m4
+        pmaxub m4, m5
+        pmaxub m1, m3
+        pminub m2, m4
+    %assign i i+1
+%endrep
+
+        mova m3, m1
+        pminub m1, m2
+        pmaxub m2, m3
+        movu m0, [c]
+        CLIPUB m0, m1, m2
+
+        movu [dstq], m0
+        add srcq, mmsize
+        add dstq, mmsize
+        sub pixelsd, mmsize
+    jg .loop
+RET
+
+; %1 mode, %2/%3 axis locations
+; m0 c, m1 u, m2 d
+%macro LINE_DIFF_AXIS 3
+    LOAD_W m3, [%2]
+    LOAD_W m4, [%3]
+    mova m6, m3
+    pminsw m3, m4
+    pmaxsw m4, m6
+    mova m5, m4
+    psubw m5, m3 ; linediff
+
+    mova m6, m0
+    psubw m6, m4 ; tu
+%if %1 == 24
+    mova m7, m5
+    psubw m7, m6
+    pminsw m6, m7
+%else
+    pminsw m6, m5
+%endif
+    pmaxsw m1, m6
+
+    mova m6, m3
+    psubw m6, m0 ; td
+%if %1 == 24
+    mova m7, m5
+    psubw m7, m6
+    pminsw m6, m7
+%else
+    pminsw m6, m5
+%endif
+    pmaxsw m2, m6
+%endmacro
+
+%macro LINE_DIFF_MODE 1
+cglobal rg_fl_mode_%1, 4, 5, 8, 0, dst, src, stride, pixels
+    mov r4q, strideq
+    neg r4q
+    %define stride_p strideq
+    %define stride_n r4q
+
+    .loop:
+        LOAD_W m0, [c]
+        pxor m1, m1
+        pxor m2, m2
+        LINE_DIFF_AXIS %1, a1, a8
+        LINE_DIFF_AXIS %1, a2, a7
+        LINE_DIFF_AXIS %1, a3, a6
+        LINE_DIFF_AXIS %1, a4, a5
+
+        psubw m0, m1
+        paddw m0, m2
+        packuswb m0, m0
+
+        movh [dstq], m0
+        add srcq, mmsize/2
+        add dstq, mmsize/2
+        sub pixelsd, mmsize/2
+    jg .loop
+RET
+%endmacro
+
+LINE_DIFF_MODE 23
+LINE_DIFF_MODE 24
+%endif
@@ -31,7 +31,6 @@ void ff_rg_fl_mode_19_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pix
 void ff_rg_fl_mode_20_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 void ff_rg_fl_mode_21_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 void ff_rg_fl_mode_22_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
-#if ARCH_X86_64
 void ff_rg_fl_mode_2_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 void ff_rg_fl_mode_3_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 void ff_rg_fl_mode_4_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
@@ -45,7 +44,6 @@ void ff_rg_fl_mode_17_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pix
 void ff_rg_fl_mode_18_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 void ff_rg_fl_mode_23_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
 void ff_rg_fl_mode_24_sse2(uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
-#endif
 
 av_cold void ff_removegrain_init_x86(RemoveGrainContext *rg)
 {
@@ -66,7 +64,6 @@ av_cold void ff_removegrain_init_x86(RemoveGrainContext *rg)
                 case 20: rg->fl[i] = ff_rg_fl_mode_20_sse2; break;
                 case 21: rg->fl[i] = ff_rg_fl_mode_21_sse2; break;
                 case 22: rg->fl[i] = ff_rg_fl_mode_22_sse2; break;
-#if ARCH_X86_64
                 case 2: rg->fl[i] = ff_rg_fl_mode_2_sse2; break;
                 case 3: rg->fl[i] = ff_rg_fl_mode_3_sse2; break;
                 case 4: rg->fl[i] = ff_rg_fl_mode_4_sse2; break;
@@ -81,7 +78,6 @@ av_cold void ff_removegrain_init_x86(RemoveGrainContext *rg)
                 case 18: rg->fl[i] = ff_rg_fl_mode_18_sse2; break;
                 case 23: rg->fl[i] = ff_rg_fl_mode_23_sse2; break;
                 case 24: rg->fl[i] = ff_rg_fl_mode_24_sse2; break;
-#endif /* ARCH_x86_64 */
             }
     }
 #endif /* CONFIG_GPL */
@@ -0,0 +1,54 @@
+;*****************************************************************************
+;* x86-optimized functions for the subtitles filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pw_128: times 8 dw 128
+
+SECTION .text
+
+; void ff_subtitles_blend_row_sse2(uint8_t *dst, const uint16_t *color,
+;                                  const uint16_t *transp, int w)
+INIT_XMM sse2
+cglobal subtitles_blend_row, 4, 4, 5, dst, color, transp, w
+    pxor            m4, m4
+    mova            m3, [pw_128]
+    movsxdifnidn    wq, wd
+    add           dstq, wq
+    lea         colorq, [colorq  + 2 * wq]
+    lea        transpq, [transpq + 2 * wq]
+    neg             wq
+.loop:
+    movq            m1, [dstq + wq]
+    movu            m2, [transpq + 2 * wq]
+    pxor            m0, m0
+    punpcklbw       m0, m1              ; dst << 8
+    pmulhuw         m0, m2
+    movu            m1, [colorq + 2 * wq]
+    paddusw         m0, m1
+    paddusw         m0, m3
+    psrlw           m0, 8
+    packuswb        m0, m4
+    movq   [dstq + wq], m0
+    add             wq, 8
+    jl .loop
+    RET
@@ -0,0 +1,108 @@
+;*****************************************************************************
+;* x86-optimized functions for unsharp filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%macro UNSHARP_BLUR 0
+; void ff_unsharp_hblur_pass(uint32_t *buf, int len)
+cglobal unsharp_hblur_pass, 2, 3, 2, buf, len, x
+    movsxdifnidn lenq, lend
+    xor             xq, xq
+.loop:
+    mova            m0, [bufq + xq * 4]
+    movu            m1, [bufq + xq * 4 + 4]
+    paddd           m0, m1
+    mova [bufq + xq * 4], m0
+    add             xq, mmsize / 4
+    cmp             xq, lenq
+    jl .loop
+    RET
+
+; void ff_unsharp_vblur(uint32_t *acc, uint32_t *const *sc, int nb_stages, int width)
+cglobal unsharp_vblur, 4, 7, 2, acc, sc, stages, width, x, z, row
+    movsxdifnidn stagesq, stagesd
+    movsxdifnidn  widthq, widthd
+    xor             xq, xq
+.loop_x:
+    mova            m0, [accq + xq * 4]
+    xor             zq, zq
+.loop_z:
+    mov           rowq, [scq + zq * gprsize]
+    mova            m1, [rowq + xq * 4]
+    mova [rowq + xq * 4], m0
+    paddd           m0, m1
+    add             zq, 1
+    cmp             zq, stagesq
+    jl .loop_z
+
+    mova [accq + xq * 4], m0
+    add             xq, mmsize / 4
+    cmp             xq, widthq
+    jl .loop_x
+    RET
+%endmacro
+
+INIT_XMM sse2
+UNSHARP_BLUR
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+UNSHARP_BLUR
+%endif
+
+; void ff_unsharp_sharpen_sse4(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+;                              int width, int amount, int scalebits, uint32_t halfscale)
+INIT_XMM sse4
+cglobal unsharp_sharpen, 4, 5, 8, dst, src, blur, width, x
+    movd            m4, r4m          ; amount
+    movd            m6, r5m          ; scalebits
+    movd            m7, r6m          ; halfscale
+    pxor            m5, m5
+    psubd           m5, m4
+    pshufd          m5, m5, 0        ; -amount
+    pshufd          m7, m7, 0
+    movsxdifnidn widthq, widthd
+    xor             xq, xq
+.loop:
+    pmovzxbd        m0, [srcq + xq]
+    pmovzxbd        m1, [srcq + xq + 4]
+    mova            m2, [blurq + xq * 4]
+    mova            m3, [blurq + xq * 4 + mmsize]
+    paddd           m2, m7
+    paddd           m3, m7
+    psrld           m2, m6
+    psrld           m3, m6
+    psubd           m2, m0           ; blur - src
+    psubd           m3, m1
+    pmulld          m2, m5           ; (src - blur) * amount
+    pmulld          m3, m5
+    psrad           m2, 16
+    psrad           m3, 16
+    paddd           m0, m2
+    paddd           m1, m3
+    packssdw        m0, m1
+    packuswb        m0, m0
+    movh  [dstq + xq], m0
+    add             xq, 8
+    cmp             xq, widthq
+    jl .loop
+    RET
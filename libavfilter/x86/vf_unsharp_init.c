@@ -0,0 +1,46 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/unsharp.h"
+
+void ff_unsharp_hblur_pass_sse2(uint32_t *buf, int len);
+void ff_unsharp_hblur_pass_avx2(uint32_t *buf, int len);
+void ff_unsharp_vblur_sse2(uint32_t *acc, uint32_t *const *sc, int nb_stages, int width);
+void ff_unsharp_vblur_avx2(uint32_t *acc, uint32_t *const *sc, int nb_stages, int width);
+void ff_unsharp_sharpen_sse4(uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                             int width, int amount, int scalebits, uint32_t halfscale);
+
+av_cold void ff_unsharp_dsp_init_x86(UnsharpDSPContext *dsp)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        dsp->hblur_pass = ff_unsharp_hblur_pass_sse2;
+        dsp->vblur      = ff_unsharp_vblur_sse2;
+    }
+    if (EXTERNAL_SSE4(cpu_flags)) {
+        dsp->sharpen    = ff_unsharp_sharpen_sse4;
+    }
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->hblur_pass = ff_unsharp_hblur_pass_avx2;
+        dsp->vblur      = ff_unsharp_vblur_avx2;
+    }
+}
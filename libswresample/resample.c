@@ -27,6 +27,7 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/thread.h"
 #include "resample.h"
 
 static inline double eval_poly(const double *coeff, int size, double x) {
@@ -298,9 +299,138 @@ fail:
     return 0;
 }
 
+/**
+ * A polyphase filter bank only depends on the parameters below, so all
+ * resamplers with the same ones share a single read-only copy.
+ */
+typedef struct FilterBankCache {
+    struct FilterBankCache *next;
+    int refcount;
+    enum AVSampleFormat format;
+    enum SwrFilterType filter_type;
+    double factor;
+    double kaiser_beta;
+    int filter_length;
+    int phase_count;
+    uint8_t *filter_bank;
+} FilterBankCache;
+
+static FilterBankCache *filter_bank_cache;
+static AVMutex filter_bank_cache_lock;
+static AVOnce filter_bank_cache_once = AV_ONCE_INIT;
+
+static av_cold void filter_bank_cache_init(void)
+{
+    ff_mutex_init(&filter_bank_cache_lock, NULL);
+}
+
+static uint8_t *new_filter_bank(ResampleContext *c, int phase_count)
+{
+    uint8_t *filter_bank = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
+
+    if (!filter_bank)
+        return NULL;
+    if (build_filter(c, (void*)filter_bank, c->factor, c->filter_length, c->filter_alloc,
+                     phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta)) {
+        av_free(filter_bank);
+        return NULL;
+    }
+    memcpy(filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, filter_bank, (c->filter_alloc-1)*c->felem_size);
+    memcpy(filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+    return filter_bank;
+}
+
+/**
+ * Get a reference to the filter bank with phase_count phases for the filter
+ * parameters of c, building it if no other resampler uses it yet.
+ *
+ * @return the filter bank, or NULL on allocation failure
+ */
+static uint8_t *filter_bank_ref(ResampleContext *c, int phase_count)
+{
+    FilterBankCache *e;
+    uint8_t *filter_bank = NULL;
+
+    ff_thread_once(&filter_bank_cache_once, filter_bank_cache_init);
+    ff_mutex_lock(&filter_bank_cache_lock);
+
+    for (e = filter_bank_cache; e; e = e->next) {
+        if (e->format        == c->format        &&
+            e->filter_type   == c->filter_type   &&
+            e->factor        == c->factor        &&
+            e->kaiser_beta   == c->kaiser_beta   &&
+            e->filter_length == c->filter_length &&
+            e->phase_count   == phase_count) {
+            e->refcount++;
+            filter_bank = e->filter_bank;
+            goto end;
+        }
+    }
+
+    e = av_mallocz(sizeof(*e));
+    if (!e)
+        goto end;
+    e->filter_bank = new_filter_bank(c, phase_count);
+    if (!e->filter_bank) {
+        av_free(e);
+        goto end;
+    }
+    e->refcount      = 1;
+    e->format        = c->format;
+    e->filter_type   = c->filter_type;
+    e->factor        = c->factor;
+    e->kaiser_beta   = c->kaiser_beta;
+    e->filter_length = c->filter_length;
+    e->phase_count   = phase_count;
+    e->next          = filter_bank_cache;
+    filter_bank_cache = e;
+    filter_bank = e->filter_bank;
+
+end:
+    ff_mutex_unlock(&filter_bank_cache_lock);
+    return filter_bank;
+}
+
+/**
+ * Drop a reference obtained with filter_bank_ref(), freeing the filter bank
+ * when it was the last one, and set *filter_bank to NULL.
+ */
+static void filter_bank_unref(uint8_t **filter_bank)
+{
+    FilterBankCache **e;
+
+    if (!*filter_bank)
+        return;
+
+    ff_mutex_lock(&filter_bank_cache_lock);
+    for (e = &filter_bank_cache; *e; e = &(*e)->next) {
+        if ((*e)->filter_bank == *filter_bank) {
+            if (!--(*e)->refcount) {
+                FilterBankCache *next = (*e)->next;
+                av_free((*e)->filter_bank);
+                av_free(*e);
+                *e = next;
+            }
+            break;
+        }
+    }
+    ff_mutex_unlock(&filter_bank_cache_lock);
+
+    *filter_bank = NULL;
+}
+
+static void resample_free(ResampleContext **c){
+    if(!*c)
+        return;
+    if (HAVE_THREADS)
+        swri_thread_free(&(*c)->thread);
+    filter_bank_unref(&(*c)->filter_bank);
+    av_freep(c);
+}
+
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
-                                    double precision, int cheby, int exact_rational)
+                                    double precision, int cheby, int exact_rational, int nb_threads)
 {
     double cutoff = cutoff0? cutoff0 : 0.97;
     double factor= FFMIN(out_rate * cutoff / in_rate, 1.0);
@@ -320,6 +450,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
     if (!c || c->phase_count != phase_count || c->linear!=linear || c->factor != factor
            || c->filter_length != FFMAX((int)ceil(filter_size/factor), 1) || c->format != format
            || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta) {
+        resample_free(&c);
         c = av_mallocz(sizeof(*c));
         if (!c)
             return NULL;
@@ -354,16 +485,22 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->factor        = factor;
         c->filter_length = FFMAX((int)ceil(filter_size/factor), 1);
         c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
+        c->nb_threads    = 1;
+        c->thread_count  = 1;
+        c->filter_bank   = filter_bank_ref(c, phase_count);
         if (!c->filter_bank)
             goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+    }
+
+    if (HAVE_THREADS && c->nb_threads != nb_threads) {
+        swri_thread_free(&c->thread);
+        c->nb_threads   = nb_threads;
+        c->thread_count = swri_thread_init(&c->thread, nb_threads);
+        if (c->thread_count < 0)
             goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
     }
 
     c->compensation_distance= 0;
@@ -384,47 +521,29 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     return c;
 error:
-    av_freep(&c->filter_bank);
-    av_free(c);
+    resample_free(&c);
     return NULL;
 }
 
-static void resample_free(ResampleContext **c){
-    if(!*c)
-        return;
-    av_freep(&(*c)->filter_bank);
-    av_freep(c);
-}
-
 static int rebuild_filter_bank_with_compensation(ResampleContext *c)
 {
     uint8_t *new_filter_bank;
     int new_src_incr, new_dst_incr;
     int phase_count = c->phase_count_compensation;
-    int ret;
 
     if (phase_count == c->phase_count)
         return 0;
 
     av_assert0(!c->frac && !c->dst_incr_mod && !c->compensation_distance);
 
-    new_filter_bank = av_calloc(c->filter_alloc, (phase_count + 1) * c->felem_size);
+    new_filter_bank = filter_bank_ref(c, phase_count);
     if (!new_filter_bank)
         return AVERROR(ENOMEM);
 
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
-    if (ret < 0) {
-        av_freep(&new_filter_bank);
-        return ret;
-    }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
-
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
     {
-        av_freep(&new_filter_bank);
+        filter_bank_unref(&new_filter_bank);
         return AVERROR(EINVAL);
     }
 
@@ -439,7 +558,7 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
     c->index         *= phase_count / c->phase_count;
     c->phase_count    = phase_count;
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     c->filter_bank = new_filter_bank;
     return 0;
 }
@@ -503,6 +622,43 @@ static int swri_resample(ResampleContext *c,
     return dst_size;
 }
 
+/* minimum number of filter taps per channel and call for threading to pay off */
+#define MIN_THREAD_TAPS (1 << 15)
+
+typedef struct ThreadData {
+    ResampleContext *c;
+    AudioData *dst, *src;
+    int dst_size, src_size;
+    int need_emms;
+    int ret, consumed;
+    int index, frac;
+} ThreadData;
+
+static void resample_channels(void *arg, int jobnr, int nb_jobs)
+{
+    ThreadData *td = arg;
+    /* each job works on its own copy of the state, only the one holding the
+     * last channel hands its updated position back to the caller */
+    ResampleContext c = *td->c;
+    int ch_count = td->dst->ch_count;
+    int start = (ch_count *  jobnr   ) / nb_jobs;
+    int end   = (ch_count * (jobnr+1)) / nb_jobs;
+    int i, consumed = 0, ret = -1;
+
+    for (i = start; i < end; i++)
+        ret = swri_resample(&c, td->dst->ch[i], td->src->ch[i],
+                            &consumed, td->src_size, td->dst_size, i+1 == ch_count);
+    if (td->need_emms)
+        emms_c();
+
+    if (end == ch_count) {
+        td->ret      = ret;
+        td->consumed = consumed;
+        td->index    = c.index;
+        td->frac     = c.frac;
+    }
+}
+
 static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
     int i, ret= -1;
     int av_unused mm_flags = av_get_cpu_flags();
@@ -514,12 +670,24 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
         dst_size = FFMIN(dst_size, c->compensation_distance);
     src_size = FFMIN(src_size, max_src_size);
 
-    for(i=0; i<dst->ch_count; i++){
-        ret= swri_resample(c, dst->ch[i], src->ch[i],
-                           consumed, src_size, dst_size, i+1==dst->ch_count);
+    if (HAVE_THREADS && c->thread && dst->ch_count > 1 &&
+        dst_size * (int64_t)c->filter_length >= MIN_THREAD_TAPS) {
+        ThreadData td = { c, dst, src, dst_size, src_size, need_emms };
+
+        swri_thread_execute(c->thread, resample_channels, &td,
+                            FFMIN(dst->ch_count, c->thread_count));
+        c->index  = td.index;
+        c->frac   = td.frac;
+        *consumed = td.consumed;
+        ret       = td.ret;
+    } else {
+        for(i=0; i<dst->ch_count; i++){
+            ret= swri_resample(c, dst->ch[i], src->ch[i],
+                               consumed, src_size, dst_size, i+1==dst->ch_count);
+        }
+        if(need_emms)
+            emms_c();
     }
-    if(need_emms)
-        emms_c();
 
     if (c->compensation_distance) {
         c->compensation_distance -= ret;
@@ -49,6 +49,9 @@ typedef struct ResampleContext {
     int felem_size;
     int filter_shift;
     int phase_count_compensation;      /* desired phase_count when compensation is enabled */
+    int nb_threads;                    /* requested number of threads, 0 for automatic */
+    int thread_count;                  /* number of threads in the pool */
+    SwrThreadContext *thread;          /* worker pool, NULL when resampling single threaded */
 
     struct {
         void (*resample_one)(void *dst, const void *src,
@@ -28,6 +28,7 @@
 #include <float.h>
 
 #define ALIGN 32
+#define SWR_BLOCK_SIZE 1024
 
 #include "libavutil/ffversion.h"
 const char swr_ffversion[] = "FFmpeg version " FFMPEG_VERSION;
@@ -262,7 +263,7 @@ av_cold int swr_init(struct SwrContext *s){
     }
 
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
-        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
+        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational, s->nb_threads);
         if (!s->resample) {
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
@@ -688,6 +689,39 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
     return out_count;
 }
 
+/**
+ * Run swr_convert_internal() on consecutive blocks of at most
+ * SWR_BLOCK_SIZE input samples, so that the converted, rematrixed and
+ * resampled intermediates of a block are still in cache when the next
+ * stage reads them, instead of each stage streaming the whole input
+ * through memory.
+ *
+ * @return number of samples output per channel
+ */
+static int convert_blocks(struct SwrContext *s, AudioData *out, int out_count,
+                                                AudioData *in , int  in_count){
+    AudioData in_tmp = *in, out_tmp = *out;
+    int ret_sum = 0;
+
+    // the dither noise position wraps depending on the block sizes
+    if (in_count <= 2*SWR_BLOCK_SIZE || s->dither.method || s->flushed)
+        return swr_convert_internal(s, out, out_count, in, in_count);
+
+    while (in_count) {
+        int count = out_count > 0 ? FFMIN(in_count, SWR_BLOCK_SIZE) : in_count;
+        int ret = swr_convert_internal(s, &out_tmp, s->resample ? out_count : count,
+                                       &in_tmp, count);
+        if (ret < 0)
+            return ret;
+        buf_set(&in_tmp, &in_tmp, count);
+        buf_set(&out_tmp, &out_tmp, ret);
+        in_count  -= count;
+        out_count -= ret;
+        ret_sum   += ret;
+    }
+    return ret_sum;
+}
+
 int swr_is_initialized(struct SwrContext *s) {
     return !!s->in_buffer.ch_count;
 }
@@ -744,7 +778,7 @@ int attribute_align_arg swr_convert(struct SwrContext *s, uint8_t *out_arg[SWR_C
     fill_audiodata(out, out_arg);
 
     if(s->resample){
-        int ret = swr_convert_internal(s, out, out_count, in, in_count);
+        int ret = convert_blocks(s, out, out_count, in, in_count);
         if(ret>0 && !s->drop_output)
             s->outpts += ret * (int64_t)s->in_sample_rate;
 
@@ -786,7 +820,7 @@ int attribute_align_arg swr_convert(struct SwrContext *s, uint8_t *out_arg[SWR_C
 
             if(out_count){
                 size = FFMIN(in_count, out_count);
-                ret= swr_convert_internal(s, out, size, in, size);
+                ret= convert_blocks(s, out, size, in, size);
                 if(ret<0)
                     return ret;
                 buf_set(in, in, ret);
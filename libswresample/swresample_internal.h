@@ -69,7 +69,7 @@ struct DitherContext {
 };
 
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
-                                    double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
+                                    double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational, int nb_threads);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
 typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
@@ -132,6 +132,7 @@ struct SwrContext {
     double kaiser_beta;                                /**< swr beta value for Kaiser window (only applicable if filter_type == AV_FILTER_TYPE_KAISER) */
     double precision;                               /**< soxr resampling precision (in bits) */
     int cheby;                                      /**< soxr: if 1 then passband rolloff will be none (Chebyshev) & irrational ratio approximation precision will be higher */
+    int nb_threads;                                 ///< number of threads used to resample channels in parallel, 0 for automatic
 
     float min_compensation;                         ///< swr minimum below which no compensation will happen
     float min_hard_compensation;                    ///< swr minimum below which no silence inject / sample drop will happen
@@ -188,6 +189,25 @@ struct SwrContext {
 av_warn_unused_result
 int swri_realloc_audio(AudioData *a, int count);
 
+typedef struct SwrThreadContext SwrThreadContext;
+typedef void (swri_thread_func)(void *arg, int jobnr, int nb_jobs);
+
+/**
+ * Start a pool of worker threads.
+ *
+ * @param nb_threads number of threads, 0 for one per cpu
+ * @return the number of threads started, 1 (with *pc set to NULL) if no
+ *         pool is needed, or a negative error code
+ */
+int  swri_thread_init(SwrThreadContext **pc, int nb_threads);
+void swri_thread_free(SwrThreadContext **pc);
+/**
+ * Run func(arg, jobnr, nb_jobs) for every jobnr in [0, nb_jobs) on the pool
+ * and wait for all of them to finish.
+ */
+void swri_thread_execute(SwrThreadContext *c, swri_thread_func *func,
+                         void *arg, int nb_jobs);
+
 void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
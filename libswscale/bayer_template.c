@@ -134,23 +134,18 @@ static void BAYER_RENAME(rgb24_copy)(const uint8_t *src, int src_stride, uint8_t
     }
 }
 
-static void BAYER_RENAME(rgb24_interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width)
+/**
+ * interpolate width pixels of two lines away from the left and right edges,
+ * src and dst point to the first of them
+ */
+static void BAYER_RENAME(rgb24_interpolate_line)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width)
 {
     int i;
-
-    BAYER_TO_RGB24_COPY
-    src += 2 * BAYER_SIZEOF;
-    dst += 6;
-
-    for (i = 2 ; i < width - 2; i+= 2) {
+    for (i = 0 ; i < width; i+= 2) {
         BAYER_TO_RGB24_INTERPOLATE
         src += 2 * BAYER_SIZEOF;
         dst += 6;
     }
-
-    if (width > 2) {
-        BAYER_TO_RGB24_COPY
-    }
 }
 
 static void BAYER_RENAME(yv12_copy)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv)
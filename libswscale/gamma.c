@@ -18,20 +18,50 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/pixdesc.h"
 #include "swscale_internal.h"
 
 typedef struct GammaContext
 {
     uint16_t *table;
+    int step;           ///< number of 16 bit components per pixel, 3 or 4
 } GammaContext;
 
-// gamma_convert expects 16 bit rgb format
+static void gamma_convert_line(uint16_t *line, const uint16_t *table,
+                               int width, int step)
+{
+    uint16_t *end = line + width * step;
+
+    for (; line < end; line += step) {
+        uint16_t r = AV_RL16(line + 0);
+        uint16_t g = AV_RL16(line + 1);
+        uint16_t b = AV_RL16(line + 2);
+
+        AV_WL16(line + 0, table[r]);
+        AV_WL16(line + 1, table[g]);
+        AV_WL16(line + 2, table[b]);
+    }
+}
+
+void ff_gamma_convert_rgb48_c(uint16_t *line, const uint16_t *table, int width)
+{
+    gamma_convert_line(line, table, width, 3);
+}
+
+void ff_gamma_convert_rgba64_c(uint16_t *line, const uint16_t *table, int width)
+{
+    gamma_convert_line(line, table, width, 4);
+}
+
+// gamma_convert expects 16 bit rgb or rgba format, the alpha is left untouched
 // it writes directly in src slice thus it must be modifiable (done through cascade context)
 static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     GammaContext *instance = desc->instance;
-    uint16_t *table = instance->table;
+    const uint16_t *table = instance->table;
+    const int step = instance->step;
     int srcW = desc->src->width;
+    int simd_w = c->gammaConvert ? srcW & ~15 : 0;
 
     int i;
     for (i = 0; i < sliceH; ++i) {
@@ -39,17 +69,10 @@ static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, i
         int src_pos = sliceY+i - desc->src->plane[0].sliceY;
 
         uint16_t *src1 = (uint16_t*)*(src+src_pos);
-        int j;
-        for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
-
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
-        }
 
+        if (simd_w)
+            c->gammaConvert(src1, table, simd_w);
+        gamma_convert_line(src1 + simd_w * step, table, srcW - simd_w, step);
     }
     return sliceH;
 }
@@ -61,6 +84,7 @@ int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *t
     if (!li)
         return AVERROR(ENOMEM);
     li->table = table;
+    li->step  = av_get_padded_bits_per_pixel(av_pix_fmt_desc_get(src->fmt)) >> 4;
 
     desc->instance = li;
     desc->src = src;
@@ -584,6 +584,11 @@ static av_cold void sws_init_swscale(SwsContext *c)
 
     ff_sws_init_range_convert(c);
 
+    if (srcFormat == AV_PIX_FMT_RGB48LE)
+        c->gammaConvert = ff_gamma_convert_rgb48_c;
+    else if (srcFormat == AV_PIX_FMT_RGBA64LE)
+        c->gammaConvert = ff_gamma_convert_rgba64_c;
+
     if (!(isGray(srcFormat) || isGray(c->dstFormat) ||
           srcFormat == AV_PIX_FMT_MONOBLACK || srcFormat == AV_PIX_FMT_MONOWHITE))
         c->needs_hcscale = 1;
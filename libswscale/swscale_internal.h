@@ -550,6 +550,23 @@ typedef struct SwsContext {
     void (*readAlpPlanar)(uint8_t *dst, const uint8_t *src[4], int width, int32_t *rgb2yuv);
     /** @} */
 
+    /**
+     * Replace the R, G and B components of width pixels of a packed
+     * RGB48LE or RGBA64LE line (as given by srcFormat) by their table
+     * entries, in place. width is a multiple of 16 and the table must be
+     * readable one entry past its end.
+     */
+    void (*gammaConvert)(uint16_t *line, const uint16_t *table, int width);
+
+    /**
+     * Demosaic width pixels of two lines of a Bayer source (as given by
+     * srcFormat) to RGB24. src and dst point to the first pixel, the
+     * pixels up to 2 to the left and right and one line above and below
+     * are read. width is a multiple of 16.
+     */
+    void (*bayerToRGB24)(const uint8_t *src, int src_stride,
+                         uint8_t *dst, int dst_stride, int width);
+
     /**
      * Scale one horizontal line of input data using a bilinear filter
      * to produce one line of output data. Compared to SwsContext->hScale(),
@@ -873,6 +890,7 @@ void ff_get_unscaled_swscale(SwsContext *c);
 void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
 void ff_get_unscaled_swscale_aarch64(SwsContext *c);
+void ff_get_unscaled_swscale_x86(SwsContext *c);
 
 /**
  * Return function pointer to fastest main scaler path function depending
@@ -1008,6 +1026,8 @@ int ff_rotate_slice(SwsSlice *s, int lum, int chr);
 
 /// initializes gamma conversion descriptor
 int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table);
+void ff_gamma_convert_rgb48_c(uint16_t *line, const uint16_t *table, int width);
+void ff_gamma_convert_rgba64_c(uint16_t *line, const uint16_t *table, int width);
 
 /// initializes lum pixel format conversion descriptor
 int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst, uint32_t *pal);
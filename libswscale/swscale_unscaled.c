@@ -1034,6 +1034,12 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
 {
     uint8_t *dstPtr= dst[0];
     const uint8_t *srcPtr= src[0];
+    const int size = av_pix_fmt_desc_get(c->srcFormat)->comp[0].step;
+    const int width = c->srcW;
+    /* pixels between the 2 pixel wide left and right edge blocks */
+    const int inner_w = width > 4 ? (width - 3) & ~1 : 0;
+    /* the part given to c->bayerToRGB24, its neighbours are within the line */
+    const int simd_w  = width > 4 ? (width - 4) & ~15 : 0;
     int i;
     void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
     void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
@@ -1041,7 +1047,7 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
     switch(c->srcFormat) {
 #define CASE(pixfmt, prefix) \
     case pixfmt: copy        = bayer_##prefix##_to_rgb24_copy; \
-                 interpolate = bayer_##prefix##_to_rgb24_interpolate; \
+                 interpolate = bayer_##prefix##_to_rgb24_interpolate_line; \
                  break;
     CASE(AV_PIX_FMT_BAYER_BGGR8,    bggr8)
     CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
@@ -1061,20 +1067,28 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
 
     av_assert0(srcSliceH > 1);
 
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], width);
     srcPtr += 2 * srcStride[0];
     dstPtr += 2 * dstStride[0];
 
     for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], 2);
+        if (simd_w)
+            c->bayerToRGB24(srcPtr + 2 * size, srcStride[0],
+                            dstPtr + 6, dstStride[0], simd_w);
+        interpolate(srcPtr + (2 + simd_w) * size, srcStride[0],
+                    dstPtr + 3 * (2 + simd_w), dstStride[0], inner_w - simd_w);
+        if (width > 2)
+            copy(srcPtr + (2 + inner_w) * size, srcStride[0],
+                 dstPtr + 3 * (2 + inner_w), dstStride[0], 2);
         srcPtr += 2 * srcStride[0];
         dstPtr += 2 * dstStride[0];
     }
 
     if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
+        copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], width);
     } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], width);
     return srcSliceH;
 }
 
@@ -1665,9 +1679,27 @@ void ff_get_unscaled_swscale(SwsContext *c)
         c->swscale = rgbToPlanarRgbWrapper;
 
     if (isBayer(srcFormat)) {
-        if (dstFormat == AV_PIX_FMT_RGB24)
+        if (dstFormat == AV_PIX_FMT_RGB24) {
             c->swscale = bayer_to_rgb24_wrapper;
-        else if (dstFormat == AV_PIX_FMT_YUV420P)
+            switch (srcFormat) {
+#define CASE(pixfmt, prefix) \
+            case pixfmt: c->bayerToRGB24 = bayer_##prefix##_to_rgb24_interpolate_line; break;
+            CASE(AV_PIX_FMT_BAYER_BGGR8,    bggr8)
+            CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
+            CASE(AV_PIX_FMT_BAYER_BGGR16BE, bggr16be)
+            CASE(AV_PIX_FMT_BAYER_RGGB8,    rggb8)
+            CASE(AV_PIX_FMT_BAYER_RGGB16LE, rggb16le)
+            CASE(AV_PIX_FMT_BAYER_RGGB16BE, rggb16be)
+            CASE(AV_PIX_FMT_BAYER_GBRG8,    gbrg8)
+            CASE(AV_PIX_FMT_BAYER_GBRG16LE, gbrg16le)
+            CASE(AV_PIX_FMT_BAYER_GBRG16BE, gbrg16be)
+            CASE(AV_PIX_FMT_BAYER_GRBG8,    grbg8)
+            CASE(AV_PIX_FMT_BAYER_GRBG16LE, grbg16le)
+            CASE(AV_PIX_FMT_BAYER_GRBG16BE, grbg16be)
+#undef CASE
+            default: break;
+            }
+        } else if (dstFormat == AV_PIX_FMT_YUV420P)
             c->swscale = bayer_to_yv12_wrapper;
         else if (!isBayer(dstFormat)) {
             av_log(c, AV_LOG_ERROR, "unsupported bayer conversion\n");
@@ -1781,6 +1813,8 @@ void ff_get_unscaled_swscale(SwsContext *c)
          ff_get_unscaled_swscale_arm(c);
     if (ARCH_AARCH64)
         ff_get_unscaled_swscale_aarch64(c);
+    if (ARCH_X86)
+        ff_get_unscaled_swscale_x86(c);
 }
 
 /* Convert the palette to the same packed 32-bit format as the palette */
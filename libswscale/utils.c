@@ -328,8 +328,8 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
 
     emms_c(); // FIXME should not be required but IS (even for non-MMX versions)
 
-    // NOTE: the +3 is for the MMX(+1) / SSE(+3) scaler which reads over the end
-    FF_ALLOC_ARRAY_OR_GOTO(NULL, *filterPos, (dstW + 3), sizeof(**filterPos), fail);
+    // NOTE: the +7 is for the MMX(+1) / SSE(+3) / AVX2(+7) scaler which reads over the end
+    FF_ALLOC_ARRAY_OR_GOTO(NULL, *filterPos, (dstW + 7), sizeof(**filterPos), fail);
 
     if (FFABS(xInc - 0x10000) < 10 && srcPos == dstPos) { // unscaled
         int i;
@@ -670,7 +670,7 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
     // Note the +1 is for the MMX scaler which reads over the end
     /* align at 16 for AltiVec (needed by hScale_altivec_real) */
     FF_ALLOCZ_ARRAY_OR_GOTO(NULL, *outFilter,
-                            (dstW + 3), *outFilterSize * sizeof(int16_t), fail);
+                            (dstW + 7), *outFilterSize * sizeof(int16_t), fail);
 
     /* normalize & store in outFilter */
     for (i = 0; i < dstW; i++) {
@@ -694,15 +694,12 @@ static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
         }
     }
 
-    (*filterPos)[dstW + 0] =
-    (*filterPos)[dstW + 1] =
-    (*filterPos)[dstW + 2] = (*filterPos)[dstW - 1]; /* the MMX/SSE scaler will
-                                                      * read over the end */
-    for (i = 0; i < *outFilterSize; i++) {
-        int k = (dstW - 1) * (*outFilterSize) + i;
-        (*outFilter)[k + 1 * (*outFilterSize)] =
-        (*outFilter)[k + 2 * (*outFilterSize)] =
-        (*outFilter)[k + 3 * (*outFilterSize)] = (*outFilter)[k];
+    /* the MMX/SSE/AVX2 scalers will read over the end */
+    for (i = dstW; i < dstW + 7; i++) {
+        int j;
+        (*filterPos)[i] = (*filterPos)[dstW - 1];
+        for (j = 0; j < *outFilterSize; j++)
+            (*outFilter)[i * (*outFilterSize) + j] = (*outFilter)[(dstW - 1) * (*outFilterSize) + j];
     }
 
     ret = 0;
@@ -1076,9 +1073,11 @@ static uint16_t * alloc_gamma_tbl(double e)
 {
     int i = 0;
     uint16_t * tbl;
-    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * 1 << 16);
+    // one more entry for the SIMD lookup, which reads 32 bits per sample
+    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * ((1 << 16) + 1));
     if (!tbl)
         return NULL;
+    tbl[1 << 16] = 0;
 
     for (i = 0; i < 65536; ++i) {
         tbl[i] = pow(i / 65535.0, e) * 65535.0;
@@ -1445,7 +1444,10 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     // hardcoded for now
     c->gamma_value = 2.2;
     tmpFmt = AV_PIX_FMT_RGBA64LE;
-
+    // scale without alpha unless it is carried from src to dst
+    if (!(isALPHA(srcFormat) && isALPHA(dstFormat)) &&
+        (srcFormat != AV_PIX_FMT_RGB48LE || dstFormat != AV_PIX_FMT_RGB48LE))
+        tmpFmt = AV_PIX_FMT_RGB48LE;
 
     if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
         SwsContext *c2;
@@ -1456,9 +1458,12 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         if (ret < 0)
             return ret;
 
+        // keep the full precision of the generic converter, the unscaled
+        // yuv2rgb path would only give 8 bits into the 16 bit intermediate
         c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
                                                 srcW, srcH, tmpFmt,
-                                                flags, NULL, NULL, c->param);
+                                                flags | SWS_ACCURATE_RND,
+                                                NULL, NULL, c->param);
         if (!c->cascaded_context[0]) {
             return -1;
         }
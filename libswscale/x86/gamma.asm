@@ -0,0 +1,74 @@
+;******************************************************************************
+;* x86-optimized gamma table lookup for gamma correct scaling
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pd_65535: times 8 dd 0xffff
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void ff_gamma_convert_<fmt>_<opt>(uint16_t *line, const uint16_t *table,
+;                                   int width);
+;
+; width must be a multiple of 16. Gathers dwords at table + 2 * sample and
+; keeps the low word, which is why the table has to be readable one entry
+; past the largest sample. The alpha of rgba64 is left untouched.
+;-----------------------------------------------------------------------------
+
+; %1 = rgb48 or rgba64
+%macro GAMMA_CONVERT_FN 1
+cglobal gamma_convert_%1, 3, 3, 7, line, table, w
+    movsxdifnidn   wq, wd
+%ifidn %1, rgb48
+    lea            wq, [wq*3]
+%else
+    shl            wq, 2
+%endif
+    lea         lineq, [lineq+wq*2]
+    neg            wq
+    mova           m6, [pd_65535]
+.loop:
+    pmovzxwd       m0, [lineq+wq*2]
+    pmovzxwd       m1, [lineq+wq*2+16]
+    pcmpeqd        m2, m2
+    pcmpeqd        m3, m3
+    vpgatherdd     m4, [tableq+m0*2], m2
+    vpgatherdd     m5, [tableq+m1*2], m3
+    pand           m4, m6
+    pand           m5, m6
+    packusdw       m4, m5
+    vpermq         m4, m4, q3120
+%ifidn %1, rgba64
+    pblendw        m4, [lineq+wq*2], 0x88   ; keep the last word of every pixel
+%endif
+    movu [lineq+wq*2], m4
+    add            wq, mmsize / 2
+    jl .loop
+    RET
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+GAMMA_CONVERT_FN rgb48
+GAMMA_CONVERT_FN rgba64
+%endif
@@ -23,7 +23,11 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 32
+
+; loaded as ymm by the AVX2 functions, keep them first for the alignment
+pb_bswap16:      times 2 db 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+pb_bswap16_zext: times 2 db 1, 0, 0x80, 0x80, 5, 4, 0x80, 0x80, 9, 8, 0x80, 0x80, 13, 12, 0x80, 0x80
 
 %define RY 0x20DE
 %define GY 0x4087
@@ -94,6 +98,15 @@ shuf_rgb_12x4:   db 0, 0x80, 1, 0x80,  2, 0x80,  3, 0x80, \
 shuf_rgb_3x56:   db 2, 0x80, 3, 0x80,  4, 0x80,  5, 0x80, \
                     8, 0x80, 9, 0x80, 10, 0x80, 11, 0x80
 
+; zero extend one component of 4 packed 48-bit pixels, loaded at +0 and +8,
+; to dwords, entry = component
+pb_rgb48_lo:     db  0,  1, -1, -1,  6,  7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+                 db  2,  3, -1, -1,  8,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+                 db  4,  5, -1, -1, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+pb_rgb48_hi:     db -1, -1, -1, -1, -1, -1, -1, -1,  4,  5, -1, -1, 10, 11, -1, -1
+                 db -1, -1, -1, -1, -1, -1, -1, -1,  6,  7, -1, -1, 12, 13, -1, -1
+                 db -1, -1, -1, -1, -1, -1, -1, -1,  8,  9, -1, -1, 14, 15, -1, -1
+
 SECTION .text
 
 ;-----------------------------------------------------------------------------
@@ -738,3 +751,488 @@ YUYV_TO_UV_FN 3, uyvy, 1
 NVXX_TO_UV_FN 5, nv12
 NVXX_TO_UV_FN 5, nv21
 %endif
+
+;-----------------------------------------------------------------------------
+; 16-bit per component YUV to Y/UV.
+;
+; void <fmt>ToY_<opt>(uint8_t *dst, const uint8_t *src, const uint8_t *unused1,
+;                     const uint8_t *unused2, int w, uint32_t *unused);
+; void <fmt>ToUV_<opt>(uint8_t *dstU, uint8_t *dstV, const uint8_t *unused,
+;                      const uint8_t *src1, const uint8_t *src2,
+;                      int w, uint32_t *unused);
+;
+; bswap16 reads opposite-endian planar YUV, p010le/be read the 10 MSBs of
+; P010 (NV12-like) lines. The output is native-endian uint16_t. Loads and
+; stores are unaligned and the last iteration may read and write up to
+; mmsize / 2 - 1 pixels past w.
+;-----------------------------------------------------------------------------
+
+; %1 = register to byte-swap the words of, %2 = temporary (sse2 only)
+%macro BSWAP16 2
+%if cpuflag(ssse3)
+    pshufb         %1, [pb_bswap16]
+%else
+    psrlw          %2, %1, 8
+    psllw          %1, 8
+    por            %1, %2
+%endif
+%endmacro
+
+; %1 = bswap16, p010le or p010be
+%macro WORD_TO_Y_FN 1
+cglobal %1ToY, 5, 5, 2, dst, src, unused1, unused2, w
+%if ARCH_X86_64
+    movsxd         wq, wd
+%endif
+    lea          dstq, [dstq+wq*2]
+    lea          srcq, [srcq+wq*2]
+    neg            wq
+.loop:
+    movu           m0, [srcq+wq*2]
+%ifnidn %1, p010le
+    BSWAP16        m0, m1
+%endif
+%ifnidn %1, bswap16
+    psrlw          m0, 6
+%endif
+    movu [dstq+wq*2], m0
+    add            wq, mmsize / 2
+    jl .loop
+    REP_RET
+%endmacro
+
+%macro BSWAP16_TO_UV_FN 0
+cglobal bswap16ToUV, 5, 6, 3, dstU, dstV, unused, src1, src2, w
+%if ARCH_X86_64
+    movsxd         wq, dword r5m
+%else ; x86-32
+    mov            wq, r5m
+%endif
+    lea         dstUq, [dstUq+wq*2]
+    lea         dstVq, [dstVq+wq*2]
+    lea         src1q, [src1q+wq*2]
+    lea         src2q, [src2q+wq*2]
+    neg            wq
+.loop:
+    movu           m0, [src1q+wq*2]
+    movu           m1, [src2q+wq*2]
+    BSWAP16        m0, m2
+    BSWAP16        m1, m2
+    movu [dstUq+wq*2], m0
+    movu [dstVq+wq*2], m1
+    add            wq, mmsize / 2
+    jl .loop
+    REP_RET
+%endmacro
+
+; %1 = le or be
+%macro P010_TO_UV_FN 1
+cglobal p010%1ToUV, 4, 5, 4, dstU, dstV, unused, src, w
+%if ARCH_X86_64
+    movsxd         wq, dword r5m
+%else ; x86-32
+    mov            wq, r5m
+%endif
+    lea         dstUq, [dstUq+wq*2]
+    lea         dstVq, [dstVq+wq*2]
+    lea          srcq, [srcq+wq*4]
+    neg            wq
+.loop:
+    movu           m0, [srcq+wq*4]        ; (word) { U0, V0, ..., U3, V3 }
+    movu           m1, [srcq+wq*4+mmsize] ; (word) { U4, V4, ..., U7, V7 }
+%ifidn %1, be
+    BSWAP16        m0, m2
+    BSWAP16        m1, m2
+%endif
+    pslld          m2, m0, 16
+    pslld          m3, m1, 16
+    psrld          m0, 22                 ; (dword) { V0 >> 6, ..., V3 >> 6 }
+    psrld          m1, 22                 ; (dword) { V4 >> 6, ..., V7 >> 6 }
+    psrld          m2, 22                 ; (dword) { U0 >> 6, ..., U3 >> 6 }
+    psrld          m3, 22                 ; (dword) { U4 >> 6, ..., U7 >> 6 }
+    packssdw       m2, m3
+    packssdw       m0, m1
+%if mmsize == 32
+    vpermq         m2, m2, q3120
+    vpermq         m0, m0, q3120
+%endif
+    movu [dstUq+wq*2], m2
+    movu [dstVq+wq*2], m0
+    add            wq, mmsize / 2
+    jl .loop
+    REP_RET
+%endmacro
+
+INIT_XMM sse2
+WORD_TO_Y_FN bswap16
+WORD_TO_Y_FN p010le
+WORD_TO_Y_FN p010be
+BSWAP16_TO_UV_FN
+P010_TO_UV_FN le
+P010_TO_UV_FN be
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+WORD_TO_Y_FN bswap16
+WORD_TO_Y_FN p010le
+WORD_TO_Y_FN p010be
+BSWAP16_TO_UV_FN
+P010_TO_UV_FN le
+P010_TO_UV_FN be
+%endif
+
+;-----------------------------------------------------------------------------
+; 9-16 bit planar GBR(A) to Y/UV/A.
+;
+; void planar_rgb<bpc><le/be>_to_y_<opt>(uint8_t *dst, const uint8_t *src[4],
+;                                        int w, int32_t *rgb2yuv);
+; void planar_rgb<bpc><le/be>_to_uv_<opt>(uint8_t *dstU, uint8_t *dstV,
+;                                         const uint8_t *src[4], int w,
+;                                         int32_t *rgb2yuv);
+; void planar_rgb<bpc><le/be>_to_a_<opt>(uint8_t *dst, const uint8_t *src[4],
+;                                        int w, int32_t *rgb2yuv);
+;
+; Same arithmetic as planar_rgb16_to_y/uv/a() in libswscale/input.c: 32-bit
+; products of the components and the rgb2yuv coefficients, the result is
+; truncated to 16 bits.
+;-----------------------------------------------------------------------------
+
+%if ARCH_X86_64
+; %1 = dst, %2 = source pointer, %3 = byte offset, %4 = le or be
+%macro LOAD_RGB16 4
+    pmovzxwd       %1, [%2+wq*2+%3]
+%ifidn %4, be
+    pshufb         %1, m15
+%endif
+%endmacro
+
+; %1 = dst, %2 = coefficient index into rgb2yuv
+%macro LOAD_COEFF 2
+%if cpuflag(avx2)
+    vpbroadcastd   %1, [coeffsq+%2*4]
+%else
+    movd           %1, [coeffsq+%2*4]
+    pshufd         %1, %1, 0
+%endif
+%endmacro
+
+; %1 = dst, %2 = 32-bit constant
+%macro LOAD_CONST 2
+    mov       coeffsd, %2
+    movd          xm%1, coeffsd
+%if cpuflag(avx2)
+    vpbroadcastd  m%1, xm%1
+%else
+    pshufd        m%1, m%1, 0
+%endif
+%endmacro
+
+; truncate the dwords of %1 (pixels 0..) and %2 (the following pixels)
+; to words and pack them into %1
+%macro PACK_RGB16 2
+    pslld          %1, 16
+    pslld          %2, 16
+    psrad          %1, 16
+    psrad          %2, 16
+    packssdw       %1, %2
+%if mmsize == 32
+    vpermq         %1, %1, q3120
+%endif
+%endmacro
+
+; Y = (ry * r + gy * g + by * b + rnd) >> shift, with
+; m4 = rnd, m5 = ry, m6 = gy, m7 = by
+; %1 = dst, %2 = byte offset, %3 = le or be, %4 = shift
+%macro RGB16_TO_Y 4
+    LOAD_RGB16     %1, srcgq, %2, %3
+    LOAD_RGB16     m2, srcbq, %2, %3
+    LOAD_RGB16     m3, srcrq, %2, %3
+    pmulld         %1, m6
+    pmulld         m2, m7
+    pmulld         m3, m5
+    paddd          %1, m2
+    paddd          m3, m4
+    paddd          %1, m3
+    psrad          %1, %4
+%endmacro
+
+; m4 = rnd, m5-m7 = ru, gu, bu, m8-m10 = rv, gv, bv
+; %1 = dst U, %2 = dst V, %3 = byte offset, %4 = le or be, %5 = shift
+%macro RGB16_TO_UV 5
+    LOAD_RGB16     %2, srcgq, %3, %4
+    LOAD_RGB16    m11, srcbq, %3, %4
+    LOAD_RGB16    m12, srcrq, %3, %4
+    pmulld         %1, %2, m6
+    pmulld        m13, m11, m7
+    pmulld        m14, m12, m5
+    paddd          %1, m13
+    paddd         m14, m4
+    paddd          %1, m14
+    psrad          %1, %5
+    pmulld         %2, m9
+    pmulld        m11, m10
+    pmulld        m12, m8
+    paddd          %2, m11
+    paddd         m12, m4
+    paddd          %2, m12
+    psrad          %2, %5
+%endmacro
+
+; %1 = bpc, %2 = le or be
+%macro PLANAR_RGB16_FNS 2
+%if %1 < 16
+%assign %%shift %1 + 1
+%else
+%assign %%shift 15
+%endif
+
+cglobal planar_rgb%1%2_to_y, 4, 7, 16, dst, src, w, coeffs, srcg, srcb, srcr
+    movsxd         wq, wd
+    mov         srcgq, [srcq+0*gprsize]
+    mov         srcbq, [srcq+1*gprsize]
+    mov         srcrq, [srcq+2*gprsize]
+    LOAD_COEFF     m5, RY_IDX
+    LOAD_COEFF     m6, GY_IDX
+    LOAD_COEFF     m7, BY_IDX
+    LOAD_CONST      4, 33 << (%1 + 6)
+%ifidn %2, be
+    mova          m15, [pb_bswap16_zext]
+%endif
+    lea          dstq, [dstq+wq*2]
+    lea         srcgq, [srcgq+wq*2]
+    lea         srcbq, [srcbq+wq*2]
+    lea         srcrq, [srcrq+wq*2]
+    neg            wq
+.loop:
+    RGB16_TO_Y     m0, 0,          %2, %%shift
+    RGB16_TO_Y     m1, mmsize / 2, %2, %%shift
+    PACK_RGB16     m0, m1
+    movu [dstq+wq*2], m0
+    add            wq, mmsize / 2
+    jl .loop
+    RET
+
+cglobal planar_rgb%1%2_to_uv, 5, 7, 16, dstU, dstV, srcr, w, coeffs, srcg, srcb
+    movsxd         wq, wd
+    mov         srcgq, [srcrq+0*gprsize]
+    mov         srcbq, [srcrq+1*gprsize]
+    mov         srcrq, [srcrq+2*gprsize]
+    LOAD_COEFF     m5, RU_IDX
+    LOAD_COEFF     m6, GU_IDX
+    LOAD_COEFF     m7, BU_IDX
+    LOAD_COEFF     m8, RV_IDX
+    LOAD_COEFF     m9, GV_IDX
+    LOAD_COEFF    m10, BV_IDX
+    LOAD_CONST      4, 257 << (%1 + 6)
+%ifidn %2, be
+    mova          m15, [pb_bswap16_zext]
+%endif
+    lea         dstUq, [dstUq+wq*2]
+    lea         dstVq, [dstVq+wq*2]
+    lea         srcgq, [srcgq+wq*2]
+    lea         srcbq, [srcbq+wq*2]
+    lea         srcrq, [srcrq+wq*2]
+    neg            wq
+.loop:
+    RGB16_TO_UV    m0, m1, 0,          %2, %%shift
+    RGB16_TO_UV    m2, m3, mmsize / 2, %2, %%shift
+    PACK_RGB16     m0, m2
+    PACK_RGB16     m1, m3
+    movu [dstUq+wq*2], m0
+    movu [dstVq+wq*2], m1
+    add            wq, mmsize / 2
+    jl .loop
+    RET
+%endmacro
+
+; %1 = bpc, %2 = le or be
+%macro PLANAR_RGB16_TO_A_FN 2
+cglobal planar_rgb%1%2_to_a, 3, 4, 1, dst, src, w, srca
+    movsxd         wq, wd
+    mov         srcaq, [srcq+3*gprsize]
+    lea          dstq, [dstq+wq*2]
+    lea         srcaq, [srcaq+wq*2]
+    neg            wq
+.loop:
+    movu           m0, [srcaq+wq*2]
+%ifidn %2, be
+    pshufb         m0, [pb_bswap16]
+%endif
+%if %1 < 14
+    psllw          m0, 14 - %1
+%endif
+    movu [dstq+wq*2], m0
+    add            wq, mmsize / 2
+    jl .loop
+    REP_RET
+%endmacro
+
+%macro PLANAR_RGB16_FUNCS 0
+PLANAR_RGB16_FNS      9, le
+PLANAR_RGB16_FNS      9, be
+PLANAR_RGB16_FNS     10, le
+PLANAR_RGB16_FNS     10, be
+PLANAR_RGB16_FNS     12, le
+PLANAR_RGB16_FNS     12, be
+PLANAR_RGB16_FNS     14, le
+PLANAR_RGB16_FNS     14, be
+PLANAR_RGB16_FNS     16, le
+PLANAR_RGB16_FNS     16, be
+PLANAR_RGB16_TO_A_FN 10, le
+PLANAR_RGB16_TO_A_FN 10, be
+PLANAR_RGB16_TO_A_FN 12, le
+PLANAR_RGB16_TO_A_FN 12, be
+PLANAR_RGB16_TO_A_FN 16, le
+PLANAR_RGB16_TO_A_FN 16, be
+%endmacro
+
+;-----------------------------------------------------------------------------
+; Packed little endian RGB48/BGR48 to Y/UV.
+;
+; void <rgb/bgr>48LEToY_<opt>(uint8_t *dst, const uint8_t *src,
+;                             const uint8_t *unused1, const uint8_t *unused2,
+;                             int w, uint32_t *rgb2yuv);
+; void <rgb/bgr>48LEToUV[_half]_<opt>(uint8_t *dstU, uint8_t *dstV,
+;                                     const uint8_t *unused0,
+;                                     const uint8_t *src1, const uint8_t *src2,
+;                                     int w, uint32_t *rgb2yuv);
+;
+; Same arithmetic as rgb48ToY/ToUV/ToUV_half_c_template() in
+; libswscale/input.c, the _half variant averages horizontal pixel pairs.
+;-----------------------------------------------------------------------------
+
+; %1 = dst, %2 = component index in the packed pixel
+%macro RGB48_COMP 2
+    pshufb         %1, m0, [pb_rgb48_lo+16*%2]
+    pshufb        m15, m1, [pb_rgb48_hi+16*%2]
+    por            %1, m15
+%endmacro
+
+; r, g, b of the 4 pixels at byte offset %1 into m11, m12, m13
+%macro LOAD_RGB48 1
+    movu           m0, [srcq+%1]
+    movu           m1, [srcq+%1+8]
+    RGB48_COMP    m11, R_COMP
+    RGB48_COMP    m12, 1
+    RGB48_COMP    m13, B_COMP
+%endmacro
+
+; averages of the 4 pixel pairs at byte offset %1 into m11, m12, m13
+%macro LOAD_RGB48_HALF 1
+    LOAD_RGB48     %1
+    movu           m0, [srcq+%1+24]
+    movu           m1, [srcq+%1+32]
+    RGB48_COMP    m14, R_COMP
+    phaddd        m11, m14
+    RGB48_COMP    m14, 1
+    phaddd        m12, m14
+    RGB48_COMP    m14, B_COMP
+    phaddd        m13, m14
+    pcmpeqd        m0, m0
+    psubd         m11, m0
+    psubd         m12, m0
+    psubd         m13, m0
+    psrld         m11, 1
+    psrld         m12, 1
+    psrld         m13, 1
+%endmacro
+
+; %1 = dst, %2-%4 = r, g, b coefficients
+; (r * %2 + g * %3 + b * %4 + m4) >> 15 from m11-m13
+%macro RGB48_DOT 4
+    pmulld         %1, m11, %2
+    pmulld        m14, m12, %3
+    paddd          %1, m14
+    pmulld        m14, m13, %4
+    paddd          %1, m14
+    paddd          %1, m4
+    psrld          %1, RGB2YUV_SHIFT
+%endmacro
+
+; %1 = rgb or bgr
+%macro RGB48_FNS 1
+%ifidn %1, rgb
+%define R_COMP 0
+%define B_COMP 2
+%else
+%define R_COMP 2
+%define B_COMP 0
+%endif
+
+cglobal %1 %+ 48LEToY, 6, 6, 16, dst, src, u1, u2, w, coeffs
+    movsxd         wq, wd
+    LOAD_COEFF     m5, RY_IDX
+    LOAD_COEFF     m6, GY_IDX
+    LOAD_COEFF     m7, BY_IDX
+    LOAD_CONST      4, 0x2001 << (RGB2YUV_SHIFT - 1)
+    lea          dstq, [dstq+wq*2]
+    neg            wq
+.loop:
+    LOAD_RGB48      0
+    RGB48_DOT      m2, m5, m6, m7
+    LOAD_RGB48     24
+    RGB48_DOT      m3, m5, m6, m7
+    PACK_RGB16     m2, m3
+    movu [dstq+wq*2], m2
+    add          srcq, 48
+    add            wq, 8
+    jl .loop
+    RET
+
+RGB48_TO_UV_FN %1,      , LOAD_RGB48,       6
+RGB48_TO_UV_FN %1, _half, LOAD_RGB48_HALF, 12
+%endmacro
+
+; %1 = rgb or bgr, %2 = name suffix, %3 = load macro,
+; %4 = source bytes per output pixel
+%macro RGB48_TO_UV_FN 4
+cglobal %1 %+ 48LEToUV%2, 7, 7, 16, dstU, dstV, u1, src, u2, w, coeffs
+    movsxd         wq, wd
+    LOAD_COEFF     m5, RU_IDX
+    LOAD_COEFF     m6, GU_IDX
+    LOAD_COEFF     m7, BU_IDX
+    LOAD_COEFF     m8, RV_IDX
+    LOAD_COEFF     m9, GV_IDX
+    LOAD_COEFF    m10, BV_IDX
+    LOAD_CONST      4, 0x10001 << (RGB2YUV_SHIFT - 1)
+    lea         dstUq, [dstUq+wq*2]
+    lea         dstVq, [dstVq+wq*2]
+    neg            wq
+.loop:
+    %3              0
+    RGB48_DOT      m2, m5, m6, m7
+    RGB48_DOT      m3, m8, m9, m10
+    %3              %4 * 4
+    RGB48_DOT      m0, m5, m6, m7
+    RGB48_DOT      m1, m8, m9, m10
+    PACK_RGB16     m2, m0
+    PACK_RGB16     m3, m1
+    movu [dstUq+wq*2], m2
+    movu [dstVq+wq*2], m3
+    add          srcq, %4 * 8
+    add            wq, 8
+    jl .loop
+    RET
+%endmacro
+
+%define RGB2YUV_SHIFT 15
+%define RY_IDX 0
+%define GY_IDX 1
+%define BY_IDX 2
+%define RU_IDX 3
+%define GU_IDX 4
+%define BU_IDX 5
+%define RV_IDX 6
+%define GV_IDX 7
+%define BV_IDX 8
+
+INIT_XMM sse4
+PLANAR_RGB16_FUNCS
+RGB48_FNS rgb
+RGB48_FNS bgr
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+PLANAR_RGB16_FUNCS
+%endif
+%endif ; ARCH_X86_64
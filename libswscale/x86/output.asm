@@ -22,20 +22,28 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
-
-minshort:      times 8 dw 0x8000
-yuv2yuvX_16_start:  times 4 dd 0x4000 - 0x40000000
-yuv2yuvX_10_start:  times 4 dd 0x10000
-yuv2yuvX_9_start:   times 4 dd 0x20000
-yuv2yuvX_10_upper:  times 8 dw 0x3ff
-yuv2yuvX_9_upper:   times 8 dw 0x1ff
-pd_4:          times 4 dd 4
-pd_4min0x40000:times 4 dd 4 - (0x40000)
-pw_16:         times 8 dw 16
-pw_32:         times 8 dw 32
-pw_512:        times 8 dw 512
-pw_1024:       times 8 dw 1024
+SECTION_RODATA 32
+
+minshort:      times 16 dw 0x8000
+yuv2yuvX_16_start:  times 8 dd 0x4000 - 0x40000000
+yuv2yuvX_14_start:  times 8 dd 0x1000
+yuv2yuvX_12_start:  times 8 dd 0x4000
+yuv2yuvX_10_start:  times 8 dd 0x10000
+yuv2yuvX_9_start:   times 8 dd 0x20000
+yuv2yuvX_14_upper:  times 16 dw 0x3fff
+yuv2yuvX_12_upper:  times 16 dw 0xfff
+yuv2yuvX_10_upper:  times 16 dw 0x3ff
+yuv2yuvX_9_upper:   times 16 dw 0x1ff
+pd_4:          times 8 dd 4
+pd_4min0x40000:times 8 dd 4 - (0x40000)
+pw_1:          times 16 dw 1
+pw_4:          times 16 dw 4
+pw_16:         times 16 dw 16
+pw_32:         times 16 dw 32
+pw_512:        times 16 dw 512
+pw_1024:       times 16 dw 1024
+pw_4096:       times 16 dw 4096
+pw_16384:      times 16 dw 16384
 
 SECTION .text
 
@@ -50,9 +58,13 @@ SECTION .text
 ;                                     const uint8_t *dither, int offset)
 ;
 ; Scale one or $filterSize lines of source data to generate one line of output
-; data. The input is 15 bits in int16_t if $output_size is [8,10] and 19 bits in
+; data. The input is 15 bits in int16_t if $output_size is [8,14] and 19 bits in
 ; int32_t if $output_size is 16. $filter is 12 bits. $filterSize is a multiple
 ; of 2. $offset is either 0 or 3. $dither holds 8 values.
+;
+; The AVX2 versions process 16 (yuv2planeX) or 32 (yuv2plane1) pixels per
+; iteration and only get called for a multiple of that many pixels, the rest
+; of the line is left to the AVX/SSE versions (see libswscale/x86/swscale.c).
 ;-----------------------------------------------------------------------------
 %macro yuv2planeX_mainloop 2
 .pixelloop_%2:
@@ -61,8 +73,8 @@ SECTION .text
     ; 8 pixels but we can only handle 2 pixels per register, and thus 4
     ; pixels per iteration. In order to not have to keep track of where
     ; we are w.r.t. dithering, we unroll the MMX/8-bit loop x2.
-%if %1 == 8
-%assign %%repcnt 16/mmsize
+%if %1 == 8 && mmsize == 8
+%assign %%repcnt 2
 %else
 %assign %%repcnt 1
 %endif
@@ -86,26 +98,36 @@ SECTION .text
     ; input pixels
     mov             r6, [srcq+gprsize*cntr_reg-2*gprsize]
 %if %1 == 16
-    mova            m3, [r6+r5*4]
-    mova            m5, [r6+r5*4+mmsize]
+    movsrc          m3, [r6+r5*4]
+    movsrc          m5, [r6+r5*4+mmsize]
 %else ; %1 == 8/9/10
-    mova            m3, [r6+r5*2]
+    movsrc          m3, [r6+r5*2]
 %endif ; %1 == 8/9/10/16
     mov             r6, [srcq+gprsize*cntr_reg-gprsize]
 %if %1 == 16
-    mova            m4, [r6+r5*4]
-    mova            m6, [r6+r5*4+mmsize]
+    movsrc          m4, [r6+r5*4]
+    movsrc          m6, [r6+r5*4+mmsize]
 %else ; %1 == 8/9/10
-    mova            m4, [r6+r5*2]
+    movsrc          m4, [r6+r5*2]
 %endif ; %1 == 8/9/10/16
 
     ; coefficients
+%if mmsize == 32
+    vpbroadcastd    m0, [filterq+2*cntr_reg-4] ; coeff[0], coeff[1]
+%else ; mmsize == 8/16
     movd            m0, [filterq+2*cntr_reg-4] ; coeff[0], coeff[1]
+%endif ; mmsize == 8/16/32
 %if %1 == 16
+%if mmsize == 32
+    pslld           m7,  m0,  16
+    psrad           m7,  16              ; coeff[0]
+    psrad           m0,  16              ; coeff[1]
+%else ; mmsize == 16
     pshuflw         m7,  m0,  0          ; coeff[0]
     pshuflw         m0,  m0,  0x55       ; coeff[1]
     pmovsxwd        m7,  m7              ; word -> dword
     pmovsxwd        m0,  m0              ; word -> dword
+%endif ; mmsize == 16/32
 
     pmulld          m3,  m7
     pmulld          m5,  m7
@@ -119,7 +141,9 @@ SECTION .text
 %else ; %1 == 10/9/8
     punpcklwd       m5,  m3,  m4
     punpckhwd       m3,  m4
+%if mmsize != 32
     SPLATD          m0
+%endif ; mmsize != 32
 
     pmaddwd         m5,  m0
     pmaddwd         m3,  m0
@@ -142,20 +166,30 @@ SECTION .text
 %if %1 == 8
     packssdw        m2,  m1
     packuswb        m2,  m2
+%if mmsize == 32
+    vpermq          m2,  m2,  q2020
+    movu   [dstq+r5*1], xm2
+%else ; mmsize == 8/16
     movh   [dstq+r5*1],  m2
+%endif ; mmsize == 8/16/32
 %else ; %1 == 9/10/16
 %if %1 == 16
     packssdw        m2,  m1
+%if mmsize == 32
+    vpermq          m2,  m2,  q3120
+%endif ; mmsize == 32
     paddw           m2, [minshort]
-%else ; %1 == 9/10
-%if cpuflag(sse4)
+%else ; %1 == 9/10/12/14
+    ; for 12/14 bits, the sums can exceed the signed word range once
+    ; shifted, so clamp in the signed domain for pminsw
+%if cpuflag(sse4) && %1 <= 10
     packusdw        m2,  m1
-%else ; mmxext/sse2
+%else ; mmxext/sse2 or 12/14 bits
     packssdw        m2,  m1
     pmaxsw          m2,  m6
 %endif ; mmxext/sse2/sse4/avx
     pminsw          m2, [yuv2yuvX_%1_upper]
-%endif ; %1 == 9/10/16
+%endif ; %1 == 9/10/12/14/16
     mov%2   [dstq+r5*2],  m2
 %endif ; %1 == 8/9/10/16
 
@@ -177,12 +211,34 @@ SECTION .text
 %define movsx movsxd
 %endif
 
+%if mmsize == 32
+%define movsrc movu
+%else
+%define movsrc mova
+%endif
+
 cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
-%if %1 == 8 || %1 == 9 || %1 == 10
+%if %1 < 16
     pxor            m6,  m6
-%endif ; %1 == 8/9/10
+%endif ; %1 == 8/9/10/12/14
 
-%if %1 == 8
+%if %1 == 8 && mmsize == 32
+    ; create registers holding dither, identical in both lanes
+    movq           xm9, [ditherq]        ; dither
+    test       offsetd, offsetd
+    jz              .no_rot
+    punpcklqdq     xm9, xm9
+    PALIGNR        xm9, xm9, 3, xm0
+.no_rot:
+    punpcklbw      xm9, xm6
+    punpcklwd      xm8, xm9, xm6
+    punpckhwd      xm9, xm6
+    pslld          xm8, 12
+    pslld          xm9, 12
+    vpermq          m8, m8, q1010
+    vpermq          m9, m9, q1010
+%define m_dith m9
+%elif %1 == 8
 %if ARCH_X86_32
 %assign pad 0x2c - (stack_offset & 15)
     SUB             rsp, pad
@@ -237,6 +293,8 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
 
 %if mmsize == 8 || %1 == 8
     yuv2planeX_mainloop %1, a
+%elif mmsize == 32
+    yuv2planeX_mainloop %1, u
 %else ; mmsize == 16
     test          dstq, 15
     jnz .unaligned
@@ -246,7 +304,7 @@ cglobal yuv2planeX_%1, %3, 8, %2, filter, fltsize, src, dst, w, dither, offset
     yuv2planeX_mainloop %1, u
 %endif ; mmsize == 8/16
 
-%if %1 == 8
+%if %1 == 8 && mmsize != 32
 %if ARCH_X86_32
     ADD             rsp, pad
     RET
@@ -263,17 +321,23 @@ INIT_MMX mmxext
 yuv2planeX_fn  8,  0, 7
 yuv2planeX_fn  9,  0, 5
 yuv2planeX_fn 10,  0, 5
+yuv2planeX_fn 12,  0, 5
+yuv2planeX_fn 14,  0, 5
 %endif
 
 INIT_XMM sse2
 yuv2planeX_fn  8, 10, 7
 yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
 
 INIT_XMM sse4
 yuv2planeX_fn  8, 10, 7
 yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
 yuv2planeX_fn 16,  8, 5
 
 %if HAVE_AVX_EXTERNAL
@@ -281,6 +345,18 @@ INIT_XMM avx
 yuv2planeX_fn  8, 10, 7
 yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
+%endif
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+yuv2planeX_fn  8, 10, 7
+yuv2planeX_fn  9,  7, 5
+yuv2planeX_fn 10,  7, 5
+yuv2planeX_fn 12,  7, 5
+yuv2planeX_fn 14,  7, 5
+yuv2planeX_fn 16,  8, 5
 %endif
 
 ; %1=outout-bpc, %2=alignment (u/a)
@@ -292,6 +368,9 @@ yuv2planeX_fn 10,  7, 5
     psraw           m0, 7
     psraw           m1, 7
     packuswb        m0, m1
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+%endif ; mmsize == 32
     mov%2    [dstq+wq], m0
 %elif %1 == 16
     paddd           m0, m4, [srcq+wq*4+mmsize*0]
@@ -302,9 +381,13 @@ yuv2planeX_fn 10,  7, 5
     psrad           m1, 3
     psrad           m2, 3
     psrad           m3, 3
-%if cpuflag(sse4) ; avx/sse4
+%if cpuflag(sse4) ; avx/sse4/avx2
     packusdw        m0, m1
     packusdw        m2, m3
+%if mmsize == 32
+    vpermq          m0, m0, q3120
+    vpermq          m2, m2, q3120
+%endif ; mmsize == 32
 %else ; mmx/sse2
     packssdw        m0, m1
     packssdw        m2, m3
@@ -313,7 +396,7 @@ yuv2planeX_fn 10,  7, 5
 %endif ; mmx/sse2/sse4/avx
     mov%2    [dstq+wq*2+mmsize*0], m0
     mov%2    [dstq+wq*2+mmsize*1], m2
-%else ; %1 == 9/10
+%else ; %1 == 9/10/12/14
     paddsw          m0, m2, [srcq+wq*2+mmsize*0]
     paddsw          m1, m2, [srcq+wq*2+mmsize*1]
     psraw           m0, 15 - %1
@@ -350,15 +433,19 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     pxor            m4, m4               ; zero
 
     ; create registers holding dither
-    movq            m3, [ditherq]        ; dither
+    movq           xm3, [ditherq]        ; dither
     test       offsetd, offsetd
     jz              .no_rot
-%if mmsize == 16
-    punpcklqdq      m3, m3
-%endif ; mmsize == 16
-    PALIGNR         m3, m3, 3, m2
+%if mmsize >= 16
+    punpcklqdq     xm3, xm3
+%endif ; mmsize >= 16
+    PALIGNR        xm3, xm3, 3, xm2
 .no_rot:
-%if mmsize == 8
+%if mmsize == 32
+    punpcklbw      xm3, xm4
+    vpermq          m3, m3, q1010
+    mova            m2, m3
+%elif mmsize == 8
     mova            m2, m3
     punpckhbw       m3, m4               ; byte->word
     punpcklbw       m2, m4               ; byte->word
@@ -374,6 +461,14 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     pxor            m4, m4
     mova            m3, [pw_1024]
     mova            m2, [pw_16]
+%elif %1 == 12
+    pxor            m4, m4
+    mova            m3, [pw_4096]
+    mova            m2, [pw_4]
+%elif %1 == 14
+    pxor            m4, m4
+    mova            m3, [pw_16384]
+    mova            m2, [pw_1]
 %else ; %1 == 16
 %if cpuflag(sse4) ; sse4/avx
     mova            m4, [pd_4]
@@ -386,6 +481,8 @@ cglobal yuv2plane1_%1, %3, %3, %2, src, dst, w, dither, offset
     ; actual pixel scaling
 %if mmsize == 8
     yuv2plane1_mainloop %1, a
+%elif mmsize == 32
+    yuv2plane1_mainloop %1, u
 %else ; mmsize == 16
     test          dstq, 15
     jnz .unaligned
@@ -405,12 +502,16 @@ yuv2plane1_fn 16, 0, 3
 INIT_MMX mmxext
 yuv2plane1_fn  9, 0, 3
 yuv2plane1_fn 10, 0, 3
+yuv2plane1_fn 12, 0, 3
+yuv2plane1_fn 14, 0, 3
 %endif
 
 INIT_XMM sse2
 yuv2plane1_fn  8, 5, 5
 yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 12, 5, 3
+yuv2plane1_fn 14, 5, 3
 yuv2plane1_fn 16, 6, 3
 
 INIT_XMM sse4
@@ -421,5 +522,17 @@ INIT_XMM avx
 yuv2plane1_fn  8, 5, 5
 yuv2plane1_fn  9, 5, 3
 yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 12, 5, 3
+yuv2plane1_fn 14, 5, 3
+yuv2plane1_fn 16, 5, 3
+%endif
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+INIT_YMM avx2
+yuv2plane1_fn  8, 5, 5
+yuv2plane1_fn  9, 5, 3
+yuv2plane1_fn 10, 5, 3
+yuv2plane1_fn 12, 5, 3
+yuv2plane1_fn 14, 5, 3
 yuv2plane1_fn 16, 5, 3
 %endif
@@ -0,0 +1,616 @@
+;******************************************************************************
+;* x86-optimized unscaled packed <-> planar RGB conversion functions
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+; pshufb masks moving 16 packed 24-bit pixels (8 packed 48-bit pixels) spread
+; over three registers to and from three planes, entry 3*plane+register for
+; unpack and 3*register+plane for pack
+pb_unpack24:   db  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  1,  4,  7, 10, 13
+               db  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14
+               db  2,  5,  8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1,  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15
+
+pb_pack24:     db  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5
+               db -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1
+               db -1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1
+               db -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1
+               db  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10
+               db -1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1
+               db -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1
+               db -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1
+               db 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15
+
+pb_unpack48:   db  0,  1,  6,  7, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1,  2,  3,  8,  9, 14, 15, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  4,  5, 10, 11
+               db  2,  3,  8,  9, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1,  4,  5, 10, 11, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  1,  6,  7, 12, 13
+               db  4,  5, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1,  0,  1,  6,  7, 12, 13, -1, -1, -1, -1, -1, -1
+               db -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  3,  8,  9, 14, 15
+
+pb_pack48:     db  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5, -1, -1
+               db -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5
+               db -1, -1, -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1
+               db -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1, 10, 11
+               db -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1
+               db  4,  5, -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1
+               db -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1
+               db 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1
+               db -1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15
+pb_unpack32:             db 0, 4,  8, 12, 1, 5,  9, 13, 2, 6, 10, 14, -1, -1, -1, -1
+pb_unpack32_alpha_first: db 1, 5,  9, 13, 2, 6, 10, 14, 3, 7, 11, 15, -1, -1, -1, -1
+pb_unpack64:             db 0, 1,  8,  9, 2, 3, 10, 11, 4, 5, 12, 13,  6,  7, 14, 15
+
+SECTION .text
+
+; %1 = destination, %2 = mask table, %3 = index of the mask for m0
+; combine the bytes selected from m0, m1 and m2, clobbers m4 and m5
+%macro SHUFFLE3 3
+    pshufb              %1, m0, [%2+16*(%3+0)]
+    pshufb              m4, m1, [%2+16*(%3+1)]
+    pshufb              m5, m2, [%2+16*(%3+2)]
+    por                 %1, m4
+    por                 %1, m5
+%endmacro
+
+; %1 = register, %2 = temporary
+; x << scale_high | x >> scale_low with the shift counts in m6 and m7
+%macro SCALE16 2
+    psrlw               %2, %1, m7
+    psllw               %1, m6
+    por                 %1, %2
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void ff_gbr24ptopacked24(uint8_t *dst, const uint8_t *src0,
+;                          const uint8_t *src1, const uint8_t *src2, int width)
+;
+; width must be a multiple of 16
+;-----------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal gbr24ptopacked24, 5, 5, 6, dst, src0, src1, src2, w
+    movsxdifnidn        wq, wd
+    add              src0q, wq
+    add              src1q, wq
+    add              src2q, wq
+    neg                 wq
+.loop:
+    movu                m0, [src0q+wq]
+    movu                m1, [src1q+wq]
+    movu                m2, [src2q+wq]
+    SHUFFLE3            m3, pb_pack24, 0
+    movu      [dstq+ 0], m3
+    SHUFFLE3            m3, pb_pack24, 3
+    movu      [dstq+16], m3
+    SHUFFLE3            m3, pb_pack24, 6
+    movu      [dstq+32], m3
+    add               dstq, 48
+    add                 wq, 16
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_gbr24ptopacked32(uint8_t *dst, const uint8_t *src0,
+;                          const uint8_t *src1, const uint8_t *src2, int width)
+;
+; width must be a multiple of 16
+;-----------------------------------------------------------------------------
+; %1 = alpha first
+%macro GBR24P_TO_PACKED32 1
+%if %1
+cglobal gbr24ptopacked32_alpha_first, 5, 5, 7, dst, src0, src1, src2, w
+%else
+cglobal gbr24ptopacked32, 5, 5, 7, dst, src0, src1, src2, w
+%endif
+    movsxdifnidn        wq, wd
+    add              src0q, wq
+    add              src1q, wq
+    add              src2q, wq
+    lea               dstq, [dstq+wq*4]
+    neg                 wq
+    pcmpeqb             m6, m6
+.loop:
+    movu                m0, [src0q+wq]
+    movu                m1, [src1q+wq]
+    movu                m2, [src2q+wq]
+%if %1
+    punpckhbw           m3, m6, m0
+    punpcklbw           m4, m6, m0
+    punpckhbw           m5, m1, m2
+    punpcklbw           m1, m2
+    punpcklwd           m0, m4, m1
+    punpckhwd           m4, m1
+    punpcklwd           m1, m3, m5
+    punpckhwd           m3, m5
+    movu [dstq+wq*4+ 0], m0
+    movu [dstq+wq*4+16], m4
+    movu [dstq+wq*4+32], m1
+    movu [dstq+wq*4+48], m3
+%else
+    punpckhbw           m3, m0, m1
+    punpcklbw           m0, m1
+    punpckhbw           m4, m2, m6
+    punpcklbw           m2, m6
+    punpcklwd           m1, m0, m2
+    punpckhwd           m0, m2
+    punpcklwd           m2, m3, m4
+    punpckhwd           m3, m4
+    movu [dstq+wq*4+ 0], m1
+    movu [dstq+wq*4+16], m0
+    movu [dstq+wq*4+32], m2
+    movu [dstq+wq*4+48], m3
+%endif
+    add                 wq, 16
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+GBR24P_TO_PACKED32 0
+GBR24P_TO_PACKED32 1
+
+;-----------------------------------------------------------------------------
+; void ff_packed24togbr24p(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+;                          const uint8_t *src, int width)
+;
+; width must be a multiple of 16
+;-----------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal packed24togbr24p, 5, 5, 6, dst0, dst1, dst2, src, w
+    movsxdifnidn        wq, wd
+    add              dst0q, wq
+    add              dst1q, wq
+    add              dst2q, wq
+    neg                 wq
+.loop:
+    movu                m0, [srcq+ 0]
+    movu                m1, [srcq+16]
+    movu                m2, [srcq+32]
+    SHUFFLE3            m3, pb_unpack24, 0
+    movu      [dst0q+wq], m3
+    SHUFFLE3            m3, pb_unpack24, 3
+    movu      [dst1q+wq], m3
+    SHUFFLE3            m3, pb_unpack24, 6
+    movu      [dst2q+wq], m3
+    add               srcq, 48
+    add                 wq, 16
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_packed32togbr24p(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+;                          const uint8_t *src, int width)
+;
+; width must be a multiple of 16
+;-----------------------------------------------------------------------------
+; %1 = alpha first
+%macro PACKED32_TO_GBR24P 1
+%if %1
+cglobal packed32togbr24p_alpha_first, 5, 5, 8, dst0, dst1, dst2, src, w
+    mova                m7, [pb_unpack32_alpha_first]
+%else
+cglobal packed32togbr24p, 5, 5, 8, dst0, dst1, dst2, src, w
+    mova                m7, [pb_unpack32]
+%endif
+    movsxdifnidn        wq, wd
+    add              dst0q, wq
+    add              dst1q, wq
+    add              dst2q, wq
+    lea               srcq, [srcq+wq*4]
+    neg                 wq
+.loop:
+    movu                m0, [srcq+wq*4+ 0]
+    movu                m1, [srcq+wq*4+16]
+    movu                m2, [srcq+wq*4+32]
+    movu                m3, [srcq+wq*4+48]
+    pshufb              m0, m7
+    pshufb              m1, m7
+    pshufb              m2, m7
+    pshufb              m3, m7
+    punpckldq           m4, m0, m1
+    punpckhdq           m0, m1
+    punpckldq           m5, m2, m3
+    punpckhdq           m2, m3
+    punpcklqdq          m6, m4, m5
+    punpckhqdq          m4, m5
+    punpcklqdq          m0, m2
+    movu      [dst0q+wq], m6
+    movu      [dst1q+wq], m4
+    movu      [dst2q+wq], m0
+    add                 wq, 16
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM ssse3
+PACKED32_TO_GBR24P 0
+PACKED32_TO_GBR24P 1
+
+;-----------------------------------------------------------------------------
+; void ff_gbr16ptopacked48(uint16_t *dst, const uint16_t *src0,
+;                          const uint16_t *src1, const uint16_t *src2,
+;                          int width, int scale_high, int scale_low)
+;
+; width must be a multiple of 8
+;-----------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal gbr16ptopacked48, 5, 5, 8, dst, src0, src1, src2, w, high, low
+    movsxdifnidn        wq, wd
+    movd                m6, highm
+    movd                m7, lowm
+    lea              src0q, [src0q+wq*2]
+    lea              src1q, [src1q+wq*2]
+    lea              src2q, [src2q+wq*2]
+    neg                 wq
+.loop:
+    movu                m0, [src0q+wq*2]
+    movu                m1, [src1q+wq*2]
+    movu                m2, [src2q+wq*2]
+    SCALE16             m0, m3
+    SCALE16             m1, m3
+    SCALE16             m2, m3
+    SHUFFLE3            m3, pb_pack48, 0
+    movu      [dstq+ 0], m3
+    SHUFFLE3            m3, pb_pack48, 3
+    movu      [dstq+16], m3
+    SHUFFLE3            m3, pb_pack48, 6
+    movu      [dstq+32], m3
+    add               dstq, 48
+    add                 wq, 8
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_gbr16ptopacked64(uint16_t *dst, const uint16_t *src0,
+;                          const uint16_t *src1, const uint16_t *src2,
+;                          int width, int scale_high, int scale_low)
+; void ff_gbra16ptopacked64(uint16_t *dst, const uint16_t *src0,
+;                           const uint16_t *src1, const uint16_t *src2,
+;                           const uint16_t *src3, int width,
+;                           int scale_high, int scale_low)
+;
+; width must be a multiple of 8, gbr16ptopacked64 writes opaque alpha
+;-----------------------------------------------------------------------------
+; %1 = number of source planes
+%macro GBR16P_TO_PACKED64 1
+%if %1 == 4
+cglobal gbra16ptopacked64, 6, 6, 8, dst, src0, src1, src2, src3, w, high, low
+%else
+cglobal gbr16ptopacked64, 5, 5, 8, dst, src0, src1, src2, w, high, low
+%endif
+    movsxdifnidn        wq, wd
+    movd                m6, highm
+    movd                m7, lowm
+    lea              src0q, [src0q+wq*2]
+    lea              src1q, [src1q+wq*2]
+    lea              src2q, [src2q+wq*2]
+%if %1 == 4
+    lea              src3q, [src3q+wq*2]
+%else
+    pcmpeqb             m3, m3
+%endif
+    lea               dstq, [dstq+wq*8]
+    neg                 wq
+.loop:
+    movu                m0, [src0q+wq*2]
+    movu                m1, [src1q+wq*2]
+    movu                m2, [src2q+wq*2]
+    SCALE16             m0, m4
+    SCALE16             m1, m4
+    SCALE16             m2, m4
+%if %1 == 4
+    movu                m3, [src3q+wq*2]
+    SCALE16             m3, m4
+%endif
+    punpckhwd           m4, m0, m1
+    punpcklwd           m0, m1
+    punpckhwd           m5, m2, m3
+    punpcklwd           m2, m3
+    punpckldq           m1, m0, m2
+    punpckhdq           m0, m2
+    punpckldq           m2, m4, m5
+    punpckhdq           m4, m5
+    movu [dstq+wq*8+ 0], m1
+    movu [dstq+wq*8+16], m0
+    movu [dstq+wq*8+32], m2
+    movu [dstq+wq*8+48], m4
+    add                 wq, 8
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM sse2
+GBR16P_TO_PACKED64 3
+GBR16P_TO_PACKED64 4
+
+;-----------------------------------------------------------------------------
+; void ff_packed48togbr16p(uint16_t *dst0, uint16_t *dst1, uint16_t *dst2,
+;                          const uint16_t *src, int width, int shift)
+;
+; width must be a multiple of 8
+;-----------------------------------------------------------------------------
+INIT_XMM ssse3
+cglobal packed48togbr16p, 5, 5, 8, dst0, dst1, dst2, src, w, shift
+    movsxdifnidn        wq, wd
+    movd                m7, shiftm
+    lea              dst0q, [dst0q+wq*2]
+    lea              dst1q, [dst1q+wq*2]
+    lea              dst2q, [dst2q+wq*2]
+    neg                 wq
+.loop:
+    movu                m0, [srcq+ 0]
+    movu                m1, [srcq+16]
+    movu                m2, [srcq+32]
+    SHUFFLE3            m3, pb_unpack48, 0
+    psrlw               m3, m7
+    movu    [dst0q+wq*2], m3
+    SHUFFLE3            m3, pb_unpack48, 3
+    psrlw               m3, m7
+    movu    [dst1q+wq*2], m3
+    SHUFFLE3            m3, pb_unpack48, 6
+    psrlw               m3, m7
+    movu    [dst2q+wq*2], m3
+    add               srcq, 48
+    add                 wq, 8
+    jl .loop
+    RET
+
+;-----------------------------------------------------------------------------
+; void ff_packed64togbr16p(uint16_t *dst0, uint16_t *dst1, uint16_t *dst2,
+;                          const uint16_t *src, int width, int shift)
+; void ff_packed64togbra16p(uint16_t *dst0, uint16_t *dst1, uint16_t *dst2,
+;                           uint16_t *dst3, const uint16_t *src, int width,
+;                           int shift)
+;
+; width must be a multiple of 8, packed64togbr16p drops the alpha
+;-----------------------------------------------------------------------------
+; %1 = number of destination planes
+%macro PACKED64_TO_GBR16P 1
+%if %1 == 4
+cglobal packed64togbra16p, 6, 6, 8, dst0, dst1, dst2, dst3, src, w, shift
+%else
+cglobal packed64togbr16p, 5, 5, 8, dst0, dst1, dst2, src, w, shift
+%endif
+    movsxdifnidn        wq, wd
+    mova                m6, [pb_unpack64]
+    movd                m7, shiftm
+    lea              dst0q, [dst0q+wq*2]
+    lea              dst1q, [dst1q+wq*2]
+    lea              dst2q, [dst2q+wq*2]
+%if %1 == 4
+    lea              dst3q, [dst3q+wq*2]
+%endif
+    lea               srcq, [srcq+wq*8]
+    neg                 wq
+.loop:
+    movu                m0, [srcq+wq*8+ 0]
+    movu                m1, [srcq+wq*8+16]
+    movu                m2, [srcq+wq*8+32]
+    movu                m3, [srcq+wq*8+48]
+    pshufb              m0, m6
+    pshufb              m1, m6
+    pshufb              m2, m6
+    pshufb              m3, m6
+    punpckldq           m4, m0, m1
+    punpckhdq           m0, m1
+    punpckldq           m5, m2, m3
+    punpckhdq           m2, m3
+    punpcklqdq          m1, m4, m5
+    punpckhqdq          m4, m5
+    punpcklqdq          m3, m0, m2
+    psrlw               m1, m7
+    psrlw               m4, m7
+    psrlw               m3, m7
+    movu    [dst0q+wq*2], m1
+    movu    [dst1q+wq*2], m4
+    movu    [dst2q+wq*2], m3
+%if %1 == 4
+    punpckhqdq          m0, m2
+    psrlw               m0, m7
+    movu    [dst3q+wq*2], m0
+%endif
+    add                 wq, 8
+    jl .loop
+    RET
+%endmacro
+
+INIT_XMM ssse3
+PACKED64_TO_GBR16P 3
+PACKED64_TO_GBR16P 4
+
+;-----------------------------------------------------------------------------
+; void ff_bayer_<pattern>8_to_rgb24(const uint8_t *src, int src_stride,
+;                                   uint8_t *dst, int dst_stride, int width)
+;
+; demosaic two lines like the rgb24_interpolate_line template function,
+; width must be a multiple of 16
+;-----------------------------------------------------------------------------
+%if ARCH_X86_64
+; %1 = even pixels of 16 as words, %2 = address
+%macro BAYER_EVEN 2
+    movu                %1, %2
+    pand                %1, m15
+%endmacro
+
+; %1 = odd pixels of 16 as words, %2 = address
+%macro BAYER_ODD 2
+    movu                %1, %2
+    psrlw               %1, 8
+%endmacro
+
+; %1 = even pixels, %2 = odd pixels, %3 = address
+%macro BAYER_LOAD 3
+    movu                %2, %3
+    pand                %1, %2, m15
+    psrlw               %2, 8
+%endmacro
+
+; %1 = even pixels, %2 = odd pixels, %3 = shift of the odd pixels
+; merge %2 >> %3 into the high bytes of %1
+%macro BAYER_MERGE 3
+%if %3
+    psrlw               %2, %3
+%endif
+    psllw               %2, 8
+    por                 %1, %2
+%endmacro
+
+; %1 = address, %2 = red stored last
+; store the red, green and blue planes in m0, m1 and m2 as 16 RGB24 pixels
+%macro BAYER_STORE 2
+%if %2
+    SWAP                 0, 2
+%endif
+    SHUFFLE3            m3, pb_pack24, 0
+    movu        [%1+ 0], m3
+    SHUFFLE3            m3, pb_pack24, 3
+    movu        [%1+16], m3
+    SHUFFLE3            m3, pb_pack24, 6
+    movu        [%1+32], m3
+%if %2
+    SWAP                 0, 2
+%endif
+%endmacro
+
+; %1 = pattern, %2 = green first, %3 = red stored last
+; in the comments Xy[k] is pixel 2k (X = E) or 2k+1 (X = O) of line y, the
+; "red" pixels are those on the diagonal of the green first patterns and
+; the odd ones of line 1 for the others
+%macro BAYER_TO_RGB24 3
+cglobal bayer_%1_to_rgb24, 5, 7, 16, src, src_stride, dst, dst_stride, w, src_above, src_below
+    movsxdifnidn src_strideq, src_strided
+    movsxdifnidn dst_strideq, dst_strided
+    mov         src_aboveq, srcq
+    sub         src_aboveq, src_strideq
+    lea         src_belowq, [srcq+src_strideq*2]
+    pcmpeqw            m15, m15
+    psrlw              m15, 8
+.loop:
+%if %2
+    BAYER_LOAD          m6, m7, [src_aboveq]            ; E-1, O-1
+    BAYER_EVEN          m8, [src_aboveq+2]              ; E-1[k+1]
+    BAYER_LOAD          m9, m10, [srcq+src_strideq]     ; E1, O1
+    BAYER_EVEN         m11, [srcq+src_strideq+2]        ; E1[k+1]
+    BAYER_LOAD         m12, m13, [srcq]                 ; E0, O0
+    BAYER_EVEN         m14, [srcq+2]                    ; E0[k+1]
+
+    paddw               m6, m9
+    paddw               m8, m11
+    paddw               m8, m6
+    psrlw               m0, m6, 1
+    BAYER_MERGE         m0, m8, 2
+    paddw               m7, m10
+    paddw               m7, m12
+    paddw               m7, m14
+    mova                m1, m12
+    BAYER_MERGE         m1, m7, 2
+    BAYER_ODD           m6, [srcq-2]                    ; O0[k-1]
+    paddw               m6, m13
+    psrlw               m2, m6, 1
+    psllw               m8, m13, 8
+    por                 m2, m8
+    BAYER_STORE       dstq, %3
+
+    paddw              m11, m9
+    mova                m0, m9
+    BAYER_MERGE         m0, m11, 1
+    BAYER_ODD           m7, [srcq+src_strideq-2]        ; O1[k-1]
+    BAYER_LOAD          m8, m14, [src_belowq]           ; E2, O2
+    paddw               m7, m12
+    paddw               m7, m10
+    paddw               m7, m8
+    psrlw               m1, m7, 2
+    BAYER_MERGE         m1, m10, 0
+    BAYER_ODD           m7, [src_belowq-2]              ; O2[k-1]
+    paddw               m6, m7
+    paddw               m6, m14
+    psrlw               m2, m6, 2
+    paddw              m13, m14
+    BAYER_MERGE         m2, m13, 1
+    BAYER_STORE dstq+dst_strideq, %3
+%else
+    BAYER_ODD           m6, [src_aboveq-2]              ; O-1[k-1]
+    BAYER_LOAD          m7, m8, [src_aboveq]            ; E-1, O-1
+    BAYER_ODD           m9, [srcq+src_strideq-2]        ; O1[k-1]
+    BAYER_LOAD         m10, m11, [srcq+src_strideq]     ; E1, O1
+    BAYER_ODD          m12, [srcq-2]                    ; O0[k-1]
+    BAYER_LOAD         m13, m14, [srcq]                 ; E0, O0
+
+    paddw               m6, m8
+    paddw               m8, m11
+    paddw               m9, m11
+    paddw               m0, m6, m9
+    psrlw               m0, 2
+    BAYER_MERGE         m0, m8, 1
+    paddw               m7, m12
+    paddw               m7, m14
+    paddw               m1, m7, m10
+    psrlw               m1, 2
+    psllw               m6, m14, 8
+    por                 m1, m6
+    BAYER_EVEN         m12, [srcq+2]                    ; E0[k+1]
+    paddw              m12, m13
+    psrlw               m2, m12, 1
+    psllw               m2, 8
+    por                 m2, m13
+    BAYER_STORE       dstq, %3
+
+    psrlw               m0, m9, 1
+    BAYER_MERGE         m0, m11, 0
+    BAYER_EVEN          m6, [srcq+src_strideq+2]        ; E1[k+1]
+    BAYER_LOAD          m7, m8, [src_belowq]            ; E2, O2
+    paddw              m14, m10
+    paddw              m14, m6
+    paddw              m14, m8
+    mova                m1, m10
+    BAYER_MERGE         m1, m14, 2
+    BAYER_EVEN          m9, [src_belowq+2]              ; E2[k+1]
+    paddw              m12, m7
+    paddw              m12, m9
+    paddw              m13, m7
+    psrlw               m2, m13, 1
+    BAYER_MERGE         m2, m12, 2
+    BAYER_STORE dstq+dst_strideq, %3
+%endif
+    add               srcq, 16
+    add         src_aboveq, 16
+    add         src_belowq, 16
+    add               dstq, 48
+    sub                 wd, 16
+    jg .loop
+    RET
+%endmacro
+
+INIT_XMM ssse3
+BAYER_TO_RGB24 bggr8, 0, 0
+BAYER_TO_RGB24 rggb8, 0, 1
+BAYER_TO_RGB24 gbrg8, 1, 0
+BAYER_TO_RGB24 grbg8, 1, 1
+%endif
@@ -21,12 +21,13 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 32
 
-max_19bit_int: times 4 dd 0x7ffff
-max_19bit_flt: times 4 dd 524287.0
-minshort:      times 8 dw 0x8000
-unicoeff:      times 4 dd 0x20000000
+max_19bit_int: times 8 dd 0x7ffff
+max_19bit_flt: times 8 dd 524287.0
+minshort:      times 16 dw 0x8000
+unicoeff:      times 8 dd 0x20000000
+hscale8_perm:  dd 0, 4, 1, 5, 2, 6, 3, 7
 
 SECTION .text
 
@@ -429,3 +430,138 @@ INIT_XMM ssse3
 SCALE_FUNCS2 6, 6, 8
 INIT_XMM sse4
 SCALE_FUNCS2 6, 6, 8
+
+%if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+; AVX2 versions of the 4 and 8 tap scalers. They produce 8 output pixels per
+; iteration, so they read up to 7 entries past the end of filterPos/filter
+; (which initFilter() pads for that) and write up to 7 pixels past dstW.
+
+; HSCALE8_LOAD_AVX2 source_width, dst register, index of the pixel pair
+%macro HSCALE8_LOAD_AVX2 3
+    movsxd     pos0q, dword [fltposq+wq*2+%3*8+0]
+    movsxd     pos1q, dword [fltposq+wq*2+%3*8+4]
+%if %1 == 8
+    movq        xm%2, [srcq+pos0q]              ; src[filterPos[2*%3+0] + {0,1,..,7}]
+    movhps      xm%2, [srcq+pos1q]              ; src[filterPos[2*%3+1] + {0,1,..,7}]
+    pmovzxbw     m%2, xm%2                      ; byte -> word
+%else ; %1 == 9-16
+    movu        xm%2, [srcq+pos0q*2]            ; src[filterPos[2*%3+0] + {0,1,..,7}]
+    vinserti128  m%2, m%2, [srcq+pos1q*2], 1    ; src[filterPos[2*%3+1] + {0,1,..,7}]
+%endif ; %1 == 8/9-16
+%endmacro
+
+; SCALE_FUNC_AVX2 source_width, intermediate_nbits, filtersize
+%macro SCALE_FUNC_AVX2 3
+cglobal hscale%1to%2_%3, 6, 7, 10, pos0, dst, w, src, filter, fltpos, pos1
+    movsxd        wq, wd
+%if %2 == 19
+    mova          m2, [max_19bit_int]
+%endif ; %2 == 19
+%if %1 == 16
+    mova          m6, [minshort]
+    mova          m7, [unicoeff]
+%endif ; %1 == 16
+
+%if %3 == 8
+    mova          m8, [hscale8_perm]
+    shl           wq, 1                         ; see the 8-tap case of SCALE_FUNC
+%define wshr 1
+%else ; %3 == 4
+%define wshr 0
+%endif ; %3 == 8
+    lea      filterq, [filterq+wq*8]
+%if %2 == 15
+    lea         dstq, [dstq+wq*(2>>wshr)]
+%else ; %2 == 19
+    lea         dstq, [dstq+wq*(4>>wshr)]
+%endif ; %2 == 15/19
+    lea      fltposq, [fltposq+wq*(4>>wshr)]
+    neg           wq
+
+.loop:
+%if %3 == 4
+    ; gather 8x4 source pixels into m0 (dst[0-1|2-3]) and m1 (dst[4-5|6-7])
+    movu          m3, [fltposq+wq*4]            ; filterPos[0-7]
+    pcmpeqd       m9, m9
+%if %1 == 8
+    vpgatherdd    m1, [srcq+m3], m9             ; src[filterPos[0-7] + {0,1,2,3}]
+    vextracti128 xm5, m1, 1
+    pmovzxbw      m0, xm1                       ; byte -> word
+    pmovzxbw      m1, xm5
+%else ; %1 == 9-16
+    vextracti128 xm5, m3, 1
+    vpgatherdq    m0, [srcq+xm3*2], m9          ; src[filterPos[0-3] + {0,1,2,3}]
+    pcmpeqd       m9, m9
+    vpgatherdq    m1, [srcq+xm5*2], m9          ; src[filterPos[4-7] + {0,1,2,3}]
+%endif ; %1 == 8/9-16
+%if %1 == 16
+    psubw         m0, m6
+    psubw         m1, m6
+%endif ; %1 == 16
+    pmaddwd       m0, [filterq+wq*8+mmsize*0]   ; *= filter[{ 0, 1,...,14,15}]
+    pmaddwd       m1, [filterq+wq*8+mmsize*1]   ; *= filter[{16,17,...,30,31}]
+    phaddd        m0, m1                        ; dst[0,1,4,5|2,3,6,7]
+%else ; %3 == 8
+    ; load 8x8 source pixels into m0, m1, m4 and m5, two pixels per register
+    HSCALE8_LOAD_AVX2 %1, 0, 0
+    HSCALE8_LOAD_AVX2 %1, 1, 1
+    HSCALE8_LOAD_AVX2 %1, 4, 2
+    HSCALE8_LOAD_AVX2 %1, 5, 3
+%if %1 == 16
+    psubw         m0, m6
+    psubw         m1, m6
+    psubw         m4, m6
+    psubw         m5, m6
+%endif ; %1 == 16
+    pmaddwd       m0, [filterq+wq*8+mmsize*0]   ; *= filter[{ 0, 1,...,14,15}]
+    pmaddwd       m1, [filterq+wq*8+mmsize*1]   ; *= filter[{16,17,...,30,31}]
+    pmaddwd       m4, [filterq+wq*8+mmsize*2]   ; *= filter[{32,33,...,46,47}]
+    pmaddwd       m5, [filterq+wq*8+mmsize*3]   ; *= filter[{48,49,...,62,63}]
+    phaddd        m0, m1
+    phaddd        m4, m5
+    phaddd        m0, m4                        ; dst[0,2,4,6|1,3,5,7]
+%endif ; %3 == 4/8
+
+%if %1 == 16 ; add 0x8000 * sum(coeffs), i.e. back from signed -> unsigned
+    paddd         m0, m7
+%endif ; %1 == 16
+
+    ; reorder, clip, store
+    psrad         m0, 14 + %1 - %2
+%if %3 == 4
+    vpermq        m0, m0, q3120
+%else ; %3 == 8
+    vpermd        m0, m8, m0
+%endif ; %3 == 4/8
+%if %2 == 15
+    vextracti128 xm1, m0, 1
+    packssdw     xm0, xm1
+    movu [dstq+wq*(2>>wshr)], xm0
+%else ; %2 == 19
+    pminsd        m0, m2
+    movu [dstq+wq*(4>>wshr)], m0
+%endif ; %2 == 15/19
+    add           wq, 8<<wshr
+    jl .loop
+    RET
+%endmacro
+
+%macro SCALE_FUNCS_AVX2 2
+SCALE_FUNC_AVX2 %1, %2, 4
+SCALE_FUNC_AVX2 %1, %2, 8
+%endmacro
+
+INIT_YMM avx2
+SCALE_FUNCS_AVX2  8, 15
+SCALE_FUNCS_AVX2  9, 15
+SCALE_FUNCS_AVX2 10, 15
+SCALE_FUNCS_AVX2 12, 15
+SCALE_FUNCS_AVX2 14, 15
+SCALE_FUNCS_AVX2 16, 15
+SCALE_FUNCS_AVX2  8, 19
+SCALE_FUNCS_AVX2  9, 19
+SCALE_FUNCS_AVX2 10, 19
+SCALE_FUNCS_AVX2 12, 19
+SCALE_FUNCS_AVX2 14, 19
+SCALE_FUNCS_AVX2 16, 19
+%endif ; HAVE_AVX2_EXTERNAL && ARCH_X86_64
@@ -315,6 +315,10 @@ SCALE_FUNCS_MMX(mmx);
 SCALE_FUNCS_SSE(sse2);
 SCALE_FUNCS_SSE(ssse3);
 SCALE_FUNCS_SSE(sse4);
+#if ARCH_X86_64
+SCALE_FUNCS(4, avx2);
+SCALE_FUNCS(8, avx2);
+#endif
 
 #define VSCALEX_FUNC(size, opt) \
 void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
@@ -323,7 +327,9 @@ void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
 #define VSCALEX_FUNCS(opt) \
     VSCALEX_FUNC(8,  opt); \
     VSCALEX_FUNC(9,  opt); \
-    VSCALEX_FUNC(10, opt)
+    VSCALEX_FUNC(10, opt); \
+    VSCALEX_FUNC(12, opt); \
+    VSCALEX_FUNC(14, opt)
 
 #if ARCH_X86_32
 VSCALEX_FUNCS(mmxext);
@@ -332,6 +338,10 @@ VSCALEX_FUNCS(sse2);
 VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
+#if ARCH_X86_64
+VSCALEX_FUNCS(avx2);
+VSCALEX_FUNC(16, avx2);
+#endif
 
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
@@ -340,6 +350,8 @@ void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int ds
     VSCALE_FUNC(8,  opt1); \
     VSCALE_FUNC(9,  opt2); \
     VSCALE_FUNC(10, opt2); \
+    VSCALE_FUNC(12, opt2); \
+    VSCALE_FUNC(14, opt2); \
     VSCALE_FUNC(16, opt1)
 
 #if ARCH_X86_32
@@ -348,6 +360,60 @@ VSCALE_FUNCS(mmx, mmxext);
 VSCALE_FUNCS(sse2, sse2);
 VSCALE_FUNC(16, sse4);
 VSCALE_FUNCS(avx, avx);
+#if ARCH_X86_64
+VSCALE_FUNCS(avx2, avx2);
+
+/* The AVX2 vertical scalers only get whole iterations (16 pixels for
+ * yuv2planeX, 32 for yuv2plane1), the AVX/SSE4 versions finish the line so
+ * that nothing is written further past dstW than before. */
+#define VSCALEX_AVX2_WRAPPER(size, tail_opt, src_type, dst_bytes) \
+static void yuv2planeX_ ## size ## _avx2(const int16_t *filter, int filterSize, \
+                                         const int16_t **src, uint8_t *dest, \
+                                         int dstW, const uint8_t *dither, \
+                                         int offset) \
+{ \
+    int w = dstW & ~15; \
+    if (w) \
+        ff_yuv2planeX_ ## size ## _avx2(filter, filterSize, src, dest, w, \
+                                        dither, offset); \
+    if (w < dstW) { \
+        const int16_t *tail[MAX_FILTER_SIZE]; \
+        int i; \
+        for (i = 0; i < filterSize; i++) \
+            tail[i] = (const int16_t *)((const src_type *)src[i] + w); \
+        ff_yuv2planeX_ ## size ## _ ## tail_opt(filter, filterSize, tail, \
+                                               dest + w * dst_bytes, \
+                                               dstW - w, dither, offset); \
+    } \
+}
+
+#define VSCALE_AVX2_WRAPPER(size, tail_opt, src_type, dst_bytes) \
+static void yuv2plane1_ ## size ## _avx2(const int16_t *src, uint8_t *dst, \
+                                         int dstW, const uint8_t *dither, \
+                                         int offset) \
+{ \
+    int w = dstW & ~31; \
+    if (w) \
+        ff_yuv2plane1_ ## size ## _avx2(src, dst, w, dither, offset); \
+    if (w < dstW) \
+        ff_yuv2plane1_ ## size ## _ ## tail_opt((const int16_t *)((const src_type *)src + w), \
+                                               dst + w * dst_bytes, \
+                                               dstW - w, dither, offset); \
+}
+
+VSCALEX_AVX2_WRAPPER(8,  avx,  int16_t, 1)
+VSCALEX_AVX2_WRAPPER(9,  avx,  int16_t, 2)
+VSCALEX_AVX2_WRAPPER(10, avx,  int16_t, 2)
+VSCALEX_AVX2_WRAPPER(12, avx,  int16_t, 2)
+VSCALEX_AVX2_WRAPPER(14, avx,  int16_t, 2)
+VSCALEX_AVX2_WRAPPER(16, sse4, int32_t, 2)
+VSCALE_AVX2_WRAPPER(8,  avx,  int16_t, 1)
+VSCALE_AVX2_WRAPPER(9,  avx,  int16_t, 2)
+VSCALE_AVX2_WRAPPER(10, avx,  int16_t, 2)
+VSCALE_AVX2_WRAPPER(12, avx,  int16_t, 2)
+VSCALE_AVX2_WRAPPER(14, avx,  int16_t, 2)
+VSCALE_AVX2_WRAPPER(16, avx,  int32_t, 2)
+#endif /* ARCH_X86_64 */
 
 #define INPUT_Y_FUNC(fmt, opt) \
 void ff_ ## fmt ## ToY_  ## opt(uint8_t *dst, const uint8_t *src, \
@@ -381,6 +447,63 @@ INPUT_FUNCS(sse2);
 INPUT_FUNCS(ssse3);
 INPUT_FUNCS(avx);
 
+#define INPUT_WORD_FUNCS(opt) \
+    INPUT_FUNC(bswap16, opt); \
+    INPUT_Y_FUNC(p010le, opt); \
+    INPUT_Y_FUNC(p010be, opt); \
+    INPUT_UV_FUNC(p010le, opt); \
+    INPUT_UV_FUNC(p010be, opt)
+
+INPUT_WORD_FUNCS(sse2);
+INPUT_WORD_FUNCS(avx2);
+
+#if ARCH_X86_64
+#define INPUT_PLANAR_RGB_Y_FN_DECL(fmt, opt) \
+void ff_planar_ ## fmt ## _to_y_ ## opt(uint8_t *dst, const uint8_t *src[4], \
+                                       int w, int32_t *rgb2yuv)
+#define INPUT_PLANAR_RGB_UV_FN_DECL(fmt, opt) \
+void ff_planar_ ## fmt ## _to_uv_ ## opt(uint8_t *dstU, uint8_t *dstV, \
+                                        const uint8_t *src[4], int w, \
+                                        int32_t *rgb2yuv)
+#define INPUT_PLANAR_RGB_A_FN_DECL(fmt, opt) \
+void ff_planar_ ## fmt ## _to_a_ ## opt(uint8_t *dst, const uint8_t *src[4], \
+                                       int w, int32_t *rgb2yuv)
+#define INPUT_PLANAR_RGBXX_YUV_FN_DECL(rgb_fmt, opt) \
+    INPUT_PLANAR_RGB_Y_FN_DECL(rgb_fmt ## le, opt); \
+    INPUT_PLANAR_RGB_UV_FN_DECL(rgb_fmt ## le, opt); \
+    INPUT_PLANAR_RGB_Y_FN_DECL(rgb_fmt ## be, opt); \
+    INPUT_PLANAR_RGB_UV_FN_DECL(rgb_fmt ## be, opt)
+#define INPUT_PLANAR_RGBXX_A_FN_DECL(rgb_fmt, opt) \
+    INPUT_PLANAR_RGB_A_FN_DECL(rgb_fmt ## le, opt); \
+    INPUT_PLANAR_RGB_A_FN_DECL(rgb_fmt ## be, opt)
+#define INPUT_PLANAR_RGB_FUNCS(opt) \
+    INPUT_PLANAR_RGBXX_YUV_FN_DECL(rgb9,  opt); \
+    INPUT_PLANAR_RGBXX_YUV_FN_DECL(rgb10, opt); \
+    INPUT_PLANAR_RGBXX_YUV_FN_DECL(rgb12, opt); \
+    INPUT_PLANAR_RGBXX_YUV_FN_DECL(rgb14, opt); \
+    INPUT_PLANAR_RGBXX_YUV_FN_DECL(rgb16, opt); \
+    INPUT_PLANAR_RGBXX_A_FN_DECL(rgb10, opt); \
+    INPUT_PLANAR_RGBXX_A_FN_DECL(rgb12, opt); \
+    INPUT_PLANAR_RGBXX_A_FN_DECL(rgb16, opt)
+
+INPUT_PLANAR_RGB_FUNCS(sse4);
+INPUT_PLANAR_RGB_FUNCS(avx2);
+
+#define INPUT_RGB48_FUNCS(fmt, opt) \
+    INPUT_FUNC(fmt ## 48LE, opt); \
+void ff_ ## fmt ## 48LEToUV_half_ ## opt(uint8_t *dstU, uint8_t *dstV, \
+                                         const uint8_t *unused0, \
+                                         const uint8_t *src1, \
+                                         const uint8_t *src2, \
+                                         int w, uint32_t *unused)
+
+INPUT_RGB48_FUNCS(rgb, sse4);
+INPUT_RGB48_FUNCS(bgr, sse4);
+#endif
+
+void ff_gamma_convert_rgb48_avx2(uint16_t *line, const uint16_t *table, int width);
+void ff_gamma_convert_rgba64_avx2(uint16_t *line, const uint16_t *table, int width);
+
 av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
@@ -429,6 +552,8 @@ av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 #define ASSIGN_VSCALEX_FUNC(vscalefn, opt, do_16_case, condition_8bit) \
 switch(c->dstBpc){ \
     case 16:                          do_16_case;                          break; \
+    case 14: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_14_ ## opt; break; \
+    case 12: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_12_ ## opt; break; \
     case 10: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_10_ ## opt; break; \
     case 9:  if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_9_  ## opt; break; \
     case 8: if ((condition_8bit) && !c->use_mmx_vfilter) vscalefn = ff_yuv2planeX_8_  ## opt; break; \
@@ -436,6 +561,8 @@ switch(c->dstBpc){ \
 #define ASSIGN_VSCALE_FUNC(vscalefn, opt1, opt2, opt2chk) \
     switch(c->dstBpc){ \
     case 16: if (!isBE(c->dstFormat))            vscalefn = ff_yuv2plane1_16_ ## opt1; break; \
+    case 14: if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_14_ ## opt2; break; \
+    case 12: if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_12_ ## opt2; break; \
     case 10: if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_10_ ## opt2; break; \
     case 9:  if (!isBE(c->dstFormat) && opt2chk) vscalefn = ff_yuv2plane1_9_  ## opt2;  break; \
     case 8:                                      vscalefn = ff_yuv2plane1_8_  ## opt1;  break; \
@@ -447,6 +574,82 @@ switch(c->dstBpc){ \
             if (!c->chrSrcHSubSample) \
                 c->chrToYV12 = ff_ ## x ## ToUV_ ## opt; \
             break
+#define case_rgb48(x, X, opt) \
+        case AV_PIX_FMT_ ## X: \
+            c->lumToYV12 = ff_ ## x ## ToY_ ## opt; \
+            c->chrToYV12 = c->chrSrcHSubSample ? ff_ ## x ## ToUV_half_ ## opt \
+                                               : ff_ ## x ## ToUV_ ## opt; \
+            break
+/* same formats as ff_sws_init_input_funcs() reads with bswap16Y_c/bswap16UV_c
+ * and p010{LE,BE}To{Y,UV}_c on a little-endian host */
+#define ASSIGN_WORD_INPUT_FUNCS(opt) \
+    switch (c->srcFormat) { \
+    case AV_PIX_FMT_YUVA444P9BE: \
+    case AV_PIX_FMT_YUVA422P9BE: \
+    case AV_PIX_FMT_YUVA420P9BE: \
+    case AV_PIX_FMT_YUVA444P10BE: \
+    case AV_PIX_FMT_YUVA422P10BE: \
+    case AV_PIX_FMT_YUVA420P10BE: \
+    case AV_PIX_FMT_YUVA420P16BE: \
+    case AV_PIX_FMT_YUVA422P16BE: \
+    case AV_PIX_FMT_YUVA444P16BE: \
+        c->alpToYV12 = ff_bswap16ToY_ ## opt; \
+    case AV_PIX_FMT_YUV444P9BE: \
+    case AV_PIX_FMT_YUV422P9BE: \
+    case AV_PIX_FMT_YUV420P9BE: \
+    case AV_PIX_FMT_YUV444P10BE: \
+    case AV_PIX_FMT_YUV440P10BE: \
+    case AV_PIX_FMT_YUV422P10BE: \
+    case AV_PIX_FMT_YUV420P10BE: \
+    case AV_PIX_FMT_YUV444P12BE: \
+    case AV_PIX_FMT_YUV440P12BE: \
+    case AV_PIX_FMT_YUV422P12BE: \
+    case AV_PIX_FMT_YUV420P12BE: \
+    case AV_PIX_FMT_YUV444P14BE: \
+    case AV_PIX_FMT_YUV422P14BE: \
+    case AV_PIX_FMT_YUV420P14BE: \
+    case AV_PIX_FMT_YUV420P16BE: \
+    case AV_PIX_FMT_YUV422P16BE: \
+    case AV_PIX_FMT_YUV444P16BE: \
+        c->chrToYV12 = ff_bswap16ToUV_ ## opt; \
+    case AV_PIX_FMT_GRAY16BE: \
+        c->lumToYV12 = ff_bswap16ToY_ ## opt; \
+        break; \
+    case AV_PIX_FMT_P010LE: \
+        c->lumToYV12 = ff_p010leToY_ ## opt; \
+        c->chrToYV12 = ff_p010leToUV_ ## opt; \
+        break; \
+    case AV_PIX_FMT_P010BE: \
+        c->lumToYV12 = ff_p010beToY_ ## opt; \
+        c->chrToYV12 = ff_p010beToUV_ ## opt; \
+        break; \
+    default: \
+        break; \
+    }
+#define case_planar_rgb(x, X, opt) \
+    case AV_PIX_FMT_ ## X: \
+        c->readLumPlanar = ff_planar_ ## x ## _to_y_ ## opt; \
+        c->readChrPlanar = ff_planar_ ## x ## _to_uv_ ## opt; \
+        break
+#define case_planar_rgba(x, X, XA, opt) \
+    case AV_PIX_FMT_ ## XA: \
+        c->readAlpPlanar = ff_planar_ ## x ## _to_a_ ## opt; \
+    case_planar_rgb(x, X, opt)
+#define ASSIGN_PLANAR_RGB_FUNCS(opt) \
+    switch (c->srcFormat) { \
+    case_planar_rgb(rgb9le,  GBRP9LE,  opt); \
+    case_planar_rgb(rgb9be,  GBRP9BE,  opt); \
+    case_planar_rgba(rgb10le, GBRP10LE, GBRAP10LE, opt); \
+    case_planar_rgba(rgb10be, GBRP10BE, GBRAP10BE, opt); \
+    case_planar_rgba(rgb12le, GBRP12LE, GBRAP12LE, opt); \
+    case_planar_rgba(rgb12be, GBRP12BE, GBRAP12BE, opt); \
+    case_planar_rgb(rgb14le, GBRP14LE, opt); \
+    case_planar_rgb(rgb14be, GBRP14BE, opt); \
+    case_planar_rgba(rgb16le, GBRP16LE, GBRAP16LE, opt); \
+    case_planar_rgba(rgb16be, GBRP16BE, GBRAP16BE, opt); \
+    default: \
+        break; \
+    }
 #if ARCH_X86_32
     if (EXTERNAL_MMX(cpu_flags)) {
         ASSIGN_MMX_SCALE_FUNC(c->hyScale, c->hLumFilterSize, mmx, mmx);
@@ -531,6 +734,7 @@ switch(c->dstBpc){ \
         default:
             break;
         }
+        ASSIGN_WORD_INPUT_FUNCS(sse2);
     }
     if (EXTERNAL_SSSE3(cpu_flags)) {
         ASSIGN_SSE_SCALE_FUNC(c->hyScale, c->hLumFilterSize, ssse3, ssse3);
@@ -551,6 +755,15 @@ switch(c->dstBpc){ \
                             HAVE_ALIGNED_STACK || ARCH_X86_64);
         if (c->dstBpc == 16 && !isBE(c->dstFormat))
             c->yuv2plane1 = ff_yuv2plane1_16_sse4;
+#if ARCH_X86_64
+        ASSIGN_PLANAR_RGB_FUNCS(sse4);
+        switch (c->srcFormat) {
+        case_rgb48(rgb48LE, RGB48LE, sse4);
+        case_rgb48(bgr48LE, BGR48LE, sse4);
+        default:
+            break;
+        }
+#endif
     }
 
     if (EXTERNAL_AVX(cpu_flags)) {
@@ -581,4 +794,63 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        ASSIGN_WORD_INPUT_FUNCS(avx2);
+        if (c->srcFormat == AV_PIX_FMT_RGB48LE)
+            c->gammaConvert = ff_gamma_convert_rgb48_avx2;
+        else if (c->srcFormat == AV_PIX_FMT_RGBA64LE)
+            c->gammaConvert = ff_gamma_convert_rgba64_avx2;
+    }
+
+#if ARCH_X86_64
+#define ASSIGN_AVX2_SCALE_FUNC(hscalefn, filtersize) \
+    switch (filtersize) { \
+    case 4:  ASSIGN_SCALE_FUNC2(hscalefn, 4, avx2, avx2); break; \
+    case 8:  ASSIGN_SCALE_FUNC2(hscalefn, 8, avx2, avx2); break; \
+    }
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        ASSIGN_AVX2_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
+        ASSIGN_AVX2_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
+        ASSIGN_PLANAR_RGB_FUNCS(avx2);
+
+        switch (c->dstBpc) {
+        case 16:
+            if (!isBE(c->dstFormat)) {
+                c->yuv2planeX = yuv2planeX_16_avx2;
+                c->yuv2plane1 = yuv2plane1_16_avx2;
+            }
+            break;
+        case 14:
+            if (!isBE(c->dstFormat)) {
+                c->yuv2planeX = yuv2planeX_14_avx2;
+                c->yuv2plane1 = yuv2plane1_14_avx2;
+            }
+            break;
+        case 12:
+            if (!isBE(c->dstFormat)) {
+                c->yuv2planeX = yuv2planeX_12_avx2;
+                c->yuv2plane1 = yuv2plane1_12_avx2;
+            }
+            break;
+        case 10:
+            if (!isBE(c->dstFormat)) {
+                c->yuv2planeX = yuv2planeX_10_avx2;
+                c->yuv2plane1 = yuv2plane1_10_avx2;
+            }
+            break;
+        case 9:
+            if (!isBE(c->dstFormat)) {
+                c->yuv2planeX = yuv2planeX_9_avx2;
+                c->yuv2plane1 = yuv2plane1_9_avx2;
+            }
+            break;
+        case 8:
+            if (!c->use_mmx_vfilter)
+                c->yuv2planeX = yuv2planeX_8_avx2;
+            c->yuv2plane1 = yuv2plane1_8_avx2;
+            break;
+        }
+    }
+#endif
 }
@@ -0,0 +1,356 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+#include "libavutil/attributes.h"
+#include "libavutil/x86/cpu.h"
+#include "libavutil/cpu.h"
+#include "libavutil/pixdesc.h"
+
+void ff_gbr24ptopacked24_ssse3(uint8_t *dst, const uint8_t *src0,
+                               const uint8_t *src1, const uint8_t *src2,
+                               int width);
+void ff_gbr24ptopacked32_sse2(uint8_t *dst, const uint8_t *src0,
+                              const uint8_t *src1, const uint8_t *src2,
+                              int width);
+void ff_gbr24ptopacked32_alpha_first_sse2(uint8_t *dst, const uint8_t *src0,
+                                          const uint8_t *src1,
+                                          const uint8_t *src2, int width);
+void ff_packed24togbr24p_ssse3(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                               const uint8_t *src, int width);
+void ff_packed32togbr24p_ssse3(uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                               const uint8_t *src, int width);
+void ff_packed32togbr24p_alpha_first_ssse3(uint8_t *dst0, uint8_t *dst1,
+                                           uint8_t *dst2, const uint8_t *src,
+                                           int width);
+
+void ff_gbr16ptopacked48_ssse3(uint16_t *dst, const uint16_t *src0,
+                               const uint16_t *src1, const uint16_t *src2,
+                               int width, int scale_high, int scale_low);
+void ff_gbr16ptopacked64_sse2(uint16_t *dst, const uint16_t *src0,
+                              const uint16_t *src1, const uint16_t *src2,
+                              int width, int scale_high, int scale_low);
+void ff_gbra16ptopacked64_sse2(uint16_t *dst, const uint16_t *src0,
+                               const uint16_t *src1, const uint16_t *src2,
+                               const uint16_t *src3, int width,
+                               int scale_high, int scale_low);
+void ff_packed48togbr16p_ssse3(uint16_t *dst0, uint16_t *dst1, uint16_t *dst2,
+                               const uint16_t *src, int width, int shift);
+void ff_packed64togbr16p_ssse3(uint16_t *dst0, uint16_t *dst1, uint16_t *dst2,
+                               const uint16_t *src, int width, int shift);
+void ff_packed64togbra16p_ssse3(uint16_t *dst0, uint16_t *dst1, uint16_t *dst2,
+                                uint16_t *dst3, const uint16_t *src, int width,
+                                int shift);
+
+void ff_bayer_bggr8_to_rgb24_ssse3(const uint8_t *src, int src_stride,
+                                   uint8_t *dst, int dst_stride, int width);
+void ff_bayer_rggb8_to_rgb24_ssse3(const uint8_t *src, int src_stride,
+                                   uint8_t *dst, int dst_stride, int width);
+void ff_bayer_gbrg8_to_rgb24_ssse3(const uint8_t *src, int src_stride,
+                                   uint8_t *dst, int dst_stride, int width);
+void ff_bayer_grbg8_to_rgb24_ssse3(const uint8_t *src, int src_stride,
+                                   uint8_t *dst, int dst_stride, int width);
+
+#define isByteRGB24(f) ((f) == AV_PIX_FMT_RGB24 || (f) == AV_PIX_FMT_BGR24)
+
+#define isByteRGB32(f) (          \
+        (f) == AV_PIX_FMT_RGBA || \
+        (f) == AV_PIX_FMT_BGRA || \
+        (f) == AV_PIX_FMT_ARGB || \
+        (f) == AV_PIX_FMT_ABGR)
+
+/* formats storing the red component first, the others store blue first */
+#define isRedFirst(f) (              \
+        (f) == AV_PIX_FMT_RGB24    || \
+        (f) == AV_PIX_FMT_RGBA     || \
+        (f) == AV_PIX_FMT_ARGB     || \
+        (f) == AV_PIX_FMT_RGB48LE  || \
+        (f) == AV_PIX_FMT_RGBA64LE)
+
+#define isAlphaFirst(f) ((f) == AV_PIX_FMT_ARGB || (f) == AV_PIX_FMT_ABGR)
+
+#define isPackedRGB16LE(f) (          \
+        (f) == AV_PIX_FMT_RGB48LE  || \
+        (f) == AV_PIX_FMT_BGR48LE  || \
+        (f) == AV_PIX_FMT_RGBA64LE || \
+        (f) == AV_PIX_FMT_BGRA64LE)
+
+#define isPlanarRGB16LE(f) (           \
+        (f) == AV_PIX_FMT_GBRP9LE   || \
+        (f) == AV_PIX_FMT_GBRP10LE  || \
+        (f) == AV_PIX_FMT_GBRP12LE  || \
+        (f) == AV_PIX_FMT_GBRP14LE  || \
+        (f) == AV_PIX_FMT_GBRP16LE  || \
+        (f) == AV_PIX_FMT_GBRAP12LE || \
+        (f) == AV_PIX_FMT_GBRAP16LE)
+
+/* The wrappers below produce the same output as planarRgbToRgbWrapper,
+ * rgbToPlanarRgbWrapper, Rgb16ToPlanarRgb16Wrapper and
+ * planarRgb16ToRgb16Wrapper; the SIMD functions handle a multiple of 16
+ * (8 for 16 bit components) pixels per line and the rest is done in C. */
+
+static int planar_rgb_to_rgb_x86_wrapper(SwsContext *c, const uint8_t *src[],
+                                         int srcStride[], int srcSliceY,
+                                         int srcSliceH, uint8_t *dst[],
+                                         int dstStride[])
+{
+    const enum AVPixelFormat dstFormat = c->dstFormat;
+    const int alpha_first = isAlphaFirst(dstFormat);
+    const int packed24    = isByteRGB24(dstFormat);
+    const int first       = isRedFirst(dstFormat) ? 2 : 1;
+    const int last        = 3 - first;
+    const int width       = c->srcW;
+    const int simd_width  = width & ~15;
+    const uint8_t *src0 = src[first], *src1 = src[0], *src2 = src[last];
+    uint8_t *dst_line = dst[0] + srcSliceY * dstStride[0];
+    int x, h;
+
+    for (h = 0; h < srcSliceH; h++) {
+        uint8_t *dest = dst_line + simd_width * (packed24 ? 3 : 4);
+
+        if (simd_width) {
+            if (packed24)
+                ff_gbr24ptopacked24_ssse3(dst_line, src0, src1, src2, simd_width);
+            else if (alpha_first)
+                ff_gbr24ptopacked32_alpha_first_sse2(dst_line, src0, src1, src2,
+                                                     simd_width);
+            else
+                ff_gbr24ptopacked32_sse2(dst_line, src0, src1, src2, simd_width);
+        }
+        for (x = simd_width; x < width; x++) {
+            if (alpha_first)
+                *dest++ = 0xff;
+            *dest++ = src0[x];
+            *dest++ = src1[x];
+            *dest++ = src2[x];
+            if (!packed24 && !alpha_first)
+                *dest++ = 0xff;
+        }
+
+        src0     += srcStride[first];
+        src1     += srcStride[0];
+        src2     += srcStride[last];
+        dst_line += dstStride[0];
+    }
+
+    return srcSliceH;
+}
+
+static int rgb_to_planar_rgb_x86_wrapper(SwsContext *c, const uint8_t *src[],
+                                         int srcStride[], int srcSliceY,
+                                         int srcSliceH, uint8_t *dst[],
+                                         int dstStride[])
+{
+    const enum AVPixelFormat srcFormat = c->srcFormat;
+    const int alpha_first = isAlphaFirst(srcFormat);
+    const int packed24    = isByteRGB24(srcFormat);
+    const int inc_size    = packed24 ? 3 : 4;
+    const int first       = isRedFirst(srcFormat) ? 2 : 1;
+    const int last        = 3 - first;
+    const int width       = c->srcW;
+    const int simd_width  = width & ~15;
+    const uint8_t *src_line = src[0];
+    uint8_t *dst0 = dst[first] + srcSliceY * dstStride[first];
+    uint8_t *dst1 = dst[0]     + srcSliceY * dstStride[0];
+    uint8_t *dst2 = dst[last]  + srcSliceY * dstStride[last];
+    int x, h;
+
+    for (h = 0; h < srcSliceH; h++) {
+        const uint8_t *s = src_line + simd_width * inc_size + alpha_first;
+
+        if (simd_width) {
+            if (packed24)
+                ff_packed24togbr24p_ssse3(dst0, dst1, dst2, src_line, simd_width);
+            else if (alpha_first)
+                ff_packed32togbr24p_alpha_first_ssse3(dst0, dst1, dst2, src_line,
+                                                      simd_width);
+            else
+                ff_packed32togbr24p_ssse3(dst0, dst1, dst2, src_line, simd_width);
+        }
+        for (x = simd_width; x < width; x++) {
+            dst0[x] = s[0];
+            dst1[x] = s[1];
+            dst2[x] = s[2];
+            s += inc_size;
+        }
+
+        src_line += srcStride[0];
+        dst0     += dstStride[first];
+        dst1     += dstStride[0];
+        dst2     += dstStride[last];
+    }
+
+    return srcSliceH;
+}
+
+static int rgb16_to_planar_rgb16_x86_wrapper(SwsContext *c, const uint8_t *src[],
+                                             int srcStride[], int srcSliceY,
+                                             int srcSliceH, uint8_t *dst[],
+                                             int dstStride[])
+{
+    const AVPixFmtDescriptor *src_format = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_format = av_pix_fmt_desc_get(c->dstFormat);
+    const int shift      = 16 - dst_format->comp[0].depth;
+    const int src_alpha  = !!(src_format->flags & AV_PIX_FMT_FLAG_ALPHA);
+    const int dst_alpha  = dst[3] != NULL;
+    const int first      = isRedFirst(c->srcFormat) ? 2 : 1;
+    const int last       = 3 - first;
+    const int width      = c->srcW;
+    const int simd_width = width & ~7;
+    uint16_t *dst0 = (uint16_t *)dst[first];
+    uint16_t *dst1 = (uint16_t *)dst[0];
+    uint16_t *dst2 = (uint16_t *)dst[last];
+    uint16_t *dst3 = (uint16_t *)dst[3];
+    int x, h;
+
+    for (h = 0; h < srcSliceH; h++) {
+        const uint16_t *src_line = (const uint16_t *)(src[0] + srcStride[0] * h);
+
+        if (simd_width) {
+            if (!src_alpha)
+                ff_packed48togbr16p_ssse3(dst0, dst1, dst2, src_line,
+                                          simd_width, shift);
+            else if (dst_alpha)
+                ff_packed64togbra16p_ssse3(dst0, dst1, dst2, dst3, src_line,
+                                           simd_width, shift);
+            else
+                ff_packed64togbr16p_ssse3(dst0, dst1, dst2, src_line,
+                                          simd_width, shift);
+        }
+        src_line += simd_width * (3 + src_alpha);
+        for (x = simd_width; x < width; x++) {
+            dst0[x] = *src_line++ >> shift;
+            dst1[x] = *src_line++ >> shift;
+            dst2[x] = *src_line++ >> shift;
+            if (src_alpha) {
+                if (dst_alpha)
+                    dst3[x] = *src_line >> shift;
+                src_line++;
+            }
+        }
+        if (dst_alpha && !src_alpha) {
+            for (x = 0; x < width; x++)
+                dst3[x] = 0xFFFF;
+        }
+
+        dst0 += dstStride[first] >> 1;
+        dst1 += dstStride[0]     >> 1;
+        dst2 += dstStride[last]  >> 1;
+        if (dst_alpha)
+            dst3 += dstStride[3] >> 1;
+    }
+
+    return srcSliceH;
+}
+
+static int planar_rgb16_to_rgb16_x86_wrapper(SwsContext *c, const uint8_t *src[],
+                                             int srcStride[], int srcSliceY,
+                                             int srcSliceH, uint8_t *dst[],
+                                             int dstStride[])
+{
+    const AVPixFmtDescriptor *src_format = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_format = av_pix_fmt_desc_get(c->dstFormat);
+    const int bpp        = src_format->comp[0].depth;
+    const int scale_high = 16 - bpp, scale_low = (bpp - 8) * 2;
+    const int alpha      = !!(dst_format->flags & AV_PIX_FMT_FLAG_ALPHA);
+    const int src_alpha  = src[3] != NULL;
+    const int first      = isRedFirst(c->dstFormat) ? 2 : 1;
+    const int last       = 3 - first;
+    const int width      = c->srcW;
+    const int simd_width = width & ~7;
+    const uint16_t *src0 = (const uint16_t *)src[first];
+    const uint16_t *src1 = (const uint16_t *)src[0];
+    const uint16_t *src2 = (const uint16_t *)src[last];
+    const uint16_t *src3 = (const uint16_t *)src[3];
+    uint8_t *dst_line = dst[0] + srcSliceY * dstStride[0];
+    int x, h;
+
+    for (h = 0; h < srcSliceH; h++) {
+        uint16_t *dest = (uint16_t *)dst_line;
+
+        if (simd_width) {
+            if (!alpha)
+                ff_gbr16ptopacked48_ssse3(dest, src0, src1, src2, simd_width,
+                                          scale_high, scale_low);
+            else if (src_alpha)
+                ff_gbra16ptopacked64_sse2(dest, src0, src1, src2, src3,
+                                          simd_width, scale_high, scale_low);
+            else
+                ff_gbr16ptopacked64_sse2(dest, src0, src1, src2, simd_width,
+                                         scale_high, scale_low);
+        }
+        dest += simd_width * (3 + alpha);
+        for (x = simd_width; x < width; x++) {
+            *dest++ = src0[x] << scale_high | src0[x] >> scale_low;
+            *dest++ = src1[x] << scale_high | src1[x] >> scale_low;
+            *dest++ = src2[x] << scale_high | src2[x] >> scale_low;
+            if (alpha)
+                *dest++ = src_alpha ? src3[x] << scale_high | src3[x] >> scale_low
+                                    : 0xffff;
+        }
+
+        src0 += srcStride[first] >> 1;
+        src1 += srcStride[0]     >> 1;
+        src2 += srcStride[last]  >> 1;
+        if (src_alpha)
+            src3 += srcStride[3] >> 1;
+        dst_line += dstStride[0];
+    }
+
+    return srcSliceH;
+}
+
+av_cold void ff_get_unscaled_swscale_x86(SwsContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+    const enum AVPixelFormat srcFormat = c->srcFormat;
+    const enum AVPixelFormat dstFormat = c->dstFormat;
+
+    if (EXTERNAL_SSE2(cpu_flags)) {
+        if (srcFormat == AV_PIX_FMT_GBRP && isByteRGB32(dstFormat))
+            c->swscale = planar_rgb_to_rgb_x86_wrapper;
+        if (isPlanarRGB16LE(srcFormat) &&
+            (dstFormat == AV_PIX_FMT_RGBA64LE || dstFormat == AV_PIX_FMT_BGRA64LE))
+            c->swscale = planar_rgb16_to_rgb16_x86_wrapper;
+    }
+
+    if (EXTERNAL_SSSE3(cpu_flags)) {
+        if (srcFormat == AV_PIX_FMT_GBRP && isByteRGB24(dstFormat))
+            c->swscale = planar_rgb_to_rgb_x86_wrapper;
+        if ((isByteRGB24(srcFormat) || isByteRGB32(srcFormat)) &&
+            dstFormat == AV_PIX_FMT_GBRP)
+            c->swscale = rgb_to_planar_rgb_x86_wrapper;
+        if (isPlanarRGB16LE(srcFormat) &&
+            (dstFormat == AV_PIX_FMT_RGB48LE || dstFormat == AV_PIX_FMT_BGR48LE))
+            c->swscale = planar_rgb16_to_rgb16_x86_wrapper;
+        if (isPackedRGB16LE(srcFormat) && isPlanarRGB16LE(dstFormat))
+            c->swscale = rgb16_to_planar_rgb16_x86_wrapper;
+    }
+
+    if (ARCH_X86_64 && EXTERNAL_SSSE3(cpu_flags) && dstFormat == AV_PIX_FMT_RGB24) {
+        switch (srcFormat) {
+        case AV_PIX_FMT_BAYER_BGGR8: c->bayerToRGB24 = ff_bayer_bggr8_to_rgb24_ssse3; break;
+        case AV_PIX_FMT_BAYER_RGGB8: c->bayerToRGB24 = ff_bayer_rggb8_to_rgb24_ssse3; break;
+        case AV_PIX_FMT_BAYER_GBRG8: c->bayerToRGB24 = ff_bayer_gbrg8_to_rgb24_ssse3; break;
+        case AV_PIX_FMT_BAYER_GRBG8: c->bayerToRGB24 = ff_bayer_grbg8_to_rgb24_ssse3; break;
+        default: break;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/aacenc.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 1024
+
+#define randomize_float(buf, len)                               \
+    do {                                                        \
+        int i;                                                  \
+        for (i = 0; i < len; i++) {                             \
+            float f = (float)rnd() / (UINT_MAX >> 5) - 16.0f;   \
+            buf[i] = f;                                         \
+        }                                                       \
+    } while (0)
+
+static void test_abs_pow34(AACEncContext *s)
+{
+    LOCAL_ALIGNED_16(float, in,   [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, out0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, out1, [BUF_SIZE]);
+
+    declare_func(void, float *, const float *, const int);
+
+    randomize_float(in, BUF_SIZE);
+
+    if (check_func(s->abs_pow34, "abs_pow34")) {
+        call_ref(out0, in, BUF_SIZE);
+        call_new(out1, in, BUF_SIZE);
+        if (!float_near_ulp_array(out0, out1, 1, BUF_SIZE))
+            fail();
+        bench_new(out1, in, BUF_SIZE);
+    }
+
+    report("abs_pow34");
+}
+
+static void test_aac_quantize_bands(AACEncContext *s)
+{
+    static const int maxval_tab[] = { 1, 2, 4, 7, 12, 16, 8191 };
+    static const float rounding_tab[] = { 0.4054f, 0.1697f, 0.5f };
+    LOCAL_ALIGNED_16(float, in,     [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, scaled, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(int,   out0,   [BUF_SIZE]);
+    LOCAL_ALIGNED_16(int,   out1,   [BUF_SIZE]);
+    const float Q34 = 0.8f;
+    int i, j, is_signed;
+
+    declare_func(void, int *, const float *, const float *, int, int, int,
+                 const float, const float);
+
+    randomize_float(in, BUF_SIZE);
+    for (i = 0; i < BUF_SIZE; i++)
+        scaled[i] = fabsf(in[i]);
+
+    if (check_func(s->quant_bands, "quant_bands")) {
+        for (is_signed = 0; is_signed <= 1; is_signed++) {
+            for (i = 0; i < FF_ARRAY_ELEMS(maxval_tab); i++) {
+                for (j = 0; j < FF_ARRAY_ELEMS(rounding_tab); j++) {
+                    const int maxval = maxval_tab[i];
+                    const float rounding = rounding_tab[j];
+
+                    call_ref(out0, in, scaled, BUF_SIZE, is_signed, maxval, Q34, rounding);
+                    call_new(out1, in, scaled, BUF_SIZE, is_signed, maxval, Q34, rounding);
+                    if (memcmp(out0, out1, BUF_SIZE * sizeof(*out0)))
+                        fail();
+                }
+            }
+        }
+        bench_new(out1, in, scaled, BUF_SIZE, 1, 8191, Q34, rounding_tab[0]);
+    }
+
+    report("quant_bands");
+}
+
+void checkasm_check_aacencdsp(void)
+{
+    static AACEncContext s;
+
+    ff_aac_dsp_init(&s);
+
+    test_abs_pow34(&s);
+    test_aac_quantize_bands(&s);
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/cfhddsp.h"
+
+#include "checkasm.h"
+
+#define WIDTH 128
+#define PAD   8
+
+#define randomize_buffers(buf, size)                                \
+    do {                                                            \
+        int j;                                                      \
+        for (j = 0; j < size; j++)                                  \
+            buf[j] = rnd();                                         \
+    } while (0)
+
+static const int widths[] = { 8, 24, WIDTH };
+
+void checkasm_check_cfhddsp(void)
+{
+    LOCAL_ALIGNED_16(int16_t, low,  [3 * (WIDTH + PAD)]);
+    LOCAL_ALIGNED_16(int16_t, high, [WIDTH + PAD]);
+    LOCAL_ALIGNED_16(int16_t, dst0, [4 * WIDTH]);
+    LOCAL_ALIGNED_16(int16_t, dst1, [4 * WIDTH]);
+    const int16_t *mid = low + WIDTH + PAD;
+    CFHDDSPContext c;
+    int i;
+
+    ff_cfhddsp_init(&c);
+
+    randomize_buffers(low,  3 * (WIDTH + PAD));
+    randomize_buffers(high, WIDTH + PAD);
+
+    if (check_func(c.horiz_filter, "cfhd_horiz_filter")) {
+        declare_func(void, int16_t *, const int16_t *, const int16_t *, int);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            call_ref(dst0, mid + 1, high, widths[i]);
+            call_new(dst1, mid + 1, high, widths[i]);
+            if (memcmp(dst0, dst1, 2 * widths[i] * sizeof(*dst0)))
+                fail();
+        }
+        bench_new(dst1, mid + 1, high, WIDTH);
+    }
+
+    if (check_func(c.horiz_filter_clip, "cfhd_horiz_filter_clip")) {
+        declare_func(void, int16_t *, const int16_t *, const int16_t *, int, int);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int clip = i & 1 ? 12 : 10;
+            call_ref(dst0, mid + 1, high, widths[i], clip);
+            call_new(dst1, mid + 1, high, widths[i], clip);
+            if (memcmp(dst0, dst1, 2 * widths[i] * sizeof(*dst0)))
+                fail();
+        }
+        bench_new(dst1, mid + 1, high, WIDTH, 10);
+    }
+    report("horiz_filter");
+
+    if (check_func(c.vert_filter, "cfhd_vert_filter")) {
+        declare_func(void, int16_t *, ptrdiff_t, const int16_t *, ptrdiff_t,
+                     const int16_t *, int);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0, 0, 4 * WIDTH * sizeof(*dst0));
+            memset(dst1, 0, 4 * WIDTH * sizeof(*dst1));
+            call_ref(dst0, 2 * WIDTH, mid, WIDTH + PAD, high, widths[i]);
+            call_new(dst1, 2 * WIDTH, mid, WIDTH + PAD, high, widths[i]);
+            if (memcmp(dst0, dst1, 4 * WIDTH * sizeof(*dst0)))
+                fail();
+        }
+        bench_new(dst1, 2 * WIDTH, mid, WIDTH + PAD, high, WIDTH);
+    }
+    report("vert_filter");
+}
@@ -65,12 +65,18 @@ static const struct {
     void (*func)(void);
 } tests[] = {
 #if CONFIG_AVCODEC
+    #if CONFIG_AAC_ENCODER
+        { "aacencdsp", checkasm_check_aacencdsp },
+    #endif
     #if CONFIG_ALAC_DECODER
         { "alacdsp", checkasm_check_alacdsp },
     #endif
     #if CONFIG_BSWAPDSP
         { "bswapdsp", checkasm_check_bswapdsp },
     #endif
+    #if CONFIG_CFHD_DECODER
+        { "cfhddsp", checkasm_check_cfhddsp },
+    #endif
     #if CONFIG_DCA_DECODER
         { "synth_filter", checkasm_check_synth_filter },
     #endif
@@ -95,9 +101,24 @@ static const struct {
     #if CONFIG_PIXBLOCKDSP
         { "pixblockdsp", checkasm_check_pixblockdsp },
     #endif
+    #if CONFIG_PNG_ENCODER
+        { "pngencdsp", checkasm_check_pngencdsp },
+    #endif
+    #if CONFIG_PRORES_KS_ENCODER
+        { "proresencdsp", checkasm_check_proresencdsp },
+    #endif
+    #if CONFIG_TEXTUREDSP
+        { "texturedsp", checkasm_check_texturedsp },
+    #endif
+    #if CONFIG_TEXTUREDSPENC
+        { "texturedspenc", checkasm_check_texturedspenc },
+    #endif
     #if CONFIG_V210_ENCODER
         { "v210enc", checkasm_check_v210enc },
     #endif
+    #if CONFIG_VC2_ENCODER
+        { "vc2enc_dwt", checkasm_check_vc2enc_dwt },
+    #endif
     #if CONFIG_VP9_DECODER
         { "vp9dsp", checkasm_check_vp9dsp },
     #endif
@@ -106,12 +127,37 @@ static const struct {
     #endif
 #endif
 #if CONFIG_AVFILTER
+        { "drawutils", checkasm_check_drawutils },
+    #if CONFIG_ATADENOISE_FILTER
+        { "vf_atadenoise", checkasm_check_atadenoise },
+    #endif
     #if CONFIG_BLEND_FILTER
         { "vf_blend", checkasm_check_blend },
     #endif
+    #if CONFIG_BOXBLUR_FILTER
+        { "vf_boxblur", checkasm_check_boxblur },
+    #endif
     #if CONFIG_COLORSPACE_FILTER
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
+    #if CONFIG_FRAMERATE_FILTER
+        { "vf_framerate", checkasm_check_framerate },
+    #endif
+    #if CONFIG_LUT_FILTER
+        { "vf_lut", checkasm_check_lut },
+    #endif
+    #if CONFIG_REMOVEGRAIN_FILTER
+        { "vf_removegrain", checkasm_check_removegrain },
+    #endif
+    #if CONFIG_ASS_FILTER || CONFIG_SUBTITLES_FILTER
+        { "vf_subtitles", checkasm_check_subtitles },
+    #endif
+    #if CONFIG_UNSHARP_FILTER
+        { "vf_unsharp", checkasm_check_unsharp },
+    #endif
+#endif
+#if CONFIG_SWSCALE
+    { "sw_scale", checkasm_check_sw_scale },
 #endif
     { NULL }
 };
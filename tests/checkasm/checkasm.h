@@ -30,19 +30,35 @@
 #include "libavutil/lfg.h"
 #include "libavutil/timer.h"
 
+void checkasm_check_aacencdsp(void);
 void checkasm_check_alacdsp(void);
+void checkasm_check_atadenoise(void);
 void checkasm_check_blend(void);
+void checkasm_check_boxblur(void);
 void checkasm_check_bswapdsp(void);
+void checkasm_check_cfhddsp(void);
 void checkasm_check_colorspace(void);
+void checkasm_check_drawutils(void);
 void checkasm_check_flacdsp(void);
 void checkasm_check_fmtconvert(void);
+void checkasm_check_framerate(void);
 void checkasm_check_h264dsp(void);
 void checkasm_check_h264pred(void);
 void checkasm_check_h264qpel(void);
 void checkasm_check_jpeg2000dsp(void);
+void checkasm_check_lut(void);
 void checkasm_check_pixblockdsp(void);
+void checkasm_check_pngencdsp(void);
+void checkasm_check_proresencdsp(void);
+void checkasm_check_removegrain(void);
+void checkasm_check_subtitles(void);
+void checkasm_check_sw_scale(void);
 void checkasm_check_synth_filter(void);
+void checkasm_check_texturedsp(void);
+void checkasm_check_texturedspenc(void);
+void checkasm_check_unsharp(void);
 void checkasm_check_v210enc(void);
+void checkasm_check_vc2enc_dwt(void);
 void checkasm_check_vp9dsp(void);
 void checkasm_check_videodsp(void);
 
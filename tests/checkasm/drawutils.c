@@ -0,0 +1,102 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/drawutils.h"
+#include "libavutil/internal.h"
+
+#define WIDTH 64
+
+#define randomize_buffers(buf, size)            \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd();                     \
+    } while (0)
+
+/* alpha as computed by ff_blend_mask() for 8-bit formats */
+#define ALPHA(a) ((0x10307 * (a) + 0x3) >> 8)
+
+static void check_blend_row8(FFDrawContext *draw)
+{
+    LOCAL_ALIGNED_32(uint8_t, mask, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    unsigned src, alpha;
+    int w;
+
+    declare_func(void, uint8_t *dst, const uint8_t *mask, int w,
+                 unsigned src, unsigned alpha);
+
+    if (check_func(draw->blend_row8, "blend_row8")) {
+        for (w = 4; w <= WIDTH; w += 12) {
+            src   = rnd() & 0xff;
+            alpha = ALPHA(rnd() & 0xff);
+            randomize_buffers(mask, WIDTH);
+            randomize_buffers(dst0, WIDTH);
+            memcpy(dst1, dst0, WIDTH);
+            call_ref(dst0, mask, w, src, alpha);
+            call_new(dst1, mask, w, src, alpha);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, mask, WIDTH, 0x80, ALPHA(0xff));
+    }
+}
+
+static void check_blend_row8_2x2(FFDrawContext *draw)
+{
+    LOCAL_ALIGNED_32(uint8_t, mask, [4 * WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    unsigned src, alpha;
+    int w;
+
+    declare_func(void, uint8_t *dst, const uint8_t *mask,
+                 ptrdiff_t mask_linesize, int w, unsigned src, unsigned alpha);
+
+    if (check_func(draw->blend_row8_2x2, "blend_row8_2x2")) {
+        for (w = 4; w <= WIDTH; w += 12) {
+            src   = rnd() & 0xff;
+            alpha = ALPHA(rnd() & 0xff);
+            randomize_buffers(mask, 4 * WIDTH);
+            randomize_buffers(dst0, WIDTH);
+            memcpy(dst1, dst0, WIDTH);
+            call_ref(dst0, mask, 2 * WIDTH, w, src, alpha);
+            call_new(dst1, mask, 2 * WIDTH, w, src, alpha);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, mask, 2 * WIDTH, WIDTH, 0x80, ALPHA(0xff));
+    }
+}
+
+void checkasm_check_drawutils(void)
+{
+    FFDrawContext draw;
+
+    if (ff_draw_init(&draw, AV_PIX_FMT_YUV420P, 0) < 0)
+        return;
+
+    check_blend_row8(&draw);
+    report("blend_row8");
+
+    check_blend_row8_2x2(&draw);
+    report("blend_row8_2x2");
+}
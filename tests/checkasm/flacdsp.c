@@ -53,6 +53,44 @@ static void check_decorrelate(uint8_t **ref_dst, uint8_t **ref_src, uint8_t **ne
     bench_new(new_dst, (int32_t **)new_src, channels, BUF_SIZE / sizeof(int32_t), 8);
 }
 
+static void check_lpc_encode(void)
+{
+    LOCAL_ALIGNED_16(int32_t, smp,     [BUF_SIZE + 4]);
+    LOCAL_ALIGNED_16(int32_t, ref_res, [BUF_SIZE + 4]);
+    LOCAL_ALIGNED_16(int32_t, new_res, [BUF_SIZE + 4]);
+    int32_t coefs[32];
+    int i, order;
+    declare_func(void, int32_t *res, const int32_t *smp, int len, int order,
+                 const int32_t coefs[32], int shift);
+
+    for (order = 1; order <= 32; order++) {
+        for (i = 0; i < BUF_SIZE + 4; i++)
+            smp[i] = (int32_t)rnd() >> 8;
+        for (i = 0; i < order; i++)
+            coefs[i] = (int32_t)rnd() >> 17;
+        call_ref(ref_res, smp, BUF_SIZE, order, coefs, 14);
+        call_new(new_res, smp, BUF_SIZE, order, coefs, 14);
+        if (memcmp(ref_res, new_res, BUF_SIZE * sizeof(*ref_res)))
+            fail();
+    }
+    bench_new(new_res, smp, BUF_SIZE, 32, coefs, 14);
+}
+
+static void check_rice_sum(void)
+{
+    LOCAL_ALIGNED_16(uint32_t, res, [BUF_SIZE]);
+    int i, k;
+    declare_func(uint64_t, const uint32_t *res, int len, int k);
+
+    for (i = 0; i < BUF_SIZE; i++)
+        res[i] = rnd();
+    for (k = 0; k < 31; k++) {
+        if (call_ref(res + 1, BUF_SIZE - 4, k) != call_new(res + 1, BUF_SIZE - 4, k))
+            fail();
+    }
+    bench_new(res, BUF_SIZE, 4);
+}
+
 void checkasm_check_flacdsp(void)
 {
     LOCAL_ALIGNED_16(uint8_t, ref_dst, [BUF_SIZE*MAX_CHANNELS]);
@@ -87,4 +125,13 @@ void checkasm_check_flacdsp(void)
     }
 
     report("decorrelate");
+
+    ff_flacdsp_init(&h, AV_SAMPLE_FMT_S32, 2, 24);
+    if (check_func(h.lpc32_encode, "flac_enc_lpc_32"))
+        check_lpc_encode();
+    report("lpc_encode");
+
+    if (check_func(h.rice_sum, "flac_rice_sum"))
+        check_rice_sum();
+    report("rice_sum");
 }
@@ -0,0 +1,94 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavcodec/pngencdsp.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 1024
+#define PAD      8
+
+#define randomize_buffers(buf, size)            \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j += 4)           \
+            AV_WN32A(buf + j, rnd());           \
+    } while (0)
+
+static void check_sub_prediction(void (*func)(uint8_t *, const uint8_t *,
+                                              const uint8_t *, int, int),
+                                 const char *name, int align)
+{
+    static const int bpps[] = { 1, 2, 3, 4, 6, 8 };
+    LOCAL_ALIGNED_16(uint8_t, src,  [BUF_SIZE + PAD]);
+    LOCAL_ALIGNED_16(uint8_t, top,  [BUF_SIZE + PAD]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [BUF_SIZE]);
+    int i;
+
+    declare_func(void, uint8_t *, const uint8_t *, const uint8_t *, int, int);
+
+    randomize_buffers(src, BUF_SIZE + PAD);
+    randomize_buffers(top, BUF_SIZE + PAD);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bpps); i++) {
+        const int bpp = bpps[i];
+        const int w   = (BUF_SIZE - bpp) & ~(align - 1);
+
+        if (check_func(func, "%s_bpp%d", name, bpp)) {
+            memset(dst0, 0, BUF_SIZE);
+            memset(dst1, 0, BUF_SIZE);
+            call_ref(dst0, src + PAD, top + PAD, w, bpp);
+            call_new(dst1, src + PAD, top + PAD, w, bpp);
+            if (memcmp(dst0, dst1, w))
+                fail();
+            bench_new(dst1, src + PAD, top + PAD, w, bpp);
+        }
+    }
+}
+
+void checkasm_check_pngencdsp(void)
+{
+    PNGEncDSPContext c;
+
+    ff_pngencdsp_init(&c);
+
+    check_sub_prediction(c.sub_paeth_prediction, "sub_paeth_prediction", 8);
+    report("sub_paeth_prediction");
+
+    check_sub_prediction(c.sub_avg_prediction, "sub_avg_prediction", 16);
+    report("sub_avg_prediction");
+
+    if (check_func(c.filter_cost, "filter_cost")) {
+        LOCAL_ALIGNED_16(uint8_t, buf, [BUF_SIZE]);
+        declare_func(int, const uint8_t *, int);
+
+        randomize_buffers(buf, BUF_SIZE);
+        buf[0] = 0x80;
+        if (call_ref(buf, BUF_SIZE) != call_new(buf, BUF_SIZE))
+            fail();
+        bench_new(buf, BUF_SIZE);
+    }
+    report("filter_cost");
+}
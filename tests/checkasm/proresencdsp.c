@@ -0,0 +1,74 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/proresencdsp.h"
+
+#include "checkasm.h"
+
+#define MAX_BLOCKS 32
+
+static void check_quantize(ProresEncDSPContext *c)
+{
+    static const int nb_blocks[] = { 1, 2, 8, MAX_BLOCKS };
+    LOCAL_ALIGNED_32(int16_t, src,  [64 * MAX_BLOCKS]);
+    LOCAL_ALIGNED_32(int16_t, dst0, [64 * MAX_BLOCKS]);
+    LOCAL_ALIGNED_32(int16_t, dst1, [64 * MAX_BLOCKS]);
+    int16_t qmat[64];
+    int i, j;
+
+    declare_func(int, int16_t *, const int16_t *, const int16_t *, int);
+
+    /* DCT coefficients are mostly small, with a few large ones and the
+     * extremes of the range to check the rounding of the division */
+    for (i = 0; i < 64 * MAX_BLOCKS; i++) {
+        switch (rnd() & 7) {
+        case 0:  src[i] = rnd();                                 break;
+        case 1:  src[i] = rnd() & 1 ? INT16_MIN : INT16_MAX;     break;
+        default: src[i] = (int)(rnd() & 0x3ff) - 0x200;          break;
+        }
+    }
+
+    if (check_func(c->quantize, "prores_quantize")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(nb_blocks); i++) {
+            for (j = 0; j < 64; j++)
+                qmat[j] = i & 1 ? 1 + rnd() % 8001 : 1 + rnd() % 64;
+            memset(dst0, 0, sizeof(*dst0) * 64 * MAX_BLOCKS);
+            memset(dst1, 0, sizeof(*dst1) * 64 * MAX_BLOCKS);
+            if (call_ref(dst0, src, qmat, nb_blocks[i]) !=
+                call_new(dst1, src, qmat, nb_blocks[i]) ||
+                memcmp(dst0, dst1, sizeof(*dst0) * 64 * MAX_BLOCKS))
+                fail();
+        }
+        bench_new(dst1, src, qmat, MAX_BLOCKS);
+    }
+    report("quantize");
+}
+
+void checkasm_check_proresencdsp(void)
+{
+    ProresEncDSPContext c;
+
+    ff_proresencdsp_init(&c);
+
+    check_quantize(&c);
+}
@@ -0,0 +1,654 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/bswap.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/pixfmt.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define SRC_PIXELS 512
+#define MAX_DSTW   SRC_PIXELS
+/* the hscale and vscale functions may read/write up to 31 pixels past dstW */
+#define PAD        32
+#define MAX_VTAPS  16
+
+static const int widths[] = { 1, 7, 16, 33, 171, MAX_DSTW };
+
+static const struct {
+    int bpc;
+    enum AVPixelFormat fmt;
+} depths[] = {
+    {  8, AV_PIX_FMT_YUV420P     },
+    {  9, AV_PIX_FMT_YUV420P9LE  },
+    { 10, AV_PIX_FMT_YUV420P10LE },
+    { 12, AV_PIX_FMT_YUV420P12LE },
+    { 14, AV_PIX_FMT_YUV420P14LE },
+    { 16, AV_PIX_FMT_YUV420P16LE },
+};
+
+static struct SwsContext *alloc_context(enum AVPixelFormat src_fmt, int src_bpc,
+                                        enum AVPixelFormat dst_fmt, int dst_bpc,
+                                        int hfilter_size)
+{
+    struct SwsContext *c = sws_alloc_context();
+
+    if (!c)
+        return NULL;
+    c->srcFormat       = src_fmt;
+    c->dstFormat       = dst_fmt;
+    c->srcBpc          = src_bpc;
+    c->dstBpc          = dst_bpc;
+    c->hLumFilterSize  = hfilter_size;
+    c->hChrFilterSize  = hfilter_size;
+    c->dither          = SWS_DITHER_NONE;
+    /* keep the MMX vertical scaler, which needs its own filter layout, out */
+    c->flags           = SWS_BITEXACT;
+    ff_getSwsFunc(c);
+    return c;
+}
+
+/* random filter whose coefficients add up to 1 << bits, like initFilter() */
+static void random_filter(int16_t *filter, int filter_size, int bits)
+{
+    int i, sum = 0;
+
+    for (i = 0; i < filter_size - 1; i++) {
+        filter[i] = (int)(rnd() % (1 << (bits - 3))) - (1 << (bits - 5));
+        sum += filter[i];
+    }
+    filter[filter_size - 1] = (1 << bits) - sum;
+}
+
+static void check_hscale(void)
+{
+    static const int filter_sizes[] = { 4, 8, 12, 16 };
+    LOCAL_ALIGNED_32(uint16_t, src, [SRC_PIXELS + 16]);
+    LOCAL_ALIGNED_32(int16_t,  filter,    [(MAX_DSTW + PAD) * 16]);
+    LOCAL_ALIGNED_32(int32_t,  filter_pos, [MAX_DSTW + PAD]);
+    LOCAL_ALIGNED_32(int32_t,  dst0, [MAX_DSTW + PAD]);
+    LOCAL_ALIGNED_32(int32_t,  dst1, [MAX_DSTW + PAD]);
+    int d, o, f, w, i, j;
+
+    declare_func(void, struct SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(depths); d++) {
+        const int bpc = depths[d].bpc;
+
+        for (i = 0; i < SRC_PIXELS + 16; i++)
+            src[i] = rnd() & (bpc == 8 ? 0xffff : (1 << bpc) - 1);
+
+        for (o = 0; o < 2; o++) {
+            const int out_bits = o ? 19 : 15;
+
+            for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+                const int filter_size = filter_sizes[f];
+                struct SwsContext *c = alloc_context(depths[d].fmt, bpc,
+                                                     o ? AV_PIX_FMT_YUV420P16LE : AV_PIX_FMT_YUV420P,
+                                                     o ? 16 : 8, filter_size);
+                const int src_len = bpc == 8 ? 2 * SRC_PIXELS : SRC_PIXELS;
+
+                if (!c)
+                    fail();
+                else if (check_func(c->hyScale, "hscale_%d_to_%d_%d",
+                                    bpc, out_bits, filter_size)) {
+                    for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                        const int dst_w = widths[w];
+
+                        for (i = 0; i < dst_w; i++) {
+                            filter_pos[i] = rnd() % (src_len - filter_size);
+                            random_filter(filter + i * filter_size, filter_size, 14);
+                        }
+                        /* initFilter() pads filterPos and filter for the SIMD versions */
+                        for (; i < dst_w + PAD; i++) {
+                            filter_pos[i] = filter_pos[dst_w - 1];
+                            for (j = 0; j < filter_size; j++)
+                                filter[i * filter_size + j] = filter[(dst_w - 1) * filter_size + j];
+                        }
+
+                        memset(dst0, 0, (MAX_DSTW + PAD) * sizeof(*dst0));
+                        memset(dst1, 0, (MAX_DSTW + PAD) * sizeof(*dst1));
+                        call_ref(c, (int16_t *)dst0, dst_w, (const uint8_t *)src,
+                                 filter, filter_pos, filter_size);
+                        call_new(c, (int16_t *)dst1, dst_w, (const uint8_t *)src,
+                                 filter, filter_pos, filter_size);
+                        if (memcmp(dst0, dst1, dst_w * (o ? 4 : 2)))
+                            fail();
+                    }
+                    bench_new(c, (int16_t *)dst1, MAX_DSTW, (const uint8_t *)src,
+                              filter, filter_pos, filter_size);
+                }
+                sws_freeContext(c);
+            }
+        }
+    }
+    report("hscale");
+}
+
+static void init_vscale_src(int32_t *src_buf, const int16_t **src, int bpc)
+{
+    int i, j;
+
+    for (j = 0; j < MAX_VTAPS; j++) {
+        int32_t *line = src_buf + j * (MAX_DSTW + PAD);
+
+        for (i = 0; i < MAX_DSTW + PAD; i++) {
+            if (bpc == 16)
+                line[i] = rnd() & 0x7ffff;
+            else
+                ((int16_t *)line)[i] = rnd() & 0x7fff;
+        }
+        src[j] = (const int16_t *)line;
+    }
+}
+
+static void check_yuv2planeX(void)
+{
+    static const int filter_sizes[] = { 2, 4, 8, MAX_VTAPS };
+    LOCAL_ALIGNED_32(int32_t, src_buf, [MAX_VTAPS * (MAX_DSTW + PAD)]);
+    LOCAL_ALIGNED_32(int16_t, filter, [MAX_VTAPS]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+    const int16_t *src[MAX_VTAPS];
+    int d, f, w, i, offset;
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+
+    for (d = 0; d < FF_ARRAY_ELEMS(depths); d++) {
+        const int bpc = depths[d].bpc;
+        struct SwsContext *c = alloc_context(AV_PIX_FMT_YUV420P, 8, depths[d].fmt, bpc, 4);
+
+        if (!c) {
+            fail();
+            continue;
+        }
+
+        init_vscale_src(src_buf, src, bpc);
+        if (check_func(c->yuv2planeX, "yuv2planeX_%d", bpc)) {
+            for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+                random_filter(filter, filter_sizes[f], 12);
+                for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                    for (offset = 0; offset <= 3; offset += 3) {
+                        memset(dst0, 0, (MAX_DSTW + PAD) * 2);
+                        memset(dst1, 0, (MAX_DSTW + PAD) * 2);
+                        call_ref(filter, filter_sizes[f], src, dst0, widths[w], dither, offset);
+                        call_new(filter, filter_sizes[f], src, dst1, widths[w], dither, offset);
+                        if (memcmp(dst0, dst1, widths[w] * (bpc > 8 ? 2 : 1)))
+                            fail();
+                    }
+                }
+            }
+            bench_new(filter, 8, src, dst1, MAX_DSTW, dither, 0);
+        }
+        sws_freeContext(c);
+    }
+    report("yuv2planeX");
+}
+
+static void check_yuv2plane1(void)
+{
+    LOCAL_ALIGNED_32(int32_t, src_buf, [MAX_VTAPS * (MAX_DSTW + PAD)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+    const int16_t *src[MAX_VTAPS];
+    int d, w, i, offset;
+
+    declare_func(void, const int16_t *src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+
+    for (d = 0; d < FF_ARRAY_ELEMS(depths); d++) {
+        const int bpc = depths[d].bpc;
+        struct SwsContext *c = alloc_context(AV_PIX_FMT_YUV420P, 8, depths[d].fmt, bpc, 4);
+
+        if (!c) {
+            fail();
+            continue;
+        }
+
+        init_vscale_src(src_buf, src, bpc);
+        if (check_func(c->yuv2plane1, "yuv2plane1_%d", bpc)) {
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                for (offset = 0; offset <= 3; offset += 3) {
+                    memset(dst0, 0, (MAX_DSTW + PAD) * 2);
+                    memset(dst1, 0, (MAX_DSTW + PAD) * 2);
+                    call_ref(src[0], dst0, widths[w], dither, offset);
+                    call_new(src[0], dst1, widths[w], dither, offset);
+                    if (memcmp(dst0, dst1, widths[w] * (bpc > 8 ? 2 : 1)))
+                        fail();
+                }
+            }
+            bench_new(src[0], dst1, MAX_DSTW, dither, 0);
+        }
+        sws_freeContext(c);
+    }
+    report("yuv2plane1");
+}
+
+static void check_input_word(void)
+{
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_YUVA420P10BE, AV_PIX_FMT_YUV444P16BE, AV_PIX_FMT_GRAY16BE,
+        AV_PIX_FMT_P010LE, AV_PIX_FMT_P010BE,
+    };
+    LOCAL_ALIGNED_32(uint16_t, src0, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint16_t, src1, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint16_t, src2, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [(MAX_DSTW + PAD) * 2]);
+    int f, w, i;
+
+    for (i = 0; i < (MAX_DSTW + PAD) * 2; i++) {
+        src0[i] = rnd();
+        src1[i] = rnd();
+        src2[i] = rnd();
+    }
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        const char *name = av_get_pix_fmt_name(formats[f]);
+        struct SwsContext *c = alloc_context(formats[f], 16, AV_PIX_FMT_YUV420P, 8, 4);
+
+        if (!c) {
+            fail();
+            continue;
+        }
+
+        if (check_func(c->lumToYV12, "%s_to_y", name)) {
+            declare_func(void, uint8_t *dst, const uint8_t *src, const uint8_t *src2,
+                         const uint8_t *src3, int width, uint32_t *pal);
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                memset(dst0, 0, MAX_DSTW * 2);
+                memset(dst1, 0, MAX_DSTW * 2);
+                call_ref((uint8_t *)dst0, (const uint8_t *)src0, (const uint8_t *)src1,
+                         (const uint8_t *)src2, widths[w], NULL);
+                call_new((uint8_t *)dst1, (const uint8_t *)src0, (const uint8_t *)src1,
+                         (const uint8_t *)src2, widths[w], NULL);
+                if (memcmp(dst0, dst1, widths[w] * 2))
+                    fail();
+            }
+            bench_new((uint8_t *)dst1, (const uint8_t *)src0, (const uint8_t *)src1,
+                      (const uint8_t *)src2, MAX_DSTW, NULL);
+        }
+
+        if (c->alpToYV12 && check_func(c->alpToYV12, "%s_to_a", name)) {
+            declare_func(void, uint8_t *dst, const uint8_t *src, const uint8_t *src2,
+                         const uint8_t *src3, int width, uint32_t *pal);
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                memset(dst0, 0, MAX_DSTW * 2);
+                memset(dst1, 0, MAX_DSTW * 2);
+                call_ref((uint8_t *)dst0, (const uint8_t *)src1, (const uint8_t *)src0,
+                         (const uint8_t *)src2, widths[w], NULL);
+                call_new((uint8_t *)dst1, (const uint8_t *)src1, (const uint8_t *)src0,
+                         (const uint8_t *)src2, widths[w], NULL);
+                if (memcmp(dst0, dst1, widths[w] * 2))
+                    fail();
+            }
+            bench_new((uint8_t *)dst1, (const uint8_t *)src1, (const uint8_t *)src0,
+                      (const uint8_t *)src2, MAX_DSTW, NULL);
+        }
+
+        if (c->chrToYV12 && check_func(c->chrToYV12, "%s_to_uv", name)) {
+            declare_func(void, uint8_t *dstU, uint8_t *dstV, const uint8_t *src1,
+                         const uint8_t *src2, const uint8_t *src3, int width, uint32_t *pal);
+            uint16_t *dst0v = dst0 + MAX_DSTW + PAD, *dst1v = dst1 + MAX_DSTW + PAD;
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                memset(dst0, 0, (MAX_DSTW + PAD) * 4);
+                memset(dst1, 0, (MAX_DSTW + PAD) * 4);
+                call_ref((uint8_t *)dst0, (uint8_t *)dst0v, (const uint8_t *)src2,
+                         (const uint8_t *)src0, (const uint8_t *)src1, widths[w], NULL);
+                call_new((uint8_t *)dst1, (uint8_t *)dst1v, (const uint8_t *)src2,
+                         (const uint8_t *)src0, (const uint8_t *)src1, widths[w], NULL);
+                if (memcmp(dst0, dst1, widths[w] * 2) ||
+                    memcmp(dst0v, dst1v, widths[w] * 2))
+                    fail();
+            }
+            bench_new((uint8_t *)dst1, (uint8_t *)dst1v, (const uint8_t *)src2,
+                      (const uint8_t *)src0, (const uint8_t *)src1, MAX_DSTW, NULL);
+        }
+        sws_freeContext(c);
+    }
+    report("input_word");
+}
+
+static void check_input_planar_rgb(void)
+{
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_GBRP9LE,   AV_PIX_FMT_GBRP9BE,
+        AV_PIX_FMT_GBRAP10LE, AV_PIX_FMT_GBRAP10BE,
+        AV_PIX_FMT_GBRAP12LE, AV_PIX_FMT_GBRAP12BE,
+        AV_PIX_FMT_GBRP14LE,  AV_PIX_FMT_GBRP14BE,
+        AV_PIX_FMT_GBRAP16LE, AV_PIX_FMT_GBRAP16BE,
+    };
+    /* BT.601 limited range, as set up by fill_rgb2yuv_table() */
+    static const int32_t coeffs[9] = {
+         8414,  16519,  3208,
+        -4865,  -9528, 14392,
+        14392, -12061, -2332,
+    };
+    LOCAL_ALIGNED_32(uint16_t, src, [4 * (MAX_DSTW + PAD)]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [(MAX_DSTW + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [(MAX_DSTW + PAD) * 2]);
+    uint16_t *dst0v = dst0 + MAX_DSTW + PAD, *dst1v = dst1 + MAX_DSTW + PAD;
+    const uint8_t *planes[4];
+    int f, w, i;
+
+    for (i = 0; i < 4; i++)
+        planes[i] = (const uint8_t *)(src + i * (MAX_DSTW + PAD));
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(formats[f]);
+        const int bpc = desc->comp[0].depth;
+        struct SwsContext *c = alloc_context(formats[f], bpc, AV_PIX_FMT_YUV420P, 8, 4);
+        int32_t *rgb2yuv;
+
+        if (!c) {
+            fail();
+            continue;
+        }
+        rgb2yuv = c->input_rgb2yuv_table;
+        memcpy(rgb2yuv, coeffs, sizeof(coeffs));
+
+        for (i = 0; i < 4 * (MAX_DSTW + PAD); i++) {
+            uint16_t v = rnd() & ((1 << bpc) - 1);
+            src[i] = desc->flags & AV_PIX_FMT_FLAG_BE ? av_bswap16(v) : v;
+        }
+
+        if (check_func(c->readLumPlanar, "%s_to_y", desc->name)) {
+            declare_func(void, uint8_t *dst, const uint8_t *src[4], int width,
+                         int32_t *rgb2yuv);
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                memset(dst0, 0, MAX_DSTW * 2);
+                memset(dst1, 0, MAX_DSTW * 2);
+                call_ref((uint8_t *)dst0, planes, widths[w], rgb2yuv);
+                call_new((uint8_t *)dst1, planes, widths[w], rgb2yuv);
+                if (memcmp(dst0, dst1, widths[w] * 2))
+                    fail();
+            }
+            bench_new((uint8_t *)dst1, planes, MAX_DSTW, rgb2yuv);
+        }
+
+        if (check_func(c->readChrPlanar, "%s_to_uv", desc->name)) {
+            declare_func(void, uint8_t *dstU, uint8_t *dstV, const uint8_t *src[4],
+                         int width, int32_t *rgb2yuv);
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                memset(dst0, 0, (MAX_DSTW + PAD) * 4);
+                memset(dst1, 0, (MAX_DSTW + PAD) * 4);
+                call_ref((uint8_t *)dst0, (uint8_t *)dst0v, planes, widths[w], rgb2yuv);
+                call_new((uint8_t *)dst1, (uint8_t *)dst1v, planes, widths[w], rgb2yuv);
+                if (memcmp(dst0, dst1, widths[w] * 2) ||
+                    memcmp(dst0v, dst1v, widths[w] * 2))
+                    fail();
+            }
+            bench_new((uint8_t *)dst1, (uint8_t *)dst1v, planes, MAX_DSTW, rgb2yuv);
+        }
+
+        if (c->readAlpPlanar && check_func(c->readAlpPlanar, "%s_to_a", desc->name)) {
+            declare_func(void, uint8_t *dst, const uint8_t *src[4], int width,
+                         int32_t *rgb2yuv);
+
+            for (w = 0; w < FF_ARRAY_ELEMS(widths); w++) {
+                memset(dst0, 0, MAX_DSTW * 2);
+                memset(dst1, 0, MAX_DSTW * 2);
+                call_ref((uint8_t *)dst0, planes, widths[w], rgb2yuv);
+                call_new((uint8_t *)dst1, planes, widths[w], rgb2yuv);
+                if (memcmp(dst0, dst1, widths[w] * 2))
+                    fail();
+            }
+            bench_new((uint8_t *)dst1, planes, MAX_DSTW, rgb2yuv);
+        }
+        sws_freeContext(c);
+    }
+    report("input_planar_rgb");
+}
+
+static void check_gamma_convert(void)
+{
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_RGB48LE, AV_PIX_FMT_RGBA64LE,
+    };
+    static const int gamma_widths[] = { 16, 32, 160, MAX_DSTW };
+    uint16_t *table = av_malloc(sizeof(*table) * ((1 << 16) + 1));
+    LOCAL_ALIGNED_32(uint16_t, src,  [MAX_DSTW * 4]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [MAX_DSTW * 4]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [MAX_DSTW * 4]);
+    int f, w, i;
+
+    declare_func(void, uint16_t *line, const uint16_t *table, int width);
+
+    if (!table) {
+        fail();
+        return;
+    }
+    for (i = 0; i < 1 << 16; i++)
+        table[i] = rnd();
+    table[1 << 16] = 0;
+    for (i = 0; i < MAX_DSTW * 4; i++)
+        src[i] = rnd();
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        struct SwsContext *c = alloc_context(formats[f], 16, AV_PIX_FMT_YUV420P, 8, 4);
+
+        if (!c) {
+            fail();
+            continue;
+        }
+        if (check_func(c->gammaConvert, "gamma_convert_%s",
+                       av_get_pix_fmt_name(formats[f]))) {
+            for (w = 0; w < FF_ARRAY_ELEMS(gamma_widths); w++) {
+                memcpy(dst0, src, MAX_DSTW * 8);
+                memcpy(dst1, src, MAX_DSTW * 8);
+                call_ref(dst0, table, gamma_widths[w]);
+                call_new(dst1, table, gamma_widths[w]);
+                if (memcmp(dst0, dst1, MAX_DSTW * 8))
+                    fail();
+            }
+            bench_new(dst1, table, MAX_DSTW);
+        }
+        sws_freeContext(c);
+    }
+    av_free(table);
+    report("gamma_convert");
+}
+
+#define BAYER_W      128
+/* two pixels on each side of the demosaiced part are read */
+#define BAYER_STRIDE (BAYER_W + 4)
+
+static void check_bayer_to_rgb24(void)
+{
+    static const enum AVPixelFormat formats[] = {
+        AV_PIX_FMT_BAYER_BGGR8, AV_PIX_FMT_BAYER_RGGB8,
+        AV_PIX_FMT_BAYER_GBRG8, AV_PIX_FMT_BAYER_GRBG8,
+    };
+    static const int bayer_widths[] = { 16, 32, 80, BAYER_W };
+    LOCAL_ALIGNED_32(uint8_t, src,  [4 * BAYER_STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [2 * 3 * BAYER_W]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [2 * 3 * BAYER_W]);
+    int f, w, i;
+
+    declare_func(void, const uint8_t *src, int src_stride,
+                 uint8_t *dst, int dst_stride, int width);
+
+    for (i = 0; i < 4 * BAYER_STRIDE; i++)
+        src[i] = rnd();
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        struct SwsContext *c = sws_getContext(BAYER_W, 4, formats[f],
+                                              BAYER_W, 4, AV_PIX_FMT_RGB24,
+                                              SWS_POINT, NULL, NULL, NULL);
+
+        if (!c) {
+            fail();
+            continue;
+        }
+        if (check_func(c->bayerToRGB24, "bayer_%s_to_rgb24",
+                       av_get_pix_fmt_name(formats[f]) + 6)) {
+            for (w = 0; w < FF_ARRAY_ELEMS(bayer_widths); w++) {
+                memset(dst0, 0, 2 * 3 * BAYER_W);
+                memset(dst1, 0, 2 * 3 * BAYER_W);
+                call_ref(src + BAYER_STRIDE + 2, BAYER_STRIDE,
+                         dst0, 3 * BAYER_W, bayer_widths[w]);
+                call_new(src + BAYER_STRIDE + 2, BAYER_STRIDE,
+                         dst1, 3 * BAYER_W, bayer_widths[w]);
+                if (memcmp(dst0, dst1, 2 * 3 * BAYER_W))
+                    fail();
+            }
+            bench_new(src + BAYER_STRIDE + 2, BAYER_STRIDE,
+                      dst1, 3 * BAYER_W, BAYER_W);
+        }
+        sws_freeContext(c);
+    }
+    report("bayer_to_rgb24");
+}
+
+#define RGB_W      128
+#define RGB_H      4
+/* room for 128 pixels of 64 bits plus some padding */
+#define RGB_STRIDE (RGB_W * 8 + 64)
+
+static void check_unscaled(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                           uint8_t *src_buf, uint8_t *dst0_buf, uint8_t *dst1_buf)
+{
+    static const int rgb_widths[] = { 1, 7, 16, 33, 120, RGB_W };
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(src_fmt);
+    const int src_planes = av_pix_fmt_count_planes(src_fmt);
+    const int dst_planes = av_pix_fmt_count_planes(dst_fmt);
+    const uint8_t *src[4] = { NULL };
+    uint8_t *dst0[4] = { NULL }, *dst1[4] = { NULL };
+    int stride[4] = { RGB_STRIDE, RGB_STRIDE, RGB_STRIDE, RGB_STRIDE };
+    struct SwsContext *c;
+    int i, w;
+
+    declare_func(int, struct SwsContext *c, const uint8_t *src[], int srcStride[],
+                 int srcSliceY, int srcSliceH, uint8_t *dst[], int dstStride[]);
+
+    if (!sws_isSupportedInput(src_fmt) || !sws_isSupportedOutput(dst_fmt))
+        return;
+
+    for (i = 0; i < 4 * RGB_STRIDE * RGB_H / 2; i++) {
+        uint16_t v = rnd();
+        /* planar sources of less than 16 bits hold in range samples */
+        if ((src_desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
+            src_desc->comp[0].depth > 8 && src_desc->comp[0].depth < 16)
+            v &= (1 << src_desc->comp[0].depth) - 1;
+        AV_WN16(src_buf + 2 * i, v);
+    }
+    for (i = 0; i < 4; i++) {
+        if (i < src_planes)
+            src[i] = src_buf + i * RGB_STRIDE * RGB_H;
+        if (i < dst_planes) {
+            dst0[i] = dst0_buf + i * RGB_STRIDE * RGB_H;
+            dst1[i] = dst1_buf + i * RGB_STRIDE * RGB_H;
+        }
+    }
+
+    c = sws_getContext(RGB_W, RGB_H, src_fmt, RGB_W, RGB_H, dst_fmt,
+                       SWS_POINT, NULL, NULL, NULL);
+    if (!c) {
+        fail();
+        return;
+    }
+
+    if (check_func(c->swscale, "%s_to_%s", src_desc->name,
+                   av_get_pix_fmt_name(dst_fmt))) {
+        for (w = 0; w < FF_ARRAY_ELEMS(rgb_widths); w++) {
+            /* the unscaled converters take the line width from the context */
+            c->srcW = rgb_widths[w];
+            memset(dst0_buf, 0, 4 * RGB_STRIDE * RGB_H);
+            memset(dst1_buf, 0, 4 * RGB_STRIDE * RGB_H);
+            call_ref(c, src, stride, 1, RGB_H - 1, dst0, stride);
+            call_new(c, src, stride, 1, RGB_H - 1, dst1, stride);
+            if (memcmp(dst0_buf, dst1_buf, 4 * RGB_STRIDE * RGB_H))
+                fail();
+        }
+        c->srcW = RGB_W;
+        bench_new(c, src, stride, 0, RGB_H, dst1, stride);
+    }
+    sws_freeContext(c);
+}
+
+static void check_unscaled_rgb(void)
+{
+    static const enum AVPixelFormat packed8[] = {
+        AV_PIX_FMT_RGB24, AV_PIX_FMT_BGR24,
+        AV_PIX_FMT_RGBA,  AV_PIX_FMT_BGRA,
+        AV_PIX_FMT_ARGB,  AV_PIX_FMT_ABGR,
+    };
+    static const enum AVPixelFormat planar16[] = {
+        AV_PIX_FMT_GBRP9LE,   AV_PIX_FMT_GBRP10LE,
+        AV_PIX_FMT_GBRP12LE,  AV_PIX_FMT_GBRP14LE,
+        AV_PIX_FMT_GBRP16LE,  AV_PIX_FMT_GBRAP12LE,
+        AV_PIX_FMT_GBRAP16LE,
+    };
+    static const enum AVPixelFormat packed16[] = {
+        AV_PIX_FMT_RGB48LE,  AV_PIX_FMT_BGR48LE,
+        AV_PIX_FMT_RGBA64LE, AV_PIX_FMT_BGRA64LE,
+    };
+    LOCAL_ALIGNED_32(uint8_t, src,  [4 * RGB_STRIDE * RGB_H]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [4 * RGB_STRIDE * RGB_H]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [4 * RGB_STRIDE * RGB_H]);
+    int i, j;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(packed8); i++) {
+        check_unscaled(AV_PIX_FMT_GBRP, packed8[i], src, dst0, dst1);
+        check_unscaled(packed8[i], AV_PIX_FMT_GBRP, src, dst0, dst1);
+    }
+    for (i = 0; i < FF_ARRAY_ELEMS(planar16); i++) {
+        for (j = 0; j < FF_ARRAY_ELEMS(packed16); j++) {
+            check_unscaled(planar16[i], packed16[j], src, dst0, dst1);
+            check_unscaled(packed16[j], planar16[i], src, dst0, dst1);
+        }
+    }
+    report("unscaled_rgb");
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    check_yuv2planeX();
+    check_yuv2plane1();
+    check_input_word();
+    check_input_planar_rgb();
+    check_gamma_convert();
+    check_unscaled_rgb();
+    check_bayer_to_rgb24();
+}
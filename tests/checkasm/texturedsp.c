@@ -0,0 +1,87 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/texturedsp.h"
+
+#include "checkasm.h"
+
+#define STRIDE 32
+
+/* Fill a compressed block with random bits, alternately forcing the color
+ * endpoints into the three color mode (c0 <= c1) and the alpha endpoints
+ * into the six value mode (a0 <= a1) at offset 0. */
+static void fill_block(uint8_t *block, int size, int color, int i)
+{
+    int j;
+
+    for (j = 0; j < size; j++)
+        block[j] = rnd();
+    if (i & 1)
+        FFSWAP(uint8_t, block[0], block[1]);
+    if (i & 2) {
+        block[color + 0] = block[color + 2];
+        block[color + 1] = block[color + 3];
+    }
+    if (i & 4)
+        block[1] = block[0];
+}
+
+static void check_block(int (*func)(uint8_t *, ptrdiff_t, const uint8_t *),
+                        const char *name, int size, int color)
+{
+    uint8_t block[16];
+    uint8_t dst0[4 * STRIDE], dst1[4 * STRIDE];
+    int i;
+
+    declare_func(int, uint8_t *, ptrdiff_t, const uint8_t *);
+
+    if (check_func(func, "%s", name)) {
+        for (i = 0; i < 64; i++) {
+            int ret0, ret1;
+
+            fill_block(block, size, color, i);
+            memset(dst0, 0xaa, sizeof(dst0));
+            memset(dst1, 0xaa, sizeof(dst1));
+            ret0 = call_ref(dst0, STRIDE, block);
+            ret1 = call_new(dst1, STRIDE, block);
+            if (ret0 != ret1 || memcmp(dst0, dst1, sizeof(dst0)))
+                fail();
+        }
+        bench_new(dst1, STRIDE, block);
+    }
+}
+
+void checkasm_check_texturedsp(void)
+{
+    TextureDSPContext c;
+
+    ff_texturedsp_init(&c);
+
+    check_block(c.dxt1_block,   "dxt1_block",   8,  0);
+    check_block(c.dxt1a_block,  "dxt1a_block",  8,  0);
+    check_block(c.dxt5_block,   "dxt5_block",   16, 8);
+    check_block(c.rgtc1s_block, "rgtc1s_block", 8,  0);
+    check_block(c.rgtc1u_block, "rgtc1u_block", 8,  0);
+    report("texturedsp");
+}
@@ -0,0 +1,93 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/texturedsp.h"
+
+#include "checkasm.h"
+
+#define STRIDE 32
+
+enum { BLOCK_RANDOM, BLOCK_FLAT, BLOCK_GRADIENT, BLOCK_NARROW, BLOCK_TYPES };
+
+/* Fill a 4x4 RGBA block with content exercising the different paths:
+ * random pixels, a single color, a smooth ramp and a small value range. */
+static void fill_block(uint8_t *block, int type)
+{
+    uint32_t base = rnd();
+    int x, y, ch;
+
+    for (y = 0; y < 4; y++) {
+        for (x = 0; x < 4; x++) {
+            for (ch = 0; ch < 4; ch++) {
+                uint8_t *p = block + y * STRIDE + x * 4 + ch;
+                int b = (base >> (ch * 8)) & 0xff;
+
+                switch (type) {
+                case BLOCK_RANDOM:   *p = rnd();                               break;
+                case BLOCK_FLAT:     *p = b;                                   break;
+                case BLOCK_GRADIENT: *p = av_clip_uint8(b + (x + y * 4) * 8 - 64); break;
+                case BLOCK_NARROW:   *p = av_clip_uint8(b + (rnd() & 7));       break;
+                }
+            }
+        }
+    }
+}
+
+static void check_block(int (*func)(uint8_t *, ptrdiff_t, const uint8_t *),
+                        const char *name)
+{
+    LOCAL_ALIGNED_16(uint8_t, block, [4 * STRIDE]);
+    uint8_t dst0[16], dst1[16];
+    int i, type;
+
+    declare_func(int, uint8_t *, ptrdiff_t, const uint8_t *);
+
+    if (check_func(func, "%s", name)) {
+        for (type = 0; type < BLOCK_TYPES; type++) {
+            for (i = 0; i < 16; i++) {
+                int ret0, ret1;
+
+                fill_block(block, type);
+                memset(dst0, 0xaa, sizeof(dst0));
+                memset(dst1, 0xaa, sizeof(dst1));
+                ret0 = call_ref(dst0, STRIDE, block);
+                ret1 = call_new(dst1, STRIDE, block);
+                if (ret0 != ret1 || memcmp(dst0, dst1, sizeof(dst0)))
+                    fail();
+            }
+        }
+        bench_new(dst1, STRIDE, block);
+    }
+}
+
+void checkasm_check_texturedspenc(void)
+{
+    TextureDSPContext c;
+
+    ff_texturedspenc_init(&c, TEXTURE_FIT_RANGE);
+
+    check_block(c.dxt1_block,   "dxt1_block_range");
+    check_block(c.dxt5_block,   "dxt5_block_range");
+    check_block(c.dxt5ys_block, "dxt5ys_block_range");
+    report("block_range");
+}
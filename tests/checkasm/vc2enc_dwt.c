@@ -0,0 +1,137 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavcodec/vc2enc_dwt.h"
+
+#include "checkasm.h"
+
+#define WIDTH 1024
+#define PAD   8
+
+#define randomize_buffers(buf, size)                                \
+    do {                                                            \
+        int j;                                                      \
+        for (j = 0; j < size; j++)                                  \
+            buf[j] = (int32_t)(rnd() & 0x1fffff) - (1 << 20);       \
+    } while (0)
+
+static const int widths[] = { 1, 3, 8, 45, WIDTH };
+
+static void check_deinterleave(VC2DWTDSPContext *c)
+{
+    LOCAL_ALIGNED_32(dwtcoef, src,  [2 * (WIDTH + PAD)]);
+    LOCAL_ALIGNED_32(dwtcoef, lo0, [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(dwtcoef, hi0, [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(dwtcoef, lo1, [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(dwtcoef, hi1, [WIDTH + PAD]);
+    int i, shift;
+
+    declare_func(void, dwtcoef *, dwtcoef *, const dwtcoef *, int, int);
+
+    randomize_buffers(src, 2 * (WIDTH + PAD));
+
+    for (shift = 0; shift < 2; shift++) {
+        if (check_func(c->deinterleave, "vc2enc_deinterleave_shift%d", shift)) {
+            for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                const int w = widths[i];
+                call_ref(lo0, hi0, src, w, shift);
+                call_new(lo1, hi1, src, w, shift);
+                if (memcmp(lo0, lo1, w * sizeof(*lo0)) ||
+                    memcmp(hi0, hi1, w * sizeof(*hi0)))
+                    fail();
+            }
+            bench_new(lo1, hi1, src, WIDTH, shift);
+        }
+    }
+    report("deinterleave");
+}
+
+static void check_lift(VC2DWTDSPContext *c)
+{
+    LOCAL_ALIGNED_32(dwtcoef, src,  [WIDTH + 4 * PAD]);
+    LOCAL_ALIGNED_32(dwtcoef, ref,  [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(dwtcoef, dst0, [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(dwtcoef, dst1, [WIDTH + PAD]);
+    const dwtcoef *b = src + PAD;
+    int i;
+
+    randomize_buffers(src, WIDTH + 4 * PAD);
+    randomize_buffers(ref, WIDTH + PAD);
+
+#define CHECK_LIFT(name, ...)                                               \
+    if (check_func(c->name, "vc2enc_" #name)) {                             \
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {                      \
+            const int w = widths[i];                                        \
+            memcpy(dst0, ref, (WIDTH + PAD) * sizeof(*ref));                \
+            memcpy(dst1, ref, (WIDTH + PAD) * sizeof(*ref));                \
+            call_ref(dst0, __VA_ARGS__, w);                                 \
+            call_new(dst1, __VA_ARGS__, w);                                 \
+            if (memcmp(dst0, dst1, w * sizeof(*dst0)))                      \
+                fail();                                                     \
+        }                                                                   \
+        bench_new(dst1, __VA_ARGS__, WIDTH);                                \
+    }
+
+    {
+        declare_func(void, dwtcoef *, const dwtcoef *, const dwtcoef *, int);
+        CHECK_LIFT(lift_lo,    b - 1, b)
+        CHECK_LIFT(lift_hi_53, b, b + 1)
+    }
+    {
+        declare_func(void, dwtcoef *, const dwtcoef *, const dwtcoef *,
+                     const dwtcoef *, const dwtcoef *, int);
+        CHECK_LIFT(lift_hi_97, b - 1, b, b + 1, b + 2)
+    }
+    report("lift");
+
+    if (check_func(c->haar, "vc2enc_haar")) {
+        LOCAL_ALIGNED_32(dwtcoef, lo0, [WIDTH + PAD]);
+        LOCAL_ALIGNED_32(dwtcoef, lo1, [WIDTH + PAD]);
+        declare_func(void, dwtcoef *, dwtcoef *, int);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            const int w = widths[i];
+            memcpy(lo0,  src, (WIDTH + PAD) * sizeof(*src));
+            memcpy(lo1,  src, (WIDTH + PAD) * sizeof(*src));
+            memcpy(dst0, ref, (WIDTH + PAD) * sizeof(*ref));
+            memcpy(dst1, ref, (WIDTH + PAD) * sizeof(*ref));
+            call_ref(lo0, dst0, w);
+            call_new(lo1, dst1, w);
+            if (memcmp(lo0, lo1, w * sizeof(*lo0)) ||
+                memcmp(dst0, dst1, w * sizeof(*dst0)))
+                fail();
+        }
+        bench_new(lo1, dst1, WIDTH);
+    }
+    report("haar");
+}
+
+void checkasm_check_vc2enc_dwt(void)
+{
+    VC2DWTDSPContext c;
+
+    ff_vc2enc_dwt_dsp_init(&c);
+
+    check_deinterleave(&c);
+    check_lift(&c);
+}
@@ -0,0 +1,119 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/atadenoise.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH  256
+#define FRAMES 33
+
+/* Frames are the same row plus a little noise, with some samples far off so
+ * that both thresholds are hit somewhere along the row. */
+static void fill_frames(uint16_t *buf, int depth)
+{
+    const int max = (1 << depth) - 1;
+    int i, x;
+
+    for (x = 0; x < WIDTH; x++)
+        buf[x] = rnd() & max;
+    for (i = 1; i < FRAMES; i++) {
+        for (x = 0; x < WIDTH; x++) {
+            int noise = (int)(rnd() % 9 - 4) << (depth - 8);
+            int val = buf[x] + noise;
+
+            if (!(rnd() & 31))
+                val = rnd() & max;
+            buf[i * WIDTH + x] = av_clip(val, 0, max);
+        }
+    }
+}
+
+static void check_filter_row(int depth)
+{
+    ATADenoiseDSPContext dsp;
+    const int bpp = depth > 8 ? 2 : 1;
+    uint16_t *frames = av_malloc_array(FRAMES * WIDTH, sizeof(*frames));
+    uint8_t *data = av_malloc(FRAMES * WIDTH * bpp);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH * 2]);
+    static const int sizes[] = { 5, 9, FRAMES };
+    const uint8_t *srcf[FRAMES];
+    int i, j, width;
+
+    declare_func(void, const uint8_t *src, uint8_t *dst, const uint8_t **srcf,
+                 int width, int mid, int size, int thra, int thrb);
+
+    if (!frames || !data)
+        goto end;
+
+    ff_atadenoise_dsp_init(&dsp, depth);
+
+    if (check_func(dsp.filter_row, "atadenoise_filter_row%d", depth)) {
+        for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+            const int size = sizes[i];
+            const int mid = size / 2 + 1;
+            /* default thresholds, and thra 0 which disables the check */
+            const int thra = i & 1 ? -1 : 0.02 * (1 << depth) - 1;
+            const int thrb = 0.04 * (1 << depth) * (i + 1) - 1;
+
+            fill_frames(frames, depth);
+            /* the center frame is the unmodified row, the others are noisy */
+            for (j = 0; j < FRAMES; j++) {
+                const int k = j == mid ? 0 : j < mid ? j + 1 : j;
+                int x;
+
+                for (x = 0; x < WIDTH; x++) {
+                    if (bpp == 1)
+                        data[j * WIDTH + x] = frames[k * WIDTH + x];
+                    else
+                        ((uint16_t *)data)[j * WIDTH + x] = frames[k * WIDTH + x];
+                }
+                srcf[j] = data + j * WIDTH * bpp;
+            }
+
+            for (width = 16; width <= WIDTH; width += 240) {
+                memset(dst0, 0, WIDTH * 2);
+                memset(dst1, 0, WIDTH * 2);
+                call_ref(srcf[mid], dst0, srcf, width, mid, size, thra, thrb);
+                call_new(srcf[mid], dst1, srcf, width, mid, size, thra, thrb);
+                if (memcmp(dst0, dst1, WIDTH * 2))
+                    fail();
+            }
+        }
+        bench_new(srcf[FRAMES / 2 + 1], dst1, srcf, WIDTH, FRAMES / 2 + 1, FRAMES,
+                  0.02 * (1 << depth) - 1, 0.04 * (1 << depth) - 1);
+    }
+
+end:
+    av_free(frames);
+    av_free(data);
+}
+
+void checkasm_check_atadenoise(void)
+{
+    check_filter_row(8);
+    report("filter_row8");
+
+    check_filter_row(10);
+    check_filter_row(16);
+    report("filter_row16");
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/boxblur.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+
+#define WIDTH 64
+
+static const int radii[] = { 1, 2, 7, 20 };
+
+#define randomize_buffers(buf, size, mask)      \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd() & (mask);            \
+    } while (0)
+
+/* fill sum with the state of a window of the given radius that contains sub */
+#define init_sums(sum0, sum1, sub, radius, inv, max)                            \
+    do {                                                                        \
+        int j;                                                                  \
+        for (j = 0; j < WIDTH; j++) {                                           \
+            int window = sub[j] + rnd() % (2 * (radius) * (max) + 1);           \
+            sum0[j] = sum1[j] = window * (inv) + (1 << 15);                     \
+        }                                                                       \
+    } while (0)
+
+/* samples are limited to max, so that the window sums fit in an int */
+#define CHECK_BLUR_ROW(type, depth, max)                                        \
+static void check_blur_row ## depth(BoxBlurDSPContext *dsp)                    \
+{                                                                               \
+    LOCAL_ALIGNED_32(type, add, [WIDTH]);                                       \
+    LOCAL_ALIGNED_32(type, sub, [WIDTH]);                                       \
+    LOCAL_ALIGNED_32(type, dst0, [WIDTH]);                                      \
+    LOCAL_ALIGNED_32(type, dst1, [WIDTH]);                                      \
+    LOCAL_ALIGNED_32(int32_t, sum0, [WIDTH]);                                   \
+    LOCAL_ALIGNED_32(int32_t, sum1, [WIDTH]);                                   \
+    int i, width, inv = 0;                                                      \
+                                                                                \
+    declare_func(void, type *dst, const type *add, const type *sub,             \
+                 int32_t *sum, int width, int inv);                             \
+                                                                                \
+    if (check_func(dsp->blur_row ## depth, "boxblur_blur_row" #depth)) {        \
+        for (i = 0; i < FF_ARRAY_ELEMS(radii); i++) {                           \
+            const int length = 2 * radii[i] + 1;                                \
+            inv = ((1 << 16) + length / 2) / length;                            \
+            for (width = 16; width <= WIDTH; width += 48) {                     \
+                randomize_buffers(add, WIDTH, max);                             \
+                randomize_buffers(sub, WIDTH, max);                             \
+                init_sums(sum0, sum1, sub, radii[i], inv, max);                 \
+                memset(dst0, 0, sizeof(*dst0) * WIDTH);                         \
+                memset(dst1, 0, sizeof(*dst1) * WIDTH);                         \
+                call_ref(dst0, add, sub, sum0, width, inv);                     \
+                call_new(dst1, add, sub, sum1, width, inv);                     \
+                if (memcmp(dst0, dst1, sizeof(*dst0) * WIDTH) ||                \
+                    memcmp(sum0, sum1, sizeof(*sum0) * WIDTH))                  \
+                    fail();                                                     \
+            }                                                                   \
+        }                                                                       \
+        bench_new(dst1, add, sub, sum1, WIDTH, inv);                            \
+    }                                                                           \
+}
+
+CHECK_BLUR_ROW(uint8_t,   8, 0xff)
+CHECK_BLUR_ROW(uint16_t, 16, 0x3fff)
+
+void checkasm_check_boxblur(void)
+{
+    BoxBlurDSPContext dsp;
+
+    ff_boxblur_dsp_init(&dsp);
+
+    check_blur_row8(&dsp);
+    report("blur_row8");
+
+    check_blur_row16(&dsp);
+    report("blur_row16");
+}
@@ -0,0 +1,118 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/framerate.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH  256
+#define HEIGHT 16
+#define STRIDE (WIDTH * 2 + 32)
+#define SIZE   (STRIDE * HEIGHT)
+
+#define randomize_buffers(buf, size, mask)      \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd() & (mask);            \
+    } while (0)
+
+static void check_blend(framerate_blend_func blend, int depth)
+{
+    LOCAL_ALIGNED_32(uint16_t, src1, [SIZE / 2]);
+    LOCAL_ALIGNED_32(uint16_t, src2, [SIZE / 2]);
+    LOCAL_ALIGNED_32(uint8_t,  dst0, [SIZE]);
+    LOCAL_ALIGNED_32(uint8_t,  dst1, [SIZE]);
+    uint8_t *src1_8 = (uint8_t *)src1, *src2_8 = (uint8_t *)src2;
+    const int max = 1 << depth;
+    int width, factor2;
+
+    declare_func(void, const uint8_t *src1, ptrdiff_t src1_linesize,
+                 const uint8_t *src2, ptrdiff_t src2_linesize,
+                 uint8_t *dst, ptrdiff_t dst_linesize,
+                 ptrdiff_t width, ptrdiff_t height,
+                 int factor1, int factor2, int half, int shift);
+
+    if (check_func(blend, "blend_frames%d", depth)) {
+        for (width = 32; width <= WIDTH; width += 224) {
+            if (depth == 8) {
+                randomize_buffers(src1_8, SIZE, 0xff);
+                randomize_buffers(src2_8, SIZE, 0xff);
+            } else {
+                randomize_buffers(src1, SIZE / 2, max - 1);
+                randomize_buffers(src2, SIZE / 2, max - 1);
+            }
+            factor2 = (rnd() & 0xff) * (1 << (depth - 8));
+            memset(dst0, 0, SIZE);
+            memset(dst1, 0, SIZE);
+            call_ref(src1_8, STRIDE, src2_8, STRIDE, dst0, STRIDE, width, HEIGHT,
+                     max - factor2, factor2, max / 2, depth);
+            call_new(src1_8, STRIDE, src2_8, STRIDE, dst1, STRIDE, width, HEIGHT,
+                     max - factor2, factor2, max / 2, depth);
+            if (memcmp(dst0, dst1, SIZE))
+                fail();
+        }
+        bench_new(src1_8, STRIDE, src2_8, STRIDE, dst1, STRIDE, WIDTH, HEIGHT,
+                  max - 64, 64, max / 2, depth);
+    }
+}
+
+static void check_sad16(FrameRateDSPContext *dsp, int depth)
+{
+    LOCAL_ALIGNED_32(uint16_t, src1, [SIZE / 2]);
+    LOCAL_ALIGNED_32(uint16_t, src2, [SIZE / 2]);
+    int width;
+
+    declare_func(int64_t, const uint8_t *src1, ptrdiff_t src1_linesize,
+                 const uint8_t *src2, ptrdiff_t src2_linesize,
+                 ptrdiff_t width, ptrdiff_t height);
+
+    if (check_func(dsp->sad16, "sad16_%d", depth)) {
+        for (width = 8; width <= WIDTH; width += 248) {
+            randomize_buffers(src1, SIZE / 2, (1 << depth) - 1);
+            randomize_buffers(src2, SIZE / 2, (1 << depth) - 1);
+            src1[0] = (1 << depth) - 1;
+            src2[0] = 0;
+            if (call_ref((uint8_t *)src1, STRIDE, (uint8_t *)src2, STRIDE, width, HEIGHT) !=
+                call_new((uint8_t *)src1, STRIDE, (uint8_t *)src2, STRIDE, width, HEIGHT))
+                fail();
+        }
+        bench_new((uint8_t *)src1, STRIDE, (uint8_t *)src2, STRIDE, WIDTH, HEIGHT);
+    }
+}
+
+void checkasm_check_framerate(void)
+{
+    FrameRateDSPContext dsp;
+
+    ff_framerate_dsp_init(&dsp);
+
+    check_blend(dsp.blend8, 8);
+    report("blend_frames8");
+
+    check_blend(dsp.blend16, 10);
+    check_blend(dsp.blend16, 12);
+    report("blend_frames16");
+
+    check_sad16(&dsp, 10);
+    check_sad16(&dsp, 12);
+    report("sad16");
+}
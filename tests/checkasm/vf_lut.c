@@ -0,0 +1,105 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/lut.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 256
+
+#define randomize_buffers(buf, size, mask)      \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd() & (mask);            \
+    } while (0)
+
+static void check_lut_plane8(LutDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    uint8_t lut[256];
+    int width;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint8_t *lut,
+                 int width);
+
+    if (check_func(dsp->lut_plane8, "lut_plane8")) {
+        for (width = 32; width <= WIDTH; width += 224) {
+            randomize_buffers(src, WIDTH, 0xff);
+            randomize_buffers(lut, 256, 0xff);
+            memset(dst0, 0, WIDTH);
+            memset(dst1, 0, WIDTH);
+            call_ref(dst0, src, lut, width);
+            call_new(dst1, src, lut, width);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, src, lut, WIDTH);
+    }
+}
+
+static void check_lut_plane16(LutDSPContext *dsp, int depth)
+{
+    LOCAL_ALIGNED_32(uint16_t, src,  [WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [WIDTH]);
+    uint16_t *lut = av_malloc_array((1 << depth) + 1, sizeof(*lut));
+    int width;
+
+    declare_func(void, uint16_t *dst, const uint16_t *src, const uint16_t *lut,
+                 int width);
+
+    if (!lut)
+        return;
+
+    if (check_func(dsp->lut_plane16, "lut_plane16_%d", depth)) {
+        for (width = 32; width <= WIDTH; width += 224) {
+            randomize_buffers(src, WIDTH, (1 << depth) - 1);
+            randomize_buffers(lut, (1 << depth) + 1, (1 << depth) - 1);
+            src[0] = (1 << depth) - 1;
+            memset(dst0, 0, sizeof(*dst0) * WIDTH);
+            memset(dst1, 0, sizeof(*dst1) * WIDTH);
+            call_ref(dst0, src, lut, width);
+            call_new(dst1, src, lut, width);
+            if (memcmp(dst0, dst1, sizeof(*dst0) * WIDTH))
+                fail();
+        }
+        bench_new(dst1, src, lut, WIDTH);
+    }
+
+    av_free(lut);
+}
+
+void checkasm_check_lut(void)
+{
+    LutDSPContext dsp;
+
+    ff_lut_dsp_init(&dsp);
+
+    check_lut_plane8(&dsp);
+    report("lut_plane8");
+
+    check_lut_plane16(&dsp, 10);
+    check_lut_plane16(&dsp, 16);
+    report("lut_plane16");
+}
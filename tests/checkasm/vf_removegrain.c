@@ -0,0 +1,74 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/removegrain.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#define WIDTH  256
+#define STRIDE (WIDTH + 32)
+
+#define randomize_buffers(buf, size)            \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd() & 0xff;              \
+    } while (0)
+
+static void check_removegrain(int mode)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [3 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    RemoveGrainContext s = { 0 };
+    int i, width;
+
+    declare_func(void, uint8_t *dst, uint8_t *src, ptrdiff_t stride, int pixels);
+
+    s.nb_planes = 1;
+    s.mode[0]   = mode;
+    ff_removegrain_init(&s);
+
+    if (check_func(s.fl[0], "rg_fl_mode_%d", mode)) {
+        for (width = 16; width <= WIDTH; width += 240) {
+            randomize_buffers(src, 3 * STRIDE);
+            /* flat areas exercise the tie breaking of the selecting modes */
+            for (i = 0; i < 3 * STRIDE; i += 7)
+                src[i] = src[(i + STRIDE) % (3 * STRIDE)];
+            memset(dst0, 0, WIDTH);
+            memset(dst1, 0, WIDTH);
+            call_ref(dst0, src + STRIDE + 16, STRIDE, width);
+            call_new(dst1, src + STRIDE + 16, STRIDE, width);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, src + STRIDE + 16, STRIDE, WIDTH);
+    }
+}
+
+void checkasm_check_removegrain(void)
+{
+    int mode;
+
+    for (mode = 1; mode <= 24; mode++)
+        check_removegrain(mode);
+    report("removegrain");
+}
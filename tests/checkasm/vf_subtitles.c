@@ -0,0 +1,69 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/subtitles.h"
+#include "libavutil/internal.h"
+
+#define WIDTH 256
+
+#define randomize_buffers(buf, size, mask)      \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd() & (mask);            \
+    } while (0)
+
+static void check_blend_row(SubtitlesDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, color, [WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, transp, [WIDTH]);
+    int i, w;
+
+    declare_func(void, uint8_t *dst, const uint16_t *color,
+                 const uint16_t *transp, int w);
+
+    if (check_func(dsp->blend_row, "subtitles_blend_row")) {
+        for (w = 8; w <= WIDTH; w += 56) {
+            randomize_buffers(dst0, WIDTH, 0xff);
+            randomize_buffers(transp, WIDTH, 0xffff);
+            /* a premultiplied color never exceeds the opacity */
+            for (i = 0; i < WIDTH; i++)
+                color[i] = (rnd() & 0xff) * (0xffff - transp[i]) / 0xffff << 8;
+            memcpy(dst1, dst0, WIDTH);
+            call_ref(dst0, color, transp, w);
+            call_new(dst1, color, transp, w);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, color, transp, WIDTH);
+    }
+}
+
+void checkasm_check_subtitles(void)
+{
+    SubtitlesDSPContext dsp;
+
+    ff_subtitles_dsp_init(&dsp);
+
+    check_blend_row(&dsp);
+    report("blend_row");
+}
@@ -0,0 +1,135 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/unsharp.h"
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH    256
+#define STAGES   4
+#define BUF_SIZE (WIDTH + 64)
+
+#define randomize_buffers(buf, size, mask)      \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            buf[j] = rnd() & (mask);            \
+    } while (0)
+
+static void check_hblur_pass(UnsharpDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint32_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, buf1, [BUF_SIZE]);
+    int len;
+
+    declare_func(void, uint32_t *buf, int len);
+
+    if (check_func(dsp->hblur_pass, "unsharp_hblur_pass")) {
+        for (len = WIDTH - 3; len <= WIDTH; len++) {
+            randomize_buffers(buf0, BUF_SIZE, 0xffffff);
+            memcpy(buf1, buf0, sizeof(*buf0) * BUF_SIZE);
+            call_ref(buf0, len);
+            call_new(buf1, len);
+            if (memcmp(buf0, buf1, sizeof(*buf0) * len))
+                fail();
+        }
+        bench_new(buf1, WIDTH);
+    }
+}
+
+static void check_vblur(UnsharpDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint32_t, acc0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, acc1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, state0, [STAGES * BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, state1, [STAGES * BUF_SIZE]);
+    uint32_t *sc0[STAGES], *sc1[STAGES];
+    int i;
+
+    declare_func(void, uint32_t *acc, uint32_t *const *sc, int nb_stages, int width);
+
+    for (i = 0; i < STAGES; i++) {
+        sc0[i] = state0 + i * BUF_SIZE;
+        sc1[i] = state1 + i * BUF_SIZE;
+    }
+
+    if (check_func(dsp->vblur, "unsharp_vblur")) {
+        for (i = 2; i <= STAGES; i += 2) {
+            randomize_buffers(acc0, BUF_SIZE, 0xffffff);
+            randomize_buffers(state0, STAGES * BUF_SIZE, 0xffffff);
+            memcpy(acc1, acc0, sizeof(*acc0) * BUF_SIZE);
+            memcpy(state1, state0, sizeof(*state0) * STAGES * BUF_SIZE);
+            call_ref(acc0, sc0, i, WIDTH);
+            call_new(acc1, sc1, i, WIDTH);
+            if (memcmp(acc0, acc1, sizeof(*acc0) * WIDTH) ||
+                memcmp(state0, state1, sizeof(*state0) * STAGES * BUF_SIZE))
+                fail();
+        }
+        bench_new(acc1, sc1, STAGES, WIDTH);
+    }
+}
+
+static void check_sharpen(UnsharpDSPContext *dsp)
+{
+    static const float amounts[] = { -1.5, 0.5, 5.0 };
+    LOCAL_ALIGNED_32(uint8_t, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, blur, [BUF_SIZE]);
+    const int scalebits = 2 * STAGES;
+    int i, width;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint32_t *blur,
+                 int width, int amount, int scalebits, uint32_t halfscale);
+
+    if (check_func(dsp->sharpen, "unsharp_sharpen")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(amounts); i++) {
+            const int amount = amounts[i] * 65536.0;
+            for (width = WIDTH - 7; width <= WIDTH; width += 7) {
+                randomize_buffers(src, BUF_SIZE, 0xff);
+                randomize_buffers(blur, BUF_SIZE, (1 << (8 + scalebits)) - 1);
+                memset(dst0, 0, BUF_SIZE);
+                memset(dst1, 0, BUF_SIZE);
+                call_ref(dst0, src, blur, width, amount, scalebits, 1 << (scalebits - 1));
+                call_new(dst1, src, blur, width, amount, scalebits, 1 << (scalebits - 1));
+                if (memcmp(dst0, dst1, width))
+                    fail();
+            }
+        }
+        bench_new(dst1, src, blur, WIDTH, 65536, scalebits, 1 << (scalebits - 1));
+    }
+}
+
+void checkasm_check_unsharp(void)
+{
+    UnsharpDSPContext dsp;
+
+    ff_unsharp_dsp_init(&dsp);
+
+    check_hblur_pass(&dsp);
+    report("hblur_pass");
+
+    check_vblur(&dsp);
+    report("vblur");
+
+    check_sharpen(&dsp);
+    report("sharpen");
+}
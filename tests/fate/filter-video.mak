@@ -368,6 +368,18 @@ fate-filter-scale200: CMD = video_filter "scale=w=200:h=200"
 FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scale500
 fate-filter-scale500: CMD = video_filter "scale=w=500:h=500"
 
+FATE_FILTER_VSYNTH-$(CONFIG_DRAWTEXT_FILTER) += fate-filter-drawtext
+fate-filter-drawtext: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawtext=fontfile=$(SRC_PATH)/tests/drawtext.bdf:fontsize=8:fontcolor=white:shadowx=1:shadowy=1:x=8:y=8:text=0123.456789 -frames 15
+
+FATE_FILTER_VSYNTH-$(CONFIG_DRAWTEXT_FILTER) += fate-filter-drawtext-counter
+fate-filter-drawtext-counter: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawtext=fontfile=$(SRC_PATH)/tests/drawtext.bdf:fontsize=8:fontcolor=white:shadowx=1:shadowy=1:x=8:y=8:text=00.%{n} -frames 15
+
+FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scalegamma
+fate-filter-scalegamma: CMD = video_filter "scale=w=176:h=144:gamma=1"
+
+FATE_FILTER_VSYNTH-$(call ALLYES, FORMAT_FILTER SCALE_FILTER) += fate-filter-scalegamma-rgba
+fate-filter-scalegamma-rgba: CMD = video_filter "format=rgba,scale=w=176:h=144:gamma=1"
+
 FATE_FILTER_VSYNTH-$(CONFIG_SCALE_FILTER) += fate-filter-scalechroma
 fate-filter-scalechroma: tests/data/vsynth1.yuv
 fate-filter-scalechroma: CMD = framecrc -flags bitexact -s 352x288 -pix_fmt yuv444p -i tests/data/vsynth1.yuv -pix_fmt yuv420p -sws_flags +bitexact -vf scale=out_v_chr_pos=33:out_h_chr_pos=151